@@ -21,6 +21,10 @@
 //  - wxAtomicDec must return a zero value if the value is zero once
 //  decremented else it must return any non-zero value (the true value is OK
 //  but not necessary).
+//  - wxAtomicCompareExchange must atomically replace the value with the new
+//  one if it is equal to the expected one and return true if it did it, it
+//  is only available if wxHAS_ATOMIC_COMPARE_EXCHANGE is defined and is a full
+//  memory barrier.
 
 #if wxUSE_THREADS
 
@@ -41,6 +45,20 @@ inline wxUint32 wxAtomicDec (wxUint32 &value)
     return __sync_sub_and_fetch(&value, 1);
 }
 
+inline bool
+wxAtomicCompareExchange(wxUint32 volatile& value, wxUint32 expected, wxUint32 desired)
+{
+    return __sync_bool_compare_and_swap(&value, expected, desired);
+}
+
+template <typename T>
+inline bool
+wxAtomicCompareExchange(T* volatile& value, T* expected, T* desired)
+{
+    return __sync_bool_compare_and_swap(&value, expected, desired);
+}
+
+#define wxHAS_ATOMIC_COMPARE_EXCHANGE
 
 #elif defined(__WINDOWS__)
 
@@ -57,6 +75,27 @@ inline wxUint32 wxAtomicDec (wxUint32 &value)
     return InterlockedDecrement ((LONG*)&value);
 }
 
+inline bool
+wxAtomicCompareExchange(wxUint32 volatile& value, wxUint32 expected, wxUint32 desired)
+{
+    return (wxUint32)InterlockedCompareExchange
+           (
+            (LONG volatile*)&value, desired, expected
+           ) == expected;
+}
+
+template <typename T>
+inline bool
+wxAtomicCompareExchange(T* volatile& value, T* expected, T* desired)
+{
+    return InterlockedCompareExchangePointer
+           (
+            (PVOID volatile*)&value, desired, expected
+           ) == expected;
+}
+
+#define wxHAS_ATOMIC_COMPARE_EXCHANGE
+
 #elif defined(__DARWIN__)
 
 #include "libkern/OSAtomic.h"
@@ -70,6 +109,23 @@ inline wxUint32 wxAtomicDec (wxUint32 &value)
     return OSAtomicDecrement32 ((int32_t*)&value);
 }
 
+inline bool
+wxAtomicCompareExchange(wxUint32 volatile& value, wxUint32 expected, wxUint32 desired)
+{
+    return OSAtomicCompareAndSwap32Barrier(expected, desired,
+                                           (int32_t volatile*)&value);
+}
+
+template <typename T>
+inline bool
+wxAtomicCompareExchange(T* volatile& value, T* expected, T* desired)
+{
+    return OSAtomicCompareAndSwapPtrBarrier(expected, desired,
+                                            (void* volatile*)&value);
+}
+
+#define wxHAS_ATOMIC_COMPARE_EXCHANGE
+
 #elif defined (__SOLARIS__)
 
 #include <atomic.h>
@@ -84,6 +140,29 @@ inline wxUint32 wxAtomicDec (wxUint32 &value)
     return atomic_add_32_nv ((uint32_t*)&value, (uint32_t)-1);
 }
 
+inline bool
+wxAtomicCompareExchange(wxUint32 volatile& value, wxUint32 expected, wxUint32 desired)
+{
+    membar_exit();
+    const bool ok = atomic_cas_32((uint32_t volatile*)&value,
+                                  expected, desired) == expected;
+    membar_enter();
+    return ok;
+}
+
+template <typename T>
+inline bool
+wxAtomicCompareExchange(T* volatile& value, T* expected, T* desired)
+{
+    membar_exit();
+    const bool ok = atomic_cas_ptr((void volatile*)&value,
+                                   expected, desired) == expected;
+    membar_enter();
+    return ok;
+}
+
+#define wxHAS_ATOMIC_COMPARE_EXCHANGE
+
 #else // unknown platform
 
 // it will result in inclusion if the generic implementation code a bit later in this page
@@ -97,6 +176,29 @@ inline wxUint32 wxAtomicDec (wxUint32 &value)
 inline void wxAtomicInc (wxUint32 &value) { ++value; }
 inline wxUint32 wxAtomicDec (wxUint32 &value) { return --value; }
 
+inline bool
+wxAtomicCompareExchange(wxUint32 volatile& value, wxUint32 expected, wxUint32 desired)
+{
+    if ( value != expected )
+        return false;
+
+    value = desired;
+    return true;
+}
+
+template <typename T>
+inline bool
+wxAtomicCompareExchange(T* volatile& value, T* expected, T* desired)
+{
+    if ( value != expected )
+        return false;
+
+    value = desired;
+    return true;
+}
+
+#define wxHAS_ATOMIC_COMPARE_EXCHANGE
+
 #endif // !wxUSE_THREADS
 
 // ----------------------------------------------------------------------------
@@ -27,6 +27,7 @@
 #include "wx/tracker.h"
 #include "wx/typeinfo.h"
 #include "wx/any.h"
+#include "wx/vector.h"
 
 #include "wx/meta/convertible.h"
 
@@ -71,6 +72,7 @@ class WXDLLIMPEXP_FWD_BASE wxEventFilter;
 
 class WXDLLIMPEXP_FWD_BASE wxMSVC_FWD_MULTIPLE_BASES wxEvtHandler;
 class wxEventConnectionRef;
+class wxEventCoalescingMap;
 
 // ----------------------------------------------------------------------------
 // Event types
@@ -915,6 +917,19 @@ public:
     void Skip(bool skip = true) { m_skipped = skip; }
     bool GetSkipped() const { return m_skipped; }
 
+    // Set the key used to coalesce this event with the other events of the
+    // same type queued for the same handler: only the most recently queued
+    // one of all the pending events with the same type and key is processed.
+    void SetCoalescingKey(long key)
+    {
+        m_coalescingKey = key;
+        m_hasCoalescingKey = true;
+    }
+
+    void ResetCoalescingKey() { m_hasCoalescingKey = false; }
+    bool HasCoalescingKey() const { return m_hasCoalescingKey; }
+    long GetCoalescingKey() const { return m_coalescingKey; }
+
     // This function is used to create a copy of the event polymorphically and
     // all derived classes must implement it because otherwise wxPostEvent()
     // for them wouldn't work (it needs to do a copy of the event)
@@ -1018,6 +1033,18 @@ private:
     // If this handler
     wxEvtHandler *m_handlerToProcessOnlyIn;
 
+    // The next event in the list of the pending events of wxEvtHandler, only
+    // used while this event is queued.
+    wxEvent *m_nextPending;
+
+    // The key set by SetCoalescingKey(), only used if m_hasCoalescingKey.
+    long m_coalescingKey;
+    bool m_hasCoalescingKey;
+
+    // Set for a pending event when a more recent event with the same type and
+    // coalescing key is queued, such event is discarded instead of processed.
+    bool m_isSuperseded;
+
 protected:
     // the propagation level: while it is positive, we propagate the event to
     // the parent window (if any)
@@ -1052,6 +1079,9 @@ private:
     // and this one needs to access our m_handlerToProcessOnlyIn
     friend class WXDLLIMPEXP_FWD_BASE wxEventProcessInHandlerOnly;
 
+    // while this one uses m_nextPending for its pending events list
+    friend class WXDLLIMPEXP_FWD_BASE wxEvtHandler;
+
 
     DECLARE_ABSTRACT_CLASS(wxEvent)
 };
@@ -3659,10 +3689,31 @@ protected:
     wxEvtHandler*       m_nextHandler;
     wxEvtHandler*       m_previousHandler;
     wxList*             m_dynamicEvents;
-    wxList*             m_pendingEvents;
+
+    // The events queued by QueueEvent(), possibly from other threads, linked
+    // by wxEvent::m_nextPending in the reverse order: this pointer is only
+    // modified atomically and the queue can be appended to without locking.
+    wxEvent* volatile   m_pendingEventsQueued;
+
+    // The events already taken from the queue above by ProcessPendingEvents()
+    // in the order in which they should be processed.
+    wxEvent*            m_pendingEventsFirst;
+    wxEvent*            m_pendingEventsLast;
+
+    // Non-zero if this handler doesn't need to be added to the list of the
+    // handlers with pending events in wxApp when a new event is queued, only
+    // modified atomically.
+    wxUint32 volatile   m_pendingEventsRegistered;
+
+    // The most recent event for each of the distinct event type and
+    // coalescing key pairs used by the events in m_pendingEventsFirst list,
+    // protected by the same lock and only allocated when the first event with
+    // a coalescing key is queued.
+    wxEventCoalescingMap* m_pendingEventsCoalescing;
 
 #if wxUSE_THREADS
-    // critical section protecting m_pendingEvents
+    // critical section protecting m_pendingEventsFirst and Last, only used
+    // when processing the events and not when queuing them
     wxCriticalSection m_pendingEventsLock;
 #endif // wxUSE_THREADS
 
@@ -3701,6 +3752,19 @@ private:
     // try to process events in all handlers chained to this one
     bool DoTryChain(wxEvent& event);
 
+    // move the events from m_pendingEventsQueued to m_pendingEventsFirst and
+    // Last, must be called with m_pendingEventsLock held
+    void TakePendingEvents();
+
+    // remove this handler from the list of handlers with pending events in
+    // wxApp if it doesn't have any, must be called with m_pendingEventsLock
+    // held
+    void UnregisterIfNoPendingEvents();
+
+    // remove the given event, following prev (which may be NULL), from
+    // m_pendingEventsFirst list, must be called with m_pendingEventsLock held
+    void RemovePendingEvent(wxEvent* prev, wxEvent* event);
+
     // Head of the event filter linked list.
     static wxEventFilter* ms_filterList;
 
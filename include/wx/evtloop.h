@@ -207,6 +207,11 @@ protected:
     // been really called IsActive() but it's too late to change this now).
     bool IsInsideRun() const { return m_isInsideRun; }
 
+    // Return true if this loop runs in a worker thread independently of the
+    // application main loop: such loops never become active, so that the
+    // application events are still dispatched by the main loop.
+    virtual bool IsWorkerLoop() const { return false; }
+
 
     // the pointer to currently active loop
     static wxEventLoopBase *ms_activeLoop;
@@ -18,6 +18,7 @@
 #include "wx/hashmap.h"
 
 #include "wx/scrolwin.h"
+#include "wx/vector.h"
 
 // ----------------------------------------------------------------------------
 // constants
@@ -78,6 +79,15 @@ enum wxGridRenderStyle
                           wxGRID_DRAW_BOX_RECT
 };
 
+// Flags used with wxGrid::SetAutoSizeMode() to select how the auto-sizing
+// functions measure the contents of the cells.
+enum wxGridAutoSizeMode
+{
+    wxGRID_AUTOSIZE_DEFAULT = 0x000,
+    wxGRID_AUTOSIZE_PARALLEL = 0x001,
+    wxGRID_AUTOSIZE_SAMPLE = 0x002
+};
+
 // ----------------------------------------------------------------------------
 // forward declarations
 // ----------------------------------------------------------------------------
@@ -198,6 +208,20 @@ public:
         return GetBestSize(grid, attr, dc, row, col).GetWidth();
     }
 
+    // If the best size of the cell is just the extent of its text drawn with
+    // the font of the given attribute, return true and fill the text. This
+    // allows wxGrid to measure many cells at once, possibly in other threads,
+    // when auto-sizing them. The default implementation returns false and the
+    // standard renderers only return true when they are used directly, as a
+    // derived class may compute its best size differently.
+    virtual bool GetBestSizeText(wxGrid& WXUNUSED(grid),
+                                 wxGridCellAttr& WXUNUSED(attr),
+                                 int WXUNUSED(row), int WXUNUSED(col),
+                                 wxString* WXUNUSED(text))
+    {
+        return false;
+    }
+
     // create a new object which is the copy of this one
     virtual wxGridCellRenderer *Clone() const = 0;
 };
@@ -888,6 +912,110 @@ private:
     DECLARE_DYNAMIC_CLASS_NO_COPY( wxGridStringTable )
 };
 
+// ----------------------------------------------------------------------------
+// wxGridTypedTable: a table storing the values of each column in its own type
+// ----------------------------------------------------------------------------
+
+// the types of the columns of wxGridTypedTable
+enum wxGridColumnType
+{
+    wxGRID_COLUMN_STRING,   // wxString, equal strings are stored only once
+    wxGRID_COLUMN_NUMBER,   // wxInt64
+    wxGRID_COLUMN_FLOAT,    // double
+    wxGRID_COLUMN_BOOL      // bool
+};
+
+class wxGridTypedTableColumn;
+
+class WXDLLIMPEXP_ADV wxGridTypedTable : public wxGridTableBase
+{
+public:
+    wxGridTypedTable();
+    wxGridTypedTable( int numRows, int numCols,
+                      wxGridColumnType type = wxGRID_COLUMN_STRING );
+    virtual ~wxGridTypedTable();
+
+    // add columns of the given type, the overloads without the type add
+    // string columns
+    bool InsertCols( size_t pos, size_t numCols, wxGridColumnType type );
+    bool AppendCols( size_t numCols, wxGridColumnType type );
+
+    // change the type of the column, converting its values to the new type
+    void SetColType( int col, wxGridColumnType type );
+    wxGridColumnType GetColType( int col ) const;
+
+    // access the values of the wxGRID_COLUMN_NUMBER columns without losing
+    // precision when long is 32 bit
+    wxInt64 GetValueAsInt64( int row, int col );
+    void SetValueAsInt64( int row, int col, wxInt64 value );
+
+    // set the values of count cells of the column starting at the given row
+    // at once, the type of the values must correspond to the column type
+    void SetColValues( int col, int row, const wxString *values, size_t count );
+    void SetColValues( int col, int row, const wxInt64 *values, size_t count );
+    void SetColValues( int col, int row, const double *values, size_t count );
+    void SetColValues( int col, int row, const bool *values, size_t count );
+
+    // these are pure virtual in wxGridTableBase
+    //
+    virtual int GetNumberRows() wxOVERRIDE { return static_cast<int>(m_numRows); }
+    virtual int GetNumberCols() wxOVERRIDE { return static_cast<int>(m_cols.size()); }
+    virtual wxString GetValue( int row, int col ) wxOVERRIDE;
+    virtual void SetValue( int row, int col, const wxString& s ) wxOVERRIDE;
+
+    // overridden functions from wxGridTableBase
+    //
+    virtual bool IsEmptyCell( int row, int col ) wxOVERRIDE;
+
+    virtual wxString GetTypeName( int row, int col ) wxOVERRIDE;
+    virtual bool CanGetValueAs( int row, int col, const wxString& typeName ) wxOVERRIDE;
+
+    virtual long GetValueAsLong( int row, int col ) wxOVERRIDE;
+    virtual double GetValueAsDouble( int row, int col ) wxOVERRIDE;
+    virtual bool GetValueAsBool( int row, int col ) wxOVERRIDE;
+
+    virtual void SetValueAsLong( int row, int col, long value ) wxOVERRIDE;
+    virtual void SetValueAsDouble( int row, int col, double value ) wxOVERRIDE;
+    virtual void SetValueAsBool( int row, int col, bool value ) wxOVERRIDE;
+
+    void Clear() wxOVERRIDE;
+    bool InsertRows( size_t pos = 0, size_t numRows = 1 ) wxOVERRIDE;
+    bool AppendRows( size_t numRows = 1 ) wxOVERRIDE;
+    bool DeleteRows( size_t pos = 0, size_t numRows = 1 ) wxOVERRIDE;
+    bool InsertCols( size_t pos = 0, size_t numCols = 1 ) wxOVERRIDE;
+    bool AppendCols( size_t numCols = 1 ) wxOVERRIDE;
+    bool DeleteCols( size_t pos = 0, size_t numCols = 1 ) wxOVERRIDE;
+
+    void SetRowLabelValue( int row, const wxString& ) wxOVERRIDE;
+    void SetColLabelValue( int col, const wxString& ) wxOVERRIDE;
+    wxString GetRowLabelValue( int row ) wxOVERRIDE;
+    wxString GetColLabelValue( int col ) wxOVERRIDE;
+
+private:
+    // return the column if the cell coordinates are valid or NULL
+    wxGridTypedTableColumn *GetCol( int row, int col ) const;
+
+    // return the column if the coordinates are valid and it has this type
+    wxGridTypedTableColumn *GetColOfType( int row, int col,
+                                          wxGridColumnType type ) const;
+
+    // common part of all SetColValues() overloads
+    wxGridTypedTableColumn *GetColForValues( int col, int row, size_t count,
+                                             wxGridColumnType type ) const;
+
+    size_t m_numRows;
+
+    // the columns owned by the table
+    wxVector<wxGridTypedTableColumn *> m_cols;
+
+    // these only get used if you set your own labels, otherwise the
+    // GetRow/ColLabelValue functions return wxGridTableBase defaults
+    wxArrayString m_rowLabels;
+    wxArrayString m_colLabels;
+
+    DECLARE_DYNAMIC_CLASS_NO_COPY( wxGridTypedTable )
+};
+
 
 
 // ============================================================================
@@ -927,6 +1055,54 @@ struct WXDLLIMPEXP_ADV wxGridSizesInfo
     wxUnsignedToIntHashMap m_customSizes;
 };
 
+// ----------------------------------------------------------------------------
+// wxGridLineEnds stores the positions of the ends of the rows or columns.
+//
+// This class is only used internally by wxGrid. It stores the differences
+// between the sizes of the lines in their display order and the default size
+// in a binary indexed (Fenwick) tree, allowing to change the size of a line,
+// find the end of a line or the line at the given coordinate in O(log(N)).
+// ----------------------------------------------------------------------------
+
+class WXDLLIMPEXP_ADV wxGridLineEnds
+{
+public:
+    wxGridLineEnds() { m_sizeDefault = 0; }
+
+    // (re)initialize the ends from the sizes of the lines which are negative
+    // for the hidden lines, the order contains the index of the line at each
+    // position and may be empty if the lines are in their natural order
+    void Init(const wxArrayInt& sizes, const wxArrayInt& order, int sizeDefault);
+
+    void Clear() { m_tree.Empty(); }
+    bool IsEmpty() const { return m_tree.IsEmpty(); }
+
+    // add the given number of lines of the default size after the existing
+    // ones, this takes O(count*log(N)) instead of O(N) for Init()
+    void AppendDefault(int count);
+
+    // get the end of the line at the given display position
+    int GetEnd(int pos) const;
+
+    // change the size of the line at the given display position by diff
+    void Add(int pos, int diff);
+
+    // return the position of the first line ending after the given
+    // coordinate or the number of lines if there is none
+    int FindPos(int coord) const;
+
+private:
+    // return the sum of the elements of m_tree for the first count lines
+    int GetSum(int count) const;
+
+    // the default size of the lines which is not stored in m_tree
+    int m_sizeDefault;
+
+    // the element i (1-based) contains the sum of the differences from the
+    // default size for the lines (i - (i & -i), i]
+    wxArrayInt m_tree;
+};
+
 // ----------------------------------------------------------------------------
 // wxGrid
 // ----------------------------------------------------------------------------
@@ -1473,6 +1649,13 @@ public:
     void     AutoSizeRows( bool setAsMin = true )
         { (void)SetOrCalcRowSizes(false, setAsMin); }
 
+    // select how the functions above measure the cells contents, mode is a
+    // combination of wxGridAutoSizeMode flags and maxSampledRows is only used
+    // with wxGRID_AUTOSIZE_SAMPLE
+    void     SetAutoSizeMode( int mode, int maxSampledRows = 1000 );
+    int      GetAutoSizeMode() const { return m_autoSizeMode; }
+    int      GetAutoSizeMaxSampledRows() const { return m_autoSizeMaxSampledRows; }
+
     // auto size the grid, that is make the columns/rows of the "right" size
     // and also set the grid size to just fit its contents
     void     AutoSize();
@@ -1919,18 +2102,24 @@ protected:
     // init the m_rowHeights/Bottoms arrays with default values
     void InitRowHeights();
 
+    // recompute m_rowBottoms from m_rowHeights
+    void UpdateRowBottoms();
+
     int        m_defaultRowHeight;
     int        m_minAcceptableRowHeight;
     wxArrayInt m_rowHeights;
-    wxArrayInt m_rowBottoms;
+    wxGridLineEnds m_rowBottoms;
 
     // init the m_colWidths/Rights arrays
     void InitColWidths();
 
+    // recompute m_colRights from m_colWidths and the columns order
+    void UpdateColRights();
+
     int        m_defaultColWidth;
     int        m_minAcceptableColWidth;
     wxArrayInt m_colWidths;
-    wxArrayInt m_colRights;
+    wxGridLineEnds m_colRights;
 
     int m_sortCol;
     bool m_sortIsAscending;
@@ -1987,6 +2176,21 @@ protected:
     // common part of AutoSizeColumn/Row()
     void AutoSizeColOrRow(int n, bool setAsMin, wxGridDirection direction);
 
+    // set the size of the column or row to the given extent of its cells
+    // contents or to the extent of its label if it's bigger
+    void DoAutoSizeColOrRow(int n, bool setAsMin, wxGridDirection direction,
+                            wxCoord extent);
+
+    // compute the maximal extent of the cells contents of each of count
+    // columns or rows starting from the given one, hidden ones are skipped
+    void CalcColsOrRowsContentsExtents(int first, int count,
+                                       wxGridDirection direction,
+                                       wxArrayInt& extents);
+
+    // get the rows to measure when auto-sizing the given column using
+    // wxGRID_AUTOSIZE_SAMPLE mode
+    void GetAutoSizeSampledRows(int col, wxArrayInt& rows) const;
+
     // Calculate the minimum acceptable size for labels area
     wxCoord CalcColOrRowLabelAreaMinSize(wxGridDirection direction);
 
@@ -2107,6 +2311,9 @@ protected:
 
     TabBehaviour m_tabBehaviour;        // determines how the TAB key behaves
 
+    int m_autoSizeMode;                 // combination of wxGridAutoSizeMode
+    int m_autoSizeMaxSampledRows;       // used with wxGRID_AUTOSIZE_SAMPLE
+
     void Init();        // common part of all ctors
     void Create();
     void CreateColumnWindow();
@@ -37,6 +37,11 @@ public:
                                wxDC& dc,
                                int row, int col) wxOVERRIDE;
 
+    virtual bool GetBestSizeText(wxGrid& grid,
+                                 wxGridCellAttr& attr,
+                                 int row, int col,
+                                 wxString* text) wxOVERRIDE;
+
     virtual wxGridCellRenderer *Clone() const wxOVERRIDE
         { return new wxGridCellStringRenderer; }
 
@@ -70,6 +75,11 @@ public:
                                wxDC& dc,
                                int row, int col) wxOVERRIDE;
 
+    virtual bool GetBestSizeText(wxGrid& grid,
+                                 wxGridCellAttr& attr,
+                                 int row, int col,
+                                 wxString* text) wxOVERRIDE;
+
     virtual wxGridCellRenderer *Clone() const wxOVERRIDE
         { return new wxGridCellNumberRenderer; }
 
@@ -105,6 +115,11 @@ public:
                                wxDC& dc,
                                int row, int col) wxOVERRIDE;
 
+    virtual bool GetBestSizeText(wxGrid& grid,
+                                 wxGridCellAttr& attr,
+                                 int row, int col,
+                                 wxString* text) wxOVERRIDE;
+
     // parameters string format is "width[,precision[,format]]"
     // with format being one of f|e|g|E|F|G
     virtual void SetParameters(const wxString& params) wxOVERRIDE;
@@ -173,6 +188,11 @@ public:
                                wxDC& dc,
                                int row, int col) wxOVERRIDE;
 
+    virtual bool GetBestSizeText(wxGrid& grid,
+                                 wxGridCellAttr& attr,
+                                 int row, int col,
+                                 wxString* text) wxOVERRIDE;
+
     virtual wxGridCellRenderer *Clone() const wxOVERRIDE;
 
     // output strptime()-like format string
@@ -208,6 +228,11 @@ public:
                                wxDC& dc,
                                int row, int col) wxOVERRIDE;
 
+    virtual bool GetBestSizeText(wxGrid& grid,
+                                 wxGridCellAttr& attr,
+                                 int row, int col,
+                                 wxString* text) wxOVERRIDE;
+
     virtual wxGridCellRenderer *Clone() const wxOVERRIDE;
 
     // parameters string format is "item1[,item2[...,itemN]]" where itemN will
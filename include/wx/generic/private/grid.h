@@ -12,6 +12,8 @@
 #define _WX_GENERIC_GRID_PRIVATE_H_
 
 #include "wx/defs.h"
+#include "wx/hashmap.h"
+#include "wx/vector.h"
 
 #if wxUSE_GRID
 
@@ -26,55 +28,35 @@ wxDECLARE_EVENT( wxEVT_GRID_HIDE_EDITOR, wxCommandEvent );
 WX_DEFINE_ARRAY_WITH_DECL_PTR(wxGridCellAttr *, wxArrayAttrs,
                                  class WXDLLIMPEXP_ADV);
 
-struct wxGridCellWithAttr
+// hash function for wxGridCellCoords
+struct wxGridCellCoordsHash
 {
-    wxGridCellWithAttr(int row, int col, wxGridCellAttr *attr_)
-        : coords(row, col), attr(attr_)
-    {
-        wxASSERT( attr );
-    }
+    wxGridCellCoordsHash() { }
 
-    wxGridCellWithAttr(const wxGridCellWithAttr& other)
-        : coords(other.coords),
-          attr(other.attr)
+    unsigned long operator()(const wxGridCellCoords& coords) const
     {
-        attr->IncRef();
+        return ((unsigned long)coords.GetRow() * 0x9e3779b1UL) ^
+                    (unsigned long)coords.GetCol();
     }
 
-    wxGridCellWithAttr& operator=(const wxGridCellWithAttr& other)
-    {
-        coords = other.coords;
-        if (attr != other.attr)
-        {
-            attr->DecRef();
-            attr = other.attr;
-            attr->IncRef();
-        }
-        return *this;
-    }
+    wxGridCellCoordsHash& operator=(const wxGridCellCoordsHash&)
+        { return *this; }
+};
 
-    void ChangeAttr(wxGridCellAttr* new_attr)
-    {
-        if (attr != new_attr)
-        {
-            // "Delete" (i.e. DecRef) the old attribute.
-            attr->DecRef();
-            attr = new_attr;
-            // Take ownership of the new attribute, i.e. no IncRef.
-        }
-    }
+struct wxGridCellCoordsEqual
+{
+    wxGridCellCoordsEqual() { }
 
-    ~wxGridCellWithAttr()
-    {
-        attr->DecRef();
-    }
+    bool operator()(const wxGridCellCoords& a, const wxGridCellCoords& b) const
+        { return a == b; }
 
-    wxGridCellCoords coords;
-    wxGridCellAttr  *attr;
+    wxGridCellCoordsEqual& operator=(const wxGridCellCoordsEqual&)
+        { return *this; }
 };
 
-WX_DECLARE_OBJARRAY_WITH_DECL(wxGridCellWithAttr, wxGridCellWithAttrArray,
-                              class WXDLLIMPEXP_ADV);
+WX_DECLARE_HASH_MAP_WITH_DECL(wxGridCellCoords, wxGridCellAttr *,
+                              wxGridCellCoordsHash, wxGridCellCoordsEqual,
+                              wxGridCellAttrHash, class WXDLLIMPEXP_ADV);
 
 
 // ----------------------------------------------------------------------------
@@ -407,20 +389,83 @@ private:
 // the internal data representation used by wxGridCellAttrProvider
 // ----------------------------------------------------------------------------
 
+// this class gives ids to the rows or columns containing cells with
+// attributes, which, unlike their indices, don't change when other rows or
+// columns are inserted or deleted
+class WXDLLIMPEXP_ADV wxGridCellAttrIds
+{
+public:
+    enum { NO_ID = -1 };
+
+    // returns the id of the row or column or NO_ID if it doesn't have any
+    int Get(int rowOrCol) const
+    {
+        return (size_t)rowOrCol < m_ids.size() ? m_ids[rowOrCol] : NO_ID;
+    }
+
+    // returns the id of the row or column, giving it a new one if necessary
+    int GetOrCreate(int rowOrCol);
+
+    // returns the upper bound of all the currently allocated ids
+    int GetIdsCount() const { return m_uses.size(); }
+
+    // must be called when a cell using this id is added or removed
+    void AddUse(int id) { m_uses[id]++; }
+    void RemoveUse(int id) { m_uses[id]--; }
+
+    // returns true if there are any cells using this id
+    bool IsUsed(int id) const { return m_uses[id] > 0; }
+
+    // returns true if the row or column having this id was deleted
+    bool IsDeleted(int id) const { return m_uses[id] == DELETED; }
+
+    // updates the ids after inserting or deleting rows or columns, the ids of
+    // the deleted ones which are still used by some cells are returned in
+    // deletedIds and must be passed to FreeId() after removing these cells
+    void UpdateAttrRowsOrCols( size_t pos, int numRowsOrCols,
+                               wxVector<int>& deletedIds );
+
+    // makes the id of a deleted row or column available for reuse
+    void FreeId(int id);
+
+private:
+    enum { DELETED = -1 };
+
+    // the id of each row or column or NO_ID
+    wxVector<int> m_ids;
+
+    // the number of cells using each id or DELETED
+    wxVector<int> m_uses;
+
+    // the ids which are not used by any row or column any more, reused
+    // before allocating the new ones
+    wxVector<int> m_freeIds;
+};
+
 // this class stores attributes set for cells
 class WXDLLIMPEXP_ADV wxGridCellAttrData
 {
 public:
+    wxGridCellAttrData() { }
+    ~wxGridCellAttrData();
+
     void SetAttr(wxGridCellAttr *attr, int row, int col);
     wxGridCellAttr *GetAttr(int row, int col) const;
     void UpdateAttrRows( size_t pos, int numRows );
     void UpdateAttrCols( size_t pos, int numCols );
 
 private:
-    // searches for the attr for given cell, returns wxNOT_FOUND if not found
-    int FindIndex(int row, int col) const;
+    // removes the attributes of the cells in the deleted rows (if deletedRows
+    // is true) or columns with the given ids and frees these ids
+    void RemoveDeleted(const wxVector<int>& deletedIds, bool deletedRows);
 
-    wxGridCellWithAttrArray m_attrs;
+    // the attributes indexed by the ids of their row and column, so that
+    // inserting or deleting rows or columns doesn't need to update them
+    wxGridCellAttrHash m_attrs;
+    wxGridCellAttrIds m_rowIds,
+                      m_colIds;
+
+    wxDECLARE_NO_COPY_CLASS(wxGridCellAttrData);
 };
 
 // this class stores attributes set for rows or columns
@@ -450,6 +495,183 @@ public:
                            m_colAttrs;
 };
 
+// ----------------------------------------------------------------------------
+// wxGridTypedTable columns
+// ----------------------------------------------------------------------------
+
+// base class for the columns of wxGridTypedTable
+class wxGridTypedTableColumn
+{
+public:
+    virtual ~wxGridTypedTableColumn() { }
+
+    virtual wxGridColumnType GetType() const = 0;
+
+    // get or set the value of the cell as string
+    virtual wxString GetValue(size_t row) const = 0;
+    virtual void SetValue(size_t row, const wxString& value) = 0;
+
+    // return true if the cell doesn't have any value
+    virtual bool IsEmpty(size_t row) const = 0;
+
+    // insert numRows rows with the default value or delete them
+    virtual void InsertRows(size_t pos, size_t numRows) = 0;
+    virtual void DeleteRows(size_t pos, size_t numRows) = 0;
+
+    // reset all the cells to the default value
+    virtual void Clear() = 0;
+};
+
+// insert count copies of value at the given position in the vector
+template <typename T>
+void wxGridInsertInVector(wxVector<T>& values, size_t pos, size_t count,
+                          const T& value)
+{
+    const size_t size = values.size();
+    values.resize(size + count, value);
+    for ( size_t n = size; n-- > pos; )
+        values[n + count] = values[n];
+    for ( size_t n = pos; n < pos + count; n++ )
+        values[n] = value;
+}
+
+// convert the values of wxGridTypedTable columns to and from strings
+inline wxString wxGridFormatValue(wxInt64 value)
+{
+    return wxString::Format("%" wxLongLongFmtSpec "d", value);
+}
+
+inline wxString wxGridFormatValue(double value)
+{
+    return wxString::FromDouble(value);
+}
+
+inline wxString wxGridFormatValue(bool value)
+{
+    // use the same strings as wxGridCellBoolEditor does by default
+    return value ? wxS("1") : wxString();
+}
+
+inline void wxGridParseValue(const wxString& str, wxInt64 *value)
+{
+    wxLongLong_t ll;
+    *value = str.ToLongLong(&ll) ? ll : 0;
+}
+
+inline void wxGridParseValue(const wxString& str, double *value)
+{
+    if ( !str.ToDouble(value) )
+        *value = 0.;
+}
+
+inline void wxGridParseValue(const wxString& str, bool *value)
+{
+    *value = !str.empty() && str != wxS("0");
+}
+
+// column storing the values of the given type directly
+template <typename T, wxGridColumnType type>
+class wxGridTypedTableValues : public wxGridTypedTableColumn
+{
+public:
+    explicit wxGridTypedTableValues(size_t numRows)
+        : m_values(numRows, T())
+    {
+    }
+
+    T Get(size_t row) const { return m_values[row]; }
+    void Set(size_t row, T value) { m_values[row] = value; }
+
+    virtual wxGridColumnType GetType() const wxOVERRIDE { return type; }
+
+    virtual wxString GetValue(size_t row) const wxOVERRIDE
+    {
+        return wxGridFormatValue(m_values[row]);
+    }
+
+    virtual void SetValue(size_t row, const wxString& value) wxOVERRIDE
+    {
+        wxGridParseValue(value, &m_values[row]);
+    }
+
+    virtual bool IsEmpty(size_t WXUNUSED(row)) const wxOVERRIDE
+    {
+        return false;
+    }
+
+    virtual void InsertRows(size_t pos, size_t numRows) wxOVERRIDE
+    {
+        wxGridInsertInVector(m_values, pos, numRows, T());
+    }
+
+    virtual void DeleteRows(size_t pos, size_t numRows) wxOVERRIDE
+    {
+        m_values.erase(m_values.begin() + pos,
+                       m_values.begin() + pos + numRows);
+    }
+
+    virtual void Clear() wxOVERRIDE
+    {
+        m_values.assign(m_values.size(), T());
+    }
+
+private:
+    wxVector<T> m_values;
+};
+
+typedef wxGridTypedTableValues<wxInt64, wxGRID_COLUMN_NUMBER>
+    wxGridTypedTableNumbers;
+typedef wxGridTypedTableValues<double, wxGRID_COLUMN_FLOAT>
+    wxGridTypedTableFloats;
+typedef wxGridTypedTableValues<bool, wxGRID_COLUMN_BOOL>
+    wxGridTypedTableBools;
+
+WX_DECLARE_STRING_HASH_MAP(unsigned, wxGridStringIndexHash);
+
+// column storing the indices of its values in the array of all its distinct
+// strings
+class wxGridTypedTableStrings : public wxGridTypedTableColumn
+{
+public:
+    explicit wxGridTypedTableStrings(size_t numRows);
+
+    virtual wxGridColumnType GetType() const wxOVERRIDE
+        { return wxGRID_COLUMN_STRING; }
+
+    virtual wxString GetValue(size_t row) const wxOVERRIDE
+        { return m_strings[m_indices[row]]; }
+    virtual void SetValue(size_t row, const wxString& value) wxOVERRIDE
+        { m_indices[row] = GetIndex(value); }
+
+    virtual bool IsEmpty(size_t row) const wxOVERRIDE
+        { return m_indices[row] == 0; }
+
+    virtual void InsertRows(size_t pos, size_t numRows) wxOVERRIDE
+        { wxGridInsertInVector(m_indices, pos, numRows, 0u); }
+    virtual void DeleteRows(size_t pos, size_t numRows) wxOVERRIDE
+    {
+        m_indices.erase(m_indices.begin() + pos,
+                        m_indices.begin() + pos + numRows);
+    }
+
+    virtual void Clear() wxOVERRIDE;
+
+private:
+    // return the index of the string, adding it if necessary
+    unsigned GetIndex(const wxString& value);
+
+    // remove the strings not used by any cell any more
+    void RemoveUnused();
+
+    // the index of the string of each cell in m_strings, the first string
+    // is always empty
+    wxVector<unsigned> m_indices;
+
+    // all the strings used by the cells and the index of each of them
+    wxArrayString m_strings;
+    wxGridStringIndexHash m_stringIndices;
+};
+
 // ----------------------------------------------------------------------------
 // operations classes abstracting the difference between operating on rows and
 // columns
@@ -526,8 +748,8 @@ public:
     // Get the height/width of the given row/column
     virtual int GetLineSize(const wxGrid *grid, int line) const = 0;
 
-    // Get wxGrid::m_rowBottoms/m_colRights array
-    virtual const wxArrayInt& GetLineEnds(const wxGrid *grid) const = 0;
+    // Get wxGrid::m_rowBottoms/m_colRights
+    virtual const wxGridLineEnds& GetLineEnds(const wxGrid *grid) const = 0;
 
     // Get default height row height or column width
     virtual int GetDefaultLineSize(const wxGrid *grid) const = 0;
@@ -610,7 +832,7 @@ public:
         { return grid->GetRowBottom(line); }
     virtual int GetLineSize(const wxGrid *grid, int line) const
         { return grid->GetRowHeight(line); }
-    virtual const wxArrayInt& GetLineEnds(const wxGrid *grid) const
+    virtual const wxGridLineEnds& GetLineEnds(const wxGrid *grid) const
         { return grid->m_rowBottoms; }
     virtual int GetDefaultLineSize(const wxGrid *grid) const
         { return grid->GetDefaultRowSize(); }
@@ -676,7 +898,7 @@ public:
         { return grid->GetColRight(line); }
     virtual int GetLineSize(const wxGrid *grid, int line) const
         { return grid->GetColWidth(line); }
-    virtual const wxArrayInt& GetLineEnds(const wxGrid *grid) const
+    virtual const wxGridLineEnds& GetLineEnds(const wxGrid *grid) const
         { return grid->m_colRights; }
     virtual int GetDefaultLineSize(const wxGrid *grid) const
         { return grid->GetDefaultColSize(); }
@@ -377,6 +377,9 @@ class WXDLLIMPEXP_HTML wxHtmlWordCell : public wxHtmlCell
 {
 public:
     wxHtmlWordCell(const wxString& word, const wxDC& dc);
+    // ctor for the word already measured by the caller
+    wxHtmlWordCell(const wxString& word,
+                   wxCoord width, wxCoord height, wxCoord descent);
     void Draw(wxDC& dc, int x, int y, int view_y1, int view_y2,
               wxHtmlRenderingInfo& info) wxOVERRIDE;
     virtual wxCursor GetMouseCursor(wxHtmlWindowInterface *window) const wxOVERRIDE;
@@ -450,9 +453,9 @@ public:
     void InsertCell(wxHtmlCell *cell);
 
     // sets horizontal/vertical alignment
-    void SetAlignHor(int al) {m_AlignHor = al; m_LastLayout = -1;}
+    void SetAlignHor(int al) {m_AlignHor = al; InvalidateLayout();}
     int GetAlignHor() const {return m_AlignHor;}
-    void SetAlignVer(int al) {m_AlignVer = al; m_LastLayout = -1;}
+    void SetAlignVer(int al) {m_AlignVer = al; InvalidateLayout();}
     int GetAlignVer() const {return m_AlignVer;}
 
     // sets left-border indentation. units is one of wxHTML_UNITS_* constants
@@ -468,7 +471,7 @@ public:
     // sets floating width adjustment
     // (examples : 32 percent of parent container,
     // -15 pixels percent (this means 100 % - 15 pixels)
-    void SetWidthFloat(int w, int units) {m_WidthFloat = w; m_WidthFloatUnits = units; m_LastLayout = -1;}
+    void SetWidthFloat(int w, int units) {m_WidthFloat = w; m_WidthFloatUnits = units; InvalidateLayout();}
     void SetWidthFloat(const wxHtmlTag& tag, double pixel_scale = 1.0);
     // sets minimal height of this container.
     void SetMinHeight(int h, int align = wxHTML_ALIGN_TOP) {m_MinHeight = h; m_MinHeightAlign = align; m_LastLayout = -1;}
@@ -509,6 +512,11 @@ public:
     virtual int GetMaxTotalWidth() const wxOVERRIDE { return m_MaxTotalWidth; }
 
 protected:
+    // marks the layout of this container and of all its parents as out of
+    // date, so that the next Layout() call of the topmost container will not
+    // skip it even if its width didn't change
+    void InvalidateLayout();
+
     void UpdateRenderingStatePre(wxHtmlRenderingInfo& info,
                                  wxHtmlCell *cell) const;
     void UpdateRenderingStatePost(wxHtmlRenderingInfo& info,
@@ -26,6 +26,7 @@ class WXDLLIMPEXP_FWD_HTML wxHtmlEntitiesParser;
 
 class wxHtmlTextPieces;
 class wxHtmlParserState;
+class wxHtmlParserIncrementalData;
 
 WX_DECLARE_HASH_SET_WITH_DECL_PTR(wxHtmlTagHandler*,
                                   wxPointerHash, wxPointerEqual,
@@ -80,6 +81,20 @@ public:
     // May be called during parsing to immediately return from Parse().
     virtual void StopParsing() { m_stopParsing = true; }
 
+    // Sets the source for parsing it in parts with ParseNextPart() instead of
+    // calling DoParsing(). The DOM tree is created only for the part of the
+    // source being parsed and not for all of it at once.
+    void InitParserIncrementally(const wxString& source);
+
+    // Parses approximately the next maxLength characters of the source set
+    // by InitParserIncrementally(). Returns false if the entire source has
+    // been parsed or StopParsing() was called, GetProduct() and DoneParser()
+    // should be called then.
+    bool ParseNextPart(size_t maxLength = 4096);
+
+    // Returns true after InitParserIncrementally() and until DoneParser().
+    bool IsParsingIncrementally() const { return m_incremental != NULL; }
+
     // Parses the m_Source from begin_pos to end_pos-1.
     // (in noparams version it parses whole m_Source)
     void DoParsing(const wxString::const_iterator& begin_pos,
@@ -178,6 +193,9 @@ protected:
 
     wxHtmlParserState *m_SavedStates;
 
+    // state of incremental parsing or NULL if not parsing incrementally
+    wxHtmlParserIncrementalData *m_incremental;
+
     // handlers that handle particular tags. The table is accessed by
     // key = tag's name.
     // This attribute MUST be filled by derived class otherwise it would
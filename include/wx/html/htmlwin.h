@@ -36,6 +36,7 @@ class WXDLLIMPEXP_FWD_CORE wxStatusBar;
 #define wxHW_SCROLLBAR_NEVER    0x0002
 #define wxHW_SCROLLBAR_AUTO     0x0004
 #define wxHW_NO_SELECTION       0x0008
+#define wxHW_INCREMENTAL        0x0010
 
 #define wxHW_DEFAULT_STYLE      wxHW_SCROLLBAR_AUTO
 
@@ -405,6 +406,7 @@ protected:
     void OnPaint(wxPaintEvent& event);
     void OnEraseBackground(wxEraseEvent& event);
     void OnSize(wxSizeEvent& event);
+    void OnIdle(wxIdleEvent& event);
     void OnMouseMove(wxMouseEvent& event);
     void OnMouseDown(wxMouseEvent& event);
     void OnMouseUp(wxMouseEvent& event);
@@ -516,6 +518,13 @@ private:
     // don't have any background image
     void DoEraseBackground(wxDC& dc);
 
+    // parse the next part of the page when using wxHW_INCREMENTAL and lay out
+    // the cells created so far, returns false if the page was fully parsed
+    bool ParseNextPagePart();
+
+    // scroll to the position stored in the current history item
+    void ScrollToHistoryPos();
+
     // window content for double buffered rendering, may be invalid until it is
     // really initialized in OnPaint()
     wxBitmap m_backBuffer;
@@ -531,6 +540,17 @@ private:
     // (in order to avoid ugly blinking)
     int m_tmpCanDrawLocks;
 
+    // time taken by the last layout of the page being parsed incrementally,
+    // in milliseconds
+    long m_incrementalLayoutTime;
+
+    // anchor to scroll to once it's parsed when using wxHW_INCREMENTAL
+    wxString m_pendingAnchor;
+
+    // vertical position, in scroll units, to scroll to once the page is long
+    // enough when using wxHW_INCREMENTAL or -1
+    int m_pendingScrollPos;
+
     // list of HTML filters
     static wxList m_Filters;
     // this filter is used when no filter is able to read some file
@@ -24,6 +24,8 @@ class WXDLLIMPEXP_FWD_HTML wxHtmlWinParser;
 class WXDLLIMPEXP_FWD_HTML wxHtmlWinTagHandler;
 class WXDLLIMPEXP_FWD_HTML wxHtmlTagsModule;
 
+class wxHtmlWordExtentsCache;
+
 
 //--------------------------------------------------------------------------------
 // wxHtmlWinParser
@@ -168,8 +170,7 @@ protected:
 private:
     void FlushWordBuf(wxChar *temp, int& len);
     void AddWord(wxHtmlWordCell *word);
-    void AddWord(const wxString& word)
-        { AddWord(new wxHtmlWordCell(word, *(GetDC()))); }
+    void AddWord(const wxString& word);
     void AddPreBlock(const wxString& text);
 
     bool m_tmpLastWasSpace;
@@ -181,6 +182,8 @@ private:
     double m_PixelScale, m_FontScale;
     wxDC *m_DC;
             // Device Context we're parsing for
+    wxHtmlWordExtentsCache *m_wordExtents;
+            // extents of the words already measured using m_DC
     static wxList m_Modules;
             // list of tags modules (see wxHtmlTagsModule for details)
             // This list is used to initialize m_Handlers member.
@@ -73,6 +73,16 @@ enum wxImageResizeQuality
     wxIMAGE_QUALITY_HIGH = 4
 };
 
+// Constants for wxImage::BlurInPlace() for determining the kind of blur
+enum wxImageBlurQuality
+{
+    // single pass of the box filter, this is what Blur() does
+    wxIMAGE_BLUR_BOX,
+
+    // several passes of the box filter approximating the Gaussian blur
+    wxIMAGE_BLUR_GAUSSIAN
+};
+
 // alpha channel values: fully transparent, default threshold separating
 // transparent pixels from opaque for a few functions dealing with alpha and
 // fully opaque
@@ -333,6 +343,10 @@ public:
     wxImage BlurHorizontal(int radius) const;
     wxImage BlurVertical(int radius) const;
 
+    // blurs the image in place, this avoids allocating a new image
+    wxImage& BlurInPlace(int radius,
+                         wxImageBlurQuality quality = wxIMAGE_BLUR_BOX);
+
     wxImage ShrinkBy( int xFactor , int yFactor ) const ;
 
     // rescales the image in place
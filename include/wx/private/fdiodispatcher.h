@@ -19,7 +19,22 @@ enum wxFDIODispatcherEntryFlags
     wxFDIO_INPUT = 1,
     wxFDIO_OUTPUT = 2,
     wxFDIO_EXCEPTION = 4,
-    wxFDIO_ALL = wxFDIO_INPUT | wxFDIO_OUTPUT | wxFDIO_EXCEPTION
+    wxFDIO_ALL = wxFDIO_INPUT | wxFDIO_OUTPUT | wxFDIO_EXCEPTION,
+
+    // the flags below may be combined with the ones above and change the
+    // way in which the events are reported rather than which events are
+
+    // only notify the handler when the descriptor becomes ready and not while
+    // it remains ready: the handler must read (or write) until it gets EAGAIN
+    // to be notified again, this is only honoured by wxEpollDispatcher and is
+    // treated as the default level-triggered mode by the other dispatchers
+    wxFDIO_EDGE_TRIGGERED = 8,
+
+    // disable the descriptor after notifying its handler once, ModifyFD()
+    // must be called to re-enable it (when using wxEpollDispatcher this can
+    // be done from any thread, allowing to process the descriptor in a worker
+    // thread without the dispatcher notifying about it in the meanwhile)
+    wxFDIO_ONESHOT = 16
 };
 
 // base class for wxSelectDispatcher and wxEpollDispatcher
@@ -28,13 +43,27 @@ class WXDLLIMPEXP_BASE wxFDIODispatcher
 public:
     enum { TIMEOUT_INFINITE = -1 };
 
-    // return the global dispatcher to be used for IO events, can be NULL only
-    // if wxSelectDispatcher wasn't compiled into the library at all as
-    // creating it never fails
+    // return the dispatcher to be used for IO events in the current thread:
+    // this is the one set with SetForCurrentThread() if any or the global
+    // dispatcher otherwise; can be NULL only if wxSelectDispatcher wasn't
+    // compiled into the library at all as creating it never fails
     //
     // don't delete the returned pointer
     static wxFDIODispatcher *Get();
 
+    // create a new dispatcher of the best available kind, i.e. epoll-based if
+    // possible and select()-based otherwise; the caller must delete it
+    static wxFDIODispatcher *Create();
+
+    // use the given dispatcher instead of the global one for all IO events
+    // registered from the current thread, pass NULL to revert to using the
+    // global dispatcher; return the previously used thread-specific
+    // dispatcher (possibly NULL)
+    //
+    // this is used by the event loops running in worker threads with their
+    // own dispatcher, the dispatcher must remain alive while it's used
+    static wxFDIODispatcher *SetForCurrentThread(wxFDIODispatcher *dispatcher);
+
     // if we have any registered handlers, check for any pending events to them
     // and dispatch them -- this is used from wxX11 and wxDFB event loops
     // implementation
@@ -10,6 +10,8 @@
 #ifndef _WX_PRIVATE_FDIOHANDLER_H_
 #define _WX_PRIVATE_FDIOHANDLER_H_
 
+class wxFDIODispatcher;
+
 // ----------------------------------------------------------------------------
 // wxFDIOHandler: interface used to process events on file descriptors
 // ----------------------------------------------------------------------------
@@ -17,7 +19,7 @@
 class wxFDIOHandler
 {
 public:
-    wxFDIOHandler() { m_regmask = 0; }
+    wxFDIOHandler() { m_regmask = 0; m_dispatcher = NULL; }
 
     // called when descriptor is available for non-blocking read
     virtual void OnReadWaiting() = 0;
@@ -39,6 +41,13 @@ public:
     void SetRegisteredEvent(int flag) { m_regmask |= flag; }
     void ClearRegisteredEvent(int flag) { m_regmask &= ~flag; }
 
+    // get/set the dispatcher used for this handler by wxFDIOManager: it is
+    // NULL by default, meaning that wxFDIODispatcher::Get() is used, and is
+    // set when the handler is registered for the first time so that it keeps
+    // using the same dispatcher even if it's modified from another thread
+    wxFDIODispatcher *GetDispatcher() const { return m_dispatcher; }
+    void SetDispatcher(wxFDIODispatcher *dispatcher) { m_dispatcher = dispatcher; }
+
 
     // virtual dtor for the base class
     virtual ~wxFDIOHandler() { }
@@ -46,6 +55,8 @@ public:
 private:
     int m_regmask;
 
+    wxFDIODispatcher *m_dispatcher;
+
     wxDECLARE_NO_COPY_CLASS(wxFDIOHandler);
 };
 
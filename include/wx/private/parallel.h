@@ -0,0 +1,190 @@
+///////////////////////////////////////////////////////////////////////////////
+// Name:        wx/private/parallel.h
+// Purpose:     helpers for splitting data processing between several threads
+// Author:      wxWidgets team
+// Created:     2026-10-18
+// Copyright:   (c) 2026 wxWidgets team
+// Licence:     wxWindows licence
+///////////////////////////////////////////////////////////////////////////////
+
+#ifndef _WX_PRIVATE_PARALLEL_H_
+#define _WX_PRIVATE_PARALLEL_H_
+
+#include "wx/defs.h"
+
+#if wxUSE_THREADS
+    #include "wx/thread.h"
+#endif
+
+// ----------------------------------------------------------------------------
+// wxParallelTask: a unit of work which can be split in independent parts
+// ----------------------------------------------------------------------------
+
+// The work is represented as a range [0, count) of items (e.g. image rows)
+// and ProcessRange() must be able to process any sub-range of it without
+// affecting the other ones, as different sub-ranges may be processed
+// concurrently by different threads.
+class wxParallelTask
+{
+public:
+    virtual ~wxParallelTask() { }
+
+    // Process the items in [first, last) range.
+    virtual void ProcessRange(int first, int last) = 0;
+};
+
+#if wxUSE_THREADS
+
+namespace wxPrivate
+{
+
+// Thread used for processing a single sub-range of wxParallelTask.
+class wxParallelTaskThread : public wxThread
+{
+public:
+    wxParallelTaskThread(wxParallelTask& task, int first, int last)
+        : wxThread(wxTHREAD_JOINABLE),
+          m_task(task),
+          m_first(first),
+          m_last(last)
+    {
+    }
+
+protected:
+    virtual ExitCode Entry() wxOVERRIDE
+    {
+        m_task.ProcessRange(m_first, m_last);
+
+        return 0;
+    }
+
+private:
+    wxParallelTask& m_task;
+    const int m_first,
+              m_last;
+
+    wxDECLARE_NO_COPY_CLASS(wxParallelTaskThread);
+};
+
+// Return the number of threads to use for parallel processing, this is just
+// the number of CPUs but we cache it as determining it may be expensive.
+//
+// This function can be called concurrently from several threads, so the
+// cached value is protected by a critical section.
+inline int wxGetParallelThreadsCount()
+{
+    static int s_count = 0;
+
+    wxCRITICAL_SECTION(ParallelThreadsCount);
+
+    if ( !s_count )
+    {
+        const int count = wxThread::GetCPUCount();
+        s_count = count > 0 ? count : 1;
+    }
+
+    return s_count;
+}
+
+// Override the minimal number of items per thread passed to
+// wxRunParallelTask() by all the code using it, this is only meant to be used
+// for testing: pass INT_MAX to never use several threads or 1 to always use
+// as many threads as possible. Passing 0 restores the default behaviour.
+WXDLLIMPEXP_BASE void wxSetParallelMinPerThread(int minPerThread);
+
+// Return the value set by the function above or 0 if it wasn't called.
+WXDLLIMPEXP_BASE int wxGetParallelMinPerThread();
+
+} // namespace wxPrivate
+
+#endif // wxUSE_THREADS
+
+// ----------------------------------------------------------------------------
+// wxRunParallelTask: process all items of the task using several threads
+// ----------------------------------------------------------------------------
+
+// The range [0, count) is split in contiguous chunks of at least minPerThread
+// items each and every chunk is processed by its own thread, with the calling
+// thread processing the first one. The function only returns when the entire
+// range has been processed.
+//
+// If there are not enough items to make using threads worthwhile, or if
+// threads are not available at all, the task is simply executed in the
+// calling thread.
+inline void
+wxRunParallelTask(wxParallelTask& task, int count, int minPerThread)
+{
+    if ( count <= 0 )
+        return;
+
+#if wxUSE_THREADS
+    const int minPerThreadOverride = wxPrivate::wxGetParallelMinPerThread();
+    if ( minPerThreadOverride )
+        minPerThread = minPerThreadOverride;
+
+    int numThreads = wxPrivate::wxGetParallelThreadsCount();
+    if ( minPerThread > 0 && count / minPerThread < numThreads )
+        numThreads = count / minPerThread;
+
+    if ( numThreads > 1 )
+    {
+        using wxPrivate::wxParallelTaskThread;
+
+        const int perThread = count / numThreads,
+                  extra = count % numThreads;
+
+        wxParallelTaskThread** const
+            threads = new wxParallelTaskThread*[numThreads - 1];
+
+        // The first chunk, which is processed by this thread, ends at "last".
+        const int last = perThread + (extra ? 1 : 0);
+
+        int first = last;
+        for ( int n = 1; n < numThreads; n++ )
+        {
+            const int next = first + perThread + (n < extra ? 1 : 0);
+
+            wxParallelTaskThread* const
+                thread = new wxParallelTaskThread(task, first, next);
+            if ( thread->Run() != wxTHREAD_NO_ERROR )
+            {
+                // We can't use this thread, so just process its chunk
+                // ourselves.
+                delete thread;
+                task.ProcessRange(first, next);
+
+                threads[n - 1] = NULL;
+            }
+            else
+            {
+                threads[n - 1] = thread;
+            }
+
+            first = next;
+        }
+
+        task.ProcessRange(0, last);
+
+        for ( int n = 0; n < numThreads - 1; n++ )
+        {
+            if ( threads[n] )
+            {
+                // Never process the events while waiting, this could result
+                // in unexpected reentrancy in the caller.
+                threads[n]->Wait(wxTHREAD_WAIT_BLOCK);
+                delete threads[n];
+            }
+        }
+
+        delete [] threads;
+
+        return;
+    }
+#else // !wxUSE_THREADS
+    wxUnusedVar(minPerThread);
+#endif // wxUSE_THREADS/!wxUSE_THREADS
+
+    task.ProcessRange(0, count);
+}
+
+#endif // _WX_PRIVATE_PARALLEL_H_
@@ -285,6 +285,9 @@ public:
     // turned off when this data was first detected
     virtual void ReenableEvents(wxSocketEventFlags flags) = 0;
 
+    // return the associated wxSocketBase, NULL after shutdown
+    wxSocketBase *GetWxSocket() const { return m_wxsocket; }
+
     // TODO: make these fields protected and provide accessors for those of
     //       them that wxSocketBase really needs
 //protected:
@@ -57,6 +57,10 @@ public:
     bool IsOneShot() const { return m_oneShot; }
 
 protected:
+    // return true if the timer can be started from the current thread even if
+    // it's not the main one, this is not the case by default
+    virtual bool CanStartInThisThread() const { return false; }
+
     wxTimer *m_timer;
 
     wxEvtHandler *m_owner;
@@ -71,5 +71,67 @@ DECLARE_DYNAMIC_CLASS(wxQuantize)
 
 };
 
+/*
+ * wxQuantizePalette
+ * Palette chosen for one or several images, together with the inverse colour
+ * map allowing to quickly find the palette entry for any colour. Unlike
+ * wxQuantize::Quantize(), which does everything from scratch for each image,
+ * this object can be reused for mapping any number of images to the same
+ * palette, which is much faster for e.g. the frames of an animation.
+ */
+
+class wxQuantizePaletteData;
+
+class WXDLLIMPEXP_CORE wxQuantizePalette
+{
+public:
+//// Constructor
+
+    wxQuantizePalette();
+    ~wxQuantizePalette();
+
+//// Choosing the palette
+
+    // Accumulate the colours of the given image for the next call to Fit().
+    void AddImage(const wxImage& image);
+
+    // Choose the palette colours best representing all the images added
+    // since the last call to Fit(). Returns false if no images were added.
+    bool Fit(int desiredNoColours = 236);
+
+    // Use the given palette instead of choosing it with Fit(). The rgb array
+    // contains 3*count bytes, count must be in 1..256 range.
+    bool SetColours(const unsigned char* rgb, int count);
+
+//// Accessors
+
+    // Return true if the palette colours have been chosen.
+    bool IsOk() const;
+
+    // Return the number of the palette colours and the colours themselves,
+    // as an array of 3*GetColoursCount() bytes.
+    int GetColoursCount() const;
+    const unsigned char* GetColours() const;
+
+//// Operations
+
+    // Map the colours of the image to the palette indices. The output array
+    // must have width*height elements. Big images are mapped using several
+    // threads. May be called concurrently from several threads.
+    bool Map(const wxImage& src, unsigned char* eightBitData,
+             bool dither = true) const;
+
+    // Map the image to the palette and fill the destination image, which
+    // may be the same as the source one, with the palette colours. The
+    // palette is also associated with the destination image, so that it can
+    // be saved in GIF, PCX or other indexed formats directly.
+    bool Map(const wxImage& src, wxImage& dest, bool dither = true) const;
+
+private:
+    wxQuantizePaletteData* m_data;
+
+    wxDECLARE_NO_COPY_CLASS(wxQuantizePalette);
+};
+
 #endif
     // _WX_QUANTIZE_H_
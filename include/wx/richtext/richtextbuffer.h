@@ -66,6 +66,7 @@
 #include "wx/txtstrm.h"
 #include "wx/variant.h"
 #include "wx/position.h"
+#include "wx/vector.h"
 
 #if wxUSE_DATAOBJ
 #include "wx/dataobj.h"
@@ -3016,6 +3017,12 @@ public:
     */
     virtual void Move(const wxPoint& pt);
 
+    /**
+        Called when children are added or removed by the functions above. It must also be
+        called after modifying the list returned by GetChildren() directly.
+    */
+    virtual void OnChildrenChanged() {}
+
 protected:
     wxRichTextObjectList    m_children;
 };
@@ -3611,7 +3618,20 @@ public:
     */
     bool GetFloatingObjects(wxRichTextObjectList& objects) const;
 
+    virtual void OnChildrenChanged();
+
 protected:
+    /**
+        Returns the child whose range contains the given position, or NULL.
+    */
+    wxRichTextObject* GetChildContainingPosition(long pos) const;
+
+    /**
+        Rebuilds the position index if necessary. Returns @false if it can't be used
+        because the children ranges are not up to date.
+    */
+    bool UpdatePositionIndex() const;
+
     wxRichTextCtrl* m_ctrl;
     wxRichTextAttr  m_defaultAttributes;
 
@@ -3623,6 +3643,11 @@ protected:
 
     // The floating layout state
     wxRichTextFloatCollector* m_floatCollector;
+
+    // The children sorted by their positions, for finding them by position quickly.
+    // It is rebuilt when needed after children are added or removed.
+    mutable wxVector<wxRichTextObject*> m_positionIndex;
+    mutable bool    m_positionIndexOk;
 };
 
 /**
@@ -106,6 +106,8 @@ enum wxSocketType
 };
 
 
+class WXDLLIMPEXP_FWD_BASE wxConsoleEventLoop;
+
 // event
 class WXDLLIMPEXP_FWD_NET wxSocketEvent;
 wxDECLARE_EXPORTED_EVENT(WXDLLIMPEXP_NET, wxEVT_SOCKET, wxSocketEvent);
@@ -196,6 +198,19 @@ public:
     void SetNotify(wxSocketEventFlags flags);
     void Notify(bool notify);
 
+    // use the given worker event loop, running in another thread, for this
+    // socket IO, see the documentation for details (this does nothing under
+    // non-Unix platforms where worker loops are not supported)
+    void SetEventLoop(wxConsoleEventLoop *loop)
+    {
+#if wxUSE_CONSOLE_EVENTLOOP && defined(__UNIX__)
+        m_eventLoop = loop;
+#else
+        wxUnusedVar(loop);
+#endif
+    }
+    wxConsoleEventLoop *GetEventLoop() const { return m_eventLoop; }
+
     // Get the underlying socket descriptor.
     wxSOCKET_T GetSocket() const;
 
@@ -221,6 +236,10 @@ public:
     // do not use, should be private (called from wxSocketImpl only)
     void OnRequest(wxSocketNotify notify);
 
+    // do not use, called from wxSocketImpl::Accept() to initialize this socket
+    // with the accepted connection before it can get any events for it
+    void OnAccepted(wxSocketImpl *impl);
+
     // do not use, not documented nor supported
     bool IsNoWait() const { return ((m_flags & wxSOCKET_NOWAIT) != 0); }
     wxSocketType GetType() const { return m_type; }
@@ -293,6 +312,7 @@ private:
     wxEvtHandler *m_handler;          // event handler
     void         *m_clientData;       // client data for events
     bool          m_notify;           // notify events to users?
+    wxConsoleEventLoop *m_eventLoop;  // worker loop used for events or NULL
     wxSocketEventFlags  m_eventmask;  // which events to notify?
     wxSocketEventFlags  m_eventsgot;  // collects events received in OnRequest()
 
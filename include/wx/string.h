@@ -415,9 +415,23 @@ private:
   //     wouldn't be able to use a thread-local variable of this type, in
   //     particular it should have no ctor -- we rely on statics being
   //     initialized to 0 instead
+  //
+  // for long strings the element also contains a sparse index of positions in
+  // m_impl of every INDEX_STEP-th character, which is built lazily when the
+  // string is accessed and allows to find the index of any position in it
+  // without scanning the string from the beginning
   struct Cache
   {
-      enum { SIZE = 8 };
+      enum
+      {
+          SIZE = 8,
+
+          // distance between the positions stored in the index
+          INDEX_STEP = 64,
+
+          // don't bother with the index for positions less than this
+          INDEX_MIN_POS = 4*INDEX_STEP
+      };
 
       struct Element
       {
@@ -426,11 +440,25 @@ private:
                  impl,          // the corresponding position in its m_impl
                  len;           // cached length or npos if unknown
 
+          size_t *index;        // index[n] is the position in m_impl of the
+                                // character n*INDEX_STEP, may be NULL
+          size_t indexAlloc,    // number of allocated elements in index
+                 indexLen;      // number of valid elements in index
+
           // reset cached index to 0
           void ResetPos() { pos = impl = 0; }
 
-          // reset position and length
-          void Reset() { ResetPos(); len = npos; }
+          // reset position, index and length
+          void Reset()
+          {
+              ResetPos();
+              if ( index )
+                  FreeIndex();
+              len = npos;
+          }
+
+          // free the memory used by the index
+          WXDLLIMPEXP_BASE void FreeIndex();
       };
 
       // cache the indices mapping for the last few string used
@@ -477,6 +505,9 @@ private:
   // callable from a debugger, to show the cache contents
   friend struct wxStrCacheDumper;
 
+  // this one frees the cache indices when the thread using them exits
+  friend struct wxStrCacheIndexCleaner;
+
   // uncomment this to have access to some profiling statistics on program
   // termination
   //#define wxPROFILE_STRING_CACHE
@@ -604,6 +635,11 @@ private:
           cache->ResetPos();
       }
 
+      // looking for a position far away from the cached one in a long string
+      // is done using the index, otherwise just advance from the cached one
+      if ( pos - cache->pos > Cache::INDEX_STEP && pos >= Cache::INDEX_MIN_POS )
+          return DoPosToImplUsingIndex(cache, pos);
+
       wxCACHE_PROFILE_FIELD_ADD(sumofs, pos - cache->pos);
 
 
@@ -620,6 +656,10 @@ private:
       return cache->impl;
   }
 
+  // out of line part of DoPosToImpl() finding the position using the index
+  // (and updating it)
+  size_t DoPosToImplUsingIndex(Cache::Element *cache, size_t pos) const;
+
   void InvalidateCache()
   {
       Cache::Element * const cache = FindCacheElement();
@@ -640,11 +680,18 @@ private:
       // present in the cache before, this seems to do no harm and the
       // potential for avoiding length recomputation for long strings looks
       // interesting
-      GetCacheElement()->len = len;
+      //
+      // notice that this is only called when the string contents is replaced
+      // entirely, so the cached position is not valid any more
+      Cache::Element * const cache = GetCacheElement();
+      cache->Reset();
+      cache->len = len;
   }
 
   void UpdateCachedLength(ptrdiff_t delta)
   {
+      // notice that this is only called when appending to the string, so the
+      // cached position and the index remain valid
       Cache::Element * const cache = FindCacheElement();
       if ( cache && cache->len != npos )
       {
@@ -2572,7 +2619,7 @@ public:
     // insert n chars of str starting at nStart (in str)
   wxString& insert(size_t nPos, const wxString& str, size_t nStart, size_t n)
   {
-      wxSTRING_UPDATE_CACHED_LENGTH(n);
+      wxSTRING_INVALIDATE_CACHE();
 
       size_t from, len;
       str.PosLenToImpl(nStart, n, &from, &len);
@@ -2600,7 +2647,7 @@ public:
 
   wxString& insert(size_t nPos, const char *sz, size_t n)
   {
-      wxSTRING_UPDATE_CACHED_LENGTH(n);
+      wxSTRING_INVALIDATE_CACHE();
 
       SubstrBufFromMB str(ImplStr(sz, n));
       m_impl.insert(PosToImpl(nPos), str.data, str.len);
@@ -2610,7 +2657,7 @@ public:
 
   wxString& insert(size_t nPos, const wchar_t *sz, size_t n)
   {
-      wxSTRING_UPDATE_CACHED_LENGTH(n);
+      wxSTRING_INVALIDATE_CACHE();
 
       SubstrBufFromWC str(ImplStr(sz, n));
       m_impl.insert(PosToImpl(nPos), str.data, str.len);
@@ -2621,7 +2668,7 @@ public:
     // insert n copies of ch
   wxString& insert(size_t nPos, size_t n, wxUniChar ch)
   {
-      wxSTRING_UPDATE_CACHED_LENGTH(n);
+      wxSTRING_INVALIDATE_CACHE();
 
 #if wxUSE_UNICODE_UTF8
       if ( !ch.IsAscii() )
@@ -2634,7 +2681,7 @@ public:
 
   iterator insert(iterator it, wxUniChar ch)
   {
-      wxSTRING_UPDATE_CACHED_LENGTH(1);
+      wxSTRING_INVALIDATE_CACHE();
 
 #if wxUSE_UNICODE_UTF8
       if ( !ch.IsAscii() )
@@ -2666,7 +2713,7 @@ public:
 
   void insert(iterator it, size_type n, wxUniChar ch)
   {
-      wxSTRING_UPDATE_CACHED_LENGTH(n);
+      wxSTRING_INVALIDATE_CACHE();
 
 #if wxUSE_UNICODE_UTF8
       if ( !ch.IsAscii() )
@@ -2698,9 +2745,9 @@ public:
 
   iterator erase(iterator first)
   {
-      wxSTRING_UPDATE_CACHED_LENGTH(-1);
-
-      return iterator(this, m_impl.erase(first.impl()));
+      // notice that we can't use m_impl.erase(first.impl()) as it would erase
+      // just a single byte in UTF-8 build
+      return erase(first, first + 1);
   }
 
   void clear()
@@ -18,6 +18,7 @@
 
 class wxEventLoopSource;
 class wxFDIODispatcher;
+class wxTimerScheduler;
 class wxWakeUpPipeMT;
 
 class WXDLLIMPEXP_BASE wxConsoleEventLoop
@@ -28,8 +29,22 @@ class WXDLLIMPEXP_BASE wxConsoleEventLoop
 #endif
 {
 public:
+    // the IO dispatcher used by the loop
+    enum DispatcherKind
+    {
+        // use the global dispatcher and timers, as all the other loops do
+        Dispatcher_Global,
+
+        // use the dispatcher and timers belonging to this loop only: such loop
+        // is a worker loop meant to be run in its own thread, see IsWorkerLoop()
+        //
+        // this requires epoll() support and IsOk() returns false if it is
+        // not available
+        Dispatcher_Own
+    };
+
     // initialize the event loop, use IsOk() to check if we were successful
-    wxConsoleEventLoop();
+    explicit wxConsoleEventLoop(DispatcherKind kind = Dispatcher_Global);
     virtual ~wxConsoleEventLoop();
 
     // implement base class pure virtuals
@@ -39,11 +54,35 @@ public:
     virtual void WakeUp() wxOVERRIDE;
     virtual bool IsOk() const wxOVERRIDE { return m_dispatcher != NULL; }
 
+    // return the dispatcher used by this loop
+    wxFDIODispatcher *GetDispatcher() const { return m_dispatcher; }
+
+    // delete the given object after the event currently being dispatched is
+    // processed, this is used for the objects which can't be deleted from
+    // their own event handlers in the worker loops as they don't process
+    // wxApp pending deletions
+    //
+    // this can be called from any thread, the object is always deleted in the
+    // thread running the loop
+    void ScheduleForDestruction(wxObject *object);
+
 protected:
+    virtual int DoRun() wxOVERRIDE;
+    virtual void OnExit() wxOVERRIDE;
     virtual void OnNextIteration() wxOVERRIDE;
     virtual void DoYieldFor(long eventsToProcess) wxOVERRIDE;
+    virtual bool IsWorkerLoop() const wxOVERRIDE { return m_ownsDispatcher; }
 
 private:
+#ifdef __WXOSX__
+    typedef wxCFEventLoop BaseEventLoop;
+#else
+    typedef wxEventLoopManual BaseEventLoop;
+#endif
+
+    // delete all objects passed to ScheduleForDestruction()
+    void DeleteScheduledObjects();
+
     // pipe used for wake up messages: when a child thread wants to wake up
     // the event loop in the main thread it writes to this pipe
     wxWakeUpPipeMT *m_wakeupPipe;
@@ -54,6 +93,20 @@ private:
     // either wxSelectDispatcher or wxEpollDispatcher
     wxFDIODispatcher *m_dispatcher;
 
+    // true if m_dispatcher was created by and belongs to this loop
+    bool m_ownsDispatcher;
+
+    // the objects to delete after processing the current event and the
+    // critical section protecting them
+    wxVector<wxObject *> m_objectsToDelete;
+    wxCRIT_SECT_DECLARE_MEMBER(m_objectsToDeleteLock);
+
+#if wxUSE_TIMER
+    // the scheduler for the timers started from this loop if it's a worker
+    // one or NULL if the global scheduler is used
+    wxTimerScheduler *m_timerScheduler;
+#endif // wxUSE_TIMER
+
     wxDECLARE_NO_COPY_CLASS(wxConsoleEventLoop);
 };
 
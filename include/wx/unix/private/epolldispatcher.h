@@ -15,17 +15,36 @@
 #ifdef wxUSE_EPOLL_DISPATCHER
 
 #include "wx/private/fdiodispatcher.h"
+#include "wx/thread.h"
+#include "wx/vector.h"
 
 struct epoll_event;
 
+// information about a single registered descriptor, defined in the .cpp file
+struct wxEpollEntry;
+
+// the map of all registered descriptors to their entries
+WX_DECLARE_HASH_MAP(
+  int,
+  wxEpollEntry *,
+  wxIntegerHash,
+  wxIntegerEqual,
+  wxEpollEntryMap
+);
+
 class WXDLLIMPEXP_BASE wxEpollDispatcher : public wxFDIODispatcher
 {
 public:
+    enum { DEFAULT_MAX_EVENTS = 16 };
+
     // create a new instance of this class, can return NULL if
     // epoll() is not supported on this system
     //
+    // maxEvents is the maximal number of events retrieved by a single
+    // epoll_wait() call and dispatched by a single Dispatch() call
+    //
     // the caller should delete the returned pointer
-    static wxEpollDispatcher *Create();
+    static wxEpollDispatcher *Create(int maxEvents = DEFAULT_MAX_EVENTS);
 
     virtual ~wxEpollDispatcher();
 
@@ -36,16 +55,53 @@ public:
     virtual bool HasPending() const;
     virtual int Dispatch(int timeout = TIMEOUT_INFINITE);
 
+    // change the maximal number of events dispatched at once, this can't be
+    // called from inside Dispatch()
+    void SetMaxEvents(int maxEvents);
+    int GetMaxEvents() const { return m_maxEvents; }
+
 private:
     // ctor is private, use Create()
-    wxEpollDispatcher(int epollDescriptor);
+    wxEpollDispatcher(int epollDescriptor, int maxEvents);
 
     // common part of HasPending() and Dispatch(): calls epoll_wait() with the
     // given timeout
     int DoPoll(epoll_event *events, int numEvents, int timeout) const;
 
+    // call epoll_ctl() for the given entry, return true on success
+    bool DoControl(int op, wxEpollEntry *entry);
+
+    // return the handler of the given entry, and its flags if the pointer is
+    // non-NULL, safely: the entry can be modified concurrently by ModifyFD()
+    wxFDIOHandler *GetEntryHandler(const wxEpollEntry *entry,
+                                   int *flags = NULL);
+
+    // delete the entries unregistered since the last call to this function
+    void DeleteRemovedEntries();
+
 
     int m_epollDescriptor;
+
+    // the buffer for the events returned by epoll_wait() and its size
+    epoll_event *m_events;
+    int m_maxEvents;
+
+    // the nesting level of Dispatch() calls
+    int m_dispatchLevel;
+
+    // all the registered descriptors: the entries are used as epoll user data
+    // and so are not deleted immediately when their descriptor is
+    // unregistered, as epoll_wait() could have already returned events for
+    // them, but only when it's safe to do it
+    wxEpollEntryMap m_entries;
+    wxVector<wxEpollEntry *> m_removedEntries;
+
+    // protects m_entries, m_removedEntries, the entries themselves and
+    // m_dispatchLevel as the descriptors using wxFDIO_ONESHOT can be modified
+    // from other threads
+    wxCRIT_SECT_DECLARE_MEMBER(m_entriesLock);
+
+    wxDECLARE_NO_COPY_CLASS(wxEpollDispatcher);
 };
 
 #endif // wxUSE_EPOLL_DISPATCHER
@@ -111,7 +111,8 @@ class wxSocketFDBasedManager : public wxSocketManager
 public:
     wxSocketFDBasedManager()
     {
-        m_fdioManager = NULL;
+        m_fdioManager =
+        m_fdioManagerDispatcher = NULL;
     }
 
     virtual bool OnInit();
@@ -136,8 +137,19 @@ protected:
         return socket->m_fds[d];
     }
 
+    // get the manager to use for the given socket: the sockets which are
+    // associated with a dispatcher use it directly
+    wxFDIOManager *GetFDIOManagerFor(wxSocketImplUnix *socket) const
+    {
+        return socket->GetDispatcher() ? m_fdioManagerDispatcher
+                                       : m_fdioManager;
+    }
+
     wxFDIOManager *m_fdioManager;
 
+    // the manager using wxFDIODispatcher, may be the same as m_fdioManager
+    wxFDIOManager *m_fdioManagerDispatcher;
+
     wxDECLARE_NO_COPY_CLASS(wxSocketFDBasedManager);
 };
 
@@ -13,11 +13,14 @@
 #if wxUSE_TIMER
 
 #include "wx/private/timer.h"
+#include "wx/vector.h"
 
 // the type used for milliseconds is large enough for microseconds too but
 // introduce a synonym for it to avoid confusion
 typedef wxMilliClock_t wxUsecClock_t;
 
+class wxTimerScheduler;
+
 // ----------------------------------------------------------------------------
 // wxTimer implementation class for Unix platforms
 // ----------------------------------------------------------------------------
@@ -41,10 +44,24 @@ public:
         wxASSERT_MSG( m_isRunning, wxT("stopping non-running timer?") );
 
         m_isRunning = false;
+        m_scheduler = NULL;
     }
 
+protected:
+    virtual bool CanStartInThisThread() const;
+
 private:
     bool m_isRunning;
+
+    // the scheduler this timer was added to when it was started, only valid
+    // while the timer is running
+    wxTimerScheduler *m_scheduler;
+
+    // the index of this timer in wxTimerScheduler heap, only valid while the
+    // timer is scheduled
+    size_t m_heapIndex;
+
+    friend class wxTimerScheduler;
 };
 
 // ----------------------------------------------------------------------------
@@ -53,21 +70,35 @@ private:
 
 struct wxTimerSchedule
 {
-    wxTimerSchedule(wxUnixTimerImpl *timer, wxUsecClock_t expiration)
+    wxTimerSchedule(wxUnixTimerImpl *timer,
+                    wxUsecClock_t expiration,
+                    unsigned long order)
         : m_timer(timer),
-          m_expiration(expiration)
+          m_expiration(expiration),
+          m_order(order)
     {
     }
 
+    // return true if this timer must be notified before the other one
+    bool IsBefore(const wxTimerSchedule& other) const
+    {
+        if ( m_expiration != other.m_expiration )
+            return m_expiration < other.m_expiration;
+
+        // timers expiring at the same time are notified in the order in which
+        // they were added
+        return m_order < other.m_order;
+    }
+
     // the timer itself (we don't own this pointer)
     wxUnixTimerImpl *m_timer;
 
     // the time of its next expiration, in usec
     wxUsecClock_t m_expiration;
-};
 
-// the linked list of all active timers, we keep it sorted by expiration time
-WX_DECLARE_LIST(wxTimerSchedule, wxTimerList);
+    // the sequential number of this schedule
+    unsigned long m_order;
+};
 
 // ----------------------------------------------------------------------------
 // wxTimerScheduler: class responsible for updating all timers
@@ -76,14 +107,22 @@ WX_DECLARE_LIST(wxTimerSchedule, wxTimerList);
 class wxTimerScheduler
 {
 public:
-    // get the unique timer scheduler instance
-    static wxTimerScheduler& Get()
-    {
-        if ( !ms_instance )
-            ms_instance = new wxTimerScheduler;
+    // the schedulers are normally not created directly, the global one is
+    // returned by Get(), but an event loop running in a worker thread can
+    // create its own one and install it with SetForCurrentThread()
+    wxTimerScheduler() : m_nextOrder(0) { }
 
-        return *ms_instance;
-    }
+    // all the timers still using this scheduler are stopped
+    ~wxTimerScheduler();
+
+    // get the timer scheduler to use in the current thread: this is the one
+    // set by SetForCurrentThread(), if any, or the global one otherwise
+    static wxTimerScheduler& Get();
+
+    // use the given scheduler for the timers started in the current thread,
+    // or revert to the global one if NULL; return the previously used
+    // thread-specific scheduler (possibly NULL)
+    static wxTimerScheduler *SetForCurrentThread(wxTimerScheduler *scheduler);
 
     // must be called on shutdown to delete the global timer scheduler
     static void Shutdown()
@@ -116,21 +155,30 @@ public:
     bool NotifyExpired();
 
 private:
-    // ctor and dtor are private, this is a singleton class only created by
-    // Get() and destroyed by Shutdown()
-    wxTimerScheduler() { }
-    ~wxTimerScheduler();
+    // move the element at the given position up or down the heap until the
+    // heap property is restored
+    void SiftUp(size_t n);
+    void SiftDown(size_t n);
+
+    // put the given schedule at the given position in the heap and update
+    // its timer index
+    void PutAt(size_t n, const wxTimerSchedule& s)
+    {
+        m_timers[n] = s;
+        s.m_timer->m_heapIndex = n;
+    }
 
-    // add the given timer schedule to the list in the right place
-    //
-    // we take ownership of the pointer "s" which must be heap-allocated
-    void DoAddTimer(wxTimerSchedule *s);
 
+    // all currently active timers organized as a binary min-heap ordered by
+    // expiration time: the first element is always the next one to expire
+    wxVector<wxTimerSchedule> m_timers;
 
-    // the list of all currently active timers sorted by expiration
-    wxTimerList m_timers;
+    // the order of the next timer schedule
+    unsigned long m_nextOrder;
 
     static wxTimerScheduler *ms_instance;
+
+    wxDECLARE_NO_COPY_CLASS(wxTimerScheduler);
 };
 
 #endif // wxUSE_TIMER
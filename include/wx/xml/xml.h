@@ -76,6 +76,14 @@ public:
     void SetValue(const wxString& value) { m_value = value; }
     void SetNext(wxXmlAttribute *next) { m_next = next; }
 
+    // Attributes of the documents loaded using wxXMLDOC_USE_ARENA flag are
+    // allocated in the memory pool of the document, but can still be deleted
+    // as usual, so these operators must be used for all attributes.
+    void *operator new(size_t size);
+    void *operator new(size_t WXUNUSED(size), void *place) { return place; }
+    void operator delete(void *p);
+    void operator delete(void *WXUNUSED(p), void *WXUNUSED(place)) { }
+
 private:
     wxString m_name;
     wxString m_value;
@@ -174,6 +182,13 @@ public:
     bool GetNoConversion() const { return m_noConversion; }
     void SetNoConversion(bool noconversion) { m_noConversion = noconversion; }
 
+    // Nodes of the documents loaded using wxXMLDOC_USE_ARENA flag are
+    // allocated in the memory pool of the document, see wxXmlAttribute.
+    void *operator new(size_t size);
+    void *operator new(size_t WXUNUSED(size), void *place) { return place; }
+    void operator delete(void *p);
+    void operator delete(void *WXUNUSED(p), void *WXUNUSED(place)) { }
+
 #if WXWIN_COMPATIBILITY_2_8
     wxDEPRECATED( inline wxXmlAttribute *GetProperties() const );
     wxDEPRECATED( inline bool GetPropVal(const wxString& propName,
@@ -243,7 +258,8 @@ inline void wxXmlNode::SetProperties(wxXmlAttribute *prop)
 enum wxXmlDocumentLoadFlag
 {
     wxXMLDOC_NONE = 0,
-    wxXMLDOC_KEEP_WHITESPACE_NODES = 1
+    wxXMLDOC_KEEP_WHITESPACE_NODES = 1,
+    wxXMLDOC_USE_ARENA = 2
 };
 
 
@@ -320,6 +336,76 @@ private:
     DECLARE_CLASS(wxXmlDocument)
 };
 
+
+// Kinds of the items returned by wxXmlReader::Next().
+enum wxXmlReaderEvent
+{
+    wxXML_READER_START_ELEMENT,
+    wxXML_READER_END_ELEMENT,
+    wxXML_READER_TEXT,
+    wxXML_READER_CDATA,
+    wxXML_READER_COMMENT,
+    wxXML_READER_PI,
+    wxXML_READER_END_DOCUMENT,
+    wxXML_READER_ERROR
+};
+
+class wxXmlReaderImpl;
+
+// This class reads XML documents incrementally, returning the items found in
+// them one by one without building the tree of wxXmlNode objects, and so can
+// be used to process documents too big to be loaded in memory entirely.
+
+class WXDLLIMPEXP_XML wxXmlReader
+{
+public:
+    wxXmlReader(wxInputStream& stream,
+                const wxString& encoding = wxT("UTF-8"),
+                int flags = wxXMLDOC_NONE);
+    ~wxXmlReader();
+
+    // Advances to the next item and returns its kind. Once the end of the
+    // document or an error is reached, the same value keeps being returned.
+    wxXmlReaderEvent Next();
+
+    // Accessors for the current item, i.e. the one returned by Next().
+    wxXmlReaderEvent GetEvent() const;
+
+    // Name of the element or target of the processing instruction.
+    wxString GetName() const;
+
+    // Contents of text, CDATA, comment or processing instruction.
+    wxString GetContent() const;
+
+    // Same as above but return the data in UTF-8, without any conversions.
+    // The returned pointers are only valid until the next call to Next().
+    const char *GetNameUTF8() const;
+    const char *GetContentUTF8() const;
+
+    // Attributes of the element, only for wxXML_READER_START_ELEMENT.
+    size_t GetAttributesCount() const;
+    wxString GetAttributeName(size_t n) const;
+    wxString GetAttributeValue(size_t n) const;
+    bool GetAttribute(const wxString& attrName, wxString *value) const;
+    wxString GetAttribute(const wxString& attrName,
+                          const wxString& defaultVal = wxEmptyString) const;
+
+    // Depth of the item: 0 for the root element, 1 for its children etc.
+    int GetDepth() const;
+
+    int GetLineNumber() const;
+
+    // Version and encoding from the XML declaration, if any. These values are
+    // only available once the first item of the document has been read.
+    const wxString& GetVersion() const;
+    const wxString& GetFileEncoding() const;
+
+private:
+    wxXmlReaderImpl * const m_impl;
+
+    wxDECLARE_NO_COPY_CLASS(wxXmlReader);
+};
+
 #endif // wxUSE_XML
 
 #endif // _WX_XML_H_
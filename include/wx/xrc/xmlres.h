@@ -76,7 +76,8 @@ enum wxXmlResourceFlags
 {
     wxXRC_USE_LOCALE     = 1,
     wxXRC_NO_SUBCLASSING = 2,
-    wxXRC_NO_RELOADING   = 4
+    wxXRC_NO_RELOADING   = 4,
+    wxXRC_LOAD_ON_DEMAND = 8
 };
 
 // This class holds XML resources from one or more .xml files
@@ -95,6 +96,9 @@ public:
     //        wxXRC_NO_RELOADING
     //              don't check the modification time of the XRC files and
     //              reload them if they have changed on disk
+    //        wxXRC_LOAD_ON_DEMAND
+    //              don't parse the XRC files when loading them but only when
+    //              a resource which may be defined in them is needed
     wxXmlResource(int flags = wxXRC_USE_LOCALE,
                   const wxString& domain = wxEmptyString);
 
@@ -289,6 +293,12 @@ public:
     const wxString& GetDomain() const { return m_domain; }
     void SetDomain(const wxString& domain);
 
+    // Get/Set the directory used for caching the loaded XRC files in binary
+    // form, which makes loading them faster. Empty (default) disables the
+    // cache. Notice that this must be set before loading the files.
+    const wxString& GetCacheDirectory() const { return m_cacheDir; }
+    void SetCacheDirectory(const wxString& dir) { m_cacheDir = dir; }
+
 
     // This function returns the wxXmlNode containing the definition of the
     // object with the given name or NULL.
@@ -310,8 +320,8 @@ protected:
     // wxXmlDocument (which will be owned by caller) on success or NULL.
     wxXmlDocument *DoLoadFile(const wxString& file);
 
-    // Scans the resources list for unloaded files and loads them. Also reloads
-    // files that have been modified since last loading.
+    // Reloads the files that have been modified since last loading. Files
+    // loaded on demand and not loaded yet are not loaded by this function.
     bool UpdateResources();
 
 
@@ -400,6 +410,9 @@ private:
     // domain to pass to translation functions, if any.
     wxString m_domain;
 
+    // directory for the binary cache files, if any.
+    wxString m_cacheDir;
+
     friend class wxXmlResourceHandlerImpl;
     friend class wxXmlResourceModule;
     friend class wxIdRangeManager;
@@ -282,6 +282,7 @@ public:
     virtual WXZIPFIX ~wxZipOutputStream();
 
     bool PutNextEntry(wxZipEntry *entry)        { return DoCreate(entry); }
+    bool PutNextRawEntry(wxZipEntry *entry)     { return DoCreate(entry, true); }
 
     bool WXZIPFIX PutNextEntry(const wxString& name,
                                const wxDateTime& dt = wxDateTime::Now(),
@@ -302,6 +303,16 @@ public:
     int  GetLevel() const                       { return m_level; }
     void WXZIPFIX SetLevel(int level);
 
+    int  GetThreads() const                     { return m_threads; }
+    void SetThreads(int threads, size_t blockSize = 0)
+        { m_threads = threads; m_blockSize = blockSize; }
+
+    static bool WXZIPFIX CompressEntry(wxZipEntry& entry,
+                                       const void *data,
+                                       size_t size,
+                                       wxMemoryBuffer& buf,
+                                       int level = -1);
+
 protected:
     virtual size_t WXZIPFIX OnSysWrite(const void *buffer, size_t size) wxOVERRIDE;
     virtual wxFileOffset OnSysTell() const wxOVERRIDE      { return m_entrySize; }
@@ -343,6 +354,8 @@ private:
     wxUint32 m_crcAccumulator;
     wxOutputStream *m_comp;
     int m_level;
+    int m_threads;
+    size_t m_blockSize;
     wxFileOffset m_offsetAdjustment;
     wxString m_Comment;
     bool m_endrecWritten;
@@ -396,6 +409,8 @@ private:
     wxUint32 ReadSignature();
     bool FindEndRecord();
     bool LoadEndRecord();
+    bool DoLoadEndRecord();
+    void LoadCentralDir();
 
     bool AtHeader() const       { return m_headerSize == 0; }
     bool AfterHeader() const    { return m_headerSize > 0 && !m_decomp; }
@@ -422,6 +437,9 @@ private:
     wxUint32 m_signature;
     size_t m_TotalEntries;
     wxString m_Comment;
+    class wxMemoryInputStream *m_centralDir;
+    wxFileOffset m_centralDirPos;
+    wxFileOffset m_centralDirSize;
 
     friend bool wxZipOutputStream::CopyEntry(
                     wxZipEntry *entry, wxZipInputStream& inputStream);
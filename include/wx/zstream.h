@@ -78,6 +78,9 @@ class WXDLLIMPEXP_BASE wxZlibOutputStream: public wxFilterOutputStream {
   bool SetDictionary(const char *data, const size_t datalen);
   bool SetDictionary(const wxMemoryBuffer &buf);
 
+  bool SetThreads(int threads, size_t blockSize = 0);
+  int GetThreads() const;
+
  protected:
   size_t OnSysWrite(const void *buffer, size_t size) wxOVERRIDE;
   wxFileOffset OnSysTell() const wxOVERRIDE { return m_pos; }
@@ -92,6 +95,9 @@ class WXDLLIMPEXP_BASE wxZlibOutputStream: public wxFilterOutputStream {
   unsigned char *m_z_buffer;
   struct z_stream_s *m_deflate;
   wxFileOffset m_pos;
+  int m_level;
+  int m_flags;
+  class wxZlibParallelCompressor *m_parallel;
 
   wxDECLARE_NO_COPY_CLASS(wxZlibOutputStream);
 };
@@ -137,6 +137,18 @@ public:
     */
     virtual wxEvent* Clone() const = 0;
 
+    /**
+        Returns the coalescing key of this event.
+
+        The return value is only meaningful if HasCoalescingKey() returns
+        @true.
+
+        @see SetCoalescingKey()
+
+        @since 3.1.0
+    */
+    long GetCoalescingKey() const;
+
     /**
         Returns the object (usually a window) associated with the event, if any.
     */
@@ -189,6 +201,15 @@ public:
     */
     long GetTimestamp() const;
 
+    /**
+        Returns @true if the coalescing key was set for this event.
+
+        @see SetCoalescingKey()
+
+        @since 3.1.0
+    */
+    bool HasCoalescingKey() const;
+
     /**
         Returns @true if the event is or is derived from wxCommandEvent else it returns @false.
 
@@ -196,12 +217,47 @@ public:
     */
     bool IsCommandEvent() const;
 
+    /**
+        Resets the coalescing key previously set by SetCoalescingKey().
+
+        After calling this method the event is not coalesced with any other
+        events any more.
+
+        @since 3.1.0
+    */
+    void ResetCoalescingKey();
+
     /**
         Sets the propagation level to the given value (for example returned from an
         earlier call to wxEvent::StopPropagation).
     */
     void ResumePropagation(int propagationLevel);
 
+    /**
+        Sets the key used for coalescing this event with the other pending
+        events.
+
+        When an event with a coalescing key is queued using
+        wxEvtHandler::QueueEvent() (or wxEvtHandler::AddPendingEvent() or
+        wxQueueEvent()), any events of the same type and with the same key
+        which had been queued for the same handler before but not processed
+        yet are discarded, so that only the most recent of them is processed.
+        The event keeps its position in the queue relative to the other
+        events, i.e. it is processed after all the events queued before it.
+
+        This is useful for the events which are sent very frequently and only
+        carry the latest state of something, e.g. progress notifications from
+        a worker thread: coalescing them ensures that the event loop doesn't
+        fall behind by processing the outdated notifications.
+
+        Notice that the key must not be changed while the event is queued.
+        By default the events don't have any coalescing key and are never
+        coalesced.
+
+        @since 3.1.0
+    */
+    void SetCoalescingKey(long key);
+
     /**
         Sets the originating object.
     */
@@ -454,6 +510,10 @@ public:
         if it is currently idle by calling ::wxWakeUpIdle() so there is no need
         to do it manually when using it.
 
+        If the @a event has a coalescing key, any pending events of the same
+        type and with the same key queued for this handler before it are
+        discarded, see wxEvent::SetCoalescingKey().
+
         @since 2.9.0
 
         @param event
@@ -679,7 +739,9 @@ public:
         will fail.
 
         The real processing still happens in ProcessEvent() which is called by this
-        function.
+        function for all the events queued before this call, unless the
+        handler is destroyed by one of them. Any events queued while they're
+        being processed are left for the next call.
 
         Note that this function needs a valid application object (see
         wxAppConsole::GetInstance()) because wxApp holds the list of the event
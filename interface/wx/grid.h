@@ -82,6 +82,29 @@ public:
     virtual wxSize GetBestWidth(wxGrid& grid, wxGridCellAttr& attr, wxDC& dc,
                                int row, int col, int height);
 
+    /**
+        Get the text whose extent is the best size of the cell.
+
+        Renderers whose GetBestSize() just measures the text of the cell,
+        drawn using the font of the given attribute, should override this
+        method to return this text and @true. This allows wxGrid to measure
+        the contents of many cells at once, possibly in several threads, when
+        using wxGRID_AUTOSIZE_PARALLEL mode, see wxGrid::SetAutoSizeMode().
+
+        All standard renderers showing text, except for
+        wxGridCellAutoWrapStringRenderer, override it, but their
+        implementations return @true only when they are used directly: if
+        you derive from one of them, this method returns @false, as your
+        class may compute the best size differently, unless you override it
+        too.
+
+        The default implementation simply returns @false.
+
+        @since 3.1.0
+    */
+    virtual bool GetBestSizeText(wxGrid& grid, wxGridCellAttr& attr,
+                                 int row, int col, wxString* text);
+
 protected:
     /**
         The destructor is private because only DecRef() can delete us.
@@ -1829,6 +1852,139 @@ public:
 
 
 
+/**
+    The types of the columns of wxGridTypedTable.
+
+    @since 3.1.0
+*/
+enum wxGridColumnType
+{
+    /**
+        The column contains strings.
+
+        Equal strings in the same column are stored only once.
+    */
+    wxGRID_COLUMN_STRING,
+
+    /// The column contains 64 bit integers, shown using wxGRID_VALUE_NUMBER.
+    wxGRID_COLUMN_NUMBER,
+
+    /// The column contains doubles, shown using wxGRID_VALUE_FLOAT.
+    wxGRID_COLUMN_FLOAT,
+
+    /// The column contains booleans, shown using wxGRID_VALUE_BOOL.
+    wxGRID_COLUMN_BOOL
+};
+
+/**
+   @class wxGridTypedTable
+
+   Data table storing the values of each column in its own type.
+
+   Unlike wxGridStringTable, which stores every cell as a string, this table
+   stores the values of each column in an array of values of the type of the
+   column, see ::wxGridColumnType. This uses much less memory for the big
+   tables containing mostly numbers and allows wxGrid to retrieve the values
+   using GetValueAsLong(), GetValueAsDouble() and GetValueAsBool() without
+   converting them to and from strings. GetTypeName() returns the type name
+   corresponding to the column type, so that the appropriate renderers and
+   editors are used for the numeric and boolean columns by default.
+
+   The values of the cells can still be accessed as strings and the string
+   values are converted to the column type when setting them, with the
+   strings which can't be converted resulting in 0 or @false.
+
+   To fill a big table efficiently, call AppendRows() once and then use
+   SetColValues() to set the values of each column from a buffer.
+
+   @library{wxadv}
+   @category{grid}
+
+   @since 3.1.0
+*/
+class wxGridTypedTable : public wxGridTableBase
+{
+public:
+    /// Default constructor creates an empty table.
+    wxGridTypedTable();
+
+    /**
+        Create a table with the given number of rows and columns of the
+        specified type.
+    */
+    wxGridTypedTable( int numRows, int numCols,
+                      wxGridColumnType type = wxGRID_COLUMN_STRING );
+
+    /**
+        Insert columns of the given type.
+
+        The overload of this function inherited from wxGridTableBase inserts
+        columns of wxGRID_COLUMN_STRING type.
+    */
+    bool InsertCols( size_t pos, size_t numCols, wxGridColumnType type );
+
+    /**
+        Append columns of the given type.
+
+        The overload of this function inherited from wxGridTableBase appends
+        columns of wxGRID_COLUMN_STRING type.
+    */
+    bool AppendCols( size_t numCols, wxGridColumnType type );
+
+    /**
+        Change the type of the column.
+
+        The existing values of the column are converted to the new type using
+        their string representation.
+    */
+    void SetColType( int col, wxGridColumnType type );
+
+    /// Return the type of the column.
+    wxGridColumnType GetColType( int col ) const;
+
+    /**
+        Get the value of a cell of a wxGRID_COLUMN_NUMBER column.
+
+        Unlike GetValueAsLong(), this function doesn't truncate the value on
+        the platforms where @c long is 32 bit.
+    */
+    wxInt64 GetValueAsInt64( int row, int col );
+
+    /// Set the value of a cell of a wxGRID_COLUMN_NUMBER column.
+    void SetValueAsInt64( int row, int col, wxInt64 value );
+
+    /**
+        Set the values of several cells of the same column at once.
+
+        The type of the values must correspond to the type of the column: use
+        the overload taking wxString for wxGRID_COLUMN_STRING, wxInt64 for
+        wxGRID_COLUMN_NUMBER, double for wxGRID_COLUMN_FLOAT and bool for
+        wxGRID_COLUMN_BOOL columns.
+
+        Notice that, as with SetValue(), the grid is not refreshed by this
+        function.
+
+        @param col
+            The column of the cells.
+        @param row
+            The row of the first cell to set.
+        @param values
+            Pointer to @a count values to set.
+        @param count
+            The number of the cells to set, @a row + @a count can't be greater
+            than the number of rows.
+    */
+    void SetColValues( int col, int row, const wxString *values, size_t count );
+    /// @overload
+    void SetColValues( int col, int row, const wxInt64 *values, size_t count );
+    /// @overload
+    void SetColValues( int col, int row, const double *values, size_t count );
+    /// @overload
+    void SetColValues( int col, int row, const bool *values, size_t count );
+};
+
+
+
 
 
 
@@ -1941,6 +2097,45 @@ enum wxGridRenderStyle
                           wxGRID_DRAW_BOX_RECT
 };
 
+/**
+    Flags selecting how the auto-sizing functions of wxGrid measure the
+    contents of the cells.
+
+    @see wxGrid::SetAutoSizeMode()
+
+    @since 3.1.0
+ */
+enum wxGridAutoSizeMode
+{
+    /// Measure all cells in the main thread using wxDC.
+    wxGRID_AUTOSIZE_DEFAULT = 0x000,
+
+    /**
+        Measure the text of the cells using several threads.
+
+        Only the cells using renderers overriding
+        wxGridCellRenderer::GetBestSizeText() are measured in this way, the
+        others are still measured in the main thread. The text is measured
+        using wxGraphicsContext which may give slightly different results
+        from wxDC, so the cells which may be the biggest ones in their column
+        or row are measured again in the main thread, using their renderer,
+        and the resulting sizes are the same as in the default mode. This flag
+        is ignored if wxUSE_GRAPHICS_CONTEXT is 0.
+     */
+    wxGRID_AUTOSIZE_PARALLEL = 0x001,
+
+    /**
+        Measure only some of the rows when auto-sizing the columns.
+
+        When the grid has more rows than the maximal number of sampled rows,
+        only the cells in half of this number of rows with the longest values
+        in the column, as returned by wxGrid::GetCellValue(), and in the rows
+        spread evenly over the grid are measured. Notice that all values are
+        still retrieved from the table to find the longest ones.
+     */
+    wxGRID_AUTOSIZE_SAMPLE = 0x002
+};
+
 
 
 /**
@@ -3001,6 +3196,44 @@ public:
     */
     void AutoSizeRows(bool setAsMin = true);
 
+    /**
+        Select how the auto-sizing functions measure the cells contents.
+
+        By default, all cells of the row or column are measured in the main
+        thread, which can take a long time for big grids. This function
+        allows to measure them using several threads and, for the columns,
+        to measure only a bounded number of rows.
+
+        The results of using wxGRID_AUTOSIZE_SAMPLE are the same as without
+        it if the grid doesn't have more than @a maxSampledRows rows.
+
+        @param mode
+            Combination of ::wxGridAutoSizeMode values.
+        @param maxSampledRows
+            Maximal number of rows to measure when wxGRID_AUTOSIZE_SAMPLE is
+            used, must be positive.
+
+        @see GetAutoSizeMode(), GetAutoSizeMaxSampledRows()
+
+        @since 3.1.0
+    */
+    void SetAutoSizeMode(int mode, int maxSampledRows = 1000);
+
+    /**
+        Returns the auto-sizing mode set by SetAutoSizeMode().
+
+        @since 3.1.0
+    */
+    int GetAutoSizeMode() const;
+
+    /**
+        Returns the maximal number of rows measured when auto-sizing columns
+        in wxGRID_AUTOSIZE_SAMPLE mode.
+
+        @since 3.1.0
+    */
+    int GetAutoSizeMaxSampledRows() const;
+
     /**
         Returns @true if the cell value can overflow.
 
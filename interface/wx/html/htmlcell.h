@@ -745,7 +745,21 @@ public:
 class wxHtmlWordCell : public wxHtmlCell
 {
 public:
+    /**
+        Creates the cell for the given word, measuring it using @a dc.
+    */
     wxHtmlWordCell(const wxString& word, const wxDC& dc);
+
+    /**
+        Creates the cell for the word which was already measured.
+
+        The @a width, @a height and @a descent must be the values returned
+        by wxDC::GetTextExtent() for this word in the current font.
+
+        @since 3.1.0
+    */
+    wxHtmlWordCell(const wxString& word,
+                   wxCoord width, wxCoord height, wxCoord descent);
 };
 
 
@@ -206,6 +206,30 @@ public:
     */
     virtual void InitParser(const wxString& source);
 
+    /**
+        Setups the parser for parsing the @a source string in parts.
+
+        This function calls InitParser() but, unlike it, doesn't create the
+        DOM tree for the entire source. Instead of DoParsing(), ParseNextPart()
+        must be called until it returns @false, then GetProduct() and
+        DoneParser() can be called as usual. The parser may also be stopped
+        earlier by calling DoneParser() at any moment.
+
+        Notice that the contents of the tags whose handlers parse them
+        themselves, e.g. tables, are always parsed at once.
+
+        @since 3.1.0
+    */
+    void InitParserIncrementally(const wxString& source);
+
+    /**
+        Returns @true if the parser was initialized by
+        InitParserIncrementally() and DoneParser() wasn't called yet.
+
+        @since 3.1.0
+    */
+    bool IsParsingIncrementally() const;
+
     /**
         Opens given URL and returns @c wxFSFile object that can be used to read data
         from it. This method may return @NULL in one of two cases: either the URL doesn't
@@ -248,6 +272,19 @@ public:
     */
     wxObject* Parse(const wxString& source);
 
+    /**
+        Parses the next part of the source set by InitParserIncrementally().
+
+        Approximately @a maxLength characters of the source are parsed, but
+        at least one tag or text fragment is always parsed.
+
+        @return @false if the entire source was parsed or StopParsing() was
+            called, @true if more remains to be parsed.
+
+        @since 3.1.0
+    */
+    bool ParseNextPart(size_t maxLength = 4096);
+
     /**
         Restores parser's state before last call to PushTagHandler().
     */
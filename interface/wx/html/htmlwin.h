@@ -9,6 +9,7 @@
 #define wxHW_SCROLLBAR_NEVER    0x0002
 #define wxHW_SCROLLBAR_AUTO     0x0004
 #define wxHW_NO_SELECTION       0x0008
+#define wxHW_INCREMENTAL        0x0010
 
 #define wxHW_DEFAULT_STYLE      wxHW_SCROLLBAR_AUTO
 
@@ -137,6 +138,11 @@ public:
            Display scrollbars only if page's size exceeds window's size.
     @style{wxHW_NO_SELECTION}
            Don't allow the user to select text.
+    @style{wxHW_INCREMENTAL}
+           Parse and lay out the page in parts when it is set, showing the
+           part parsed so far immediately and parsing the rest of it in idle
+           time. This is useful for showing big pages (this style is new
+           since wxWidgets 3.1.0).
     @endStyleTable
 
 
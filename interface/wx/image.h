@@ -60,6 +60,30 @@ enum wxImageResizeQuality
     wxIMAGE_QUALITY_HIGH
 };
 
+/**
+    Image blur algorithm.
+
+    This is used with wxImage::BlurInPlace().
+
+    @since 3.1.0
+ */
+enum wxImageBlurQuality
+{
+    /**
+    Average all pixels inside the box of the given radius. This is the
+    algorithm used by wxImage::Blur().
+    */
+    wxIMAGE_BLUR_BOX,
+
+    /**
+    Apply the box filter several times to approximate the Gaussian blur with
+    the standard deviation equal to half of the blur radius. This is slower
+    than wxIMAGE_BLUR_BOX, but results in a smoother image without any
+    visible box artefacts.
+    */
+    wxIMAGE_BLUR_GAUSSIAN
+};
+
 /**
     Possible values for PNG image type option.
 
@@ -764,10 +788,39 @@ public:
         specified pixel @a blurRadius. This should not be used when using
         a single mask colour for transparency.
 
-        @see BlurHorizontal(), BlurVertical()
+        @see BlurHorizontal(), BlurVertical(), BlurInPlace()
     */
     wxImage Blur(int blurRadius) const;
 
+    /**
+        Blurs the image in place.
+
+        This function modifies the image itself instead of returning a new
+        one, which avoids allocating memory for the new image and makes it
+        more efficient than Blur(). It also allows to use a better quality
+        blur algorithm, see wxImageBlurQuality.
+
+        For all algorithms, the time taken doesn't depend on @a blurRadius.
+        Big images are processed by several threads in parallel when
+        wxUSE_THREADS is on.
+
+        This should not be used when using a single mask colour for
+        transparency.
+
+        @param blurRadius
+            The radius of the blur in pixels, must be positive or 0.
+        @param quality
+            The blur algorithm to use.
+        @return
+            Reference to the image itself.
+
+        @see Blur()
+
+        @since 3.1.0
+    */
+    wxImage& BlurInPlace(int blurRadius,
+                         wxImageBlurQuality quality = wxIMAGE_BLUR_BOX);
+
     /**
         Blurs the image in the horizontal direction only. This should not be used
         when using a single mask colour for transparency.
@@ -882,6 +935,12 @@ public:
         cases it will be quite substantially slower as the bicubic algorithm has to process a
         lot of data.
 
+        Since wxWidgets 3.1.0 all resampling methods other than
+        @c wxIMAGE_QUALITY_NEAREST split the work between several threads,
+        one per CPU, when the image being created is big enough for this to be
+        worthwhile (and when wxUSE_THREADS is on). The results are exactly the
+        same as when a single thread is used.
+
         It should also be noted that the high quality scaling may not work as expected
         when using a single mask colour for transparency, as the scaling will blur the
         image and will therefore remove the mask partially. Using the alpha channel
@@ -62,3 +62,118 @@ public:
                                      wxQUANTIZE_RETURN_8BIT_DATA);
 };
 
+
+/**
+    @class wxQuantizePalette
+
+    Palette chosen for one or several images, together with the inverse colour
+    map allowing to quickly find the palette entry to use for any colour.
+
+    Unlike wxQuantize::Quantize(), which computes the colours histogram, the
+    palette and the inverse colour map from scratch for each image, this class
+    allows to compute the palette once and then reuse it for mapping any
+    number of images. This is much faster when many images, e.g. the frames of
+    an animation, need to be saved using the same palette.
+
+    Example:
+    @code
+    wxQuantizePalette palette;
+    for ( size_t n = 0; n < frames.size(); n++ )
+        palette.AddImage(frames[n]);
+    palette.Fit(256);
+
+    for ( size_t n = 0; n < frames.size(); n++ )
+        palette.Map(frames[n], frames[n]);
+
+    // All frames can now be saved as GIF using the same palette.
+    @endcode
+
+    The mapping of big images is done by several threads in parallel. Notice
+    that when dithering is used, the image is divided in bands of rows which
+    are dithered independently, so the results are slightly different from
+    those of wxQuantize::Quantize() (but they don't depend on the number of
+    threads used).
+
+    @library{wxcore}
+    @category{misc}
+
+    @since 3.1.0
+*/
+class wxQuantizePalette
+{
+public:
+    /**
+        Default constructor.
+
+        The palette can't be used for mapping images until its colours are
+        chosen by either Fit() or SetColours().
+    */
+    wxQuantizePalette();
+
+    /**
+        Accumulate the colours of the given image in the statistics used by
+        the next call to Fit().
+    */
+    void AddImage(const wxImage& image);
+
+    /**
+        Choose the palette colours best representing all the images added
+        since the last call to this function.
+
+        Returns @false if no images were added.
+    */
+    bool Fit(int desiredNoColours = 236);
+
+    /**
+        Use the given colours as the palette instead of choosing them with
+        Fit().
+
+        @param rgb
+            Array of 3*count bytes containing the red, green and blue
+            components of each colour.
+        @param count
+            The number of colours, must be between 1 and 256.
+    */
+    bool SetColours(const unsigned char* rgb, int count);
+
+    /**
+        Returns @true if the palette colours have been chosen.
+    */
+    bool IsOk() const;
+
+    /**
+        Returns the number of colours in the palette.
+    */
+    int GetColoursCount() const;
+
+    /**
+        Returns the palette colours as an array of 3*GetColoursCount() bytes
+        containing the red, green and blue components of each colour.
+    */
+    const unsigned char* GetColours() const;
+
+    /**
+        Map the colours of the image to the palette indices.
+
+        This function may be called from several threads at once.
+
+        @param src
+            The image to map.
+        @param eightBitData
+            The output array, which must have width*height elements.
+        @param dither
+            Whether Floyd-Steinberg dithering should be used.
+    */
+    bool Map(const wxImage& src, unsigned char* eightBitData,
+             bool dither = true) const;
+
+    /**
+        Map the image to the palette colours.
+
+        The destination image, which may be the same as the source one, is
+        filled with the palette colours and the palette is associated with it
+        (if @c wxUSE_PALETTE is on), so that it can be saved in the image
+        formats using palettes directly.
+    */
+    bool Map(const wxImage& src, wxImage& dest, bool dither = true) const;
+};
@@ -2868,6 +2868,19 @@ public:
     */
     virtual void Move(const wxPoint& pt);
 
+    /**
+        Called when children are added or removed by the functions above. It must also be
+        called after modifying the list returned by GetChildren() directly.
+
+        wxRichTextParagraphLayoutBox overrides it to rebuild the index used by
+        wxRichTextParagraphLayoutBox::GetParagraphAtPosition() and
+        wxRichTextParagraphLayoutBox::GetLineAtPosition() to find the paragraphs in
+        logarithmic time.
+
+        @since 3.1.0
+    */
+    virtual void OnChildrenChanged();
+
 protected:
     wxRichTextObjectList    m_children;
 };
@@ -1396,6 +1396,63 @@ public:
     */
     void SetNotify(wxSocketEventFlags flags);
 
+    /**
+        Associates the socket with a worker event loop running in another
+        thread.
+
+        By default, socket events are dispatched by the main event loop. This
+        function allows to spread the sockets over several threads instead,
+        each of them running its own event loop created with
+        @c wxConsoleEventLoop::Dispatcher_Own argument, which monitors its
+        sockets and timers independently of all the other loops. Such worker
+        loops don't process the application pending events nor generate idle
+        events, and the events for the sockets using them are processed
+        immediately, in the worker thread, instead of being queued.
+
+        This function must be called before the socket is connected, typically
+        a server would call it for the new socket before passing it to
+        wxSocketServer::AcceptWith(), choosing the worker loops in a
+        round-robin fashion:
+
+        @code
+        wxSocketBase* sock = new wxSocketBase(wxSOCKET_NOWAIT, wxSOCKET_BASE);
+        sock->SetEventLoop(workerLoops[n++ % workerLoops.size()]);
+        sock->SetEventHandler(*handler);
+        sock->SetNotify(wxSOCKET_INPUT_FLAG | wxSOCKET_LOST_FLAG);
+        sock->Notify(true);
+        if ( !server.AcceptWith(*sock, false) )
+        {
+            // The socket is not monitored by the worker loop yet, so it can
+            // be deleted directly.
+            delete sock;
+        }
+        @endcode
+
+        Notice that the event handler must be set up before accepting the
+        connection as the socket can get events in the worker thread as soon
+        as it is done. After this, the socket must only be used from the
+        worker thread, with the exception of Destroy() which can be called
+        from any thread and always deletes the socket in the worker one, and
+        the loop must outlive all the sockets using it.
+
+        This is currently only implemented for Unix console event loops and
+        this function does nothing under the other platforms, i.e. the socket
+        events are dispatched by the main event loop as usual there. Moreover,
+        the worker loops can only be created if epoll() is available, i.e.
+        under Linux, and wxConsoleEventLoop::IsOk() returns @false for them
+        otherwise.
+
+        @since 3.1.0
+    */
+    void SetEventLoop(wxConsoleEventLoop* loop);
+
+    /**
+        Returns the worker event loop set by SetEventLoop() or @NULL.
+
+        @since 3.1.0
+    */
+    wxConsoleEventLoop* GetEventLoop() const;
+
     /**
         Returns the native socket descriptor.
 
@@ -1,6 +1,6 @@
 /////////////////////////////////////////////////////////////////////////////
 // Name:        xml/xml.h
-// Purpose:     interface of wxXmlNode, wxXmlAttribute, wxXmlDocument
+// Purpose:     interface of wxXmlNode, wxXmlAttribute, wxXmlDocument, wxXmlReader
 // Author:      wxWidgets team
 // Licence:     wxWindows licence
 /////////////////////////////////////////////////////////////////////////////
@@ -440,7 +440,20 @@ public:
 enum wxXmlDocumentLoadFlag
 {
     wxXMLDOC_NONE,
-    wxXMLDOC_KEEP_WHITESPACE_NODES
+    wxXMLDOC_KEEP_WHITESPACE_NODES,
+
+    /**
+        Allocate the nodes and attributes of the document in big blocks of
+        memory freed all at once and convert each distinct element and
+        attribute name only once.
+
+        This makes loading and destroying big documents faster. The nodes can
+        still be modified, detached and deleted as usual and the memory is
+        freed when the last node allocated in it is deleted.
+
+        @since 3.1.0
+     */
+    wxXMLDOC_USE_ARENA
 };
 
 
@@ -650,6 +663,10 @@ public:
         less memory however makes impossible to recreate exactly the loaded text with a
         Save() call later. Read the initial description of this class for more info.
 
+        If @a flags contains wxXMLDOC_USE_ARENA, the nodes of the document are
+        allocated more efficiently, which is especially useful for big
+        documents, see the description of this flag for more details.
+
         Returns true on success, false otherwise.
     */
     virtual bool Load(const wxString& filename,
@@ -727,3 +744,218 @@ public:
     static wxVersionInfo GetLibraryVersionInfo();
 };
 
+
+
+/**
+    Kinds of items returned by wxXmlReader::Next().
+
+    @since 3.1.0
+*/
+enum wxXmlReaderEvent
+{
+    /// Element start tag, its name and attributes are available.
+    wxXML_READER_START_ELEMENT,
+
+    /// Element end tag, its name is available.
+    wxXML_READER_END_ELEMENT,
+
+    /// Text, possibly combining several consecutive text chunks.
+    wxXML_READER_TEXT,
+
+    /// Contents of a CDATA section.
+    wxXML_READER_CDATA,
+
+    /// Comment.
+    wxXML_READER_COMMENT,
+
+    /// Processing instruction, with the target as name and data as content.
+    wxXML_READER_PI,
+
+    /// End of the document was reached.
+    wxXML_READER_END_DOCUMENT,
+
+    /// The document is malformed or couldn't be read.
+    wxXML_READER_ERROR
+};
+
+/**
+    @class wxXmlReader
+
+    Reads XML document from a stream incrementally.
+
+    Unlike wxXmlDocument, this class doesn't build the tree of wxXmlNode
+    objects but returns the items of the document one by one, in the order in
+    which they appear in it. This allows processing documents which are too
+    big to be loaded in memory entirely and is also faster when only some part
+    of the document is needed, as processing can be stopped at any moment.
+
+    The stream is read in big chunks, so the items are returned with a small
+    delay with respect to reading it, and strings are only converted to
+    wxString when they're requested using GetName() or GetContent(), the
+    UTF-8 versions of these functions avoid any conversions at all.
+
+    Example of using this class:
+    @code
+    wxFileInputStream stream("big.xml");
+    wxXmlReader reader(stream);
+    for ( ;; )
+    {
+        switch ( reader.Next() )
+        {
+            case wxXML_READER_START_ELEMENT:
+                if ( reader.GetName() == "item" )
+                    ProcessItem(reader.GetAttribute("id"));
+                break;
+
+            case wxXML_READER_END_DOCUMENT:
+                return true;
+
+            case wxXML_READER_ERROR:
+                return false;
+
+            default:
+                // Ignore all the other items.
+                break;
+        }
+    }
+    @endcode
+
+    Whitespace-only text items are skipped unless @c wxXMLDOC_KEEP_WHITESPACE_NODES
+    flag is used, exactly as in wxXmlDocument::Load().
+
+    @library{wxxml}
+    @category{xml}
+
+    @see wxXmlDocument
+
+    @since 3.1.0
+*/
+class wxXmlReader
+{
+public:
+    /**
+        Creates the reader for the given stream.
+
+        The stream must remain alive for the lifetime of the reader object.
+        The @a encoding and @a flags parameters have the same meaning as for
+        wxXmlDocument::Load().
+    */
+    wxXmlReader(wxInputStream& stream,
+                const wxString& encoding = "UTF-8",
+                int flags = wxXMLDOC_NONE);
+
+    /**
+        Destroys the reader, the stream is not closed.
+    */
+    ~wxXmlReader();
+
+    /**
+        Advances to the next item of the document and returns its kind.
+
+        Once wxXML_READER_END_DOCUMENT or wxXML_READER_ERROR is returned, all
+        the subsequent calls return the same value. An error is also logged
+        using wxLogError(), as in wxXmlDocument::Load(), and is only returned
+        after all the items preceding it in the document.
+    */
+    wxXmlReaderEvent Next();
+
+    /**
+        Returns the kind of the current item, i.e. the last value returned by
+        Next().
+    */
+    wxXmlReaderEvent GetEvent() const;
+
+    /**
+        Returns the name of the current element or the target of the current
+        processing instruction.
+
+        Returns empty string for all the other items.
+    */
+    wxString GetName() const;
+
+    /**
+        Returns the contents of the current text, CDATA, comment or processing
+        instruction item.
+
+        Returns empty string for the other items.
+    */
+    wxString GetContent() const;
+
+    /**
+        Returns the name of the current item in UTF-8.
+
+        This is the same as GetName() but doesn't perform any conversions. The
+        returned pointer is only valid until the next call to Next().
+    */
+    const char *GetNameUTF8() const;
+
+    /**
+        Returns the contents of the current item in UTF-8.
+
+        This is the same as GetContent() but doesn't perform any conversions.
+        The returned pointer is only valid until the next call to Next().
+    */
+    const char *GetContentUTF8() const;
+
+    /**
+        Returns the number of attributes of the current element.
+
+        Always returns 0 for items other than wxXML_READER_START_ELEMENT.
+    */
+    size_t GetAttributesCount() const;
+
+    /**
+        Returns the name of the attribute with the given index.
+
+        @a n must be less than GetAttributesCount().
+    */
+    wxString GetAttributeName(size_t n) const;
+
+    /**
+        Returns the value of the attribute with the given index.
+
+        @a n must be less than GetAttributesCount().
+    */
+    wxString GetAttributeValue(size_t n) const;
+
+    /**
+        Returns true if the current element has the attribute with the given
+        name and, if @a value is not @NULL, fills it with the attribute value.
+    */
+    bool GetAttribute(const wxString& attrName, wxString *value) const;
+
+    /**
+        Returns the value of the attribute with the given name or @a defaultVal
+        if the current element doesn't have it.
+    */
+    wxString GetAttribute(const wxString& attrName,
+                          const wxString& defaultVal = wxEmptyString) const;
+
+    /**
+        Returns the depth of the current item in the document tree.
+
+        The depth of the root element is 0, the depth of its children, both
+        elements and other items, is 1 and so on. Note that the end tag of the
+        element has the same depth as its start tag.
+    */
+    int GetDepth() const;
+
+    /**
+        Returns the line number of the current item in the document.
+    */
+    int GetLineNumber() const;
+
+    /**
+        Returns the version of the document from its XML declaration.
+
+        This value is available only after the first call to Next().
+    */
+    const wxString& GetVersion() const;
+
+    /**
+        Returns the encoding of the document from its XML declaration.
+
+        This value is available only after the first call to Next().
+    */
+    const wxString& GetFileEncoding() const;
+};
@@ -18,7 +18,30 @@ enum wxXmlResourceFlags
 
     /** Prevent the XRC files from being reloaded from disk in case they have been modified there
         since being last loaded (may slightly speed up loading them). */
-    wxXRC_NO_RELOADING   = 4
+    wxXRC_NO_RELOADING   = 4,
+
+    /**
+        Don't parse the XRC files in wxXmlResource::Load() but only when a
+        resource defined in them is needed for the first time.
+
+        This makes loading many XRC files, of which only a few resources are
+        actually used, much faster, especially in combination with
+        wxXmlResource::SetCacheDirectory(): the names of the resources defined
+        in the files for which an up to date cache exists are known without
+        parsing them, so only the file containing the resource being created
+        needs to be parsed, while the files without the cache preceding it
+        have to be parsed to check if they define it.
+
+        Notice that when using this flag, the errors in the files are only
+        reported when they are parsed and not by Load(), and the ID ranges
+        defined in them are only available after they are parsed.
+
+        This flag applies to the files loaded while it is set, so it's
+        possible to use SetFlags() to load only some of the files on demand.
+
+        @since 3.1.0
+    */
+    wxXRC_LOAD_ON_DEMAND = 8
 };
 
 
@@ -124,6 +147,15 @@ public:
     */
     int CompareVersion(int major, int minor, int release, int revision) const;
 
+    /**
+        Returns the directory used for caching the loaded XRC files.
+
+        @see SetCacheDirectory()
+
+        @since 3.1.0
+     */
+    const wxString& GetCacheDirectory() const;
+
     /**
         Returns a string ID corresponding to the given numeric ID.
 
@@ -368,6 +400,26 @@ public:
     */
     static wxXmlResource* Set(wxXmlResource* res);
 
+    /**
+        Sets the directory used for caching the loaded XRC files.
+
+        If this directory is not empty, every XRC file loaded from the local
+        file system is saved in it in a compact binary form after parsing it
+        for the first time and subsequent Load() calls for the same file read
+        the cached version instead of parsing XML, which is significantly
+        faster for big files. The cache file is automatically recreated when
+        the modification time of the XRC file changes and any errors when
+        reading or writing it are silently ignored.
+
+        The directory must exist and be writable and this function must be
+        called before loading the resources to have any effect. By default the
+        cache is not used. Notice that it is also not used if wxWidgets was
+        built with @c wxUSE_DATETIME set to 0.
+
+        @since 3.1.0
+     */
+    void SetCacheDirectory(const wxString& dir);
+
     /**
         Sets the domain (message catalog) that will be used to load
         translatable strings in the XRC.
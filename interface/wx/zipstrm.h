@@ -526,6 +526,28 @@ public:
     */
     bool CopyEntry(wxZipEntry* entry, wxZipInputStream& inputStream);
 
+    /**
+        Compresses the data of an entry into a memory buffer.
+
+        The data is deflated using the given compression @a level, unless
+        the method of @a entry is @c wxZIP_METHOD_STORE or the compressed data
+        would be bigger than the original one, in which case it is just copied
+        to @a buf. The method, size, compressed size and crc of @a entry are
+        updated accordingly, so that it can then be passed to
+        PutNextRawEntry() and the contents of @a buf written to the zip.
+
+        As this function doesn't use any stream, it can be called from several
+        threads at once to compress different entries concurrently, before
+        writing all of them to the same zip.
+
+        @since 3.1.0
+    */
+    static bool CompressEntry(wxZipEntry& entry,
+                              const void *data,
+                              size_t size,
+                              wxMemoryBuffer& buf,
+                              int level = -1);
+
     //@{
     /**
         Set the compression level that will be used the next time an entry is
@@ -538,6 +560,24 @@ public:
     void SetLevel(int level);
     //@}
 
+    //@{
+    /**
+        Set the number of threads that will be used for deflating the data of
+        the entries created after this call.
+
+        If @a threads is greater than 1, the data of each entry is split in
+        blocks of @a blockSize bytes which are compressed concurrently, see
+        wxZlibOutputStream::SetThreads() for more details. Note that this is
+        only useful for big entries, as small ones fit in a single block.
+
+        By default, a single thread is used.
+
+        @since 3.1.0
+    */
+    int GetThreads() const;
+    void SetThreads(int threads, size_t blockSize = 0);
+    //@}
+
     /**
         Create a new directory entry (see wxArchiveEntry::IsDir) with the given
         name and timestamp.
@@ -562,6 +602,18 @@ public:
                       wxFileOffset size = wxInvalidOffset);
     //@}
 
+    /**
+        Takes ownership of @a entry and uses it to create a new entry in the
+        zip containing already compressed data.
+
+        The data written to the entry is stored as is, so it must be compressed
+        using the method of @a entry and its size, compressed size and crc
+        must be set, e.g. by CompressEntry().
+
+        @since 3.1.0
+    */
+    bool PutNextRawEntry(wxZipEntry* entry);
+
     /**
         Sets a comment for the zip as a whole.
         It is written at the end of the zip.
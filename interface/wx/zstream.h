@@ -88,6 +88,48 @@ public:
     bool SetDictionary(const char *data, const size_t datalen);
     bool SetDictionary(const wxMemoryBuffer &buf);
     //@}
+
+    /**
+        Compresses the data using several threads.
+
+        When this mode is enabled, the data is split in blocks of @a blockSize
+        bytes which are compressed concurrently, @a threads blocks at a time.
+        Each block uses the data preceding it as dictionary, so the output is
+        only slightly bigger than in the default mode and is still a single
+        valid zlib, gzip or raw deflate stream which can be read by any
+        decompressor. The memory used by the stream grows proportionally to
+        the number of threads and the block size, as the data of all the
+        blocks being compressed must be kept in memory.
+
+        Notice that Sync() only performs a sync flush in this mode, i.e. the
+        data after it can still refer to the data before it.
+
+        This function can only be called before writing any data to the
+        stream. If it is used together with SetDictionary(), it must be
+        called first.
+
+        @param threads
+            The number of blocks to compress at once, 0 means to use as many
+            as there are CPUs in the system and 1 disables parallel
+            compression.
+        @param blockSize
+            The size of the blocks, 0 means to use the default size of 128KiB.
+        @return
+            @false if the stream can't be used or some data was already
+            written to it.
+
+        @since 3.1.0
+    */
+    bool SetThreads(int threads, size_t blockSize = 0);
+
+    /**
+        Returns the number of threads used for compressing the data.
+
+        This is 1 unless parallel compression was enabled with SetThreads().
+
+        @since 3.1.0
+    */
+    int GetThreads() const;
 };
 
 
@@ -549,7 +549,15 @@ void wxAppConsoleBase::ProcessPendingEvents()
         // call to this function has the chance of processing them:
         if (!m_handlersWithPendingDelayedEvents.IsEmpty())
         {
-            WX_APPEND_ARRAY(m_handlersWithPendingEvents, m_handlersWithPendingDelayedEvents);
+            // a delayed handler could have been added to the main list again
+            // if it got new events in the meanwhile, don't add it twice
+            for ( size_t n = 0; n < m_handlersWithPendingDelayedEvents.GetCount(); n++ )
+            {
+                wxEvtHandler* const handler = m_handlersWithPendingDelayedEvents[n];
+                if ( m_handlersWithPendingEvents.Index(handler) == wxNOT_FOUND )
+                    m_handlersWithPendingEvents.Add(handler);
+            }
+
             m_handlersWithPendingDelayedEvents.Clear();
         }
 
@@ -55,6 +55,122 @@
     wxDEFINE_SCOPED_PTR(wxEvent, wxEventPtr)
 #endif // wxUSE_BASE
 
+#if wxUSE_BASE
+    #include "wx/atomic.h"
+    #include "wx/hashmap.h"
+    #include "wx/weakref.h"
+#endif // wxUSE_BASE
+
+// ----------------------------------------------------------------------------
+// atomic operations used for the pending events queue
+// ----------------------------------------------------------------------------
+
+#if wxUSE_BASE
+
+namespace
+{
+
+#ifndef wxHAS_ATOMIC_COMPARE_EXCHANGE
+
+// Fall back to using a single global lock: this is not efficient, but at
+// least correct.
+wxCriticalSection gs_pendingEventsAtomicsLock;
+
+inline bool
+wxAtomicCompareExchange(wxUint32 volatile& value, wxUint32 expected, wxUint32 desired)
+{
+    wxCriticalSectionLocker lock(gs_pendingEventsAtomicsLock);
+
+    if ( value != expected )
+        return false;
+
+    value = desired;
+    return true;
+}
+
+template <typename T>
+inline bool
+wxAtomicCompareExchange(T* volatile& value, T* expected, T* desired)
+{
+    wxCriticalSectionLocker lock(gs_pendingEventsAtomicsLock);
+
+    if ( value != expected )
+        return false;
+
+    value = desired;
+    return true;
+}
+
+#endif // !wxHAS_ATOMIC_COMPARE_EXCHANGE
+
+// Take all the events from the queue, leaving it empty.
+inline wxEvent* TakeQueuedEvents(wxEvent* volatile& queue)
+{
+    for ( ;; )
+    {
+        wxEvent* const head = queue;
+        if ( !head || wxAtomicCompareExchange(queue, head, (wxEvent*)NULL) )
+            return head;
+    }
+}
+
+} // anonymous namespace
+
+// ----------------------------------------------------------------------------
+// map of the pending events by their coalescing keys
+// ----------------------------------------------------------------------------
+
+// Only the events of the same type can be coalesced together, so the map is
+// indexed by both the event type and the coalescing key.
+struct wxEventCoalescingKey
+{
+    wxEventCoalescingKey(wxEventType type, long key)
+        : m_type(type), m_key(key)
+    {
+    }
+
+    wxEventType m_type;
+    long m_key;
+};
+
+struct wxEventCoalescingKeyHash
+{
+    wxEventCoalescingKeyHash() { }
+
+    unsigned long operator()(const wxEventCoalescingKey& k) const
+    {
+        return (unsigned long)k.m_key * 31 + (unsigned long)k.m_type;
+    }
+
+    wxEventCoalescingKeyHash& operator=(const wxEventCoalescingKeyHash&)
+        { return *this; }
+};
+
+struct wxEventCoalescingKeyEqual
+{
+    wxEventCoalescingKeyEqual() { }
+
+    bool operator()(const wxEventCoalescingKey& a,
+                    const wxEventCoalescingKey& b) const
+    {
+        return a.m_type == b.m_type && a.m_key == b.m_key;
+    }
+
+    wxEventCoalescingKeyEqual& operator=(const wxEventCoalescingKeyEqual&)
+        { return *this; }
+};
+
+WX_DECLARE_HASH_MAP(wxEventCoalescingKey, wxEvent*,
+                    wxEventCoalescingKeyHash, wxEventCoalescingKeyEqual,
+                    wxEventCoalescingMapBase);
+
+// This class only exists to allow forward declaring it in wx/event.h.
+class wxEventCoalescingMap : public wxEventCoalescingMapBase
+{
+};
+
+#endif // wxUSE_BASE
+
 // ----------------------------------------------------------------------------
 // wxWin macros
 // ----------------------------------------------------------------------------
@@ -372,6 +488,10 @@ wxEvent::wxEvent(int theId, wxEventType commandType)
     m_propagatedFrom = NULL;
     m_wasProcessed = false;
     m_willBeProcessedAgain = false;
+    m_nextPending = NULL;
+    m_coalescingKey = 0;
+    m_hasCoalescingKey = false;
+    m_isSuperseded = false;
 }
 
 wxEvent::wxEvent(const wxEvent& src)
@@ -382,6 +502,10 @@ wxEvent::wxEvent(const wxEvent& src)
     , m_id(src.m_id)
     , m_callbackUserData(src.m_callbackUserData)
     , m_handlerToProcessOnlyIn(NULL)
+    , m_nextPending(NULL)
+    , m_coalescingKey(src.m_coalescingKey)
+    , m_hasCoalescingKey(src.m_hasCoalescingKey)
+    , m_isSuperseded(false)
     , m_propagationLevel(src.m_propagationLevel)
     , m_propagatedFrom(NULL)
     , m_skipped(src.m_skipped)
@@ -405,6 +529,8 @@ wxEvent& wxEvent::operator=(const wxEvent& src)
     m_propagatedFrom = NULL;
     m_skipped = src.m_skipped;
     m_isCommandEvent = src.m_isCommandEvent;
+    m_coalescingKey = src.m_coalescingKey;
+    m_hasCoalescingKey = src.m_hasCoalescingKey;
 
     // don't change m_wasProcessed
 
@@ -1118,7 +1244,11 @@ wxEvtHandler::wxEvtHandler()
     m_previousHandler = NULL;
     m_enabled = true;
     m_dynamicEvents = NULL;
-    m_pendingEvents = NULL;
+    m_pendingEventsQueued = NULL;
+    m_pendingEventsFirst = NULL;
+    m_pendingEventsLast = NULL;
+    m_pendingEventsRegistered = 0;
+    m_pendingEventsCoalescing = NULL;
 
     // no client data (yet)
     m_clientData = NULL;
@@ -1163,6 +1293,7 @@ wxEvtHandler::~wxEvtHandler()
         wxTheApp->RemovePendingEventHandler(this);
 
     DeletePendingEvents();
+    delete m_pendingEventsCoalescing;
 
     // we only delete object data, not untyped
     if ( m_clientDataType == wxClientData_Object )
@@ -1259,37 +1390,149 @@ void wxEvtHandler::QueueEvent(wxEvent *event)
         return;
     }
 
-    // 1) Add this event to our list of pending events
-    wxENTER_CRIT_SECT( m_pendingEventsLock );
-
-    if ( !m_pendingEvents )
-        m_pendingEvents = new wxList;
-
-    m_pendingEvents->Append(event);
+    // 1) Add this event to our queue of pending events: as the queue is only
+    //    modified atomically, this doesn't need any locking and can be done
+    //    concurrently from any number of threads.
+    for ( ;; )
+    {
+        wxEvent* const head = m_pendingEventsQueued;
+        event->m_nextPending = head;
+        if ( wxAtomicCompareExchange(m_pendingEventsQueued, head, event) )
+            break;
+    }
 
     // 2) Add this event handler to list of event handlers that
-    //    have pending events.
-
-    wxTheApp->AppendPendingEventHandler(this);
-
-    // only release m_pendingEventsLock now because otherwise there is a race
-    // condition as described in the ticket #9093: we could process the event
-    // just added to m_pendingEvents in our ProcessPendingEvents() below before
-    // we had time to append this pointer to wxHandlersWithPendingEvents list; thus
-    // breaking the invariant that a handler should be in the list iff it has
-    // any pending events to process
-    wxLEAVE_CRIT_SECT( m_pendingEventsLock );
+    //    have pending events if it's not there yet.
+    //
+    //    Notice that this must be done after adding the event to the queue:
+    //    ProcessPendingEvents() resets the flag before checking whether the
+    //    queue is empty, so either it will see our event or we will see the
+    //    flag reset and add the handler to the list ourselves. This ensures
+    //    that the handler is always in the list if it has any pending events.
+    if ( wxAtomicCompareExchange(m_pendingEventsRegistered, 0, 1) )
+        wxTheApp->AppendPendingEventHandler(this);
 
     // 3) Inform the system that new pending events are somewhere,
     //    and that these should be processed in idle time.
     wxWakeUpIdle();
 }
 
+void wxEvtHandler::TakePendingEvents()
+{
+    // The queue contains the events in LIFO order, reverse it to get them in
+    // the order in which they were queued and append them to the events which
+    // had been already taken from it before.
+    wxEvent* first = NULL;
+    wxEvent* const last = TakeQueuedEvents(m_pendingEventsQueued);
+    for ( wxEvent* event = last; event; )
+    {
+        wxEvent* const next = event->m_nextPending;
+        event->m_nextPending = first;
+        first = event;
+        event = next;
+    }
+
+    if ( !first )
+        return;
+
+    // Mark the pending events superseded by the new ones as such, we can't
+    // remove them from the list right now as we don't know their previous
+    // events, but they will be discarded by ProcessPendingEvents().
+    for ( wxEvent* event = first; event; event = event->m_nextPending )
+    {
+        if ( !event->m_hasCoalescingKey )
+            continue;
+
+        if ( !m_pendingEventsCoalescing )
+            m_pendingEventsCoalescing = new wxEventCoalescingMap;
+
+        const wxEventCoalescingKey
+            key(event->m_eventType, event->m_coalescingKey);
+        wxEventCoalescingMap::iterator it = m_pendingEventsCoalescing->find(key);
+        if ( it != m_pendingEventsCoalescing->end() )
+        {
+            it->second->m_isSuperseded = true;
+            it->second = event;
+        }
+        else
+        {
+            m_pendingEventsCoalescing->insert(
+                wxEventCoalescingMap::value_type(key, event));
+        }
+    }
+
+    if ( m_pendingEventsLast )
+        m_pendingEventsLast->m_nextPending = first;
+    else
+        m_pendingEventsFirst = first;
+
+    m_pendingEventsLast = last;
+}
+
+void wxEvtHandler::UnregisterIfNoPendingEvents()
+{
+    if ( m_pendingEventsFirst || m_pendingEventsQueued )
+        return;
+
+    // If there are no more pending events left, we don't need to stay in
+    // this list.
+    wxTheApp->RemovePendingEventHandler(this);
+
+    // But check if any new events were queued after we checked for them
+    // above but before QueueEvent() could see that we're not registered any
+    // more: in this case we need to put ourselves back in the list.
+    wxAtomicCompareExchange(m_pendingEventsRegistered, 1, 0);
+
+    if ( m_pendingEventsQueued &&
+            wxAtomicCompareExchange(m_pendingEventsRegistered, 0, 1) )
+    {
+        wxTheApp->AppendPendingEventHandler(this);
+    }
+}
+
+void wxEvtHandler::RemovePendingEvent(wxEvent* prev, wxEvent* event)
+{
+    if ( prev )
+        prev->m_nextPending = event->m_nextPending;
+    else
+        m_pendingEventsFirst = event->m_nextPending;
+
+    if ( m_pendingEventsLast == event )
+        m_pendingEventsLast = prev;
+
+    event->m_nextPending = NULL;
+
+    // the last event with the given key is always in the map
+    if ( event->m_hasCoalescingKey && !event->m_isSuperseded )
+    {
+        m_pendingEventsCoalescing->erase(
+            wxEventCoalescingKey(event->m_eventType, event->m_coalescingKey));
+    }
+}
+
 void wxEvtHandler::DeletePendingEvents()
 {
-    if (m_pendingEvents)
-        m_pendingEvents->DeleteContents(true);
-    wxDELETE(m_pendingEvents);
+    wxENTER_CRIT_SECT( m_pendingEventsLock );
+
+    TakePendingEvents();
+
+    for ( wxEvent* event = m_pendingEventsFirst; event; )
+    {
+        wxEvent* const next = event->m_nextPending;
+        delete event;
+        event = next;
+    }
+
+    m_pendingEventsFirst =
+    m_pendingEventsLast = NULL;
+    if ( m_pendingEventsCoalescing )
+        m_pendingEventsCoalescing->clear();
+
+    // The caller is responsible for removing us from the list of handlers
+    // with pending events.
+    wxAtomicCompareExchange(m_pendingEventsRegistered, 1, 0);
+
+    wxLEAVE_CRIT_SECT( m_pendingEventsLock );
 }
 
 void wxEvtHandler::ProcessPendingEvents()
@@ -1302,31 +1545,66 @@ void wxEvtHandler::ProcessPendingEvents()
         return;
     }
 
-    // we need to process only a single pending event in this call because
     // each call to ProcessEvent() could result in the destruction of this
-    // same event handler (see the comment at the end of this function)
+    // same event handler, so use a weak reference to detect it and stop
+    // processing the events as soon as it happens
+    wxWeakRef<wxEvtHandler> self(this);
 
     wxENTER_CRIT_SECT( m_pendingEventsLock );
 
-    // this method is only called by wxApp if this handler does have
-    // pending events
-    wxCHECK_RET( m_pendingEvents && !m_pendingEvents->IsEmpty(),
-                 "should have pending events if called" );
+    // move all the events queued since the last call, in a single batch, to
+    // the list of events to process: all of them are processed in this call
+    // without going back to wxApp, but the events queued while doing it are
+    // left for the next call
+    TakePendingEvents();
 
-    wxList::compatibility_iterator node = m_pendingEvents->GetFirst();
-    wxEvent* pEvent = static_cast<wxEvent *>(node->GetData());
-
-    // find the first event which can be processed now:
-    wxEventLoopBase* evtLoop = wxEventLoopBase::GetActive();
-    if (evtLoop && evtLoop->IsYielding())
+    for ( ;; )
     {
-        while (node && pEvent && !evtLoop->IsEventAllowedInsideYield(pEvent->GetEventCategory()))
+        // this method is only called by wxApp if this handler does have
+        // pending events, but don't remain in its list forever if it doesn't
+        if ( !m_pendingEventsFirst )
         {
-            node = node->GetNext();
-            pEvent = node ? static_cast<wxEvent *>(node->GetData()) : NULL;
+            UnregisterIfNoPendingEvents();
+
+            break;
+        }
+
+        wxEvent* prev = NULL;
+        wxEvent* pEvent = m_pendingEventsFirst;
+
+        // find the first event which can be processed now, discarding all the
+        // events superseded by the more recent ones on the way, notice that
+        // we need to check for this every time as ProcessEvent() could have
+        // entered or left a nested event loop:
+        wxEventLoopBase* evtLoop = wxEventLoopBase::GetActive();
+        const bool yielding = evtLoop && evtLoop->IsYielding();
+        while ( pEvent )
+        {
+            if ( pEvent->m_isSuperseded )
+            {
+                wxEvent* const next = pEvent->m_nextPending;
+                RemovePendingEvent(prev, pEvent);
+                delete pEvent;
+                pEvent = next;
+                continue;
+            }
+
+            if ( !yielding ||
+                    evtLoop->IsEventAllowedInsideYield(pEvent->GetEventCategory()) )
+                break;
+
+            prev = pEvent;
+            pEvent = pEvent->m_nextPending;
         }
 
-        if (!node)
+        // superseded events are not counted as pending ones
+        if ( !m_pendingEventsFirst )
+            continue;
+
+        // notice that the last event with any coalescing key is never
+        // superseded, so we can only fail to find an event to process when
+        // yielding
+        if ( !pEvent )
         {
             // all our events are NOT processable now... signal this:
             wxTheApp->DelayPendingEventHandler(this);
@@ -1334,33 +1612,43 @@ void wxEvtHandler::ProcessPendingEvents()
             // see the comment at the beginning of evtloop.h header for the
             // logic behind YieldFor() and behind DelayPendingEventHandler()
 
-            wxLEAVE_CRIT_SECT( m_pendingEventsLock );
+            // We're not in the main list any more, so let QueueEvent() add
+            // us back to it if a new event, which could be processable, is
+            // queued.
+            wxAtomicCompareExchange(m_pendingEventsRegistered, 1, 0);
 
-            return;
+            if ( m_pendingEventsQueued &&
+                    wxAtomicCompareExchange(m_pendingEventsRegistered, 0, 1) )
+            {
+                wxTheApp->AppendPendingEventHandler(this);
+            }
+
+            break;
         }
-    }
 
-    wxEventPtr event(pEvent);
+        wxEventPtr event(pEvent);
 
-    // it's important we remove event from list before processing it, else a
-    // nested event loop, for example from a modal dialog, might process the
-    // same event again.
-    m_pendingEvents->Erase(node);
+        // it's important we remove event from list before processing it, else
+        // a nested event loop, for example from a modal dialog, might process
+        // the same event again.
+        RemovePendingEvent(prev, pEvent);
 
-    if ( m_pendingEvents->IsEmpty() )
-    {
-        // if there are no more pending events left, we don't need to
-        // stay in this list
-        wxTheApp->RemovePendingEventHandler(this);
-    }
+        UnregisterIfNoPendingEvents();
 
-    wxLEAVE_CRIT_SECT( m_pendingEventsLock );
+        wxLEAVE_CRIT_SECT( m_pendingEventsLock );
 
-    ProcessEvent(*event);
+        ProcessEvent(*event);
 
-    // careful: this object could have been deleted by the event handler
-    // executed by the above ProcessEvent() call, so we can't access any fields
-    // of this object any more
+        // careful: this object could have been deleted by the event handler
+        // executed by the above ProcessEvent() call, so we can't access any
+        // fields of this object any more if it was
+        if ( !self )
+            return;
+
+        wxENTER_CRIT_SECT( m_pendingEventsLock );
+    }
+
+    wxLEAVE_CRIT_SECT( m_pendingEventsLock );
 }
 
 /* static */
@@ -22,6 +22,7 @@
 #endif //WX_PRECOMP
 
 #include "wx/scopeguard.h"
+#include "wx/scopedptr.h"
 #include "wx/apptrait.h"
 #include "wx/private/eventloopsourcesmanager.h"
 // ----------------------------------------------------------------------------
@@ -62,7 +63,11 @@ int wxEventLoopBase::Run()
     // ProcessIdle() and ProcessEvents() below may throw so the code here should
     // be exception-safe, hence we must use local objects for all actions we
     // should undo
-    wxEventLoopActivator activate(this);
+    //
+    // notice that worker loops are not activated as this would prevent the
+    // main loop from being woken up when new events are posted to it
+    wxScopedPtr<wxEventLoopActivator>
+        activate(IsWorkerLoop() ? NULL : new wxEventLoopActivator(this));
 
     // We might be called again, after a previous call to ScheduleExit(), so
     // reset this flag.
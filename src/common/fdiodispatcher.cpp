@@ -27,6 +27,7 @@
 #endif //WX_PRECOMP
 
 #include "wx/private/fdiodispatcher.h"
+#include "wx/tls.h"
 
 #include "wx/private/selectdispatcher.h"
 #ifdef __UNIX__
@@ -35,6 +36,19 @@
 
 wxFDIODispatcher *gs_dispatcher = NULL;
 
+namespace
+{
+
+// the dispatcher used by the current thread instead of gs_dispatcher, if any
+inline wxTLS_TYPE_REF(wxFDIODispatcher*) GetThisThreadDispatcher()
+{
+    static wxTLS_TYPE(wxFDIODispatcher*) s_thisThreadDispatcher;
+
+    return s_thisThreadDispatcher;
+}
+
+} // anonymous namespace
+
 // ============================================================================
 // implementation
 // ============================================================================
@@ -44,24 +58,47 @@ wxFDIODispatcher *gs_dispatcher = NULL;
 // ----------------------------------------------------------------------------
 
 /* static */
-wxFDIODispatcher *wxFDIODispatcher::Get()
+wxFDIODispatcher *wxFDIODispatcher::Create()
 {
-    if ( !gs_dispatcher )
-    {
+    wxFDIODispatcher *dispatcher = NULL;
+
 #if wxUSE_EPOLL_DISPATCHER
-        gs_dispatcher = wxEpollDispatcher::Create();
-        if ( !gs_dispatcher )
+    dispatcher = wxEpollDispatcher::Create();
+    if ( !dispatcher )
 #endif // wxUSE_EPOLL_DISPATCHER
 #if wxUSE_SELECT_DISPATCHER
-            gs_dispatcher = new wxSelectDispatcher();
+        dispatcher = new wxSelectDispatcher();
 #endif // wxUSE_SELECT_DISPATCHER
-    }
+
+    return dispatcher;
+}
+
+/* static */
+wxFDIODispatcher *wxFDIODispatcher::Get()
+{
+    wxFDIODispatcher * const threadDispatcher =
+        wxTLS_VALUE(GetThisThreadDispatcher());
+    if ( threadDispatcher )
+        return threadDispatcher;
+
+    if ( !gs_dispatcher )
+        gs_dispatcher = Create();
 
     wxASSERT_MSG( gs_dispatcher, "failed to create any IO dispatchers" );
 
     return gs_dispatcher;
 }
 
+/* static */
+wxFDIODispatcher *
+wxFDIODispatcher::SetForCurrentThread(wxFDIODispatcher *dispatcher)
+{
+    wxFDIODispatcher * const old = wxTLS_VALUE(GetThisThreadDispatcher());
+    wxTLS_VALUE(GetThisThreadDispatcher()) = dispatcher;
+
+    return old;
+}
+
 /* static */
 void wxFDIODispatcher::DispatchPending()
 {
@@ -30,9 +30,11 @@
 
 #include "wx/wfstream.h"
 #include "wx/xpmdecod.h"
+#include "wx/private/parallel.h"
 
 // For memcpy
 #include <string.h>
+#include <algorithm>
 
 // make the code compile with either wxFile*Stream or wxFFile*Stream:
 #define HAS_FILE_STREAMS (wxUSE_STREAMS && (wxUSE_FILE || wxUSE_FFILE))
@@ -586,12 +588,154 @@ void ResampleBoxPrecalc(wxVector<BoxPrecalc>& boxes, int oldDim)
 
 } // anonymous namespace
 
+namespace
+{
+
+// Minimal number of destination rows to process in each thread: below this
+// the overhead of creating a thread is not worth it.
+const int RESAMPLE_MIN_ROWS_PER_THREAD = 64;
+
+// Common base class for the resampling tasks: it just stores the source and
+// destination images data.
+class ResampleTask : public wxParallelTask
+{
+protected:
+    ResampleTask(const unsigned char* srcData,
+                 const unsigned char* srcAlpha,
+                 int srcWidth,
+                 unsigned char* dstData,
+                 unsigned char* dstAlpha,
+                 int dstWidth)
+        : m_srcData(srcData),
+          m_srcAlpha(srcAlpha),
+          m_srcWidth(srcWidth),
+          m_dstData(dstData),
+          m_dstAlpha(dstAlpha),
+          m_dstWidth(dstWidth)
+    {
+    }
+
+    const unsigned char* const m_srcData;
+    const unsigned char* const m_srcAlpha;
+    const int m_srcWidth;
+
+    unsigned char* const m_dstData;
+    unsigned char* const m_dstAlpha;
+    const int m_dstWidth;
+};
+
+class ResampleBoxTask : public ResampleTask
+{
+public:
+    ResampleBoxTask(const unsigned char* srcData,
+                    const unsigned char* srcAlpha,
+                    int srcWidth,
+                    unsigned char* dstData,
+                    unsigned char* dstAlpha,
+                    int dstWidth,
+                    const wxVector<BoxPrecalc>& vPrecalcs,
+                    const wxVector<BoxPrecalc>& hPrecalcs)
+        : ResampleTask(srcData, srcAlpha, srcWidth,
+                       dstData, dstAlpha, dstWidth),
+          m_vPrecalcs(vPrecalcs),
+          m_hPrecalcs(hPrecalcs)
+    {
+    }
+
+    virtual void ProcessRange(int first, int last) wxOVERRIDE
+    {
+        // The box filter is separable, so we first sum up all the source
+        // pixels of the rows in the vertical box for each source column and
+        // then sum up these column sums over the horizontal box. As we only
+        // deal with integer values here, this gives exactly the same results
+        // as summing over all the pixels of the box directly but requires
+        // much less operations and the inner loop over the columns is easily
+        // vectorizable by the compiler.
+        const int srcLineSize = m_srcWidth * 3;
+        wxVector<unsigned> sums(srcLineSize);
+        wxVector<unsigned> sumsAlpha(m_srcAlpha ? m_srcWidth : 0);
+
+        unsigned char* dst_data = m_dstData + first * m_dstWidth * 3;
+        unsigned char* dst_alpha = m_dstAlpha ? m_dstAlpha + first * m_dstWidth
+                                              : NULL;
+
+        for ( int y = first; y < last; y++ )
+        {
+            const BoxPrecalc& vPrecalc = m_vPrecalcs[y];
+
+            std::fill(sums.begin(), sums.end(), 0);
+            for ( int j = vPrecalc.boxStart; j <= vPrecalc.boxEnd; ++j )
+            {
+                const unsigned char* const src = m_srcData + j * srcLineSize;
+                for ( int i = 0; i < srcLineSize; ++i )
+                    sums[i] += src[i];
+            }
+
+            if ( m_srcAlpha )
+            {
+                std::fill(sumsAlpha.begin(), sumsAlpha.end(), 0);
+                for ( int j = vPrecalc.boxStart; j <= vPrecalc.boxEnd; ++j )
+                {
+                    const unsigned char* const
+                        src = m_srcAlpha + j * m_srcWidth;
+                    for ( int i = 0; i < m_srcWidth; ++i )
+                        sumsAlpha[i] += src[i];
+                }
+            }
+
+            const unsigned rows = vPrecalc.boxEnd - vPrecalc.boxStart + 1;
+
+            for ( int x = 0; x < m_dstWidth; x++ )
+            {
+                const BoxPrecalc& hPrecalc = m_hPrecalcs[x];
+
+                unsigned sum_r = 0, sum_g = 0, sum_b = 0;
+                for ( int i = hPrecalc.boxStart; i <= hPrecalc.boxEnd; ++i )
+                {
+                    sum_r += sums[i * 3 + 0];
+                    sum_g += sums[i * 3 + 1];
+                    sum_b += sums[i * 3 + 2];
+                }
+
+                const unsigned
+                    averaged_pixels = rows *
+                                        (hPrecalc.boxEnd - hPrecalc.boxStart + 1);
+
+                dst_data[0] = (unsigned char)(sum_r / averaged_pixels);
+                dst_data[1] = (unsigned char)(sum_g / averaged_pixels);
+                dst_data[2] = (unsigned char)(sum_b / averaged_pixels);
+                dst_data += 3;
+
+                if ( m_srcAlpha )
+                {
+                    unsigned sum_a = 0;
+                    for ( int i = hPrecalc.boxStart; i <= hPrecalc.boxEnd; ++i )
+                        sum_a += sumsAlpha[i];
+
+                    *dst_alpha++ = (unsigned char)(sum_a / averaged_pixels);
+                }
+            }
+        }
+    }
+
+private:
+    const wxVector<BoxPrecalc>& m_vPrecalcs;
+    const wxVector<BoxPrecalc>& m_hPrecalcs;
+
+    wxDECLARE_NO_COPY_CLASS(ResampleBoxTask);
+};
+
+} // anonymous namespace
+
 wxImage wxImage::ResampleBox(int width, int height) const
 {
     // This function implements a simple pre-blur/box averaging method for
     // downsampling that gives reasonably smooth results To scale the image
     // down we will need to gather a grid of pixels of the size of the scale
     // factor in each direction and then do an averaging of the pixels.
+    //
+    // The destination rows are independent of each other, so for big images
+    // they are computed by several threads in parallel, see ResampleBoxTask.
 
     wxImage ret_image(width, height, false);
 
@@ -602,9 +746,7 @@ wxImage wxImage::ResampleBox(int width, int height) const
     ResampleBoxPrecalc(hPrecalcs, M_IMGDATA->m_width);
 
 
-    const unsigned char* src_data = M_IMGDATA->m_data;
     const unsigned char* src_alpha = M_IMGDATA->m_alpha;
-    unsigned char* dst_data = ret_image.GetData();
     unsigned char* dst_alpha = NULL;
 
     if ( src_alpha )
@@ -613,49 +755,10 @@ wxImage wxImage::ResampleBox(int width, int height) const
         dst_alpha = ret_image.GetAlpha();
     }
 
-    int averaged_pixels, src_pixel_index;
-    double sum_r, sum_g, sum_b, sum_a;
-
-    for ( int y = 0; y < height; y++ )         // Destination image - Y direction
-    {
-        // Source pixel in the Y direction
-        const BoxPrecalc& vPrecalc = vPrecalcs[y];
-
-        for ( int x = 0; x < width; x++ )      // Destination image - X direction
-        {
-            // Source pixel in the X direction
-            const BoxPrecalc& hPrecalc = hPrecalcs[x];
-
-            // Box of pixels to average
-            averaged_pixels = 0;
-            sum_r = sum_g = sum_b = sum_a = 0.0;
-
-            for ( int j = vPrecalc.boxStart; j <= vPrecalc.boxEnd; ++j )
-            {
-                for ( int i = hPrecalc.boxStart; i <= hPrecalc.boxEnd; ++i )
-                {
-                    // Calculate the actual index in our source pixels
-                    src_pixel_index = j * M_IMGDATA->m_width + i;
-
-                    sum_r += src_data[src_pixel_index * 3 + 0];
-                    sum_g += src_data[src_pixel_index * 3 + 1];
-                    sum_b += src_data[src_pixel_index * 3 + 2];
-                    if ( src_alpha )
-                        sum_a += src_alpha[src_pixel_index];
-
-                    averaged_pixels++;
-                }
-            }
-
-            // Calculate the average from the sum and number of averaged pixels
-            dst_data[0] = (unsigned char)(sum_r / averaged_pixels);
-            dst_data[1] = (unsigned char)(sum_g / averaged_pixels);
-            dst_data[2] = (unsigned char)(sum_b / averaged_pixels);
-            dst_data += 3;
-            if ( src_alpha )
-                *dst_alpha++ = (unsigned char)(sum_a / averaged_pixels);
-        }
-    }
+    ResampleBoxTask task(M_IMGDATA->m_data, src_alpha, M_IMGDATA->m_width,
+                         ret_image.GetData(), dst_alpha, width,
+                         vPrecalcs, hPrecalcs);
+    wxRunParallelTask(task, height, RESAMPLE_MIN_ROWS_PER_THREAD);
 
     return ret_image;
 }
@@ -701,15 +804,112 @@ void ResampleBilinearPrecalc(wxVector<BilinearPrecalc>& precalcs, int oldDim)
     }
 }
 
+class ResampleBilinearTask : public ResampleTask
+{
+public:
+    ResampleBilinearTask(const unsigned char* srcData,
+                         const unsigned char* srcAlpha,
+                         int srcWidth,
+                         unsigned char* dstData,
+                         unsigned char* dstAlpha,
+                         int dstWidth,
+                         const wxVector<BilinearPrecalc>& vPrecalcs,
+                         const wxVector<BilinearPrecalc>& hPrecalcs)
+        : ResampleTask(srcData, srcAlpha, srcWidth,
+                       dstData, dstAlpha, dstWidth),
+          m_vPrecalcs(vPrecalcs),
+          m_hPrecalcs(hPrecalcs)
+    {
+    }
+
+    virtual void ProcessRange(int first, int last) wxOVERRIDE
+    {
+        unsigned char* dst_data = m_dstData + first * m_dstWidth * 3;
+        unsigned char* dst_alpha = m_dstAlpha ? m_dstAlpha + first * m_dstWidth
+                                              : NULL;
+
+        // initialize alpha values to avoid g++ warnings about possibly
+        // uninitialized variables
+        double r1, g1, b1, a1 = 0;
+        double r2, g2, b2, a2 = 0;
+
+        for ( int dsty = first; dsty < last; dsty++ )
+        {
+            // We need to calculate the source pixel to interpolate from - Y-axis
+            const BilinearPrecalc& vPrecalc = m_vPrecalcs[dsty];
+            const double dy = vPrecalc.dd;
+            const double dy1 = vPrecalc.dd1;
+
+            // Both source lines we interpolate between.
+            const unsigned char* const
+                src_line1 = m_srcData + vPrecalc.offset1 * m_srcWidth * 3;
+            const unsigned char* const
+                src_line2 = m_srcData + vPrecalc.offset2 * m_srcWidth * 3;
+
+            const unsigned char* src_alpha1 = NULL;
+            const unsigned char* src_alpha2 = NULL;
+            if ( m_srcAlpha )
+            {
+                src_alpha1 = m_srcAlpha + vPrecalc.offset1 * m_srcWidth;
+                src_alpha2 = m_srcAlpha + vPrecalc.offset2 * m_srcWidth;
+            }
+
+            for ( int dstx = 0; dstx < m_dstWidth; dstx++ )
+            {
+                // X-axis of pixel to interpolate from
+                const BilinearPrecalc& hPrecalc = m_hPrecalcs[dstx];
+
+                const int x_offset1 = hPrecalc.offset1;
+                const int x_offset2 = hPrecalc.offset2;
+                const double dx = hPrecalc.dd;
+                const double dx1 = hPrecalc.dd1;
+
+                const unsigned char* const p00 = src_line1 + x_offset1 * 3;
+                const unsigned char* const p01 = src_line1 + x_offset2 * 3;
+                const unsigned char* const p10 = src_line2 + x_offset1 * 3;
+                const unsigned char* const p11 = src_line2 + x_offset2 * 3;
+
+                // first line
+                r1 = p00[0] * dx1 + p01[0] * dx;
+                g1 = p00[1] * dx1 + p01[1] * dx;
+                b1 = p00[2] * dx1 + p01[2] * dx;
+                if ( m_srcAlpha )
+                    a1 = src_alpha1[x_offset1] * dx1 + src_alpha1[x_offset2] * dx;
+
+                // second line
+                r2 = p10[0] * dx1 + p11[0] * dx;
+                g2 = p10[1] * dx1 + p11[1] * dx;
+                b2 = p10[2] * dx1 + p11[2] * dx;
+                if ( m_srcAlpha )
+                    a2 = src_alpha2[x_offset1] * dx1 + src_alpha2[x_offset2] * dx;
+
+                // result lines
+
+                dst_data[0] = static_cast<unsigned char>(r1 * dy1 + r2 * dy + .5);
+                dst_data[1] = static_cast<unsigned char>(g1 * dy1 + g2 * dy + .5);
+                dst_data[2] = static_cast<unsigned char>(b1 * dy1 + b2 * dy + .5);
+                dst_data += 3;
+
+                if ( m_srcAlpha )
+                    *dst_alpha++ = static_cast<unsigned char>(a1 * dy1 + a2 * dy);
+            }
+        }
+    }
+
+private:
+    const wxVector<BilinearPrecalc>& m_vPrecalcs;
+    const wxVector<BilinearPrecalc>& m_hPrecalcs;
+
+    wxDECLARE_NO_COPY_CLASS(ResampleBilinearTask);
+};
+
 } // anonymous namespace
 
 wxImage wxImage::ResampleBilinear(int width, int height) const
 {
     // This function implements a Bilinear algorithm for resampling.
     wxImage ret_image(width, height, false);
-    const unsigned char* src_data = M_IMGDATA->m_data;
     const unsigned char* src_alpha = M_IMGDATA->m_alpha;
-    unsigned char* dst_data = ret_image.GetData();
     unsigned char* dst_alpha = NULL;
 
     if ( src_alpha )
@@ -723,61 +923,10 @@ wxImage wxImage::ResampleBilinear(int width, int height) const
     ResampleBilinearPrecalc(vPrecalcs, M_IMGDATA->m_height);
     ResampleBilinearPrecalc(hPrecalcs, M_IMGDATA->m_width);
 
-    // initialize alpha values to avoid g++ warnings about possibly
-    // uninitialized variables
-    double r1, g1, b1, a1 = 0;
-    double r2, g2, b2, a2 = 0;
-
-    for ( int dsty = 0; dsty < height; dsty++ )
-    {
-        // We need to calculate the source pixel to interpolate from - Y-axis
-        const BilinearPrecalc& vPrecalc = vPrecalcs[dsty];
-        const int y_offset1 = vPrecalc.offset1;
-        const int y_offset2 = vPrecalc.offset2;
-        const double dy = vPrecalc.dd;
-        const double dy1 = vPrecalc.dd1;
-
-
-        for ( int dstx = 0; dstx < width; dstx++ )
-        {
-            // X-axis of pixel to interpolate from
-            const BilinearPrecalc& hPrecalc = hPrecalcs[dstx];
-
-            const int x_offset1 = hPrecalc.offset1;
-            const int x_offset2 = hPrecalc.offset2;
-            const double dx = hPrecalc.dd;
-            const double dx1 = hPrecalc.dd1;
-
-            int src_pixel_index00 = y_offset1 * M_IMGDATA->m_width + x_offset1;
-            int src_pixel_index01 = y_offset1 * M_IMGDATA->m_width + x_offset2;
-            int src_pixel_index10 = y_offset2 * M_IMGDATA->m_width + x_offset1;
-            int src_pixel_index11 = y_offset2 * M_IMGDATA->m_width + x_offset2;
-
-            // first line
-            r1 = src_data[src_pixel_index00 * 3 + 0] * dx1 + src_data[src_pixel_index01 * 3 + 0] * dx;
-            g1 = src_data[src_pixel_index00 * 3 + 1] * dx1 + src_data[src_pixel_index01 * 3 + 1] * dx;
-            b1 = src_data[src_pixel_index00 * 3 + 2] * dx1 + src_data[src_pixel_index01 * 3 + 2] * dx;
-            if ( src_alpha )
-                a1 = src_alpha[src_pixel_index00] * dx1 + src_alpha[src_pixel_index01] * dx;
-
-            // second line
-            r2 = src_data[src_pixel_index10 * 3 + 0] * dx1 + src_data[src_pixel_index11 * 3 + 0] * dx;
-            g2 = src_data[src_pixel_index10 * 3 + 1] * dx1 + src_data[src_pixel_index11 * 3 + 1] * dx;
-            b2 = src_data[src_pixel_index10 * 3 + 2] * dx1 + src_data[src_pixel_index11 * 3 + 2] * dx;
-            if ( src_alpha )
-                a2 = src_alpha[src_pixel_index10] * dx1 + src_alpha[src_pixel_index11] * dx;
-
-            // result lines
-
-            dst_data[0] = static_cast<unsigned char>(r1 * dy1 + r2 * dy + .5);
-            dst_data[1] = static_cast<unsigned char>(g1 * dy1 + g2 * dy + .5);
-            dst_data[2] = static_cast<unsigned char>(b1 * dy1 + b2 * dy + .5);
-            dst_data += 3;
-
-            if ( src_alpha )
-                *dst_alpha++ = static_cast<unsigned char>(a1 * dy1 + a2 * dy);
-        }
-    }
+    ResampleBilinearTask task(M_IMGDATA->m_data, src_alpha, M_IMGDATA->m_width,
+                              ret_image.GetData(), dst_alpha, width,
+                              vPrecalcs, hPrecalcs);
+    wxRunParallelTask(task, height, RESAMPLE_MIN_ROWS_PER_THREAD);
 
     return ret_image;
 }
@@ -831,6 +980,109 @@ void ResampleBicubicPrecalc(wxVector<BicubicPrecalc> &aWeight, int oldDim)
     }
 }
 
+class ResampleBicubicTask : public ResampleTask
+{
+public:
+    ResampleBicubicTask(const unsigned char* srcData,
+                        const unsigned char* srcAlpha,
+                        int srcWidth,
+                        unsigned char* dstData,
+                        unsigned char* dstAlpha,
+                        int dstWidth,
+                        const wxVector<BicubicPrecalc>& vPrecalcs,
+                        const wxVector<BicubicPrecalc>& hPrecalcs)
+        : ResampleTask(srcData, srcAlpha, srcWidth,
+                       dstData, dstAlpha, dstWidth),
+          m_vPrecalcs(vPrecalcs),
+          m_hPrecalcs(hPrecalcs)
+    {
+    }
+
+    virtual void ProcessRange(int first, int last) wxOVERRIDE
+    {
+        unsigned char* dst_data = m_dstData + first * m_dstWidth * 3;
+        unsigned char* dst_alpha = m_dstAlpha ? m_dstAlpha + first * m_dstWidth
+                                              : NULL;
+
+        for ( int dsty = first; dsty < last; dsty++ )
+        {
+            // We need to calculate the source pixel to interpolate from - Y-axis
+            const BicubicPrecalc& vPrecalc = m_vPrecalcs[dsty];
+
+            // Pointers to the starts of all the source lines we use.
+            const unsigned char* src_lines[4];
+            const unsigned char* src_alpha_lines[4];
+            for ( int k = 0; k < 4; k++ )
+            {
+                const int y_offset = vPrecalc.offset[k];
+                src_lines[k] = m_srcData + y_offset * m_srcWidth * 3;
+                src_alpha_lines[k] = m_srcAlpha
+                                        ? m_srcAlpha + y_offset * m_srcWidth
+                                        : NULL;
+            }
+
+            for ( int dstx = 0; dstx < m_dstWidth; dstx++ )
+            {
+                // X-axis of pixel to interpolate from
+                const BicubicPrecalc& hPrecalc = m_hPrecalcs[dstx];
+
+                // Sums for each color channel
+                double sum_r = 0, sum_g = 0, sum_b = 0, sum_a = 0;
+
+                // Here we actually determine the RGBA values for the
+                // destination pixel
+                //
+                // Notice that the order of the summation must not be changed
+                // as this would result in (very slightly) different results
+                // due to the rounding errors.
+                for ( int k = 0; k < 4; k++ )
+                {
+                    const unsigned char* const src_line = src_lines[k];
+                    const unsigned char* const src_alpha_line = src_alpha_lines[k];
+                    const double v_weight = vPrecalc.weight[k];
+
+                    // Loop across the X axis
+                    for ( int i = 0; i < 4; i++ )
+                    {
+                        // X offset
+                        const int x_offset = hPrecalc.offset[i];
+
+                        // Calculate the weight for the specified pixel
+                        // according to the bicubic b-spline kernel we're using
+                        // for interpolation
+                        const double pixel_weight = v_weight * hPrecalc.weight[i];
+
+                        // Create a sum of all velues for each color channel
+                        // adjusted for the pixel's calculated weight
+                        const unsigned char* const src = src_line + x_offset * 3;
+                        sum_r += src[0] * pixel_weight;
+                        sum_g += src[1] * pixel_weight;
+                        sum_b += src[2] * pixel_weight;
+                        if ( src_alpha_line )
+                            sum_a += src_alpha_line[x_offset] * pixel_weight;
+                    }
+                }
+
+                // Put the data into the destination image.  The summed values
+                // are of double data type and are rounded here for accuracy
+                dst_data[0] = (unsigned char)(sum_r + 0.5);
+                dst_data[1] = (unsigned char)(sum_g + 0.5);
+                dst_data[2] = (unsigned char)(sum_b + 0.5);
+                dst_data += 3;
+
+                if ( m_srcAlpha )
+                    *dst_alpha++ = (unsigned char)sum_a;
+            }
+        }
+    }
+
+private:
+    const wxVector<BicubicPrecalc>& m_vPrecalcs;
+    const wxVector<BicubicPrecalc>& m_hPrecalcs;
+
+    wxDECLARE_NO_COPY_CLASS(ResampleBicubicTask);
+};
+
 } // anonymous namespace
 
 // This is the bicubic resampling algorithm
@@ -866,9 +1118,7 @@ wxImage wxImage::ResampleBicubic(int width, int height) const
 
     ret_image.Create(width, height, false);
 
-    const unsigned char* src_data = M_IMGDATA->m_data;
     const unsigned char* src_alpha = M_IMGDATA->m_alpha;
-    unsigned char* dst_data = ret_image.GetData();
     unsigned char* dst_alpha = NULL;
 
     if ( src_alpha )
@@ -884,285 +1134,455 @@ wxImage wxImage::ResampleBicubic(int width, int height) const
     ResampleBicubicPrecalc(vPrecalcs, M_IMGDATA->m_height);
     ResampleBicubicPrecalc(hPrecalcs, M_IMGDATA->m_width);
 
-    for ( int dsty = 0; dsty < height; dsty++ )
-    {
-        // We need to calculate the source pixel to interpolate from - Y-axis
-        const BicubicPrecalc& vPrecalc = vPrecalcs[dsty];
+    ResampleBicubicTask task(M_IMGDATA->m_data, src_alpha, M_IMGDATA->m_width,
+                             ret_image.GetData(), dst_alpha, width,
+                             vPrecalcs, hPrecalcs);
+    wxRunParallelTask(task, height, RESAMPLE_MIN_ROWS_PER_THREAD);
 
-        for ( int dstx = 0; dstx < width; dstx++ )
-        {
-            // X-axis of pixel to interpolate from
-            const BicubicPrecalc& hPrecalc = hPrecalcs[dstx];
+    return ret_image;
+}
 
-            // Sums for each color channel
-            double sum_r = 0, sum_g = 0, sum_b = 0, sum_a = 0;
+namespace
+{
 
-            // Here we actually determine the RGBA values for the destination pixel
-            for ( int k = -1; k <= 2; k++ )
-            {
-                // Y offset
-                const int y_offset = vPrecalc.offset[k + 1];
+// Minimal number of pixels to blur in each thread.
+const int BLUR_MIN_PIXELS_PER_THREAD = 256*1024;
 
-                // Loop across the X axis
-                for ( int i = -1; i <= 2; i++ )
-                {
-                    // X offset
-                    const int x_offset = hPrecalc.offset[i + 1];
-
-                    // Calculate the exact position where the source data
-                    // should be pulled from based on the x_offset and y_offset
-                    int src_pixel_index = y_offset*M_IMGDATA->m_width + x_offset;
-
-                    // Calculate the weight for the specified pixel according
-                    // to the bicubic b-spline kernel we're using for
-                    // interpolation
-                    const double
-                        pixel_weight = vPrecalc.weight[k + 1] * hPrecalc.weight[i + 1];
-
-                    // Create a sum of all velues for each color channel
-                    // adjusted for the pixel's calculated weight
-                    sum_r += src_data[src_pixel_index * 3 + 0] * pixel_weight;
-                    sum_g += src_data[src_pixel_index * 3 + 1] * pixel_weight;
-                    sum_b += src_data[src_pixel_index * 3 + 2] * pixel_weight;
-                    if ( src_alpha )
-                        sum_a += src_alpha[src_pixel_index] * pixel_weight;
-                }
-            }
+// Width, in pixels, of the vertical strips in which the image is divided by
+// the vertical blur: each strip is processed from top to bottom, so that the
+// memory is accessed sequentially, and the running sums for all of its
+// columns are small enough to stay in the cache.
+const int BLUR_STRIP_WIDTH = 128;
 
-            // Put the data into the destination image.  The summed values are
-            // of double data type and are rounded here for accuracy
-            dst_data[0] = (unsigned char)(sum_r + 0.5);
-            dst_data[1] = (unsigned char)(sum_g + 0.5);
-            dst_data[2] = (unsigned char)(sum_b + 0.5);
-            dst_data += 3;
+// Return the minimal number of items to process in each thread if every item
+// contains the given number of pixels.
+inline int BlurMinItemsPerThread(int pixelsPerItem)
+{
+    return wxMax(BLUR_MIN_PIXELS_PER_THREAD / wxMax(pixelsPerItem, 1), 1);
+}
 
-            if ( src_alpha )
-                *dst_alpha++ = (unsigned char)sum_a;
-        }
-    }
+// Common base class for the blur tasks: it stores the image planes to blur
+// (RGB data and, optionally, alpha) and the blur parameters.
+//
+// The source and destination may be the same, in which case the image is
+// blurred in place.
+class BlurTask : public wxParallelTask
+{
+protected:
+    BlurTask(const unsigned char* srcData,
+             const unsigned char* srcAlpha,
+             unsigned char* dstData,
+             unsigned char* dstAlpha,
+             int width,
+             int height,
+             int radius,
+             bool round)
+        : m_srcData(srcData),
+          m_srcAlpha(srcAlpha),
+          m_dstData(dstData),
+          m_dstAlpha(dstAlpha),
+          m_width(width),
+          m_height(height),
+          m_radius(radius),
+          m_area(2*radius + 1),
+          m_bias(round ? radius : 0)
+    {
+    }
+
+    // Return the average of the pixels in the blur box given their sum.
+    unsigned char Average(unsigned long sum) const
+    {
+        return (unsigned char)((sum + m_bias) / m_area);
+    }
+
+    const unsigned char* const m_srcData;
+    const unsigned char* const m_srcAlpha;
+    unsigned char* const m_dstData;
+    unsigned char* const m_dstAlpha;
+
+    const int m_width,
+              m_height,
+              m_radius;
 
-    return ret_image;
-}
+    // number of pixels we average over
+    const unsigned long m_area;
 
-// Blur in the horizontal direction
-wxImage wxImage::BlurHorizontal(int blurRadius) const
-{
-    wxImage ret_image(MakeEmptyClone());
+    // value added to the sum before dividing it by the area: 0 for the
+    // traditional truncating behaviour or half of the area for rounding
+    const unsigned long m_bias;
+};
 
-    wxCHECK( ret_image.IsOk(), ret_image );
+// Horizontal blur: the items are the image rows.
+class BlurHorizontalTask : public BlurTask
+{
+public:
+    BlurHorizontalTask(const unsigned char* srcData,
+                       const unsigned char* srcAlpha,
+                       unsigned char* dstData,
+                       unsigned char* dstAlpha,
+                       int width,
+                       int height,
+                       int radius,
+                       bool round)
+        : BlurTask(srcData, srcAlpha, dstData, dstAlpha,
+                   width, height, radius, round)
+    {
+    }
 
-    const unsigned char* src_data = M_IMGDATA->m_data;
-    unsigned char* dst_data = ret_image.GetData();
-    const unsigned char* src_alpha = M_IMGDATA->m_alpha;
-    unsigned char* dst_alpha = ret_image.GetAlpha();
+    virtual void ProcessRange(int first, int last) wxOVERRIDE
+    {
+        // When blurring in place we need to keep the original row contents
+        // as the pixels leaving the blur box have been already overwritten.
+        wxVector<unsigned char> row;
+        if ( m_srcData == m_dstData )
+            row.resize(m_width*3);
 
-    // number of pixels we average over
-    const int blurArea = blurRadius*2 + 1;
+        for ( int y = first; y < last; y++ )
+        {
+            BlurRow<3>(m_srcData + y*m_width*3, m_dstData + y*m_width*3, row);
+            if ( m_srcAlpha )
+                BlurRow<1>(m_srcAlpha + y*m_width, m_dstAlpha + y*m_width, row);
+        }
+    }
 
-    // Horizontal blurring algorithm - average all pixels in the specified blur
-    // radius in the X or horizontal direction
-    for ( int y = 0; y < M_IMGDATA->m_height; y++ )
+private:
+    // Blur a single row of pixels with N channels each.
+    template <int N>
+    void BlurRow(const unsigned char* src,
+                 unsigned char* dst,
+                 wxVector<unsigned char>& row) const
     {
-        // Variables used in the blurring algorithm
-        long sum_r = 0,
-             sum_g = 0,
-             sum_b = 0,
-             sum_a = 0;
+        if ( src == dst )
+        {
+            memcpy(&row[0], src, m_width*N);
+            src = &row[0];
+        }
 
-        long pixel_idx;
-        const unsigned char *src;
-        unsigned char *dst;
+        const int last = m_width - 1;
 
-        // Calculate the average of all pixels in the blur radius for the first
-        // pixel of the row
-        for ( int kernel_x = -blurRadius; kernel_x <= blurRadius; kernel_x++ )
+        // Calculate the average of all pixels in the blur radius for the
+        // first pixel of the row, edge pixels are duplicated to deal with the
+        // pixels beyond the start or the end of the row.
+        unsigned long sums[N] = { 0 };
+        for ( int kernel_x = -m_radius; kernel_x <= m_radius; kernel_x++ )
         {
-            // To deal with the pixels at the start of a row so it's not
-            // grabbing GOK values from memory at negative indices of the
-            // image's data or grabbing from the previous row
-            if ( kernel_x < 0 )
-                pixel_idx = y * M_IMGDATA->m_width;
-            else
-                pixel_idx = kernel_x + y * M_IMGDATA->m_width;
-
-            src = src_data + pixel_idx*3;
-            sum_r += src[0];
-            sum_g += src[1];
-            sum_b += src[2];
-            if ( src_alpha )
-                sum_a += src_alpha[pixel_idx];
+            const unsigned char*
+                p = src + wxMax(wxMin(kernel_x, last), 0)*N;
+            for ( int c = 0; c < N; c++ )
+                sums[c] += p[c];
         }
 
-        dst = dst_data + y * M_IMGDATA->m_width*3;
-        dst[0] = (unsigned char)(sum_r / blurArea);
-        dst[1] = (unsigned char)(sum_g / blurArea);
-        dst[2] = (unsigned char)(sum_b / blurArea);
-        if ( src_alpha )
-            dst_alpha[y * M_IMGDATA->m_width] = (unsigned char)(sum_a / blurArea);
+        for ( int c = 0; c < N; c++ )
+            dst[c] = Average(sums[c]);
 
         // Now average the values of the rest of the pixels by just moving the
         // blur radius box along the row
-        for ( int x = 1; x < M_IMGDATA->m_width; x++ )
+        for ( int x = 1; x < m_width; x++ )
         {
-            // Take care of edge pixels on the left edge by essentially
-            // duplicating the edge pixel
-            if ( x - blurRadius - 1 < 0 )
-                pixel_idx = y * M_IMGDATA->m_width;
-            else
-                pixel_idx = (x - blurRadius - 1) + y * M_IMGDATA->m_width;
-
-            // Subtract the value of the pixel at the left side of the blur
-            // radius box
-            src = src_data + pixel_idx*3;
-            sum_r -= src[0];
-            sum_g -= src[1];
-            sum_b -= src[2];
-            if ( src_alpha )
-                sum_a -= src_alpha[pixel_idx];
-
-            // Take care of edge pixels on the right edge
-            if ( x + blurRadius > M_IMGDATA->m_width - 1 )
-                pixel_idx = M_IMGDATA->m_width - 1 + y * M_IMGDATA->m_width;
-            else
-                pixel_idx = x + blurRadius + y * M_IMGDATA->m_width;
-
-            // Add the value of the pixel being added to the end of our box
-            src = src_data + pixel_idx*3;
-            sum_r += src[0];
-            sum_g += src[1];
-            sum_b += src[2];
-            if ( src_alpha )
-                sum_a += src_alpha[pixel_idx];
-
-            // Save off the averaged data
-            dst = dst_data + x*3 + y*M_IMGDATA->m_width*3;
-            dst[0] = (unsigned char)(sum_r / blurArea);
-            dst[1] = (unsigned char)(sum_g / blurArea);
-            dst[2] = (unsigned char)(sum_b / blurArea);
-            if ( src_alpha )
-                dst_alpha[x + y * M_IMGDATA->m_width] = (unsigned char)(sum_a / blurArea);
+            const unsigned char* const
+                out = src + wxMax(x - m_radius - 1, 0)*N;
+            const unsigned char* const
+                in = src + wxMin(x + m_radius, last)*N;
+
+            unsigned char* const d = dst + x*N;
+            for ( int c = 0; c < N; c++ )
+            {
+                sums[c] += in[c];
+                sums[c] -= out[c];
+                d[c] = Average(sums[c]);
+            }
         }
     }
 
-    return ret_image;
-}
+    wxDECLARE_NO_COPY_CLASS(BlurHorizontalTask);
+};
 
-// Blur in the vertical direction
-wxImage wxImage::BlurVertical(int blurRadius) const
+// Vertical blur: the items are the vertical strips of BLUR_STRIP_WIDTH
+// columns each.
+class BlurVerticalTask : public BlurTask
 {
-    wxImage ret_image(MakeEmptyClone());
-
-    wxCHECK( ret_image.IsOk(), ret_image );
-
-    const unsigned char* src_data = M_IMGDATA->m_data;
-    unsigned char* dst_data = ret_image.GetData();
-    const unsigned char* src_alpha = M_IMGDATA->m_alpha;
-    unsigned char* dst_alpha = ret_image.GetAlpha();
+public:
+    BlurVerticalTask(const unsigned char* srcData,
+                     const unsigned char* srcAlpha,
+                     unsigned char* dstData,
+                     unsigned char* dstAlpha,
+                     int width,
+                     int height,
+                     int radius,
+                     bool round)
+        : BlurTask(srcData, srcAlpha, dstData, dstAlpha,
+                   width, height, radius, round)
+    {
+    }
 
-    // number of pixels we average over
-    const int blurArea = blurRadius*2 + 1;
+    static int GetStripsCount(int width)
+    {
+        return (width + BLUR_STRIP_WIDTH - 1) / BLUR_STRIP_WIDTH;
+    }
 
-    // Vertical blurring algorithm - same as horizontal but switched the
-    // opposite direction
-    for ( int x = 0; x < M_IMGDATA->m_width; x++ )
+    virtual void ProcessRange(int first, int last) wxOVERRIDE
     {
-        // Variables used in the blurring algorithm
-        long sum_r = 0,
-             sum_g = 0,
-             sum_b = 0,
-             sum_a = 0;
+        for ( int strip = first; strip < last; strip++ )
+        {
+            const int x = strip*BLUR_STRIP_WIDTH;
+            const int count = wxMin(BLUR_STRIP_WIDTH, m_width - x);
 
-        long pixel_idx;
-        const unsigned char *src;
-        unsigned char *dst;
+            BlurStrip(m_srcData + x*3, m_dstData + x*3, count*3, m_width*3);
+            if ( m_srcAlpha )
+                BlurStrip(m_srcAlpha + x, m_dstAlpha + x, count, m_width);
+        }
+    }
 
-        // Calculate the average of all pixels in our blur radius box for the
-        // first pixel of the column
-        for ( int kernel_y = -blurRadius; kernel_y <= blurRadius; kernel_y++ )
+private:
+    // Blur the strip of the given width (in bytes) of the plane with the
+    // given line size.
+    //
+    // Instead of walking down each column in turn, which is very cache
+    // unfriendly, we maintain the running sums for all the columns of the
+    // strip and update them row by row.
+    void BlurStrip(const unsigned char* src,
+                   unsigned char* dst,
+                   int count,
+                   int lineSize) const
+    {
+        const int lastRow = m_height - 1;
+
+        wxVector<unsigned long> sums(count);
+
+        // When blurring in place, the rows leaving the blur box have been
+        // overwritten by the time we need them, so we keep copies of the
+        // last radius+1 original rows in a ring buffer, and a copy of the
+        // first row which is used instead of all the rows above it.
+        const bool inPlace = src == dst;
+        const int ringSize = m_radius + 1;
+        wxVector<unsigned char> ring, firstRow;
+        if ( inPlace )
         {
-            // To deal with the pixels at the start of a column so it's not
-            // grabbing GOK values from memory at negative indices of the
-            // image's data or grabbing from the previous column
-            if ( kernel_y < 0 )
-                pixel_idx = x;
-            else
-                pixel_idx = x + kernel_y * M_IMGDATA->m_width;
-
-            src = src_data + pixel_idx*3;
-            sum_r += src[0];
-            sum_g += src[1];
-            sum_b += src[2];
-            if ( src_alpha )
-                sum_a += src_alpha[pixel_idx];
+            firstRow.assign(src, src + count);
+
+            // The ring buffer is only used if there are rows below the
+            // radius+1 first ones.
+            if ( ringSize < m_height )
+                ring.resize(ringSize*count);
         }
 
-        dst = dst_data + x*3;
-        dst[0] = (unsigned char)(sum_r / blurArea);
-        dst[1] = (unsigned char)(sum_g / blurArea);
-        dst[2] = (unsigned char)(sum_b / blurArea);
-        if ( src_alpha )
-            dst_alpha[x] = (unsigned char)(sum_a / blurArea);
+        // Calculate the sums of all pixels in our blur radius box for the
+        // first row of the strip
+        for ( int kernel_y = -m_radius; kernel_y <= m_radius; kernel_y++ )
+        {
+            const unsigned char* const
+                p = src + wxMax(wxMin(kernel_y, lastRow), 0)*lineSize;
+            for ( int i = 0; i < count; i++ )
+                sums[i] += p[i];
+        }
 
-        // Now average the values of the rest of the pixels by just moving the
-        // box along the column from top to bottom
-        for ( int y = 1; y < M_IMGDATA->m_height; y++ )
+        for ( int y = 0; y < m_height; y++ )
         {
-            // Take care of pixels that would be beyond the top edge by
-            // duplicating the top edge pixel for the column
-            if ( y - blurRadius - 1 < 0 )
-                pixel_idx = x;
-            else
-                pixel_idx = x + (y - blurRadius - 1) * M_IMGDATA->m_width;
-
-            // Subtract the value of the pixel at the top of our blur radius box
-            src = src_data + pixel_idx*3;
-            sum_r -= src[0];
-            sum_g -= src[1];
-            sum_b -= src[2];
-            if ( src_alpha )
-                sum_a -= src_alpha[pixel_idx];
-
-            // Take care of the pixels that would be beyond the bottom edge of
-            // the image similar to the top edge
-            if ( y + blurRadius > M_IMGDATA->m_height - 1 )
-                pixel_idx = x + (M_IMGDATA->m_height - 1) * M_IMGDATA->m_width;
-            else
-                pixel_idx = x + (blurRadius + y) * M_IMGDATA->m_width;
-
-            // Add the value of the pixel being added to the end of our box
-            src = src_data + pixel_idx*3;
-            sum_r += src[0];
-            sum_g += src[1];
-            sum_b += src[2];
-            if ( src_alpha )
-                sum_a += src_alpha[pixel_idx];
-
-            // Save off the averaged data
-            dst = dst_data + (x + y * M_IMGDATA->m_width) * 3;
-            dst[0] = (unsigned char)(sum_r / blurArea);
-            dst[1] = (unsigned char)(sum_g / blurArea);
-            dst[2] = (unsigned char)(sum_b / blurArea);
-            if ( src_alpha )
-                dst_alpha[x + y * M_IMGDATA->m_width] = (unsigned char)(sum_a / blurArea);
+            unsigned char* const d = dst + y*lineSize;
+
+            if ( y > 0 )
+            {
+                // Take care of pixels that would be beyond the top or bottom
+                // edges by duplicating the edge pixels for the column
+                const int rowOut = y - m_radius - 1;
+                const unsigned char* out;
+                if ( rowOut < 0 )
+                    out = inPlace ? &firstRow[0] : src;
+                else if ( inPlace )
+                    out = &ring[(rowOut % ringSize)*count];
+                else
+                    out = src + rowOut*lineSize;
+
+                // Notice that the row being added to the box has not been
+                // modified yet even when working in place, as it is never
+                // above the current one.
+                const unsigned char* const
+                    in = src + wxMin(y + m_radius, lastRow)*lineSize;
+
+                for ( int i = 0; i < count; i++ )
+                {
+                    sums[i] += in[i];
+                    sums[i] -= out[i];
+                }
+            }
+
+            // Save the original row before overwriting it, if it's going to
+            // be needed later.
+            if ( !ring.empty() )
+                memcpy(&ring[(y % ringSize)*count], d, count);
+
+            for ( int i = 0; i < count; i++ )
+                d[i] = Average(sums[i]);
         }
     }
 
+    wxDECLARE_NO_COPY_CLASS(BlurVerticalTask);
+};
+
+// Blur the image planes in the given direction using the box filter of the
+// specified radius, the source and destination may be the same.
+void
+DoBlurHorizontal(const unsigned char* srcData,
+                 const unsigned char* srcAlpha,
+                 unsigned char* dstData,
+                 unsigned char* dstAlpha,
+                 int width,
+                 int height,
+                 int radius,
+                 bool round = false)
+{
+    BlurHorizontalTask task(srcData, srcAlpha, dstData, dstAlpha,
+                            width, height, radius, round);
+    wxRunParallelTask(task, height, BlurMinItemsPerThread(width));
+}
+
+void
+DoBlurVertical(const unsigned char* srcData,
+               const unsigned char* srcAlpha,
+               unsigned char* dstData,
+               unsigned char* dstAlpha,
+               int width,
+               int height,
+               int radius,
+               bool round = false)
+{
+    BlurVerticalTask task(srcData, srcAlpha, dstData, dstAlpha,
+                          width, height, radius, round);
+    wxRunParallelTask(task,
+                      BlurVerticalTask::GetStripsCount(width),
+                      BlurMinItemsPerThread(BLUR_STRIP_WIDTH*height));
+}
+
+// Compute the radii of the box filters which, applied successively,
+// approximate the Gaussian blur with the given standard deviation.
+//
+// See "Fast Almost-Gaussian Filtering" by Peter Kovesi for the explanation of
+// the formulas used here.
+void GaussianBoxesRadii(double sigma, int* radii, int passes)
+{
+    // ideal averaging filter width
+    const double wIdeal = sqrt(12*sigma*sigma/passes + 1);
+
+    // the filters must have odd widths, use the ones just below and above
+    // the ideal width
+    int wl = int(floor(wIdeal));
+    if ( wl % 2 == 0 )
+        wl--;
+    const int wu = wl + 2;
+
+    // number of passes using the smaller width
+    const double mIdeal = (12*sigma*sigma - passes*wl*wl - 4*passes*wl - 3*passes)
+                            / (-4*wl - 4);
+    const int m = int(floor(mIdeal + 0.5));
+
+    for ( int n = 0; n < passes; n++ )
+        radii[n] = ((n < m ? wl : wu) - 1) / 2;
+}
+
+} // anonymous namespace
+
+// Blur in the horizontal direction
+wxImage wxImage::BlurHorizontal(int blurRadius) const
+{
+    wxImage ret_image(MakeEmptyClone());
+
+    wxCHECK( ret_image.IsOk(), ret_image );
+
+    DoBlurHorizontal(M_IMGDATA->m_data, M_IMGDATA->m_alpha,
+                     ret_image.GetData(), ret_image.GetAlpha(),
+                     M_IMGDATA->m_width, M_IMGDATA->m_height, blurRadius);
+
+    return ret_image;
+}
+
+// Blur in the vertical direction
+wxImage wxImage::BlurVertical(int blurRadius) const
+{
+    wxImage ret_image(MakeEmptyClone());
+
+    wxCHECK( ret_image.IsOk(), ret_image );
+
+    DoBlurVertical(M_IMGDATA->m_data, M_IMGDATA->m_alpha,
+                   ret_image.GetData(), ret_image.GetAlpha(),
+                   M_IMGDATA->m_width, M_IMGDATA->m_height, blurRadius);
+
     return ret_image;
 }
 
 // The new blur function
 wxImage wxImage::Blur(int blurRadius) const
 {
-    wxImage ret_image;
-    ret_image.Create(M_IMGDATA->m_width, M_IMGDATA->m_height, false);
+    wxImage ret_image(MakeEmptyClone());
+
+    wxCHECK( ret_image.IsOk(), ret_image );
+
+    // Blur the image in each direction, the vertical blur can be done in
+    // place as it only uses the result of the horizontal one.
+    unsigned char* const data = ret_image.GetData();
+    unsigned char* const alpha = ret_image.GetAlpha();
+    const int width = M_IMGDATA->m_width,
+              height = M_IMGDATA->m_height;
 
-    // Blur the image in each direction
-    ret_image = BlurHorizontal(blurRadius);
-    ret_image = ret_image.BlurVertical(blurRadius);
+    DoBlurHorizontal(M_IMGDATA->m_data, M_IMGDATA->m_alpha,
+                     data, alpha, width, height, blurRadius);
+    DoBlurVertical(data, alpha, data, alpha, width, height, blurRadius);
 
     return ret_image;
 }
 
+wxImage& wxImage::BlurInPlace(int blurRadius, wxImageBlurQuality quality)
+{
+    wxCHECK_MSG( IsOk(), *this, wxS("invalid image") );
+    wxCHECK_MSG( blurRadius >= 0, *this, wxS("invalid blur radius") );
+
+    AllocExclusive();
+
+    unsigned char* const data = M_IMGDATA->m_data;
+    unsigned char* const alpha = M_IMGDATA->m_alpha;
+    const int width = M_IMGDATA->m_width,
+              height = M_IMGDATA->m_height;
+
+    switch ( quality )
+    {
+        case wxIMAGE_BLUR_BOX:
+            DoBlurHorizontal(data, alpha, data, alpha, width, height, blurRadius);
+            DoBlurVertical(data, alpha, data, alpha, width, height, blurRadius);
+            break;
+
+        case wxIMAGE_BLUR_GAUSSIAN:
+            {
+                // Use 3 passes as it's enough to be visually indistinguishable
+                // from the real Gaussian blur. The radius corresponds to twice
+                // the standard deviation, i.e. ~95% of the kernel weight lies
+                // inside it.
+                static const int PASSES = 3;
+
+                int radii[PASSES];
+                GaussianBoxesRadii(blurRadius / 2.0, radii, PASSES);
+
+                // As each pass is applied to the result of the previous one,
+                // round the averages to avoid accumulating the truncation
+                // errors, which would darken the image.
+                for ( int n = 0; n < PASSES; n++ )
+                {
+                    if ( radii[n] > 0 )
+                        DoBlurHorizontal(data, alpha, data, alpha,
+                                         width, height, radii[n], true);
+                }
+
+                for ( int n = 0; n < PASSES; n++ )
+                {
+                    if ( radii[n] > 0 )
+                        DoBlurVertical(data, alpha, data, alpha,
+                                       width, height, radii[n], true);
+                }
+            }
+            break;
+    }
+
+    return *this;
+}
+
 wxImage wxImage::Rotate90( bool clockwise ) const
 {
     wxImage image(MakeEmptyClone(Clone_SwapOrientation));
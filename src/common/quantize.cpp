@@ -43,15 +43,21 @@
 #ifndef WX_PRECOMP
     #include "wx/palette.h"
     #include "wx/image.h"
+    #include "wx/utils.h"
 #endif
 
 #ifdef __WXMSW__
     #include "wx/msw/private.h"
 #endif
 
+#include "wx/vector.h"
+#include "wx/private/parallel.h"
+
 #include <stdlib.h>
 #include <string.h>
 
+#include <algorithm>
+
 #define RGB_RED       0
 #define RGB_GREEN     1
 #define RGB_BLUE      2
@@ -989,6 +995,26 @@ fill_inverse_cmap (j_decompress_ptr cinfo, int c0, int c1, int c2)
 }
 
 
+static void
+fill_whole_inverse_cmap (j_decompress_ptr cinfo)
+/* Fill all the update boxes of the inverse colormap at once.  This is worth
+ * doing when the same colormap is used for mapping many images, and is also
+ * required for mapping several images concurrently as fill_inverse_cmap()
+ * can't be called from multiple threads at once.
+ */
+{
+  int c0, c1, c2;
+
+  for (c0 = 0; c0 < HIST_C0_ELEMS; c0 += BOX_C0_ELEMS) {
+    for (c1 = 0; c1 < HIST_C1_ELEMS; c1 += BOX_C1_ELEMS) {
+      for (c2 = 0; c2 < HIST_C2_ELEMS; c2 += BOX_C2_ELEMS) {
+    fill_inverse_cmap(cinfo, c0, c1, c2);
+      }
+    }
+  }
+}
+
+
 /*
  * Map some rows of pixels to the output colormapped representation.
  */
@@ -1027,10 +1053,14 @@ pass2_no_dither (j_decompress_ptr cinfo,
 }
 
 
-void
-pass2_fs_dither (j_decompress_ptr cinfo,
-         JSAMPARRAY input_buf, JSAMPARRAY output_buf, int num_rows)
-/* This version performs Floyd-Steinberg dithering */
+static void
+fs_dither_rows (j_decompress_ptr cinfo, FSERRPTR fserrors, bool *on_odd_row,
+        JSAMPARRAY input_buf, JSAMPARRAY output_buf, int num_rows)
+/* This performs Floyd-Steinberg dithering using the given errors array,
+ * which must have (#columns + 2) * 3 entries, and updates the row parity.
+ * It is separate from pass2_fs_dither() to allow using several independent
+ * error arrays for the different parts of the same image.
+ */
 {
   my_cquantize_ptr cquantize = (my_cquantize_ptr) cinfo->cquantize;
   hist3d histogram = cquantize->histogram;
@@ -1056,20 +1086,20 @@ pass2_fs_dither (j_decompress_ptr cinfo,
   for (row = 0; row < num_rows; row++) {
     inptr = input_buf[row];
     outptr = output_buf[row];
-    if (cquantize->on_odd_row) {
+    if (*on_odd_row) {
       /* work right to left in this row */
       inptr += (width-1) * 3;   /* so point to rightmost pixel */
       outptr += width-1;
       dir = -1;
       dir3 = -3;
-      errorptr = cquantize->fserrors + (width+1)*3; /* => entry after last column */
-      cquantize->on_odd_row = false; /* flip for next time */
+      errorptr = fserrors + (width+1)*3; /* => entry after last column */
+      *on_odd_row = false; /* flip for next time */
     } else {
       /* work left to right in this row */
       dir = 1;
       dir3 = 3;
-      errorptr = cquantize->fserrors; /* => entry before first real column */
-      cquantize->on_odd_row = true; /* flip for next time */
+      errorptr = fserrors; /* => entry before first real column */
+      *on_odd_row = true; /* flip for next time */
     }
     /* Preset error values: no error propagated to first pixel from left */
     cur0 = cur1 = cur2 = 0;
@@ -1169,6 +1199,18 @@ pass2_fs_dither (j_decompress_ptr cinfo,
 }
 
 
+void
+pass2_fs_dither (j_decompress_ptr cinfo,
+         JSAMPARRAY input_buf, JSAMPARRAY output_buf, int num_rows)
+/* This version performs Floyd-Steinberg dithering */
+{
+  my_cquantize_ptr cquantize = (my_cquantize_ptr) cinfo->cquantize;
+
+  fs_dither_rows(cinfo, cquantize->fserrors, &cquantize->on_odd_row,
+         input_buf, output_buf, num_rows);
+}
+
+
 /*
  * Initialize the error-limiting transfer function (lookup table).
  * The raw F-S error computation can potentially compute error values of up to
@@ -1601,5 +1643,349 @@ bool wxQuantize::Quantize(const wxImage& src,
     return true;
 }
 
+// ----------------------------------------------------------------------------
+// wxQuantizePalette
+// ----------------------------------------------------------------------------
+
+namespace
+{
+
+// Number of rows in the bands into which the image is divided when mapping it
+// with dithering: each band is dithered independently, which allows mapping
+// the bands in parallel. Notice that this doesn't depend on the number of
+// threads used, so that the results are always the same.
+const int QUANTIZE_DITHER_BAND_ROWS = 64;
+
+// Minimal number of pixels to map in each thread.
+const int QUANTIZE_MIN_PIXELS_PER_THREAD = 256*1024;
+
+hist3d AllocHistogram()
+{
+    hist3d histogram = (hist3d) malloc(HIST_C0_ELEMS * sizeof(hist2d));
+    for (int i = 0; i < HIST_C0_ELEMS; i++)
+        histogram[i] = (hist2d) malloc(HIST_C1_ELEMS*HIST_C2_ELEMS * sizeof(histcell));
+
+    return histogram;
+}
+
+void ZeroHistogram(hist3d histogram)
+{
+    for (int i = 0; i < HIST_C0_ELEMS; i++)
+        memset(histogram[i], 0, HIST_C1_ELEMS*HIST_C2_ELEMS * sizeof(histcell));
+}
+
+void FreeHistogram(hist3d histogram)
+{
+    for (int i = 0; i < HIST_C0_ELEMS; i++)
+        free(histogram[i]);
+    free(histogram);
+}
+
+// Task mapping either the rows (without dithering) or the bands of rows (with
+// it) of an image to the colormap.
+class QuantizeMapTask : public wxParallelTask
+{
+public:
+    QuantizeMapTask(const j_decompress& dec,
+                    unsigned char* src,
+                    unsigned char* dst,
+                    int height,
+                    bool dither)
+        : m_dec(dec),
+          m_src(src),
+          m_dst(dst),
+          m_height(height),
+          m_dither(dither)
+    {
+    }
+
+    virtual void ProcessRange(int first, int last) wxOVERRIDE
+    {
+        const int width = m_dec.output_width;
+
+        // Notice that we use our own copy of j_decompress to ensure that we
+        // don't modify anything shared by the different threads: all the
+        // functions used here only read the data pointed to by it.
+        j_decompress_ptr cinfo = &m_dec;
+
+        if ( !m_dither )
+        {
+            for ( int y = first; y < last; y++ )
+            {
+                JSAMPROW in = m_src + y*width*3;
+                JSAMPROW out = m_dst + y*width;
+                pass2_no_dither(cinfo, &in, &out, 1);
+            }
+
+            return;
+        }
+
+        wxVector<FSERROR> errors((width + 2)*3);
+        for ( int band = first; band < last; band++ )
+        {
+            std::fill(errors.begin(), errors.end(), 0);
+            bool onOddRow = false;
+
+            const int end = wxMin((band + 1)*QUANTIZE_DITHER_BAND_ROWS, m_height);
+            for ( int y = band*QUANTIZE_DITHER_BAND_ROWS; y < end; y++ )
+            {
+                JSAMPROW in = m_src + y*width*3;
+                JSAMPROW out = m_dst + y*width;
+                fs_dither_rows(cinfo, &errors[0], &onOddRow, &in, &out, 1);
+            }
+        }
+    }
+
+private:
+    j_decompress m_dec;
+    unsigned char* const m_src;
+    unsigned char* const m_dst;
+    const int m_height;
+    const bool m_dither;
+
+    wxDECLARE_NO_COPY_CLASS(QuantizeMapTask);
+};
+
+} // anonymous namespace
+
+class wxQuantizePaletteData
+{
+public:
+    wxQuantizePaletteData()
+    {
+        // Allocate the colormap big enough for any number of colours.
+        dec.output_width = 0;
+        dec.desired_number_of_colors = MAXNUMCOLORS;
+        dec.actual_number_of_colors = 0;
+        prepare_range_limit_table(&dec);
+        jinit_2pass_quantizer(&dec);
+        cquantize = (my_cquantize_ptr) dec.cquantize;
+        dec.colormap = cquantize->sv_colormap;
+
+        // The histogram allocated by jinit_2pass_quantizer() is used as the
+        // inverse colormap, while the image statistics are accumulated in a
+        // separate one, so that adding more images doesn't invalidate the
+        // existing colormap.
+        ZeroHistogram(cquantize->histogram);
+        stats = AllocHistogram();
+        ZeroHistogram(stats);
+        hasStats = false;
+    }
+
+    ~wxQuantizePaletteData()
+    {
+        FreeHistogram(stats);
+        FreeHistogram(cquantize->histogram);
+        free(dec.colormap[0]);
+        free(dec.colormap[1]);
+        free(dec.colormap[2]);
+        free(dec.colormap);
+        free(dec.srl_orig);
+        free((void*)(cquantize->error_limiter - MAXJSAMPLE));
+        free(cquantize->fserrors);
+        free(cquantize);
+    }
+
+    // Must be called after changing the colormap.
+    void UpdateColours()
+    {
+        for ( int i = 0; i < dec.actual_number_of_colors; i++ )
+        {
+            colours[3*i + 0] = dec.colormap[0][i];
+            colours[3*i + 1] = dec.colormap[1][i];
+            colours[3*i + 2] = dec.colormap[2][i];
+        }
+
+        ZeroHistogram(cquantize->histogram);
+        fill_whole_inverse_cmap(&dec);
+    }
+
+    j_decompress dec;
+    my_cquantize_ptr cquantize;
+
+    // the histogram used for choosing the colours and whether it contains
+    // anything
+    hist3d stats;
+    bool hasStats;
+
+    // the colormap in RGB format
+    unsigned char colours[3*MAXNUMCOLORS];
+
+    wxDECLARE_NO_COPY_CLASS(wxQuantizePaletteData);
+};
+
+wxQuantizePalette::wxQuantizePalette()
+{
+    m_data = new wxQuantizePaletteData;
+}
+
+wxQuantizePalette::~wxQuantizePalette()
+{
+    delete m_data;
+}
+
+void wxQuantizePalette::AddImage(const wxImage& image)
+{
+    wxCHECK_RET( image.IsOk(), wxS("invalid image") );
+
+    const int w = image.GetWidth();
+    const int h = image.GetHeight();
+    unsigned char* const data = image.GetData();
+
+    j_decompress_ptr cinfo = &m_data->dec;
+    my_cquantize_ptr cquantize = m_data->cquantize;
+
+    const hist3d inverseColormap = cquantize->histogram;
+    cquantize->histogram = m_data->stats;
+    cinfo->output_width = w;
+
+    for ( int y = 0; y < h; y++ )
+    {
+        JSAMPROW row = data + y*w*3;
+        prescan_quantize(cinfo, &row, NULL, 1);
+    }
+
+    cquantize->histogram = inverseColormap;
+
+    m_data->hasStats = true;
+}
+
+bool wxQuantizePalette::Fit(int desiredNoColours)
+{
+    wxCHECK_MSG( desiredNoColours > 0 && desiredNoColours <= MAXNUMCOLORS,
+                 false, wxS("invalid number of colours") );
+
+    if ( !m_data->hasStats )
+        return false;
+
+    my_cquantize_ptr cquantize = m_data->cquantize;
+
+    const hist3d inverseColormap = cquantize->histogram;
+    cquantize->histogram = m_data->stats;
+
+    select_colors(&m_data->dec, desiredNoColours);
+
+    cquantize->histogram = inverseColormap;
+
+    // Start accumulating the statistics for the next palette from scratch.
+    ZeroHistogram(m_data->stats);
+    m_data->hasStats = false;
+
+    m_data->UpdateColours();
+
+    return true;
+}
+
+bool wxQuantizePalette::SetColours(const unsigned char* rgb, int count)
+{
+    wxCHECK_MSG( rgb, false, wxS("NULL colours") );
+    wxCHECK_MSG( count > 0 && count <= MAXNUMCOLORS, false,
+                 wxS("invalid number of colours") );
+
+    j_decompress_ptr cinfo = &m_data->dec;
+    for ( int i = 0; i < count; i++ )
+    {
+        cinfo->colormap[0][i] = rgb[3*i + 0];
+        cinfo->colormap[1][i] = rgb[3*i + 1];
+        cinfo->colormap[2][i] = rgb[3*i + 2];
+    }
+
+    cinfo->actual_number_of_colors = count;
+
+    m_data->UpdateColours();
+
+    return true;
+}
+
+bool wxQuantizePalette::IsOk() const
+{
+    return m_data->dec.actual_number_of_colors > 0;
+}
+
+int wxQuantizePalette::GetColoursCount() const
+{
+    return m_data->dec.actual_number_of_colors;
+}
+
+const unsigned char* wxQuantizePalette::GetColours() const
+{
+    return m_data->colours;
+}
+
+bool wxQuantizePalette::Map(const wxImage& src,
+                            unsigned char* eightBitData,
+                            bool dither) const
+{
+    wxCHECK_MSG( IsOk(), false, wxS("palette colours must be chosen first") );
+    wxCHECK_MSG( src.IsOk(), false, wxS("invalid image") );
+    wxCHECK_MSG( eightBitData, false, wxS("NULL output buffer") );
+
+    const int w = src.GetWidth();
+    const int h = src.GetHeight();
+
+    j_decompress dec = m_data->dec;
+    dec.output_width = w;
+
+    QuantizeMapTask task(dec, src.GetData(), eightBitData, h, dither);
+
+    const int minRows = wxMax(QUANTIZE_MIN_PIXELS_PER_THREAD / w, 1);
+    if ( dither )
+    {
+        const int bands = (h + QUANTIZE_DITHER_BAND_ROWS - 1)
+                            / QUANTIZE_DITHER_BAND_ROWS;
+        wxRunParallelTask(task, bands,
+                          wxMax(minRows / QUANTIZE_DITHER_BAND_ROWS, 1));
+    }
+    else
+    {
+        wxRunParallelTask(task, h, minRows);
+    }
+
+    return true;
+}
+
+bool wxQuantizePalette::Map(const wxImage& src, wxImage& dest, bool dither) const
+{
+    wxCHECK_MSG( src.IsOk(), false, wxS("invalid image") );
+
+    const int w = src.GetWidth();
+    const int h = src.GetHeight();
+
+    wxVector<unsigned char> data8bit(w*h);
+    if ( !Map(src, &data8bit[0], dither) )
+        return false;
+
+    if ( !dest.IsOk() || dest.GetWidth() != w || dest.GetHeight() != h )
+        dest.Create(w, h, false);
+    else
+        dest.UnShare();
+
+    unsigned char* imgdt = dest.GetData();
+    for ( int i = 0; i < w * h; i++ )
+    {
+        const unsigned char c = data8bit[i];
+        imgdt[3 * i + 0/*R*/] = m_data->colours[3 * c + 0];
+        imgdt[3 * i + 1/*G*/] = m_data->colours[3 * c + 1];
+        imgdt[3 * i + 2/*B*/] = m_data->colours[3 * c + 2];
+    }
+
+#if wxUSE_PALETTE
+    const int count = GetColoursCount();
+    unsigned char r[MAXNUMCOLORS],
+                  g[MAXNUMCOLORS],
+                  b[MAXNUMCOLORS];
+    for ( int i = 0; i < count; i++ )
+    {
+        r[i] = m_data->colours[3 * i + 0];
+        g[i] = m_data->colours[3 * i + 1];
+        b[i] = m_data->colours[3 * i + 2];
+    }
+
+    dest.SetPalette(wxPalette(count, r, g, b));
+#endif // wxUSE_PALETTE
+
+    return true;
+}
+
 #endif
     // wxUSE_IMAGE
@@ -198,13 +198,20 @@ int wxSelectDispatcher::ProcessSets(const wxSelectSets& sets)
         if ( !sets.HasFD(fd) )
             continue;
 
-        wxFDIOHandler * const handler = FindHandler(fd);
-        if ( !handler )
+        const wxFDIOHandlerMap::const_iterator it = m_handlers.find(fd);
+        if ( it == m_handlers.end() || !it->second.handler )
         {
             wxFAIL_MSG( wxT("NULL handler in wxSelectDispatcher?") );
             continue;
         }
 
+        wxFDIOHandler * const handler = it->second.handler;
+
+        // emulate wxFDIO_ONESHOT by stopping to monitor the descriptor until
+        // ModifyFD() is called for it
+        if ( it->second.flags & wxFDIO_ONESHOT )
+            m_sets.ClearFD(fd);
+
         if ( sets.Handle(fd, *handler) )
             numEvents++;
     }
@@ -551,6 +551,10 @@ wxSocketImpl *wxSocketImpl::Accept(wxSocketBase& wxsocket)
     sock->m_fd = fd;
     sock->m_peer = wxSockAddressImpl(from.addr, fromlen);
 
+    // the socket must be fully initialized before registering it as it can
+    // get events in another thread immediately if it uses a worker loop
+    wxsocket.OnAccepted(sock);
+
     sock->UnblockAndRegisterWithEventLoop();
 
     return sock;
@@ -839,6 +843,7 @@ void wxSocketBase::Init()
     m_handler      = NULL;
     m_clientData   = NULL;
     m_notify       = false;
+    m_eventLoop    = NULL;
     m_eventmask    =
     m_eventsgot    = 0;
 
@@ -900,7 +905,15 @@ bool wxSocketBase::Destroy()
     //
     // Notice that sockets used in other threads won't have any events for them
     // and we shouldn't use delayed destruction mechanism for them as it's not
-    // MT-safe.
+    // MT-safe, except for those using a worker loop which can't be deleted
+    // immediately as we may be called from their event handler.
+#if wxUSE_CONSOLE_EVENTLOOP && defined(__UNIX__)
+    if ( m_eventLoop )
+    {
+        m_eventLoop->ScheduleForDestruction(this);
+    }
+    else
+#endif // wxUSE_CONSOLE_EVENTLOOP && __UNIX__
     if ( wxIsMainThread() && wxTheApp )
     {
         wxTheApp->ScheduleForDestruction(this);
@@ -1731,10 +1744,22 @@ void wxSocketBase::OnRequest(wxSocketNotify notification)
         event.m_clientData = m_clientData;
         event.SetEventObject(this);
 
-        m_handler->AddPendingEvent(event);
+        // the events for the sockets using a worker loop are processed
+        // immediately in its thread as it doesn't process pending events
+        if ( m_eventLoop )
+            m_handler->SafelyProcessEvent(event);
+        else
+            m_handler->AddPendingEvent(event);
     }
 }
 
+void wxSocketBase::OnAccepted(wxSocketImpl *impl)
+{
+    m_impl = impl;
+    m_type = wxSOCKET_BASE;
+    m_connected = true;
+}
+
 void wxSocketBase::Notify(bool notify)
 {
     m_notify = notify;
@@ -1882,18 +1907,14 @@ bool wxSocketServer::AcceptWith(wxSocketBase& sock, bool wait)
         }
     }
 
-    sock.m_impl = m_impl->Accept(sock);
-
-    if ( !sock.m_impl )
+    // notice that Accept() initializes the socket itself on success
+    if ( !m_impl->Accept(sock) )
     {
         SetError(m_impl->GetLastError());
 
         return false;
     }
 
-    sock.m_type = wxSOCKET_BASE;
-    sock.m_connected = true;
-
     return true;
 }
 
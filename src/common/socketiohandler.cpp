@@ -41,6 +41,12 @@ bool wxSocketFDBasedManager::OnInit()
         return false;
 
     m_fdioManager = traits->GetFDIOManager();
+
+    // the sockets using worker event loops are always monitored using
+    // wxFDIODispatcher, even in the GUI applications using a different
+    // wxFDIOManager, so we need the base class manager for them too
+    m_fdioManagerDispatcher = traits->wxAppTraits::GetFDIOManager();
+
     return m_fdioManager != NULL;
 }
 
@@ -55,11 +61,13 @@ void wxSocketFDBasedManager::Install_Callback(wxSocketImpl *socket_,
 
     const wxFDIOManager::Direction d = GetDirForEvent(socket, event);
 
+    wxFDIOManager * const fdioManager = GetFDIOManagerFor(socket);
+
     int& fd = FD(socket, d);
     if ( fd != -1 )
-        m_fdioManager->RemoveInput(socket, fd, d);
+        fdioManager->RemoveInput(socket, fd, d);
 
-    fd = m_fdioManager->AddInput(socket, socket->m_fd, d);
+    fd = fdioManager->AddInput(socket, socket->m_fd, d);
 }
 
 void wxSocketFDBasedManager::Uninstall_Callback(wxSocketImpl *socket_,
@@ -73,7 +81,7 @@ void wxSocketFDBasedManager::Uninstall_Callback(wxSocketImpl *socket_,
     int& fd = FD(socket, d);
     if ( fd != -1 )
     {
-        m_fdioManager->RemoveInput(socket, fd, d);
+        GetFDIOManagerFor(socket)->RemoveInput(socket, fd, d);
         fd = -1;
     }
 }
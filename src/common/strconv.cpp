@@ -35,6 +35,14 @@
 #include <string.h>
 #include <stdlib.h>
 
+// SSE2 is always available when compiling for x86-64 and allows to check and
+// convert 16 ASCII characters at once, see ConvertASCII() below.
+#if defined(__SSE2__) || defined(_M_X64) || \
+        (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+    #define wxSTRCONV_USE_SSE2
+    #include <emmintrin.h>
+#endif
+
 #if defined(__WIN32__) && !defined(__WXMICROWIN__)
     #include "wx/msw/private.h"
     #include "wx/msw/missing.h"
@@ -981,6 +989,127 @@ const unsigned char tableUtf8Lengths[256] = {
                    0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0   // F5..FF
 };
 
+// ----------------------------------------------------------------------------
+// helpers for converting runs of ASCII characters quickly
+// ----------------------------------------------------------------------------
+
+// Convert the ASCII characters at the start of the given UTF-8 string of the
+// given length to the output buffer, if it's non-NULL, stopping at the first
+// non-ASCII character and return the number of ASCII characters found.
+static size_t ConvertASCII(wchar_t *out, const char *src, size_t srcLen)
+{
+    size_t n = 0;
+
+#ifdef wxSTRCONV_USE_SSE2
+    const __m128i zero = _mm_setzero_si128();
+    for ( ; n + 16 <= srcLen; n += 16 )
+    {
+        const __m128i
+            chars = _mm_loadu_si128(reinterpret_cast<const __m128i *>(src + n));
+        if ( _mm_movemask_epi8(chars) )
+            break;
+
+        if ( out )
+        {
+            // zero-extend the characters to the size of wchar_t
+            const __m128i lo = _mm_unpacklo_epi8(chars, zero),
+                          hi = _mm_unpackhi_epi8(chars, zero);
+            __m128i * const dst = reinterpret_cast<__m128i *>(out + n);
+#if SIZEOF_WCHAR_T == 2
+            _mm_storeu_si128(dst, lo);
+            _mm_storeu_si128(dst + 1, hi);
+#else // SIZEOF_WCHAR_T == 4
+            _mm_storeu_si128(dst, _mm_unpacklo_epi16(lo, zero));
+            _mm_storeu_si128(dst + 1, _mm_unpackhi_epi16(lo, zero));
+            _mm_storeu_si128(dst + 2, _mm_unpacklo_epi16(hi, zero));
+            _mm_storeu_si128(dst + 3, _mm_unpackhi_epi16(hi, zero));
+#endif // SIZEOF_WCHAR_T
+        }
+    }
+#else // !wxSTRCONV_USE_SSE2
+    // check as many characters as fit into a machine word at once
+    const size_t highBits = ((size_t)-1 / 0xFF) * 0x80;
+    for ( ; n + sizeof(size_t) <= srcLen; n += sizeof(size_t) )
+    {
+        size_t word;
+        memcpy(&word, src + n, sizeof(word));
+        if ( word & highBits )
+            break;
+
+        if ( out )
+        {
+            for ( size_t i = n; i < n + sizeof(size_t); i++ )
+                out[i] = src[i];
+        }
+    }
+#endif // wxSTRCONV_USE_SSE2/!wxSTRCONV_USE_SSE2
+
+    for ( ; n < srcLen && !(src[n] & 0x80); n++ )
+    {
+        if ( out )
+            out[n] = src[n];
+    }
+
+    return n;
+}
+
+// Same as above but for converting ASCII characters from wide string to UTF-8.
+static size_t ConvertASCII(char *out, const wchar_t *src, size_t srcLen)
+{
+    size_t n = 0;
+
+#ifdef wxSTRCONV_USE_SSE2
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i * const p = reinterpret_cast<const __m128i *>(src);
+
+#if SIZEOF_WCHAR_T == 2
+    const __m128i nonASCII = _mm_set1_epi16(~0x7F);
+    for ( size_t i = 0; n + 16 <= srcLen; n += 16, i += 2 )
+    {
+        const __m128i a = _mm_loadu_si128(p + i),
+                      b = _mm_loadu_si128(p + i + 1);
+
+        const __m128i bits = _mm_and_si128(_mm_or_si128(a, b), nonASCII);
+        if ( _mm_movemask_epi8(_mm_cmpeq_epi16(bits, zero)) != 0xFFFF )
+            break;
+
+        if ( out )
+            _mm_storeu_si128(reinterpret_cast<__m128i *>(out + n),
+                             _mm_packus_epi16(a, b));
+    }
+#else // SIZEOF_WCHAR_T == 4
+    const __m128i nonASCII = _mm_set1_epi32(~0x7F);
+    for ( size_t i = 0; n + 16 <= srcLen; n += 16, i += 4 )
+    {
+        const __m128i a = _mm_loadu_si128(p + i),
+                      b = _mm_loadu_si128(p + i + 1),
+                      c = _mm_loadu_si128(p + i + 2),
+                      d = _mm_loadu_si128(p + i + 3);
+
+        const __m128i bits = _mm_and_si128(_mm_or_si128(_mm_or_si128(a, b),
+                                                        _mm_or_si128(c, d)),
+                                           nonASCII);
+        if ( _mm_movemask_epi8(_mm_cmpeq_epi32(bits, zero)) != 0xFFFF )
+            break;
+
+        // all values fit into a byte, so saturation doesn't change them
+        if ( out )
+            _mm_storeu_si128(reinterpret_cast<__m128i *>(out + n),
+                             _mm_packus_epi16(_mm_packs_epi32(a, b),
+                                              _mm_packs_epi32(c, d)));
+    }
+#endif // SIZEOF_WCHAR_T
+#endif // wxSTRCONV_USE_SSE2
+
+    for ( ; n < srcLen && (wxUint32)src[n] < 0x80; n++ )
+    {
+        if ( out )
+            out[n] = (char)src[n];
+    }
+
+    return n;
+}
+
 size_t
 wxMBConvStrictUTF8::ToWChar(wchar_t *dst, size_t dstLen,
                             const char *src, size_t srcLen) const
@@ -991,95 +1120,86 @@ wxMBConvStrictUTF8::ToWChar(wchar_t *dst, size_t dstLen,
     if ( srcLen == wxNO_LEN )
         srcLen = strlen(src) + 1;
 
+    // notice that the trailing NUL, if any, is now part of the input and is
+    // converted as any other character
     for ( const char *p = src; ; p++ )
     {
-        if ( (srcLen == wxNO_LEN ? !*p : !srcLen) )
-        {
-            // all done successfully, just add the trailing NULL if we are not
-            // using explicit length
-            if ( srcLen == wxNO_LEN )
-            {
-                if ( out )
-                {
-                    if ( !dstLen )
-                        break;
-
-                    *out = L'\0';
-                }
-
-                written++;
-            }
-
+        if ( !srcLen )
             return written;
-        }
 
-        if ( out && !dstLen-- )
+        if ( out && !dstLen )
             break;
 
-        wxUint32 code;
         unsigned char c = *p;
 
+        // runs of ASCII characters are very common and are converted at once
         if ( c < 0x80 )
         {
-            if ( srcLen == 0 ) // the test works for wxNO_LEN too
-                break;
+            const size_t
+                len = ConvertASCII(out, p, out ? wxMin(srcLen, dstLen) : srcLen);
 
-            if ( srcLen != wxNO_LEN )
-                srcLen--;
+            if ( out )
+            {
+                out += len;
+                dstLen -= len;
+            }
 
-            code = c;
+            written += len;
+            srcLen -= len;
+            p += len - 1;
+            continue;
         }
-        else
-        {
-            unsigned len = tableUtf8Lengths[c];
-            if ( !len )
-                break;
 
-            if ( srcLen < len ) // the test works for wxNO_LEN too
-                break;
+        if ( out )
+            dstLen--;
 
-            if ( srcLen != wxNO_LEN )
-                srcLen -= len;
-
-            //   Char. number range   |        UTF-8 octet sequence
-            //      (hexadecimal)     |              (binary)
-            //  ----------------------+----------------------------------------
-            //  0000 0000 - 0000 007F | 0xxxxxxx
-            //  0000 0080 - 0000 07FF | 110xxxxx 10xxxxxx
-            //  0000 0800 - 0000 FFFF | 1110xxxx 10xxxxxx 10xxxxxx
-            //  0001 0000 - 0010 FFFF | 11110xxx 10xxxxxx 10xxxxxx 10xxxxxx
-            //
-            //  Code point value is stored in bits marked with 'x',
-            //  lowest-order bit of the value on the right side in the diagram
-            //  above.                                         (from RFC 3629)
-
-            // mask to extract lead byte's value ('x' bits above), by sequence
-            // length:
-            static const unsigned char leadValueMask[] = { 0x7F, 0x1F, 0x0F, 0x07 };
-
-            // mask and value of lead byte's most significant bits, by length:
-            static const unsigned char leadMarkerMask[] = { 0x80, 0xE0, 0xF0, 0xF8 };
-            static const unsigned char leadMarkerVal[] = { 0x00, 0xC0, 0xE0, 0xF0 };
-
-            len--; // it's more convenient to work with 0-based length here
-
-            // extract the lead byte's value bits:
-            if ( (c & leadMarkerMask[len]) != leadMarkerVal[len] )
-                break;
+        unsigned len = tableUtf8Lengths[c];
+        if ( !len )
+            break;
 
-            code = c & leadValueMask[len];
+        if ( srcLen < len )
+            break;
 
-            // all remaining bytes, if any, are handled in the same way
-            // regardless of sequence's length:
-            for ( ; len; --len )
-            {
-                c = *++p;
-                if ( (c & 0xC0) != 0x80 )
-                    return wxCONV_FAILED;
+        srcLen -= len;
 
-                code <<= 6;
-                code |= c & 0x3F;
-            }
+        //   Char. number range   |        UTF-8 octet sequence
+        //      (hexadecimal)     |              (binary)
+        //  ----------------------+----------------------------------------
+        //  0000 0000 - 0000 007F | 0xxxxxxx
+        //  0000 0080 - 0000 07FF | 110xxxxx 10xxxxxx
+        //  0000 0800 - 0000 FFFF | 1110xxxx 10xxxxxx 10xxxxxx
+        //  0001 0000 - 0010 FFFF | 11110xxx 10xxxxxx 10xxxxxx 10xxxxxx
+        //
+        //  Code point value is stored in bits marked with 'x',
+        //  lowest-order bit of the value on the right side in the diagram
+        //  above.                                         (from RFC 3629)
+
+        // mask to extract lead byte's value ('x' bits above), by sequence
+        // length:
+        static const unsigned char leadValueMask[] = { 0x7F, 0x1F, 0x0F, 0x07 };
+
+        // mask and value of lead byte's most significant bits, by length:
+        static const unsigned char leadMarkerMask[] = { 0x80, 0xE0, 0xF0, 0xF8 };
+        static const unsigned char leadMarkerVal[] = { 0x00, 0xC0, 0xE0, 0xF0 };
+
+        len--; // it's more convenient to work with 0-based length here
+
+        // extract the lead byte's value bits:
+        if ( (c & leadMarkerMask[len]) != leadMarkerVal[len] )
+            break;
+
+        wxUint32 code = c & leadValueMask[len];
+
+        // all remaining bytes, if any, are handled in the same way
+        // regardless of sequence's length:
+        for ( ; len; --len )
+        {
+            c = *++p;
+            if ( (c & 0xC0) != 0x80 )
+                return wxCONV_FAILED;
+
+            code <<= 6;
+            code |= c & 0x3F;
         }
 
 #ifdef WC_UTF16
@@ -1111,30 +1231,37 @@ wxMBConvStrictUTF8::FromWChar(char *dst, size_t dstLen,
     char *out = dstLen ? dst : NULL;
     size_t written = 0;
 
+    // as in ToWChar(), the trailing NUL is converted as any other character
+    if ( srcLen == wxNO_LEN )
+        srcLen = wxWcslen(src) + 1;
+
     for ( const wchar_t *wp = src; ; wp++ )
     {
-        if ( (srcLen == wxNO_LEN ? !*wp : !srcLen) )
+        if ( !srcLen )
+            return written;
+
+        // runs of ASCII characters are very common and are converted at once
+        if ( (wxUint32)*wp < 0x80 )
         {
-            // all done successfully, just add the trailing NULL if we are not
-            // using explicit length
-            if ( srcLen == wxNO_LEN )
-            {
-                if ( out )
-                {
-                    if ( !dstLen )
-                        break;
+            if ( out && !dstLen )
+                break;
 
-                    *out = '\0';
-                }
+            const size_t
+                len = ConvertASCII(out, wp, out ? wxMin(srcLen, dstLen) : srcLen);
 
-                written++;
+            if ( out )
+            {
+                out += len;
+                dstLen -= len;
             }
 
-            return written;
+            written += len;
+            srcLen -= len;
+            wp += len - 1;
+            continue;
         }
 
-        if ( srcLen != wxNO_LEN )
-            srcLen--;
+        srcLen--;
 
         wxUint32 code;
 #ifdef WC_UTF16
@@ -1143,8 +1270,7 @@ wxMBConvStrictUTF8::FromWChar(char *dst, size_t dstLen,
         {
             // skip the next char too as we decoded a surrogate
             wp++;
-            if ( srcLen != wxNO_LEN )
-                srcLen--;
+            srcLen--;
         }
 #else // wchar_t is UTF-32
         code = *wp & 0x7fffffff;
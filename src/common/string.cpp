@@ -114,6 +114,78 @@ static wxStrCacheInitializer gs_stringCacheInit;
 
 #endif // wxHAS_COMPILER_TLS/!wxHAS_COMPILER_TLS
 
+// the cache elements indices are allocated on the heap but, as the cache is a
+// thread-local POD without any dtor, nothing would free them when the thread
+// using them terminates, so use a Pthreads key destructor to do it
+//
+// notice that this is only done when using compiler TLS as otherwise the cache
+// itself is destroyed by another key destructor which could be called first
+// and only under Unix, where Pthreads are always used for threads, so the
+// indices are still leaked when the threads exit under the other platforms
+#if wxUSE_THREADS && defined(wxHAS_COMPILER_TLS) && defined(__UNIX__)
+    #define wxHAS_STRING_CACHE_INDEX_CLEANER
+#endif
+
+#ifdef wxHAS_STRING_CACHE_INDEX_CLEANER
+
+#include <pthread.h>
+
+extern "C"
+{
+static void wxStrCacheFreeIndices(void *data);
+}
+
+struct wxStrCacheIndexCleaner
+{
+    wxStrCacheIndexCleaner()
+    {
+        m_ok = pthread_key_create(&m_key, wxStrCacheFreeIndices) == 0;
+    }
+
+    ~wxStrCacheIndexCleaner()
+    {
+        if ( m_ok )
+        {
+            m_ok = false;
+            pthread_key_delete(m_key);
+        }
+    }
+
+    // must be called before allocating an index in the current thread
+    void OnIndexAlloc()
+    {
+        // notice that this can be called before this object is constructed,
+        // from ctors of other global objects, but then m_ok is still false
+        // and we don't need to do anything as we're in the main thread
+        if ( m_ok && !pthread_getspecific(m_key) )
+            pthread_setspecific(m_key, &wxString::GetCache());
+    }
+
+    static void FreeIndices(void *data)
+    {
+        wxString::Cache * const cache = static_cast<wxString::Cache *>(data);
+        for ( unsigned n = 0; n < wxString::Cache::SIZE; n++ )
+        {
+            wxString::Cache::Element& c = cache->cached[n];
+            if ( c.index )
+                c.FreeIndex();
+        }
+    }
+
+private:
+    pthread_key_t m_key;
+    bool m_ok;
+};
+
+static wxStrCacheIndexCleaner gs_stringCacheIndexCleaner;
+
+extern "C" void wxStrCacheFreeIndices(void *data)
+{
+    wxStrCacheIndexCleaner::FreeIndices(data);
+}
+
+#endif // wxHAS_STRING_CACHE_INDEX_CLEANER
+
 // gdb seems to be unable to display thread-local variables correctly, at least
 // not my 6.4.98 version under amd64, so provide this debugging helper to do it
 #if wxDEBUG_LEVEL >= 2
@@ -128,13 +200,14 @@ struct wxStrCacheDumper
             const wxString::Cache::Element&
                 c = wxString::GetCacheBegin()[n];
 
-            printf("\t%u%s\t%p: pos=(%lu, %lu), len=%ld\n",
+            printf("\t%u%s\t%p: pos=(%lu, %lu), len=%ld, index=%lu\n",
                    n,
                    n == wxString::LastUsedCacheElement() ? " [*]" : "",
                    c.str,
                    (unsigned long)c.pos,
                    (unsigned long)c.impl,
-                   (long)c.len);
+                   (long)c.len,
+                   (unsigned long)c.indexLen);
         }
     }
 };
@@ -180,6 +253,104 @@ static wxStrCacheStatsDumper s_showCacheStats;
 
 #endif // wxPROFILE_STRING_CACHE
 
+void wxString::Cache::Element::FreeIndex()
+{
+    free(index);
+    index = NULL;
+    indexAlloc =
+    indexLen = 0;
+}
+
+size_t wxString::DoPosToImplUsingIndex(Cache::Element *cache, size_t pos) const
+{
+    const size_t step = Cache::INDEX_STEP;
+
+    // start from the closest position before the requested one we know about:
+    // either the cached one or the one from the index
+    size_t startPos = 0,
+           startImpl = 0;
+    if ( cache->pos < pos )
+    {
+        startPos = cache->pos;
+        startImpl = cache->impl;
+    }
+    else
+    {
+        wxCACHE_PROFILE_FIELD_INC(mishits);
+    }
+
+    if ( cache->indexLen )
+    {
+        size_t n = pos / step;
+        if ( n >= cache->indexLen )
+            n = cache->indexLen - 1;
+
+        if ( n*step > startPos )
+        {
+            startPos = n*step;
+            startImpl = cache->index[n];
+        }
+    }
+
+    wxCACHE_PROFILE_FIELD_ADD(sumofs, pos - startPos);
+
+    // we can extend the index while advancing to the requested position if
+    // we start from a position before its end
+    size_t nextIndexed = cache->indexLen*step;
+    if ( startPos > nextIndexed )
+        nextIndexed = npos;
+
+    wxStringImpl::const_iterator i(m_impl.begin() + startImpl);
+    for ( size_t n = startPos; ; n++ )
+    {
+        if ( n == nextIndexed )
+        {
+            if ( cache->indexLen == cache->indexAlloc )
+            {
+#ifdef wxHAS_STRING_CACHE_INDEX_CLEANER
+                if ( !cache->index )
+                    gs_stringCacheIndexCleaner.OnIndexAlloc();
+#endif // wxHAS_STRING_CACHE_INDEX_CLEANER
+
+                const size_t
+                    alloc = cache->indexAlloc ? 2*cache->indexAlloc : 64;
+                size_t * const
+                    index = (size_t *)realloc(cache->index,
+                                              alloc*sizeof(size_t));
+                if ( !index )
+                {
+                    // this is not fatal, just stop extending the index
+                    nextIndexed = npos;
+                }
+                else
+                {
+                    cache->index = index;
+                    cache->indexAlloc = alloc;
+                }
+            }
+
+            if ( nextIndexed != npos )
+            {
+                cache->index[cache->indexLen++] = i - m_impl.begin();
+                nextIndexed += step;
+            }
+        }
+
+        if ( n == pos )
+            break;
+
+        wxStringOperations::IncIter(i);
+    }
+
+    cache->pos = pos;
+    cache->impl = i - m_impl.begin();
+
+    wxSTRING_CACHE_ASSERT(
+        (int)cache->impl == (begin() + pos).impl() - m_impl.begin() );
+
+    return cache->impl;
+}
+
 #endif // wxUSE_STRING_POS_CACHE
 
 // ----------------------------------------------------------------------------
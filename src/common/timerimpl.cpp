@@ -56,7 +56,7 @@ bool wxTimerImpl::Start(int milliseconds, bool oneShot)
     // under MSW timers only work when they're started from the main thread so
     // let the caller know about it
 #if wxUSE_THREADS
-    wxASSERT_MSG( wxThread::IsMain(),
+    wxASSERT_MSG( wxThread::IsMain() || CanStartInThisThread(),
                   wxT("timer can only be started from the main thread") );
 #endif // wxUSE_THREADS
 
@@ -53,6 +53,7 @@
 #include "wx/config.h"
 #include "wx/versioninfo.h"
 #include "wx/math.h"
+#include "wx/private/parallel.h"
 
 #if defined(__WXWINCE__) && wxUSE_DATETIME
     #include "wx/datetime.h"
@@ -1025,6 +1026,31 @@ unsigned int wxGCD(unsigned int u, unsigned int v)
     return u << shift;
 }
 
+// ----------------------------------------------------------------------------
+// wxRunParallelTask() support
+// ----------------------------------------------------------------------------
+
+#if wxUSE_THREADS
+
+namespace
+{
+
+int gs_parallelMinPerThread = 0;
+
+} // anonymous namespace
+
+void wxPrivate::wxSetParallelMinPerThread(int minPerThread)
+{
+    gs_parallelMinPerThread = minPerThread;
+}
+
+int wxPrivate::wxGetParallelMinPerThread()
+{
+    return gs_parallelMinPerThread;
+}
+
+#endif // wxUSE_THREADS
+
 #endif // wxUSE_BASE
 
 // ============================================================================
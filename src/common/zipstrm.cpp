@@ -135,6 +135,22 @@ static wxFileOffset QuietSeek(wxInputStream& stream, wxFileOffset pos)
 #endif
 }
 
+// Return the general purpose flags describing the given deflate level
+//
+static int DeflateFlags(int level)
+{
+    switch (level) {
+        case 0: case 1:
+            return wxZIP_DEFLATE_SUPERFAST;
+        case 2: case 3: case 4:
+            return wxZIP_DEFLATE_FAST;
+        case 8: case 9:
+            return wxZIP_DEFLATE_EXTRA;
+    }
+
+    return wxZIP_DEFLATE_NORMAL;
+}
+
 
 /////////////////////////////////////////////////////////////////////////////
 // Class factory
@@ -1340,6 +1356,9 @@ void wxZipInputStream::Init()
     m_position = wxInvalidOffset;
     m_signature = 0;
     m_TotalEntries = 0;
+    m_centralDir = NULL;
+    m_centralDirPos = 0;
+    m_centralDirSize = 0;
     m_lasterror = m_parent_i_stream->GetLastError();
 }
 
@@ -1347,6 +1366,7 @@ wxZipInputStream::~wxZipInputStream()
 {
     CloseDecompressor(m_decomp);
 
+    delete m_centralDir;
     delete m_store;
     delete m_inflate;
     delete m_rawin;
@@ -1395,9 +1415,33 @@ wxZipStreamLink *wxZipInputStream::MakeLink(wxZipOutputStream *out)
 bool wxZipInputStream::LoadEndRecord()
 {
     wxCHECK(m_position == wxInvalidOffset, false);
+
+    // An entry of a seekable stream can be opened before the end record is
+    // loaded (see DoOpen), in which case the position in it must be kept.
+    if (!AtHeader()) {
+        wxStreamError lasterror = m_lasterror;
+        wxFileOffset pos = m_parent_i_stream->TellI();
+        m_lasterror = wxSTREAM_NO_ERROR;
+
+        if (!DoLoadEndRecord())
+            return false;
+        if (QuietSeek(*m_parent_i_stream, pos) == wxInvalidOffset) {
+            m_lasterror = wxSTREAM_READ_ERROR;
+            return false;
+        }
+
+        m_lasterror = lasterror;
+        return true;
+    }
+
     if (!IsOk())
         return false;
 
+    return DoLoadEndRecord();
+}
+
+bool wxZipInputStream::DoLoadEndRecord()
+{
     m_position = 0;
 
     // First find the end-of-central-directory record.
@@ -1427,15 +1471,26 @@ bool wxZipInputStream::LoadEndRecord()
     m_TotalEntries = endrec.GetTotalEntries();
     m_Comment = endrec.GetComment();
 
+    // The central directory is read into memory at once by LoadCentralDir(),
+    // so don't trust a size which can't be right as it would allocate up to
+    // 4GB for a corrupted zip: the directory must precede the end record.
+    if (endrec.GetSize() > endPos) {
+        wxLogError(_("invalid zip file"));
+        m_lasterror = wxSTREAM_READ_ERROR;
+        return false;
+    }
+
     wxUint32 magic = m_TotalEntries ? CENTRAL_MAGIC : END_MAGIC;
 
     // Now find the central-directory. we have the file offset of
     // the CD, so look there first.
-    if (m_parent_i_stream->SeekI(endrec.GetOffset()) != wxInvalidOffset &&
+    if (endrec.GetOffset() + endrec.GetSize() <= endPos &&
+            m_parent_i_stream->SeekI(endrec.GetOffset()) != wxInvalidOffset &&
             ReadSignature() == magic) {
         m_signature = magic;
         m_position = endrec.GetOffset();
         m_offsetAdjustment = 0;
+        m_centralDirSize = endrec.GetSize();
         return true;
     }
 
@@ -1447,6 +1502,7 @@ bool wxZipInputStream::LoadEndRecord()
         m_signature = magic;
         m_position = endPos - endrec.GetSize();
         m_offsetAdjustment = m_position - endrec.GetOffset();
+        m_centralDirSize = endrec.GetSize();
         return true;
     }
 
@@ -1455,6 +1511,31 @@ bool wxZipInputStream::LoadEndRecord()
     return false;
 }
 
+// Read the whole central directory, starting at m_position, into memory so
+// that its entries can be parsed without seeking the parent stream and
+// reading it in small pieces for each of them. The end record signature
+// following the directory is read too. If this fails, the entries are just
+// read from the parent stream directly.
+//
+void wxZipInputStream::LoadCentralDir()
+{
+    const wxFileOffset size = m_centralDirSize;
+
+    // only try to do it once
+    m_centralDirSize = 0;
+
+    if (QuietSeek(*m_parent_i_stream, m_position) == wxInvalidOffset)
+        return;
+
+    wxScopedPtr<wxMemoryInputStream>
+        centralDir(new wxMemoryInputStream(*m_parent_i_stream, size + 4));
+    if (centralDir->GetLength() != size + 4)
+        return;
+
+    m_centralDir = centralDir.release();
+    m_centralDirPos = m_position;
+}
+
 // Find the end-of-central-directory record.
 // If found the stream will be positioned just past the 4 signature bytes.
 //
@@ -1540,17 +1621,30 @@ wxStreamError wxZipInputStream::ReadCentral()
         return wxSTREAM_READ_ERROR;
     }
 
-    if (QuietSeek(*m_parent_i_stream, m_position + 4) == wxInvalidOffset)
+    // the central directory is only loaded when its entries are read for the
+    // first time as it is not needed for opening the entries already known
+    if (m_centralDirSize > 0)
+        LoadCentralDir();
+
+    // read from the in-memory copy of the central directory if we have it
+    wxInputStream& stream = m_centralDir ? *m_centralDir : *m_parent_i_stream;
+    const wxFileOffset pos = m_centralDir ? m_position - m_centralDirPos
+                                          : m_position;
+
+    if (QuietSeek(stream, pos + 4) == wxInvalidOffset)
         return wxSTREAM_READ_ERROR;
 
-    size_t size = m_entry.ReadCentral(*m_parent_i_stream, GetConv());
+    size_t size = m_entry.ReadCentral(stream, GetConv());
     if (!size) {
         m_signature = 0;
         return wxSTREAM_READ_ERROR;
     }
 
     m_position += size;
-    m_signature = ReadSignature();
+
+    char magic[4];
+    stream.Read(magic, 4);
+    m_signature = stream.LastRead() == 4 ? CrackUint32(magic) : 0;
 
     if (m_offsetAdjustment)
         m_entry.SetOffset(m_entry.GetOffset() + m_offsetAdjustment);
@@ -1648,9 +1742,14 @@ bool wxZipInputStream::OpenEntry(wxArchiveEntry& entry)
 //
 bool wxZipInputStream::DoOpen(wxZipEntry *entry, bool raw)
 {
-    if (m_position == wxInvalidOffset)
-        if (!LoadEndRecord())
+    if (m_position == wxInvalidOffset) {
+        // the offset of the given entry is already known, so there is no need
+        // to look for the end record of a seekable stream just to open it
+        if (entry && m_parent_i_stream->IsSeekable())
+            m_parentSeekable = true;
+        else if (!LoadEndRecord())
             return false;
+    }
     if (m_lasterror == wxSTREAM_READ_ERROR)
         return false;
     if (IsOpened())
@@ -1891,6 +1990,8 @@ void wxZipOutputStream::Init(int level)
     m_entrySize = 0;
     m_comp = NULL;
     m_level = level;
+    m_threads = 1;
+    m_blockSize = 0;
     m_offsetAdjustment = wxInvalidOffset;
     m_endrecWritten = false;
 }
@@ -2022,6 +2123,56 @@ bool wxZipOutputStream::DoCreate(wxZipEntry *entry, bool raw /*=false*/)
     return true;
 }
 
+// Compress the data of an entry into a memory buffer, as this doesn't depend
+// on the state of any stream it can be used for compressing several entries
+// concurrently and then writing them out with PutNextRawEntry().
+//
+/* static */
+bool wxZipOutputStream::CompressEntry(wxZipEntry& entry,
+                                      const void *data,
+                                      size_t size,
+                                      wxMemoryBuffer& buf,
+                                      int level /*=-1*/)
+{
+    const int method = entry.GetMethod();
+    wxCHECK_MSG(method == wxZIP_METHOD_DEFAULT ||
+                method == wxZIP_METHOD_DEFLATE ||
+                method == wxZIP_METHOD_STORE, false,
+                wxT("unsupported Zip compression method"));
+
+    buf.Clear();
+
+    entry.SetSize(size);
+    entry.SetCrc(crc32(crc32(0, Z_NULL, 0), (const Byte*)data, size));
+
+    if (method != wxZIP_METHOD_STORE && level != 0) {
+        wxMemoryOutputStream mem;
+        wxZlibOutputStream deflate(mem, level, wxZLIB_NO_HEADER);
+
+        if (!deflate.Write(data, size).IsOk() || !deflate.Close())
+            return false;
+
+        // store the data uncompressed if the compressor makes it larger
+        const size_t len = mem.GetSize();
+        if (len < size) {
+            mem.CopyTo(buf.GetWriteBuf(len), len);
+            buf.UngetWriteBuf(len);
+
+            entry.SetMethod(wxZIP_METHOD_DEFLATE);
+            entry.SetFlags((entry.GetFlags() & ~wxZIP_DEFLATE_MASK) |
+                            DeflateFlags(level));
+            entry.SetCompressedSize(len);
+            return true;
+        }
+    }
+
+    buf.AppendData(data, size);
+
+    entry.SetMethod(wxZIP_METHOD_STORE);
+    entry.SetCompressedSize(size);
+    return true;
+}
+
 // Can be overridden to add support for additional compression methods
 //
 wxOutputStream *wxZipOutputStream::OpenCompressor(
@@ -2052,26 +2203,16 @@ wxOutputStream *wxZipOutputStream::OpenCompressor(
 
         case wxZIP_METHOD_DEFLATE:
         {
-            int defbits = wxZIP_DEFLATE_NORMAL;
-            switch (GetLevel()) {
-                case 0: case 1:
-                    defbits = wxZIP_DEFLATE_SUPERFAST;
-                    break;
-                case 2: case 3: case 4:
-                    defbits = wxZIP_DEFLATE_FAST;
-                    break;
-                case 8: case 9:
-                    defbits = wxZIP_DEFLATE_EXTRA;
-                    break;
-            }
             entry.SetFlags((entry.GetFlags() & ~wxZIP_DEFLATE_MASK) |
-                            defbits | wxZIP_SUMS_FOLLOW);
+                            DeflateFlags(GetLevel()) | wxZIP_SUMS_FOLLOW);
 
             if (!m_deflate)
                 m_deflate = new wxZlibOutputStream2(stream, GetLevel());
             else
                 m_deflate->Open(stream);
 
+            m_deflate->SetThreads(m_threads, m_blockSize);
+
             return m_deflate;
         }
 
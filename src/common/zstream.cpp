@@ -19,6 +19,7 @@
 
 #include "wx/zstream.h"
 #include "wx/versioninfo.h"
+#include "wx/private/parallel.h"
 
 #ifndef WX_PRECOMP
     #include "wx/intl.h"
@@ -40,7 +41,9 @@
 enum {
     ZSTREAM_BUFFER_SIZE = 16384,
     ZSTREAM_GZIP        = 0x10,     // gzip header
-    ZSTREAM_AUTO        = 0x20      // auto detect between gzip and zlib
+    ZSTREAM_AUTO        = 0x20,     // auto detect between gzip and zlib
+    ZSTREAM_WINDOW_SIZE = 32768,    // maximal distance of deflate matches
+    ZSTREAM_BLOCK_SIZE  = 131072    // default size of parallel blocks
 };
 
 
@@ -277,6 +280,377 @@ bool wxZlibInputStream::SetDictionary(const wxMemoryBuffer &buf)
 }
 
 
+////////////////////////////
+// wxZlibParallelCompressor
+////////////////////////////
+
+// Compresses the data in blocks which are deflated by several threads at
+// once. Each block is primed with the data preceding it as dictionary, so the
+// compression ratio is almost the same as when compressing all the data at
+// once, and all blocks except the last one end with a sync flush, which makes
+// the concatenation of the compressed blocks a single valid deflate stream.
+//
+// Because each block is compressed by its own raw deflate stream, the zlib or
+// gzip header and trailer, if any, are written by this class itself.
+
+class wxZlibParallelCompressor : public wxParallelTask
+{
+public:
+    wxZlibParallelCompressor(int level, int flags, int threads,
+                             size_t blockSize);
+    virtual ~wxZlibParallelCompressor();
+
+    int GetThreads() const          { return m_maxBlocks; }
+    size_t GetBlockSize() const     { return m_blockSize; }
+
+    // Get ready for compressing a new stream.
+    void Reset();
+
+    bool SetDictionary(const char *data, size_t datalen);
+
+    // Append the data to the current batch of blocks, compressing the batch
+    // and writing it to the given stream whenever it becomes full.
+    bool Write(const char *data, size_t size, wxOutputStream& out);
+
+    // Compress and write out all the data written so far, if final is true
+    // also terminate the stream: nothing can be written to it after this
+    // until Reset() is called.
+    bool Flush(bool final, wxOutputStream& out);
+
+    virtual void ProcessRange(int first, int last) wxOVERRIDE;
+
+private:
+    struct Block
+    {
+        Block() : m_deflate(NULL), m_err(Z_OK) { }
+
+        z_stream_s *m_deflate;
+        wxMemoryBuffer m_output;
+        int m_err;
+    };
+
+    void CompressBlock(int n);
+    bool WriteHeader(wxOutputStream& out);
+    bool WriteTrailer(wxOutputStream& out);
+
+    const int m_level;
+    const int m_flags;
+    const size_t m_blockSize;
+    const int m_maxBlocks;
+
+    Block *m_blocks;
+
+    // The input buffer starts with ZSTREAM_WINDOW_SIZE bytes of which only the
+    // last m_historyLen are used for the data preceding the current batch and
+    // is followed by m_inputLen bytes of the batch itself.
+    char *m_input;
+    size_t m_historyLen;
+    size_t m_inputLen;
+
+    // The number of blocks in the batch being compressed and whether the last
+    // of them terminates the stream.
+    int m_numBlocks;
+    bool m_final;
+
+    // True after the end of the stream has been written and until Reset().
+    bool m_finished;
+
+    bool m_headerWritten;
+    bool m_hasDictionary;
+    uLong m_dictId;
+    uLong m_check;
+    uLong m_totalLen;
+
+    wxDECLARE_NO_COPY_CLASS(wxZlibParallelCompressor);
+};
+
+wxZlibParallelCompressor::wxZlibParallelCompressor(int level,
+                                                   int flags,
+                                                   int threads,
+                                                   size_t blockSize)
+    : m_level(level),
+      m_flags(flags),
+      m_blockSize(blockSize),
+      m_maxBlocks(threads)
+{
+    m_blocks = new Block[m_maxBlocks];
+    m_input = new char[ZSTREAM_WINDOW_SIZE + m_maxBlocks * m_blockSize];
+
+    Reset();
+}
+
+wxZlibParallelCompressor::~wxZlibParallelCompressor()
+{
+    for (int n = 0; n < m_maxBlocks; n++) {
+        if (m_blocks[n].m_deflate) {
+            deflateEnd(m_blocks[n].m_deflate);
+            delete m_blocks[n].m_deflate;
+        }
+    }
+
+    delete [] m_blocks;
+    delete [] m_input;
+}
+
+void wxZlibParallelCompressor::Reset()
+{
+    m_historyLen = 0;
+    m_inputLen = 0;
+    m_numBlocks = 0;
+    m_final = false;
+    m_finished = false;
+    m_headerWritten = false;
+    m_hasDictionary = false;
+    m_dictId = 0;
+    m_check = m_flags == wxZLIB_GZIP ? crc32(0, Z_NULL, 0)
+                                     : adler32(0, Z_NULL, 0);
+    m_totalLen = 0;
+}
+
+bool wxZlibParallelCompressor::SetDictionary(const char *data, size_t datalen)
+{
+    // zlib doesn't support dictionaries for gzip streams either
+    if (m_flags == wxZLIB_GZIP || m_finished || m_headerWritten || m_inputLen)
+        return false;
+
+    // only the end of the dictionary can be used by deflate anyhow
+    m_historyLen = wxMin(datalen, (size_t)ZSTREAM_WINDOW_SIZE);
+    memcpy(m_input + ZSTREAM_WINDOW_SIZE - m_historyLen,
+           data + datalen - m_historyLen, m_historyLen);
+
+    m_hasDictionary = true;
+    m_dictId = adler32(adler32(0, Z_NULL, 0), (const Bytef*)data, datalen);
+    return true;
+}
+
+bool wxZlibParallelCompressor::Write(const char *data,
+                                     size_t size,
+                                     wxOutputStream& out)
+{
+    if (m_finished)
+        return false;
+
+    const size_t capacity = m_maxBlocks * m_blockSize;
+
+    while (size) {
+        // only compress a full batch when there is more data to add to the
+        // stream, as the last batch must be compressed differently
+        if (m_inputLen == capacity && !Flush(false, out))
+            return false;
+
+        const size_t len = wxMin(size, capacity - m_inputLen);
+        memcpy(m_input + ZSTREAM_WINDOW_SIZE + m_inputLen, data, len);
+
+        if (m_flags == wxZLIB_ZLIB)
+            m_check = adler32(m_check, (const Bytef*)data, len);
+        else if (m_flags == wxZLIB_GZIP)
+            m_check = crc32(m_check, (const Bytef*)data, len);
+
+        m_totalLen += len;
+        m_inputLen += len;
+        data += len;
+        size -= len;
+    }
+
+    return true;
+}
+
+bool wxZlibParallelCompressor::Flush(bool final, wxOutputStream& out)
+{
+    if (m_finished)
+        return true;
+
+    m_numBlocks = (m_inputLen + m_blockSize - 1) / m_blockSize;
+    m_final = final;
+
+    // the last block must be compressed even if it's empty to end the stream
+    if (final && !m_numBlocks)
+        m_numBlocks = 1;
+
+    wxRunParallelTask(*this, m_numBlocks, 1);
+
+    bool ok = m_numBlocks == 0 || m_headerWritten || WriteHeader(out);
+
+    for (int n = 0; ok && n < m_numBlocks; n++) {
+        const Block& block = m_blocks[n];
+
+        if (block.m_err != Z_OK) {
+            if (block.m_deflate) {
+                wxString msg(block.m_deflate->msg, *wxConvCurrent);
+                if (!msg)
+                    msg = wxString::Format(_("zlib error %d"), block.m_err);
+                wxLogError(_("Can't write to deflate stream: %s"),
+                           msg.c_str());
+            } else {
+                wxLogError(_("Can't initialize zlib deflate stream."));
+            }
+            ok = false;
+            break;
+        }
+
+        const size_t len = block.m_output.GetDataLen();
+        if (out.Write(block.m_output.GetData(), len).LastWrite() != len) {
+            wxLogDebug(wxT("wxZlibOutputStream: Error writing to underlying stream"));
+            ok = false;
+        }
+    }
+
+    if (final) {
+        if (ok)
+            ok = WriteTrailer(out);
+        Reset();
+        m_finished = true;
+        return ok;
+    }
+
+    // keep the end of the data as dictionary for the next batch
+    const size_t historyLen = wxMin(m_historyLen + m_inputLen,
+                                    (size_t)ZSTREAM_WINDOW_SIZE);
+    memmove(m_input + ZSTREAM_WINDOW_SIZE - historyLen,
+            m_input + ZSTREAM_WINDOW_SIZE + m_inputLen - historyLen,
+            historyLen);
+    m_historyLen = historyLen;
+    m_inputLen = 0;
+
+    return ok;
+}
+
+void wxZlibParallelCompressor::ProcessRange(int first, int last)
+{
+    for (int n = first; n < last; n++)
+        CompressBlock(n);
+}
+
+void wxZlibParallelCompressor::CompressBlock(int n)
+{
+    Block& block = m_blocks[n];
+    block.m_output.Clear();
+
+    if (!block.m_deflate) {
+        z_stream_s *z = new z_stream_s;
+        memset(z, 0, sizeof(z_stream_s));
+
+        block.m_err = deflateInit2(z, m_level, Z_DEFLATED, -MAX_WBITS,
+                                   8, Z_DEFAULT_STRATEGY);
+        if (block.m_err != Z_OK) {
+            delete z;
+            return;
+        }
+
+        block.m_deflate = z;
+    } else {
+        block.m_err = deflateReset(block.m_deflate);
+        if (block.m_err != Z_OK)
+            return;
+    }
+
+    z_stream_s * const z = block.m_deflate;
+
+    const size_t offset = n * m_blockSize;
+    Bytef * const start = (Bytef*)m_input + ZSTREAM_WINDOW_SIZE + offset;
+    const size_t len = wxMin(m_blockSize, m_inputLen - offset);
+
+    // prime the compressor with the data preceding this block
+    const size_t dictLen = wxMin(m_historyLen + offset,
+                                 (size_t)ZSTREAM_WINDOW_SIZE);
+    if (dictLen) {
+        block.m_err = deflateSetDictionary(z, start - dictLen, dictLen);
+        if (block.m_err != Z_OK)
+            return;
+    }
+
+    const int flush = m_final && n == m_numBlocks - 1 ? Z_FINISH
+                                                       : Z_SYNC_FLUSH;
+
+    z->next_in = start;
+    z->avail_in = len;
+
+    // this is normally enough for compressing the entire block in one go,
+    // the extra bytes are for the empty stored block added by sync flush
+    const size_t outLen = deflateBound(z, len) + 16;
+
+    for (;;) {
+        z->next_out = (Bytef*)block.m_output.GetAppendBuf(outLen);
+        z->avail_out = outLen;
+
+        int err = deflate(z, flush);
+        block.m_output.UngetAppendBuf(outLen - z->avail_out);
+
+        if (err == Z_STREAM_END)
+            break;
+
+        if (flush == Z_SYNC_FLUSH && z->avail_in == 0) {
+            // Z_BUF_ERROR just means that everything was already flushed
+            if (err == Z_BUF_ERROR || (err == Z_OK && z->avail_out != 0))
+                break;
+        }
+
+        if (err != Z_OK) {
+            block.m_err = err;
+            return;
+        }
+    }
+
+    block.m_err = Z_OK;
+}
+
+bool wxZlibParallelCompressor::WriteHeader(wxOutputStream& out)
+{
+    m_headerWritten = true;
+
+    unsigned char header[10];
+    size_t len = 0;
+
+    const int level = m_level == Z_DEFAULT_COMPRESSION ? 6 : m_level;
+
+    if (m_flags == wxZLIB_ZLIB) {
+        // see RFC 1950, the values are the same as used by zlib itself
+        const int flevel = level < 2 ? 0 : level < 6 ? 1 : level == 6 ? 2 : 3;
+        int flg = (flevel << 6) | (m_hasDictionary ? 0x20 : 0);
+        flg += 31 - (0x7800 + flg) % 31;
+
+        header[len++] = 0x78;
+        header[len++] = (unsigned char)flg;
+
+        if (m_hasDictionary) {
+            header[len++] = (unsigned char)(m_dictId >> 24);
+            header[len++] = (unsigned char)(m_dictId >> 16);
+            header[len++] = (unsigned char)(m_dictId >> 8);
+            header[len++] = (unsigned char)m_dictId;
+        }
+    } else if (m_flags == wxZLIB_GZIP) {
+        // see RFC 1952, no file name nor modification time is stored
+        static const unsigned char gzipHeader[] =
+            { 0x1f, 0x8b, Z_DEFLATED, 0, 0, 0, 0, 0, 0, 0xff };
+        memcpy(header, gzipHeader, sizeof(gzipHeader));
+        header[8] = level == 9 ? 2 : level < 2 ? 4 : 0;
+        len = sizeof(gzipHeader);
+    }
+
+    return out.Write(header, len).LastWrite() == len;
+}
+
+bool wxZlibParallelCompressor::WriteTrailer(wxOutputStream& out)
+{
+    unsigned char trailer[8];
+    size_t len = 0;
+
+    if (m_flags == wxZLIB_ZLIB) {
+        trailer[len++] = (unsigned char)(m_check >> 24);
+        trailer[len++] = (unsigned char)(m_check >> 16);
+        trailer[len++] = (unsigned char)(m_check >> 8);
+        trailer[len++] = (unsigned char)m_check;
+    } else if (m_flags == wxZLIB_GZIP) {
+        for (int i = 0; i < 4; i++)
+            trailer[len++] = (unsigned char)(m_check >> (8*i));
+        for (int i = 0; i < 4; i++)
+            trailer[len++] = (unsigned char)(m_totalLen >> (8*i));
+    }
+
+    return out.Write(trailer, len).LastWrite() == len;
+}
+
+
 //////////////////////
 // wxZlibOutputStream
 //////////////////////
@@ -303,6 +677,7 @@ void wxZlibOutputStream::Init(int level, int flags)
   m_z_buffer = new unsigned char[ZSTREAM_BUFFER_SIZE];
   m_z_size = ZSTREAM_BUFFER_SIZE;
   m_pos = 0;
+  m_parallel = NULL;
 
   if ( level == -1 )
   {
@@ -313,6 +688,9 @@ void wxZlibOutputStream::Init(int level, int flags)
     wxASSERT_MSG(level >= 0 && level <= 9, wxT("wxZlibOutputStream compression level must be between 0 and 9!"));
   }
 
+  m_level = level;
+  m_flags = flags;
+
   // if gzip is asked for but not supported...
   if (flags == wxZLIB_GZIP && !CanHandleGZip()) {
     wxLogError(_("Gzip not supported by this version of zlib"));
@@ -353,6 +731,7 @@ bool wxZlibOutputStream::Close()
    deflateEnd(m_deflate);
    wxDELETE(m_deflate);
    wxDELETEA(m_z_buffer);
+   wxDELETE(m_parallel);
 
   return wxFilterOutputStream::Close() && IsOk();
  }
@@ -364,6 +743,12 @@ void wxZlibOutputStream::DoFlush(bool final)
   if (!IsOk())
     return;
 
+  if (m_parallel) {
+    if (!m_parallel->Flush(final, *m_parent_o_stream))
+      m_lasterror = wxSTREAM_WRITE_ERROR;
+    return;
+  }
+
   int err = Z_OK;
   bool done = false;
 
@@ -399,6 +784,16 @@ size_t wxZlibOutputStream::OnSysWrite(const void *buffer, size_t size)
   if (!IsOk() || !size)
     return 0;
 
+  if (m_parallel) {
+    if (!m_parallel->Write((const char *)buffer, size, *m_parent_o_stream)) {
+      m_lasterror = wxSTREAM_WRITE_ERROR;
+      return 0;
+    }
+
+    m_pos += size;
+    return size;
+  }
+
   int err = Z_OK;
   m_deflate->next_in = (unsigned char *)buffer;
   m_deflate->avail_in = size;
@@ -439,6 +834,9 @@ size_t wxZlibOutputStream::OnSysWrite(const void *buffer, size_t size)
 
 bool wxZlibOutputStream::SetDictionary(const char *data, const size_t datalen)
 {
+    if (m_parallel)
+        return m_parallel->SetDictionary(data, datalen);
+
     return (deflateSetDictionary(m_deflate, (Bytef*)data, datalen) == Z_OK);
 }
 
@@ -447,5 +845,46 @@ bool wxZlibOutputStream::SetDictionary(const wxMemoryBuffer &buf)
     return SetDictionary((char*)buf.GetData(), buf.GetDataLen());
 }
 
+bool wxZlibOutputStream::SetThreads(int threads, size_t blockSize)
+{
+    wxCHECK_MSG(m_pos == 0, false,
+                wxT("must be called before writing any data"));
+
+    if (!m_deflate)
+        return false;
+
+#if wxUSE_THREADS
+    if (threads == 0)
+        threads = wxPrivate::wxGetParallelThreadsCount();
+#else
+    threads = 1;
+#endif
+
+    if (!blockSize)
+        blockSize = ZSTREAM_BLOCK_SIZE;
+
+    if (threads <= 1) {
+        wxDELETE(m_parallel);
+        return true;
+    }
+
+    // reuse the existing compressor, and its deflate streams, if possible
+    if (m_parallel && m_parallel->GetThreads() == threads
+                   && m_parallel->GetBlockSize() == blockSize) {
+        m_parallel->Reset();
+        return true;
+    }
+
+    delete m_parallel;
+    m_parallel = new wxZlibParallelCompressor(m_level, m_flags,
+                                              threads, blockSize);
+    return true;
+}
+
+int wxZlibOutputStream::GetThreads() const
+{
+    return m_parallel ? m_parallel->GetThreads() : 1;
+}
+
 #endif
   // wxUSE_ZLIB && wxUSE_STREAMS
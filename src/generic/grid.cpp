@@ -53,12 +53,21 @@
 #include "wx/generic/gridctrl.h"
 #include "wx/generic/grideditors.h"
 #include "wx/generic/private/grid.h"
+#include "wx/private/parallel.h"
+
+#if wxUSE_GRAPHICS_CONTEXT
+    #include "wx/graphics.h"
+#endif
 
 const char wxGridNameStr[] = "grid";
 
 // Required for wxIs... functions
 #include <ctype.h>
 
+#include <algorithm>
+#include <functional>
+#include <utility>
+
 WX_DECLARE_HASH_SET_WITH_DECL_PTR(int, wxIntegerHash, wxIntegerEqual,
                                   wxGridFixedIndicesSet, class WXDLLIMPEXP_ADV);
 
@@ -116,7 +125,6 @@ const int DRAG_SENSITIVITY = 3;
 #include "wx/arrimpl.cpp"
 
 WX_DEFINE_OBJARRAY(wxGridCellCoordsArray)
-WX_DEFINE_OBJARRAY(wxGridCellWithAttrArray)
 
 // ----------------------------------------------------------------------------
 // events
@@ -596,134 +604,240 @@ wxGridCellEditor* wxGridCellAttr::GetEditor(const wxGrid* grid, int row, int col
 }
 
 // ----------------------------------------------------------------------------
-// wxGridCellAttrData
+// wxGridCellAttrIds
 // ----------------------------------------------------------------------------
 
-void wxGridCellAttrData::SetAttr(wxGridCellAttr *attr, int row, int col)
+int wxGridCellAttrIds::GetOrCreate(int rowOrCol)
 {
-    // Note: contrary to wxGridRowOrColAttrData::SetAttr, we must not
-    //       touch attribute's reference counting explicitly, since this
-    //       is managed by class wxGridCellWithAttr
-    int n = FindIndex(row, col);
-    if ( n == wxNOT_FOUND )
-    {
-        if ( attr )
-        {
-            // add the attribute
-            m_attrs.Add(new wxGridCellWithAttr(row, col, attr));
-        }
-        //else: nothing to do
-    }
-    else // we already have an attribute for this cell
+    if ( (size_t)rowOrCol >= m_ids.size() )
+        m_ids.resize(rowOrCol + 1, NO_ID);
+
+    int& id = m_ids[rowOrCol];
+    if ( id == NO_ID )
     {
-        if ( attr )
+        if ( m_freeIds.empty() )
         {
-            // change the attribute
-            m_attrs[(size_t)n].ChangeAttr(attr);
+            id = m_uses.size();
+            m_uses.push_back(0);
         }
         else
         {
-            // remove this attribute
-            m_attrs.RemoveAt((size_t)n);
+            id = m_freeIds.back();
+            m_freeIds.pop_back();
         }
     }
+
+    return id;
 }
 
-wxGridCellAttr *wxGridCellAttrData::GetAttr(int row, int col) const
+void wxGridCellAttrIds::FreeId(int id)
 {
-    wxGridCellAttr *attr = NULL;
-
-    int n = FindIndex(row, col);
-    if ( n != wxNOT_FOUND )
-    {
-        attr = m_attrs[(size_t)n].attr;
-        attr->IncRef();
-    }
-
-    return attr;
+    m_uses[id] = 0;
+    m_freeIds.push_back(id);
 }
 
-void wxGridCellAttrData::UpdateAttrRows( size_t pos, int numRows )
+void wxGridCellAttrIds::UpdateAttrRowsOrCols( size_t pos, int numRowsOrCols,
+                                              wxVector<int>& deletedIds )
 {
-    size_t count = m_attrs.GetCount();
-    for ( size_t n = 0; n < count; n++ )
+    const size_t count = m_ids.size();
+    if ( pos >= count )
+        return;
+
+    if ( numRowsOrCols > 0 )
+    {
+        // shift the ids of the rows or columns after the inserted ones
+        m_ids.resize(count + numRowsOrCols);
+        for ( size_t n = count; n-- > pos; )
+            m_ids[n + numRowsOrCols] = m_ids[n];
+        for ( size_t n = pos; n < pos + numRowsOrCols; n++ )
+            m_ids[n] = NO_ID;
+    }
+    else if ( numRowsOrCols < 0 )
     {
-        wxGridCellCoords& coords = m_attrs[n].coords;
-        wxCoord row = coords.GetRow();
-        if ((size_t)row >= pos)
+        const size_t end = wxMin(pos - numRowsOrCols, count);
+        for ( size_t n = pos; n < end; n++ )
         {
-            if (numRows > 0)
+            const int id = m_ids[n];
+            if ( id == NO_ID )
+                continue;
+
+            // the ids not used by any cells can be reused immediately, the
+            // others only once the cells using them are removed
+            if ( IsUsed(id) )
             {
-                // If rows inserted, include row counter where necessary
-                coords.SetRow(row + numRows);
+                m_uses[id] = DELETED;
+                deletedIds.push_back(id);
             }
-            else if (numRows < 0)
+            else
             {
-                // If rows deleted ...
-                if ((size_t)row >= pos - numRows)
-                {
-                    // ...either decrement row counter (if row still exists)...
-                    coords.SetRow(row + numRows);
-                }
-                else
-                {
-                    // ...or remove the attribute
-                    m_attrs.RemoveAt(n);
-                    n--;
-                    count--;
-                }
+                FreeId(id);
             }
         }
+
+        m_ids.erase(m_ids.begin() + pos, m_ids.begin() + end);
+    }
+}
+
+// ----------------------------------------------------------------------------
+// wxGridCellAttrData
+// ----------------------------------------------------------------------------
+
+wxGridCellAttrData::~wxGridCellAttrData()
+{
+    for ( wxGridCellAttrHash::iterator it = m_attrs.begin();
+          it != m_attrs.end();
+          ++it )
+    {
+        it->second->DecRef();
+    }
+}
+
+void wxGridCellAttrData::SetAttr(wxGridCellAttr *attr, int row, int col)
+{
+    // Note: contrary to wxGridRowOrColAttrData::SetAttr, we take ownership
+    // of the attribute here, i.e. we don't IncRef() it
+    if ( !attr )
+    {
+        const int rowId = m_rowIds.Get(row),
+                  colId = m_colIds.Get(col);
+        if ( rowId == wxGridCellAttrIds::NO_ID ||
+                colId == wxGridCellAttrIds::NO_ID )
+            return;
+
+        // remove the attribute, if any
+        wxGridCellAttrHash::iterator it =
+            m_attrs.find(wxGridCellCoords(rowId, colId));
+        if ( it != m_attrs.end() )
+        {
+            it->second->DecRef();
+            m_attrs.erase(it);
+
+            m_rowIds.RemoveUse(rowId);
+            m_colIds.RemoveUse(colId);
+        }
+
+        return;
+    }
+
+    const int rowId = m_rowIds.GetOrCreate(row),
+              colId = m_colIds.GetOrCreate(col);
+
+    wxGridCellAttr *& attrOld = m_attrs[wxGridCellCoords(rowId, colId)];
+    if ( attrOld )
+    {
+        // change the attribute
+        if ( attrOld != attr )
+            attrOld->DecRef();
+    }
+    else
+    {
+        // add the attribute
+        m_rowIds.AddUse(rowId);
+        m_colIds.AddUse(colId);
     }
+
+    attrOld = attr;
+}
+
+wxGridCellAttr *wxGridCellAttrData::GetAttr(int row, int col) const
+{
+    const int rowId = m_rowIds.Get(row);
+    if ( rowId == wxGridCellAttrIds::NO_ID )
+        return NULL;
+
+    const int colId = m_colIds.Get(col);
+    if ( colId == wxGridCellAttrIds::NO_ID )
+        return NULL;
+
+    wxGridCellAttrHash::const_iterator it =
+        m_attrs.find(wxGridCellCoords(rowId, colId));
+    if ( it == m_attrs.end() )
+        return NULL;
+
+    wxGridCellAttr * const attr = it->second;
+    attr->IncRef();
+
+    return attr;
+}
+
+void wxGridCellAttrData::UpdateAttrRows( size_t pos, int numRows )
+{
+    wxVector<int> deletedIds;
+    m_rowIds.UpdateAttrRowsOrCols(pos, numRows, deletedIds);
+
+    RemoveDeleted(deletedIds, true);
 }
 
 void wxGridCellAttrData::UpdateAttrCols( size_t pos, int numCols )
 {
-    size_t count = m_attrs.GetCount();
-    for ( size_t n = 0; n < count; n++ )
+    wxVector<int> deletedIds;
+    m_colIds.UpdateAttrRowsOrCols(pos, numCols, deletedIds);
+
+    RemoveDeleted(deletedIds, false);
+}
+
+void wxGridCellAttrData::RemoveDeleted(const wxVector<int>& deletedIds,
+                                       bool deletedRows)
+{
+    if ( deletedIds.empty() )
+        return;
+
+    wxGridCellAttrIds& ids = deletedRows ? m_rowIds : m_colIds;
+    wxGridCellAttrIds& otherIds = deletedRows ? m_colIds : m_rowIds;
+
+    // Either look up the cells of the deleted rows or columns in all the
+    // columns or rows or check all the attributes, whichever is faster: in
+    // both cases this takes time proportional to the number of the deleted
+    // cells at most.
+    const size_t numDeleted = deletedIds.size();
+    const int numOtherIds = otherIds.GetIdsCount();
+    if ( numDeleted * numOtherIds <= m_attrs.size() )
     {
-        wxGridCellCoords& coords = m_attrs[n].coords;
-        wxCoord col = coords.GetCol();
-        if ( (size_t)col >= pos )
+        for ( size_t n = 0; n < numDeleted; n++ )
         {
-            if ( numCols > 0 )
-            {
-                // If rows inserted, include row counter where necessary
-                coords.SetCol(col + numCols);
-            }
-            else if (numCols < 0)
+            for ( int otherId = 0; otherId < numOtherIds; otherId++ )
             {
-                // If rows deleted ...
-                if ((size_t)col >= pos - numCols)
-                {
-                    // ...either decrement row counter (if row still exists)...
-                    coords.SetCol(col + numCols);
-                }
-                else
+                if ( !otherIds.IsUsed(otherId) )
+                    continue;
+
+                const wxGridCellCoords
+                    coords(deletedRows ? deletedIds[n] : otherId,
+                           deletedRows ? otherId : deletedIds[n]);
+
+                wxGridCellAttrHash::iterator it = m_attrs.find(coords);
+                if ( it != m_attrs.end() )
                 {
-                    // ...or remove the attribute
-                    m_attrs.RemoveAt(n);
-                    n--;
-                    count--;
+                    it->second->DecRef();
+                    m_attrs.erase(it);
+
+                    otherIds.RemoveUse(otherId);
                 }
             }
         }
     }
-}
-
-int wxGridCellAttrData::FindIndex(int row, int col) const
-{
-    size_t count = m_attrs.GetCount();
-    for ( size_t n = 0; n < count; n++ )
+    else
     {
-        const wxGridCellCoords& coords = m_attrs[n].coords;
-        if ( (coords.GetRow() == row) && (coords.GetCol() == col) )
+        for ( wxGridCellAttrHash::iterator it = m_attrs.begin();
+              it != m_attrs.end(); )
         {
-            return n;
+            const int id = deletedRows ? it->first.GetRow()
+                                       : it->first.GetCol(),
+                      otherId = deletedRows ? it->first.GetCol()
+                                            : it->first.GetRow();
+
+            wxGridCellAttrHash::iterator itCurrent = it++;
+            if ( ids.IsDeleted(id) )
+            {
+                otherIds.RemoveUse(otherId);
+
+                itCurrent->second->DecRef();
+                m_attrs.erase(itCurrent);
+            }
         }
     }
 
-    return wxNOT_FOUND;
+    for ( size_t n = 0; n < numDeleted; n++ )
+        ids.FreeId(deletedIds[n]);
 }
 
 // ----------------------------------------------------------------------------
@@ -1598,149 +1712,744 @@ void wxGridStringTable::SetColLabelValue( int col, const wxString& value )
     m_colLabels[col] = value;
 }
 
+// ----------------------------------------------------------------------------
+// wxGridTypedTableStrings
+// ----------------------------------------------------------------------------
 
-//////////////////////////////////////////////////////////////////////
-//////////////////////////////////////////////////////////////////////
-
-BEGIN_EVENT_TABLE(wxGridSubwindow, wxWindow)
-    EVT_MOUSE_CAPTURE_LOST(wxGridSubwindow::OnMouseCaptureLost)
-END_EVENT_TABLE()
-
-void wxGridSubwindow::OnMouseCaptureLost(wxMouseCaptureLostEvent& WXUNUSED(event))
+wxGridTypedTableStrings::wxGridTypedTableStrings(size_t numRows)
+    : m_indices(numRows, 0u)
 {
-    m_owner->CancelMouseCapture();
+    m_strings.Add(wxString());
+    m_stringIndices[wxString()] = 0;
 }
 
-BEGIN_EVENT_TABLE( wxGridRowLabelWindow, wxGridSubwindow )
-    EVT_PAINT( wxGridRowLabelWindow::OnPaint )
-    EVT_MOUSEWHEEL( wxGridRowLabelWindow::OnMouseWheel )
-    EVT_MOUSE_EVENTS( wxGridRowLabelWindow::OnMouseEvent )
-END_EVENT_TABLE()
-
-void wxGridRowLabelWindow::OnPaint( wxPaintEvent& WXUNUSED(event) )
+unsigned wxGridTypedTableStrings::GetIndex(const wxString& value)
 {
-    wxPaintDC dc(this);
+    wxGridStringIndexHash::const_iterator it = m_stringIndices.find(value);
+    if ( it != m_stringIndices.end() )
+        return it->second;
 
-    // NO - don't do this because it will set both the x and y origin
-    // coords to match the parent scrolled window and we just want to
-    // set the y coord  - MB
-    //
-    // m_owner->PrepareDC( dc );
+    // Don't let the strings which are not used any more accumulate forever,
+    // but do it rarely enough for this to take constant time on average.
+    if ( m_strings.size() > 2*m_indices.size() + 64 )
+        RemoveUnused();
 
-    int x, y;
-    m_owner->CalcUnscrolledPosition( 0, 0, &x, &y );
-    wxPoint pt = dc.GetDeviceOrigin();
-    dc.SetDeviceOrigin( pt.x, pt.y-y );
+    const unsigned index = m_strings.size();
+    m_strings.Add(value);
+    m_stringIndices[value] = index;
 
-    wxArrayInt rows = m_owner->CalcRowLabelsExposed( GetUpdateRegion() );
-    m_owner->DrawRowLabels( dc, rows );
+    return index;
 }
 
-void wxGridRowLabelWindow::OnMouseEvent( wxMouseEvent& event )
+void wxGridTypedTableStrings::RemoveUnused()
 {
-    m_owner->ProcessRowLabelMouseEvent( event );
+    const size_t numRows = m_indices.size();
+
+    wxVector<unsigned> newIndices(m_strings.size(), 0u);
+    wxArrayString strings;
+    strings.Add(wxString());
+
+    m_stringIndices.clear();
+    m_stringIndices[wxString()] = 0;
+
+    for ( size_t row = 0; row < numRows; row++ )
+    {
+        unsigned& index = m_indices[row];
+        if ( !index )
+            continue;
+
+        if ( !newIndices[index] )
+        {
+            newIndices[index] = strings.size();
+            strings.Add(m_strings[index]);
+            m_stringIndices[m_strings[index]] = newIndices[index];
+        }
+
+        index = newIndices[index];
+    }
+
+    m_strings.swap(strings);
 }
 
-void wxGridRowLabelWindow::OnMouseWheel( wxMouseEvent& event )
+void wxGridTypedTableStrings::Clear()
 {
-    if (!m_owner->GetEventHandler()->ProcessEvent( event ))
-        event.Skip();
+    m_indices.assign(m_indices.size(), 0u);
+
+    m_strings.clear();
+    m_strings.Add(wxString());
+
+    m_stringIndices.clear();
+    m_stringIndices[wxString()] = 0;
 }
 
-//////////////////////////////////////////////////////////////////////
+// ----------------------------------------------------------------------------
+// wxGridTypedTable
+// ----------------------------------------------------------------------------
 
-BEGIN_EVENT_TABLE( wxGridColLabelWindow, wxGridSubwindow )
-    EVT_PAINT( wxGridColLabelWindow::OnPaint )
-    EVT_MOUSEWHEEL( wxGridColLabelWindow::OnMouseWheel )
-    EVT_MOUSE_EVENTS( wxGridColLabelWindow::OnMouseEvent )
-END_EVENT_TABLE()
+IMPLEMENT_DYNAMIC_CLASS( wxGridTypedTable, wxGridTableBase )
 
-void wxGridColLabelWindow::OnPaint( wxPaintEvent& WXUNUSED(event) )
+namespace
 {
-    wxPaintDC dc(this);
 
-    // NO - don't do this because it will set both the x and y origin
-    // coords to match the parent scrolled window and we just want to
-    // set the x coord  - MB
-    //
-    // m_owner->PrepareDC( dc );
+wxGridTypedTableColumn *
+CreateTypedTableColumn(wxGridColumnType type, size_t numRows)
+{
+    switch ( type )
+    {
+        case wxGRID_COLUMN_STRING:
+            return new wxGridTypedTableStrings(numRows);
 
-    int x, y;
-    m_owner->CalcUnscrolledPosition( 0, 0, &x, &y );
-    wxPoint pt = dc.GetDeviceOrigin();
-    dc.SetDeviceOrigin( pt.x-x, pt.y );
+        case wxGRID_COLUMN_NUMBER:
+            return new wxGridTypedTableNumbers(numRows);
 
-    wxArrayInt cols = m_owner->CalcColLabelsExposed( GetUpdateRegion() );
-    m_owner->DrawColLabels( dc, cols );
+        case wxGRID_COLUMN_FLOAT:
+            return new wxGridTypedTableFloats(numRows);
+
+        case wxGRID_COLUMN_BOOL:
+            return new wxGridTypedTableBools(numRows);
+    }
+
+    wxFAIL_MSG( wxT("invalid wxGridTypedTable column type") );
+
+    return new wxGridTypedTableStrings(numRows);
 }
 
-void wxGridColLabelWindow::OnMouseEvent( wxMouseEvent& event )
+} // anonymous namespace
+
+wxGridTypedTable::wxGridTypedTable()
+        : wxGridTableBase()
 {
-    m_owner->ProcessColLabelMouseEvent( event );
+    m_numRows = 0;
 }
 
-void wxGridColLabelWindow::OnMouseWheel( wxMouseEvent& event )
+wxGridTypedTable::wxGridTypedTable( int numRows, int numCols,
+                                    wxGridColumnType type )
+        : wxGridTableBase()
 {
-    if (!m_owner->GetEventHandler()->ProcessEvent( event ))
-        event.Skip();
-}
+    m_numRows = numRows;
 
-//////////////////////////////////////////////////////////////////////
+    m_cols.reserve( numCols );
+    for ( int col = 0; col < numCols; col++ )
+        m_cols.push_back( CreateTypedTableColumn(type, m_numRows) );
+}
 
-BEGIN_EVENT_TABLE( wxGridCornerLabelWindow, wxGridSubwindow )
-    EVT_MOUSEWHEEL( wxGridCornerLabelWindow::OnMouseWheel )
-    EVT_MOUSE_EVENTS( wxGridCornerLabelWindow::OnMouseEvent )
-    EVT_PAINT( wxGridCornerLabelWindow::OnPaint )
-END_EVENT_TABLE()
+wxGridTypedTable::~wxGridTypedTable()
+{
+    for ( size_t col = 0; col < m_cols.size(); col++ )
+        delete m_cols[col];
+}
 
-void wxGridCornerLabelWindow::OnPaint( wxPaintEvent& WXUNUSED(event) )
+wxGridTypedTableColumn *wxGridTypedTable::GetCol( int row, int col ) const
 {
-    wxPaintDC dc(this);
+    wxCHECK_MSG( (row >= 0 && (size_t)row < m_numRows) &&
+                 (col >= 0 && (size_t)col < m_cols.size()),
+                 NULL,
+                 wxT("invalid row or column index in wxGridTypedTable") );
 
-    m_owner->DrawCornerLabel(dc);
+    return m_cols[col];
 }
 
-void wxGridCornerLabelWindow::OnMouseEvent( wxMouseEvent& event )
+wxGridTypedTableColumn *
+wxGridTypedTable::GetColOfType( int row, int col, wxGridColumnType type ) const
 {
-    m_owner->ProcessCornerLabelMouseEvent( event );
+    wxGridTypedTableColumn * const column = GetCol( row, col );
+    if ( !column )
+        return NULL;
+
+    wxCHECK_MSG( column->GetType() == type, NULL,
+                 wxT("wrong column type in wxGridTypedTable") );
+
+    return column;
 }
 
-void wxGridCornerLabelWindow::OnMouseWheel( wxMouseEvent& event )
+wxGridTypedTableColumn *
+wxGridTypedTable::GetColForValues( int col, int row, size_t count,
+                                   wxGridColumnType type ) const
 {
-    if (!m_owner->GetEventHandler()->ProcessEvent(event))
-        event.Skip();
-}
+    wxCHECK_MSG( (col >= 0 && (size_t)col < m_cols.size()) &&
+                 (row >= 0 && (size_t)row <= m_numRows) &&
+                 count <= m_numRows - row,
+                 NULL,
+                 wxT("invalid cells range in wxGridTypedTable") );
 
-//////////////////////////////////////////////////////////////////////
+    wxGridTypedTableColumn * const column = m_cols[col];
 
-BEGIN_EVENT_TABLE( wxGridWindow, wxGridSubwindow )
-    EVT_PAINT( wxGridWindow::OnPaint )
-    EVT_MOUSEWHEEL( wxGridWindow::OnMouseWheel )
-    EVT_MOUSE_EVENTS( wxGridWindow::OnMouseEvent )
-    EVT_KEY_DOWN( wxGridWindow::OnKeyDown )
-    EVT_KEY_UP( wxGridWindow::OnKeyUp )
-    EVT_CHAR( wxGridWindow::OnChar )
-    EVT_SET_FOCUS( wxGridWindow::OnFocus )
-    EVT_KILL_FOCUS( wxGridWindow::OnFocus )
-    EVT_ERASE_BACKGROUND( wxGridWindow::OnEraseBackground )
-END_EVENT_TABLE()
+    wxCHECK_MSG( column->GetType() == type, NULL,
+                 wxT("wrong column type in wxGridTypedTable") );
 
-void wxGridWindow::OnPaint( wxPaintEvent &WXUNUSED(event) )
+    return column;
+}
+
+void wxGridTypedTable::SetColType( int col, wxGridColumnType type )
 {
-    wxPaintDC dc( this );
-    m_owner->PrepareDC( dc );
-    wxRegion reg = GetUpdateRegion();
-    wxGridCellCoordsArray dirtyCells = m_owner->CalcCellsExposed( reg );
-    m_owner->DrawGridCellArea( dc, dirtyCells );
+    wxCHECK_RET( col >= 0 && (size_t)col < m_cols.size(),
+                 wxT("invalid column index in wxGridTypedTable") );
 
-    m_owner->DrawGridSpace( dc );
+    wxGridTypedTableColumn * const columnOld = m_cols[col];
+    if ( columnOld->GetType() == type )
+        return;
 
-    m_owner->DrawAllGridLines( dc, reg );
+    wxGridTypedTableColumn * const columnNew =
+        CreateTypedTableColumn(type, m_numRows);
+    for ( size_t row = 0; row < m_numRows; row++ )
+        columnNew->SetValue(row, columnOld->GetValue(row));
 
-    m_owner->DrawHighlight( dc, dirtyCells );
+    m_cols[col] = columnNew;
+    delete columnOld;
 }
 
-void wxGrid::Render( wxDC& dc,
+wxGridColumnType wxGridTypedTable::GetColType( int col ) const
+{
+    wxCHECK_MSG( col >= 0 && (size_t)col < m_cols.size(),
+                 wxGRID_COLUMN_STRING,
+                 wxT("invalid column index in wxGridTypedTable") );
+
+    return m_cols[col]->GetType();
+}
+
+wxInt64 wxGridTypedTable::GetValueAsInt64( int row, int col )
+{
+    wxGridTypedTableColumn * const
+        column = GetColOfType(row, col, wxGRID_COLUMN_NUMBER);
+
+    return column ? static_cast<wxGridTypedTableNumbers *>(column)->Get(row)
+                  : 0;
+}
+
+void wxGridTypedTable::SetValueAsInt64( int row, int col, wxInt64 value )
+{
+    wxGridTypedTableColumn * const
+        column = GetColOfType(row, col, wxGRID_COLUMN_NUMBER);
+
+    if ( column )
+        static_cast<wxGridTypedTableNumbers *>(column)->Set(row, value);
+}
+
+void wxGridTypedTable::SetColValues( int col, int row,
+                                     const wxString *values, size_t count )
+{
+    wxGridTypedTableColumn * const
+        column = GetColForValues(col, row, count, wxGRID_COLUMN_STRING);
+    if ( !column )
+        return;
+
+    for ( size_t n = 0; n < count; n++ )
+        column->SetValue(row + n, values[n]);
+}
+
+void wxGridTypedTable::SetColValues( int col, int row,
+                                     const wxInt64 *values, size_t count )
+{
+    wxGridTypedTableNumbers * const column =
+        static_cast<wxGridTypedTableNumbers *>(
+            GetColForValues(col, row, count, wxGRID_COLUMN_NUMBER));
+    if ( !column )
+        return;
+
+    for ( size_t n = 0; n < count; n++ )
+        column->Set(row + n, values[n]);
+}
+
+void wxGridTypedTable::SetColValues( int col, int row,
+                                     const double *values, size_t count )
+{
+    wxGridTypedTableFloats * const column =
+        static_cast<wxGridTypedTableFloats *>(
+            GetColForValues(col, row, count, wxGRID_COLUMN_FLOAT));
+    if ( !column )
+        return;
+
+    for ( size_t n = 0; n < count; n++ )
+        column->Set(row + n, values[n]);
+}
+
+void wxGridTypedTable::SetColValues( int col, int row,
+                                     const bool *values, size_t count )
+{
+    wxGridTypedTableBools * const column =
+        static_cast<wxGridTypedTableBools *>(
+            GetColForValues(col, row, count, wxGRID_COLUMN_BOOL));
+    if ( !column )
+        return;
+
+    for ( size_t n = 0; n < count; n++ )
+        column->Set(row + n, values[n]);
+}
+
+wxString wxGridTypedTable::GetValue( int row, int col )
+{
+    wxGridTypedTableColumn * const column = GetCol(row, col);
+
+    return column ? column->GetValue(row) : wxString();
+}
+
+void wxGridTypedTable::SetValue( int row, int col, const wxString& value )
+{
+    wxGridTypedTableColumn * const column = GetCol(row, col);
+    if ( column )
+        column->SetValue(row, value);
+}
+
+bool wxGridTypedTable::IsEmptyCell( int row, int col )
+{
+    wxGridTypedTableColumn * const column = GetCol(row, col);
+
+    return !column || column->IsEmpty(row);
+}
+
+wxString wxGridTypedTable::GetTypeName( int row, int col )
+{
+    wxGridTypedTableColumn * const column = GetCol(row, col);
+    if ( column )
+    {
+        switch ( column->GetType() )
+        {
+            case wxGRID_COLUMN_STRING:
+                break;
+
+            case wxGRID_COLUMN_NUMBER:
+                return wxGRID_VALUE_NUMBER;
+
+            case wxGRID_COLUMN_FLOAT:
+                return wxGRID_VALUE_FLOAT;
+
+            case wxGRID_COLUMN_BOOL:
+                return wxGRID_VALUE_BOOL;
+        }
+    }
+
+    return wxGRID_VALUE_STRING;
+}
+
+bool wxGridTypedTable::CanGetValueAs( int row, int col,
+                                      const wxString& typeName )
+{
+    // All values can be retrieved as strings and as their own type, and the
+    // numbers can be also retrieved as doubles without losing anything.
+    if ( typeName == wxGRID_VALUE_STRING )
+        return true;
+
+    const wxString typeNameCol = GetTypeName(row, col);
+    if ( typeName == typeNameCol )
+        return true;
+
+    return typeName == wxGRID_VALUE_FLOAT &&
+            typeNameCol == wxGRID_VALUE_NUMBER;
+}
+
+long wxGridTypedTable::GetValueAsLong( int row, int col )
+{
+    return static_cast<long>(GetValueAsInt64(row, col));
+}
+
+double wxGridTypedTable::GetValueAsDouble( int row, int col )
+{
+    wxGridTypedTableColumn * const column = GetCol(row, col);
+    if ( !column )
+        return 0.;
+
+    switch ( column->GetType() )
+    {
+        case wxGRID_COLUMN_NUMBER:
+            return static_cast<wxGridTypedTableNumbers *>(column)->Get(row);
+
+        case wxGRID_COLUMN_FLOAT:
+            return static_cast<wxGridTypedTableFloats *>(column)->Get(row);
+
+        case wxGRID_COLUMN_STRING:
+        case wxGRID_COLUMN_BOOL:
+            break;
+    }
+
+    wxFAIL_MSG( wxT("wrong column type in wxGridTypedTable") );
+
+    return 0.;
+}
+
+bool wxGridTypedTable::GetValueAsBool( int row, int col )
+{
+    wxGridTypedTableColumn * const
+        column = GetColOfType(row, col, wxGRID_COLUMN_BOOL);
+
+    return column && static_cast<wxGridTypedTableBools *>(column)->Get(row);
+}
+
+void wxGridTypedTable::SetValueAsLong( int row, int col, long value )
+{
+    SetValueAsInt64(row, col, value);
+}
+
+void wxGridTypedTable::SetValueAsDouble( int row, int col, double value )
+{
+    wxGridTypedTableColumn * const
+        column = GetColOfType(row, col, wxGRID_COLUMN_FLOAT);
+
+    if ( column )
+        static_cast<wxGridTypedTableFloats *>(column)->Set(row, value);
+}
+
+void wxGridTypedTable::SetValueAsBool( int row, int col, bool value )
+{
+    wxGridTypedTableColumn * const
+        column = GetColOfType(row, col, wxGRID_COLUMN_BOOL);
+
+    if ( column )
+        static_cast<wxGridTypedTableBools *>(column)->Set(row, value);
+}
+
+void wxGridTypedTable::Clear()
+{
+    for ( size_t col = 0; col < m_cols.size(); col++ )
+        m_cols[col]->Clear();
+}
+
+bool wxGridTypedTable::InsertRows( size_t pos, size_t numRows )
+{
+    if ( pos >= m_numRows )
+    {
+        return AppendRows( numRows );
+    }
+
+    for ( size_t col = 0; col < m_cols.size(); col++ )
+        m_cols[col]->InsertRows( pos, numRows );
+
+    m_numRows += numRows;
+
+    if ( GetView() )
+    {
+        wxGridTableMessage msg( this,
+                                wxGRIDTABLE_NOTIFY_ROWS_INSERTED,
+                                pos,
+                                numRows );
+
+        GetView()->ProcessTableMessage( msg );
+    }
+
+    return true;
+}
+
+bool wxGridTypedTable::AppendRows( size_t numRows )
+{
+    for ( size_t col = 0; col < m_cols.size(); col++ )
+        m_cols[col]->InsertRows( m_numRows, numRows );
+
+    m_numRows += numRows;
+
+    if ( GetView() )
+    {
+        wxGridTableMessage msg( this,
+                                wxGRIDTABLE_NOTIFY_ROWS_APPENDED,
+                                numRows );
+
+        GetView()->ProcessTableMessage( msg );
+    }
+
+    return true;
+}
+
+bool wxGridTypedTable::DeleteRows( size_t pos, size_t numRows )
+{
+    wxCHECK_MSG( pos < m_numRows, false,
+                 wxT("invalid row index in wxGridTypedTable::DeleteRows()") );
+
+    if ( numRows > m_numRows - pos )
+    {
+        numRows = m_numRows - pos;
+    }
+
+    for ( size_t col = 0; col < m_cols.size(); col++ )
+        m_cols[col]->DeleteRows( pos, numRows );
+
+    m_numRows -= numRows;
+
+    if ( GetView() )
+    {
+        wxGridTableMessage msg( this,
+                                wxGRIDTABLE_NOTIFY_ROWS_DELETED,
+                                pos,
+                                numRows );
+
+        GetView()->ProcessTableMessage( msg );
+    }
+
+    return true;
+}
+
+bool wxGridTypedTable::InsertCols( size_t pos, size_t numCols )
+{
+    return InsertCols( pos, numCols, wxGRID_COLUMN_STRING );
+}
+
+bool wxGridTypedTable::AppendCols( size_t numCols )
+{
+    return AppendCols( numCols, wxGRID_COLUMN_STRING );
+}
+
+bool
+wxGridTypedTable::InsertCols( size_t pos, size_t numCols, wxGridColumnType type )
+{
+    if ( pos >= m_cols.size() )
+    {
+        return AppendCols( numCols, type );
+    }
+
+    if ( !m_colLabels.IsEmpty() && pos < m_colLabels.size() )
+    {
+        m_colLabels.Insert( wxEmptyString, pos, numCols );
+
+        for ( size_t i = pos; i < pos + numCols; i++ )
+            m_colLabels[i] = wxGridTableBase::GetColLabelValue( i );
+    }
+
+    for ( size_t col = pos; col < pos + numCols; col++ )
+    {
+        m_cols.insert( m_cols.begin() + col,
+                       CreateTypedTableColumn(type, m_numRows) );
+    }
+
+    if ( GetView() )
+    {
+        wxGridTableMessage msg( this,
+                                wxGRIDTABLE_NOTIFY_COLS_INSERTED,
+                                pos,
+                                numCols );
+
+        GetView()->ProcessTableMessage( msg );
+    }
+
+    return true;
+}
+
+bool wxGridTypedTable::AppendCols( size_t numCols, wxGridColumnType type )
+{
+    for ( size_t col = 0; col < numCols; col++ )
+        m_cols.push_back( CreateTypedTableColumn(type, m_numRows) );
+
+    if ( GetView() )
+    {
+        wxGridTableMessage msg( this,
+                                wxGRIDTABLE_NOTIFY_COLS_APPENDED,
+                                numCols );
+
+        GetView()->ProcessTableMessage( msg );
+    }
+
+    return true;
+}
+
+bool wxGridTypedTable::DeleteCols( size_t pos, size_t numCols )
+{
+    const size_t curNumCols = m_cols.size();
+
+    wxCHECK_MSG( pos < curNumCols, false,
+                 wxT("invalid column index in wxGridTypedTable::DeleteCols()") );
+
+    // as in wxGridStringTable, the position is the display one
+    const size_t colID = GetView() ? GetView()->GetColAt( pos ) : pos;
+
+    if ( numCols > curNumCols - colID )
+    {
+        numCols = curNumCols - colID;
+    }
+
+    if ( colID < m_colLabels.size() )
+    {
+        m_colLabels.RemoveAt( colID, wxMin(numCols, m_colLabels.size() - colID) );
+    }
+
+    for ( size_t col = colID; col < colID + numCols; col++ )
+        delete m_cols[col];
+
+    m_cols.erase( m_cols.begin() + colID, m_cols.begin() + colID + numCols );
+
+    if ( GetView() )
+    {
+        wxGridTableMessage msg( this,
+                                wxGRIDTABLE_NOTIFY_COLS_DELETED,
+                                pos,
+                                numCols );
+
+        GetView()->ProcessTableMessage( msg );
+    }
+
+    return true;
+}
+
+wxString wxGridTypedTable::GetRowLabelValue( int row )
+{
+    if ( row >= 0 && (size_t)row < m_rowLabels.size() )
+        return m_rowLabels[row];
+
+    return wxGridTableBase::GetRowLabelValue( row );
+}
+
+wxString wxGridTypedTable::GetColLabelValue( int col )
+{
+    if ( col >= 0 && (size_t)col < m_colLabels.size() )
+        return m_colLabels[col];
+
+    return wxGridTableBase::GetColLabelValue( col );
+}
+
+void wxGridTypedTable::SetRowLabelValue( int row, const wxString& value )
+{
+    for ( int i = m_rowLabels.size(); i <= row; i++ )
+        m_rowLabels.Add( wxGridTableBase::GetRowLabelValue(i) );
+
+    m_rowLabels[row] = value;
+}
+
+void wxGridTypedTable::SetColLabelValue( int col, const wxString& value )
+{
+    for ( int i = m_colLabels.size(); i <= col; i++ )
+        m_colLabels.Add( wxGridTableBase::GetColLabelValue(i) );
+
+    m_colLabels[col] = value;
+}
+
+
+//////////////////////////////////////////////////////////////////////
+//////////////////////////////////////////////////////////////////////
+
+BEGIN_EVENT_TABLE(wxGridSubwindow, wxWindow)
+    EVT_MOUSE_CAPTURE_LOST(wxGridSubwindow::OnMouseCaptureLost)
+END_EVENT_TABLE()
+
+void wxGridSubwindow::OnMouseCaptureLost(wxMouseCaptureLostEvent& WXUNUSED(event))
+{
+    m_owner->CancelMouseCapture();
+}
+
+BEGIN_EVENT_TABLE( wxGridRowLabelWindow, wxGridSubwindow )
+    EVT_PAINT( wxGridRowLabelWindow::OnPaint )
+    EVT_MOUSEWHEEL( wxGridRowLabelWindow::OnMouseWheel )
+    EVT_MOUSE_EVENTS( wxGridRowLabelWindow::OnMouseEvent )
+END_EVENT_TABLE()
+
+void wxGridRowLabelWindow::OnPaint( wxPaintEvent& WXUNUSED(event) )
+{
+    wxPaintDC dc(this);
+
+    // NO - don't do this because it will set both the x and y origin
+    // coords to match the parent scrolled window and we just want to
+    // set the y coord  - MB
+    //
+    // m_owner->PrepareDC( dc );
+
+    int x, y;
+    m_owner->CalcUnscrolledPosition( 0, 0, &x, &y );
+    wxPoint pt = dc.GetDeviceOrigin();
+    dc.SetDeviceOrigin( pt.x, pt.y-y );
+
+    wxArrayInt rows = m_owner->CalcRowLabelsExposed( GetUpdateRegion() );
+    m_owner->DrawRowLabels( dc, rows );
+}
+
+void wxGridRowLabelWindow::OnMouseEvent( wxMouseEvent& event )
+{
+    m_owner->ProcessRowLabelMouseEvent( event );
+}
+
+void wxGridRowLabelWindow::OnMouseWheel( wxMouseEvent& event )
+{
+    if (!m_owner->GetEventHandler()->ProcessEvent( event ))
+        event.Skip();
+}
+
+//////////////////////////////////////////////////////////////////////
+
+BEGIN_EVENT_TABLE( wxGridColLabelWindow, wxGridSubwindow )
+    EVT_PAINT( wxGridColLabelWindow::OnPaint )
+    EVT_MOUSEWHEEL( wxGridColLabelWindow::OnMouseWheel )
+    EVT_MOUSE_EVENTS( wxGridColLabelWindow::OnMouseEvent )
+END_EVENT_TABLE()
+
+void wxGridColLabelWindow::OnPaint( wxPaintEvent& WXUNUSED(event) )
+{
+    wxPaintDC dc(this);
+
+    // NO - don't do this because it will set both the x and y origin
+    // coords to match the parent scrolled window and we just want to
+    // set the x coord  - MB
+    //
+    // m_owner->PrepareDC( dc );
+
+    int x, y;
+    m_owner->CalcUnscrolledPosition( 0, 0, &x, &y );
+    wxPoint pt = dc.GetDeviceOrigin();
+    dc.SetDeviceOrigin( pt.x-x, pt.y );
+
+    wxArrayInt cols = m_owner->CalcColLabelsExposed( GetUpdateRegion() );
+    m_owner->DrawColLabels( dc, cols );
+}
+
+void wxGridColLabelWindow::OnMouseEvent( wxMouseEvent& event )
+{
+    m_owner->ProcessColLabelMouseEvent( event );
+}
+
+void wxGridColLabelWindow::OnMouseWheel( wxMouseEvent& event )
+{
+    if (!m_owner->GetEventHandler()->ProcessEvent( event ))
+        event.Skip();
+}
+
+//////////////////////////////////////////////////////////////////////
+
+BEGIN_EVENT_TABLE( wxGridCornerLabelWindow, wxGridSubwindow )
+    EVT_MOUSEWHEEL( wxGridCornerLabelWindow::OnMouseWheel )
+    EVT_MOUSE_EVENTS( wxGridCornerLabelWindow::OnMouseEvent )
+    EVT_PAINT( wxGridCornerLabelWindow::OnPaint )
+END_EVENT_TABLE()
+
+void wxGridCornerLabelWindow::OnPaint( wxPaintEvent& WXUNUSED(event) )
+{
+    wxPaintDC dc(this);
+
+    m_owner->DrawCornerLabel(dc);
+}
+
+void wxGridCornerLabelWindow::OnMouseEvent( wxMouseEvent& event )
+{
+    m_owner->ProcessCornerLabelMouseEvent( event );
+}
+
+void wxGridCornerLabelWindow::OnMouseWheel( wxMouseEvent& event )
+{
+    if (!m_owner->GetEventHandler()->ProcessEvent(event))
+        event.Skip();
+}
+
+//////////////////////////////////////////////////////////////////////
+
+BEGIN_EVENT_TABLE( wxGridWindow, wxGridSubwindow )
+    EVT_PAINT( wxGridWindow::OnPaint )
+    EVT_MOUSEWHEEL( wxGridWindow::OnMouseWheel )
+    EVT_MOUSE_EVENTS( wxGridWindow::OnMouseEvent )
+    EVT_KEY_DOWN( wxGridWindow::OnKeyDown )
+    EVT_KEY_UP( wxGridWindow::OnKeyUp )
+    EVT_CHAR( wxGridWindow::OnChar )
+    EVT_SET_FOCUS( wxGridWindow::OnFocus )
+    EVT_KILL_FOCUS( wxGridWindow::OnFocus )
+    EVT_ERASE_BACKGROUND( wxGridWindow::OnEraseBackground )
+END_EVENT_TABLE()
+
+void wxGridWindow::OnPaint( wxPaintEvent &WXUNUSED(event) )
+{
+    wxPaintDC dc( this );
+    m_owner->PrepareDC( dc );
+    wxRegion reg = GetUpdateRegion();
+    wxGridCellCoordsArray dirtyCells = m_owner->CalcCellsExposed( reg );
+    m_owner->DrawGridCellArea( dc, dirtyCells );
+
+    m_owner->DrawGridSpace( dc );
+
+    m_owner->DrawAllGridLines( dc, reg );
+
+    m_owner->DrawHighlight( dc, dirtyCells );
+}
+
+void wxGrid::Render( wxDC& dc,
                      const wxPoint& position,
                      const wxSize& size,
                      const wxGridCellCoords& topLeft,
@@ -2334,9 +3043,9 @@ wxGrid::SetTable(wxGridTableBase *table,
 
         // kill row and column size arrays
         m_colWidths.Empty();
-        m_colRights.Empty();
+        m_colRights.Clear();
         m_rowHeights.Empty();
-        m_rowBottoms.Empty();
+        m_rowBottoms.Clear();
     }
 
     if (table)
@@ -2486,6 +3195,9 @@ void wxGrid::Init()
     m_yScrollPixelsPerLine = GRID_SCROLL_LINE_Y;
 
     m_tabBehaviour = Tab_Stop;
+
+    m_autoSizeMode = wxGRID_AUTOSIZE_DEFAULT;
+    m_autoSizeMaxSampledRows = 1000;
 }
 
 // ----------------------------------------------------------------------------
@@ -2497,41 +3209,41 @@ void wxGrid::Init()
 // with some extra code, it should be possible to only store the widths/heights
 // different from default ones (resulting in space savings for huge grids) but
 // this is not done currently
+//
+// the ends of the rows/columns are stored in wxGridLineEnds allowing to find
+// them and to update them when a size changes in logarithmic time
 // ----------------------------------------------------------------------------
 
 void wxGrid::InitRowHeights()
 {
     m_rowHeights.Empty();
-    m_rowBottoms.Empty();
 
     m_rowHeights.Alloc( m_numRows );
-    m_rowBottoms.Alloc( m_numRows );
 
     m_rowHeights.Add( m_defaultRowHeight, m_numRows );
 
-    int rowBottom = 0;
-    for ( int i = 0; i < m_numRows; i++ )
-    {
-        rowBottom += m_defaultRowHeight;
-        m_rowBottoms.Add( rowBottom );
-    }
+    UpdateRowBottoms();
 }
 
 void wxGrid::InitColWidths()
 {
     m_colWidths.Empty();
-    m_colRights.Empty();
 
     m_colWidths.Alloc( m_numCols );
-    m_colRights.Alloc( m_numCols );
 
     m_colWidths.Add( m_defaultColWidth, m_numCols );
 
-    for ( int i = 0; i < m_numCols; i++ )
-    {
-        int colRight = ( GetColPos( i ) + 1 ) * m_defaultColWidth;
-        m_colRights.Add( colRight );
-    }
+    UpdateColRights();
+}
+
+void wxGrid::UpdateRowBottoms()
+{
+    m_rowBottoms.Init( m_rowHeights, wxArrayInt(), m_defaultRowHeight );
+}
+
+void wxGrid::UpdateColRights()
+{
+    m_colRights.Init( m_colWidths, m_colAt, m_defaultColWidth );
 }
 
 int wxGrid::GetColWidth(int col) const
@@ -2548,13 +3260,13 @@ int wxGrid::GetColLeft(int col) const
     if ( m_colRights.IsEmpty() )
         return GetColPos( col ) * m_defaultColWidth;
 
-    return m_colRights[col] - GetColWidth(col);
+    return m_colRights.GetEnd(GetColPos( col )) - GetColWidth(col);
 }
 
 int wxGrid::GetColRight(int col) const
 {
     return m_colRights.IsEmpty() ? (GetColPos( col ) + 1) * m_defaultColWidth
-                                 : m_colRights[col];
+                                 : m_colRights.GetEnd(GetColPos( col ));
 }
 
 int wxGrid::GetRowHeight(int row) const
@@ -2572,13 +3284,13 @@ int wxGrid::GetRowTop(int row) const
     if ( m_rowBottoms.IsEmpty() )
         return row * m_defaultRowHeight;
 
-    return m_rowBottoms[row] - GetRowHeight(row);
+    return m_rowBottoms.GetEnd(row) - GetRowHeight(row);
 }
 
 int wxGrid::GetRowBottom(int row) const
 {
     return m_rowBottoms.IsEmpty() ? (row + 1) * m_defaultRowHeight
-                                  : m_rowBottoms[row];
+                                  : m_rowBottoms.GetEnd(row);
 }
 
 void wxGrid::CalcDimensions()
@@ -2705,17 +3417,7 @@ bool wxGrid::Redimension( wxGridTableMessage& msg )
             if ( !m_rowHeights.IsEmpty() )
             {
                 m_rowHeights.Insert( m_defaultRowHeight, pos, numRows );
-                m_rowBottoms.Insert( 0, pos, numRows );
-
-                int bottom = 0;
-                if ( pos > 0 )
-                    bottom = m_rowBottoms[pos - 1];
-
-                for ( i = pos; i < m_numRows; i++ )
-                {
-                    bottom += m_rowHeights[i];
-                    m_rowBottoms[i] = bottom;
-                }
+                UpdateRowBottoms();
             }
 
             if ( m_currentCellCoords == wxGridNoCellCoords )
@@ -2744,23 +3446,12 @@ bool wxGrid::Redimension( wxGridTableMessage& msg )
         case wxGRIDTABLE_NOTIFY_ROWS_APPENDED:
         {
             int numRows = msg.GetCommandInt();
-            int oldNumRows = m_numRows;
             m_numRows += numRows;
 
             if ( !m_rowHeights.IsEmpty() )
             {
                 m_rowHeights.Add( m_defaultRowHeight, numRows );
-                m_rowBottoms.Add( 0, numRows );
-
-                int bottom = 0;
-                if ( oldNumRows > 0 )
-                    bottom = m_rowBottoms[oldNumRows - 1];
-
-                for ( i = oldNumRows; i < m_numRows; i++ )
-                {
-                    bottom += m_rowHeights[i];
-                    m_rowBottoms[i] = bottom;
-                }
+                m_rowBottoms.AppendDefault( numRows );
             }
 
             if ( m_currentCellCoords == wxGridNoCellCoords )
@@ -2789,14 +3480,7 @@ bool wxGrid::Redimension( wxGridTableMessage& msg )
             if ( !m_rowHeights.IsEmpty() )
             {
                 m_rowHeights.RemoveAt( pos, numRows );
-                m_rowBottoms.RemoveAt( pos, numRows );
-
-                int h = 0;
-                for ( i = 0; i < m_numRows; i++ )
-                {
-                    h += m_rowHeights[i];
-                    m_rowBottoms[i] = h;
-                }
+                UpdateRowBottoms();
             }
 
             if ( !m_numRows )
@@ -2867,20 +3551,7 @@ bool wxGrid::Redimension( wxGridTableMessage& msg )
             if ( !m_colWidths.IsEmpty() )
             {
                 m_colWidths.Insert( m_defaultColWidth, pos, numCols );
-                m_colRights.Insert( 0, pos, numCols );
-
-                int right = 0;
-                if ( pos > 0 )
-                    right = m_colRights[GetColAt( pos - 1 )];
-
-                int colPos;
-                for ( colPos = pos; colPos < m_numCols; colPos++ )
-                {
-                    i = GetColAt( colPos );
-
-                    right += m_colWidths[i];
-                    m_colRights[i] = right;
-                }
+                UpdateColRights();
             }
 
             if ( m_currentCellCoords == wxGridNoCellCoords )
@@ -2924,21 +3595,10 @@ bool wxGrid::Redimension( wxGridTableMessage& msg )
 
             if ( !m_colWidths.IsEmpty() )
             {
+                // the new columns are always added at the end of the display
+                // order, so we can just append them
                 m_colWidths.Add( m_defaultColWidth, numCols );
-                m_colRights.Add( 0, numCols );
-
-                int right = 0;
-                if ( oldNumCols > 0 )
-                    right = m_colRights[GetColAt( oldNumCols - 1 )];
-
-                int colPos;
-                for ( colPos = oldNumCols; colPos < m_numCols; colPos++ )
-                {
-                    i = GetColAt( colPos );
-
-                    right += m_colWidths[i];
-                    m_colRights[i] = right;
-                }
+                m_colRights.AppendDefault( numCols );
             }
 
             // Notice that this must be called after updating m_colWidths above
@@ -2989,17 +3649,7 @@ bool wxGrid::Redimension( wxGridTableMessage& msg )
             if ( !m_colWidths.IsEmpty() )
             {
                 m_colWidths.RemoveAt( pos, numCols );
-                m_colRights.RemoveAt( pos, numCols );
-
-                int w = 0;
-                int colPos;
-                for ( colPos = 0; colPos < m_numCols; colPos++ )
-                {
-                    i = GetColAt( colPos );
-
-                    w += m_colWidths[i];
-                    m_colRights[i] = w;
-                }
+                UpdateColRights();
             }
 
             if ( !m_numCols )
@@ -4447,20 +5097,7 @@ void wxGrid::RefreshAfterColPosChange()
     // unless we calculate them dynamically because all columns widths are the
     // same and it's easy to do
     if ( !m_colWidths.empty() )
-    {
-        int colRight = 0;
-        for ( int colPos = 0; colPos < m_numCols; colPos++ )
-        {
-            int colID = GetColAt( colPos );
-
-            // Ignore the currently hidden columns.
-            const int width = m_colWidths[colID];
-            if ( width > 0 )
-                colRight += width;
-
-            m_colRights[colID] = colRight;
-        }
-    }
+        UpdateColRights();
 
     // and make the changes visible
     if ( m_useNativeHeader )
@@ -6542,9 +7179,8 @@ wxGridCellCoords wxGrid::XYToCell(int x, int y) const
 }
 
 // compute row or column from some (unscrolled) coordinate value, using either
-// m_defaultRowHeight/m_defaultColWidth or binary search on array of
-// m_rowBottoms/m_colRights to do it quickly in O(log n) time.
-// NOTE: This may not work correctly for reordered columns.
+// m_defaultRowHeight/m_defaultColWidth or m_rowBottoms/m_colRights to do it
+// quickly in O(log n) time.
 int wxGrid::PosToLinePos(int coord,
                          bool clipToMinMax,
                          const wxGridOperations& oper) const
@@ -6557,59 +7193,18 @@ int wxGrid::PosToLinePos(int coord,
     const int defaultLineSize = oper.GetDefaultLineSize(this);
     wxCHECK_MSG( defaultLineSize, -1, "can't have 0 default line size" );
 
-    int maxPos = coord / defaultLineSize,
-        minPos = 0;
-
     // check for the simplest case: if we have no explicit line sizes
-    // configured, then we already know the line this position falls in
-    const wxArrayInt& lineEnds = oper.GetLineEnds(this);
-    if ( lineEnds.empty() )
-    {
-        if ( maxPos < numLines )
-            return maxPos;
-
-        return clipToMinMax ? numLines - 1 : -1;
-    }
-
-
-    // binary search is quite efficient and we can't really make any assumptions
-    // on where to start here since row and columns could be of size 0 if they are
-    // hidden. While this could be made more efficient, some profiling will be
-    // necessary to determine if it really is a performance bottleneck
-    maxPos = numLines  - 1;
-
-    // check if the position is beyond the last column
-    const int lineAtMaxPos = oper.GetLineAt(this, maxPos);
-    if ( coord >= lineEnds[lineAtMaxPos] )
-        return clipToMinMax ? maxPos : -1;
-
-    // or before the first one
-    const int lineAt0 = oper.GetLineAt(this, 0);
-    if ( coord < lineEnds[lineAt0] )
-        return 0;
-
+    // configured, then we already know the line this position falls in,
+    // otherwise find the first line ending after it (notice that this
+    // correctly skips the lines of size 0, i.e. hidden ones)
+    const wxGridLineEnds& lineEnds = oper.GetLineEnds(this);
+    const int pos = lineEnds.IsEmpty() ? coord / defaultLineSize
+                                       : lineEnds.FindPos(coord);
 
-    // finally do perform the binary search
-    while ( minPos < maxPos )
-    {
-        wxCHECK_MSG( lineEnds[oper.GetLineAt(this, minPos)] <= coord &&
-                        coord < lineEnds[oper.GetLineAt(this, maxPos)],
-                     -1,
-                     "wxGrid: internal error in PosToLinePos()" );
-
-        if ( coord >= lineEnds[oper.GetLineAt(this, maxPos - 1)] )
-            return maxPos;
-        else
-            maxPos--;
-
-        const int median = minPos + (maxPos - minPos + 1) / 2;
-        if ( coord < lineEnds[oper.GetLineAt(this, median)] )
-            maxPos = median;
-        else
-            minPos = median;
-    }
+    if ( pos < numLines )
+        return pos;
 
-    return maxPos;
+    return clipToMinMax ? numLines - 1 : -1;
 }
 
 int
@@ -8066,7 +8661,7 @@ void wxGrid::SetDefaultRowSize( int height, bool resizeExistingRows )
         // arrays (which also allows us to take advantage of
         // some speed optimisations)
         m_rowHeights.Empty();
-        m_rowBottoms.Empty();
+        m_rowBottoms.Clear();
         if ( !GetBatchCount() )
             CalcDimensions();
     }
@@ -8168,10 +8763,7 @@ void wxGrid::DoSetRowSize( int row, int height )
     if ( !diff )
         return;
 
-    for ( int i = row; i < m_numRows; i++ )
-    {
-        m_rowBottoms[i] += diff;
-    }
+    m_rowBottoms.Add(row, diff);
 
     InvalidateBestSize();
 
@@ -8194,7 +8786,7 @@ void wxGrid::SetDefaultColSize( int width, bool resizeExistingCols )
         // arrays (which also allows us to take advantage of
         // some speed optimisations)
         m_colWidths.Empty();
-        m_colRights.Empty();
+        m_colRights.Clear();
         if ( !GetBatchCount() )
             CalcDimensions();
     }
@@ -8245,207 +8837,675 @@ void wxGrid::DoSetColSize( int col, int width )
 {
     wxCHECK_RET( col >= 0 && col < m_numCols, wxT("invalid column index") );
 
-    if ( m_colWidths.IsEmpty() )
+    if ( m_colWidths.IsEmpty() )
+    {
+        // need to really create the array
+        InitColWidths();
+    }
+
+    const int diff = UpdateRowOrColSize(m_colWidths[col], width);
+    if ( !diff )
+        return;
+
+    if ( m_useNativeHeader )
+        GetGridColHeader()->UpdateColumn(col);
+    //else: will be refreshed when the header is redrawn
+
+    m_colRights.Add(GetColPos(col), diff);
+
+    InvalidateBestSize();
+
+    if ( !GetBatchCount() )
+    {
+        CalcDimensions();
+        Refresh();
+    }
+}
+
+void wxGrid::SetColMinimalWidth( int col, int width )
+{
+    if (width > GetColMinimalAcceptableWidth())
+    {
+        wxLongToLongHashMap::key_type key = (wxLongToLongHashMap::key_type)col;
+        m_colMinWidths[key] = width;
+    }
+}
+
+void wxGrid::SetRowMinimalHeight( int row, int width )
+{
+    if (width > GetRowMinimalAcceptableHeight())
+    {
+        wxLongToLongHashMap::key_type key = (wxLongToLongHashMap::key_type)row;
+        m_rowMinHeights[key] = width;
+    }
+}
+
+int wxGrid::GetColMinimalWidth(int col) const
+{
+    wxLongToLongHashMap::key_type key = (wxLongToLongHashMap::key_type)col;
+    wxLongToLongHashMap::const_iterator it = m_colMinWidths.find(key);
+
+    return it != m_colMinWidths.end() ? (int)it->second : m_minAcceptableColWidth;
+}
+
+int wxGrid::GetRowMinimalHeight(int row) const
+{
+    wxLongToLongHashMap::key_type key = (wxLongToLongHashMap::key_type)row;
+    wxLongToLongHashMap::const_iterator it = m_rowMinHeights.find(key);
+
+    return it != m_rowMinHeights.end() ? (int)it->second : m_minAcceptableRowHeight;
+}
+
+void wxGrid::SetColMinimalAcceptableWidth( int width )
+{
+    // We do allow a width of 0 since this gives us
+    // an easy way to temporarily hiding columns.
+    if ( width >= 0 )
+        m_minAcceptableColWidth = width;
+}
+
+void wxGrid::SetRowMinimalAcceptableHeight( int height )
+{
+    // We do allow a height of 0 since this gives us
+    // an easy way to temporarily hiding rows.
+    if ( height >= 0 )
+        m_minAcceptableRowHeight = height;
+}
+
+int  wxGrid::GetColMinimalAcceptableWidth() const
+{
+    return m_minAcceptableColWidth;
+}
+
+int  wxGrid::GetRowMinimalAcceptableHeight() const
+{
+    return m_minAcceptableRowHeight;
+}
+
+// ----------------------------------------------------------------------------
+// auto sizing
+// ----------------------------------------------------------------------------
+
+#if wxUSE_GRAPHICS_CONTEXT
+
+namespace
+{
+
+// Maximal number of cells whose text is collected before measuring it, this
+// limits the memory used for auto-sizing big grids.
+const size_t AUTOSIZE_CELLS_PER_BATCH = 65536;
+
+// Minimal number of cells to measure in each thread.
+const int AUTOSIZE_MIN_CELLS_PER_THREAD = 512;
+
+// The text of a cell to measure for auto-sizing its column or row.
+struct AutoSizeCellText
+{
+    wxString text;
+
+    // Index of the font of the cell in the array of all fonts.
+    int font;
+
+    // Offset of the column or row being auto-sized from the first one.
+    int line;
+
+    // Number of columns or rows spanned by the cell, its extent is spread
+    // evenly between all of them.
+    int span;
+
+    // The cell itself and the attribute and renderer used for it, we hold a
+    // reference to both of them to be able to measure it in the same way as
+    // in the default mode if necessary.
+    int row,
+        col;
+    wxGridCellAttr* attr;
+    wxGridCellRenderer* renderer;
+
+    // The extent of the cell computed by AutoSizeTask.
+    wxCoord extent;
+};
+
+typedef wxVector<AutoSizeCellText> AutoSizeCellsText;
+
+// All the different fonts used by the cells being measured.
+class AutoSizeFonts
+{
+public:
+    AutoSizeFonts()
+    {
+        m_last = -1;
+    }
+
+    const wxVector<wxFont>& Get() const { return m_fonts; }
+
+    // Return the index of the font, adding it if necessary.
+    int GetIndex(const wxFont& font)
+    {
+        // Most cells use the same font, so check the last used one first.
+        if ( m_last != -1 && m_fonts[m_last] == font )
+            return m_last;
+
+        for ( m_last = 0; m_last < (int)m_fonts.size(); m_last++ )
+        {
+            if ( m_fonts[m_last] == font )
+                return m_last;
+        }
+
+        m_fonts.push_back(font);
+
+        return m_last;
+    }
+
+private:
+    wxVector<wxFont> m_fonts;
+    int m_last;
+};
+
+// Context used for measuring the text of the cells in a single thread: it
+// contains its own copies of all graphics objects which are not thread-safe
+// and so can't be shared between threads.
+class AutoSizeMeasuringContext
+{
+public:
+    explicit AutoSizeMeasuringContext(wxGraphicsContext* gc)
+        : m_gc(gc)
+    {
+        m_font = -1;
+    }
+
+    ~AutoSizeMeasuringContext()
+    {
+        delete m_gc;
+    }
+
+    // Create the graphics fonts for all the fonts not created yet, this must
+    // be called from the main thread.
+    void UpdateFonts(const wxVector<wxFont>& fonts)
+    {
+        for ( size_t n = m_fonts.size(); n < fonts.size(); n++ )
+            m_fonts.push_back(m_gc->CreateFont(fonts[n]));
+    }
+
+    // Compute the extent of the text in the same way as
+    // wxGridCellStringRenderer::DoGetBestSize() does it, but using the
+    // graphics context which can be done in any thread.
+    wxCoord GetExtent(const AutoSizeCellText& cell, bool width)
+    {
+        if ( cell.font != m_font )
+        {
+            m_gc->SetFont(m_fonts[cell.font]);
+            m_font = cell.font;
+        }
+
+        wxCoord x = 0, y = 0, maxX = 0;
+        wxStringTokenizer tk(cell.text, wxT('\n'));
+        while ( tk.HasMoreTokens() )
+        {
+            wxDouble w, h;
+            m_gc->GetTextExtent(tk.GetNextToken(), &w, &h);
+
+            // Round in the same way as wxGCDC does.
+            x = (wxCoord)(w + 0.5);
+            y = (wxCoord)(h + 0.5);
+            maxX = wxMax(maxX, x);
+        }
+
+        return width ? maxX : y * (1 + cell.text.Freq(wxT('\n')));
+    }
+
+private:
+    wxGraphicsContext* const m_gc;
+    wxVector<wxGraphicsFont> m_fonts;
+
+    // Index of the currently selected font or -1.
+    int m_font;
+
+    wxDECLARE_NO_COPY_CLASS(AutoSizeMeasuringContext);
+};
+
+// Task measuring the cells text: the cells are split in as many contiguous
+// chunks as there are measuring contexts and each chunk is processed using
+// its own context.
+class AutoSizeTask : public wxParallelTask
+{
+public:
+    AutoSizeTask(AutoSizeCellsText& cells,
+                 const wxVector<AutoSizeMeasuringContext*>& contexts,
+                 bool width)
+        : m_cells(cells),
+          m_contexts(contexts),
+          m_width(width)
+    {
+    }
+
+    virtual void ProcessRange(int first, int last) wxOVERRIDE
     {
-        // need to really create the array
-        InitColWidths();
+        const size_t numCells = m_cells.size(),
+                     numChunks = m_contexts.size();
+
+        for ( int chunk = first; chunk < last; chunk++ )
+        {
+            AutoSizeMeasuringContext& context = *m_contexts[chunk];
+
+            const size_t end = numCells * (chunk + 1) / numChunks;
+            for ( size_t n = numCells * chunk / numChunks; n < end; n++ )
+            {
+                AutoSizeCellText& cell = m_cells[n];
+                cell.extent = context.GetExtent(cell, m_width);
+            }
+        }
     }
 
-    const int diff = UpdateRowOrColSize(m_colWidths[col], width);
-    if ( !diff )
-        return;
+private:
+    AutoSizeCellsText& m_cells;
+    const wxVector<AutoSizeMeasuringContext*>& m_contexts;
+    const bool m_width;
 
-    if ( m_useNativeHeader )
-        GetGridColHeader()->UpdateColumn(col);
-    //else: will be refreshed when the header is redrawn
+    wxDECLARE_NO_COPY_CLASS(AutoSizeTask);
+};
 
-    for ( int colPos = GetColPos(col); colPos < m_numCols; colPos++ )
+// Object measuring the collected cells text using as many threads as
+// possible.
+class AutoSizeMeasurer
+{
+public:
+    AutoSizeMeasurer()
     {
-        m_colRights[GetColAt(colPos)] += diff;
+        m_renderer = wxGraphicsRenderer::GetDefaultRenderer();
     }
 
-    InvalidateBestSize();
+    ~AutoSizeMeasurer()
+    {
+        for ( size_t n = 0; n < m_contexts.size(); n++ )
+            delete m_contexts[n];
+    }
 
-    if ( !GetBatchCount() )
+    // Return false if measuring contexts can't be created.
+    bool IsOk()
     {
-        CalcDimensions();
-        Refresh();
+        return m_renderer && GetContexts(1);
     }
-}
 
-void wxGrid::SetColMinimalWidth( int col, int width )
-{
-    if (width > GetColMinimalAcceptableWidth())
+    // Compute the extents of all the cells.
+    void Measure(AutoSizeCellsText& cells,
+                 const wxVector<wxFont>& fonts,
+                 bool width)
     {
-        wxLongToLongHashMap::key_type key = (wxLongToLongHashMap::key_type)col;
-        m_colMinWidths[key] = width;
+#if wxUSE_THREADS
+        int numChunks = wxPrivate::wxGetParallelThreadsCount();
+        if ( (int)cells.size() / AUTOSIZE_MIN_CELLS_PER_THREAD < numChunks )
+            numChunks = cells.size() / AUTOSIZE_MIN_CELLS_PER_THREAD;
+        if ( numChunks < 1 )
+            numChunks = 1;
+#else // !wxUSE_THREADS
+        const int numChunks = 1;
+#endif // wxUSE_THREADS/!wxUSE_THREADS
+
+        // Contexts were already successfully created in IsOk(), so if we
+        // fail to create more of them now, just use the existing ones.
+        while ( !GetContexts(numChunks) )
+            numChunks = m_contexts.size();
+
+        // All graphics objects must be created in this thread and the task
+        // uses exactly numChunks contexts, so remember the others.
+        wxVector<AutoSizeMeasuringContext*> contexts;
+        for ( int n = 0; n < numChunks; n++ )
+        {
+            m_contexts[n]->UpdateFonts(fonts);
+            contexts.push_back(m_contexts[n]);
+        }
+
+        AutoSizeTask task(cells, contexts, width);
+        wxRunParallelTask(task, numChunks, 1);
     }
-}
 
-void wxGrid::SetRowMinimalHeight( int row, int width )
-{
-    if (width > GetRowMinimalAcceptableHeight())
+private:
+    // Ensure that we have at least the given number of contexts.
+    bool GetContexts(int count)
     {
-        wxLongToLongHashMap::key_type key = (wxLongToLongHashMap::key_type)row;
-        m_rowMinHeights[key] = width;
+        while ( (int)m_contexts.size() < count )
+        {
+            wxGraphicsContext* const gc = m_renderer->CreateMeasuringContext();
+            if ( !gc )
+                return false;
+
+            m_contexts.push_back(new AutoSizeMeasuringContext(gc));
+        }
+
+        return true;
     }
-}
 
-int wxGrid::GetColMinimalWidth(int col) const
-{
-    wxLongToLongHashMap::key_type key = (wxLongToLongHashMap::key_type)col;
-    wxLongToLongHashMap::const_iterator it = m_colMinWidths.find(key);
+    wxGraphicsRenderer* m_renderer;
+    wxVector<AutoSizeMeasuringContext*> m_contexts;
 
-    return it != m_colMinWidths.end() ? (int)it->second : m_minAcceptableColWidth;
-}
+    wxDECLARE_NO_COPY_CLASS(AutoSizeMeasurer);
+};
 
-int wxGrid::GetRowMinimalHeight(int row) const
+// Return the maximal difference between the extent of the text computed by
+// AutoSizeMeasuringContext and by wxDC: they can differ slightly, e.g. due to
+// rounding or hinting, but not by more than this.
+inline wxCoord GetAutoSizeExtentTolerance(wxCoord extent)
 {
-    wxLongToLongHashMap::key_type key = (wxLongToLongHashMap::key_type)row;
-    wxLongToLongHashMap::const_iterator it = m_rowMinHeights.find(key);
-
-    return it != m_rowMinHeights.end() ? (int)it->second : m_minAcceptableRowHeight;
+    return 2 + extent / 16;
 }
 
-void wxGrid::SetColMinimalAcceptableWidth( int width )
+// Compare the cells by their extent per line in decreasing order.
+bool AutoSizeCellHasBiggerExtent(const AutoSizeCellText* cell1,
+                                 const AutoSizeCellText* cell2)
 {
-    // We do allow a width of 0 since this gives us
-    // an easy way to temporarily hiding columns.
-    if ( width >= 0 )
-        m_minAcceptableColWidth = width;
+    return cell1->extent / cell1->span > cell2->extent / cell2->span;
 }
 
-void wxGrid::SetRowMinimalAcceptableHeight( int height )
-{
-    // We do allow a height of 0 since this gives us
-    // an easy way to temporarily hiding rows.
-    if ( height >= 0 )
-        m_minAcceptableRowHeight = height;
+// Measure all the collected cells and update the extents of their columns or
+// rows.
+//
+// Results must be exactly the same as in the default mode, so the approximate
+// extents computed in parallel are only used to find the cells which can't be
+// the biggest ones in their column or row: all the others are measured again
+// by their renderers using the given DC, in decreasing order of their extent
+// to skip as many of them as possible.
+void MeasureAutoSizeCells(wxGrid& grid,
+                          wxDC& dc,
+                          AutoSizeMeasurer& measurer,
+                          AutoSizeCellsText& cells,
+                          const AutoSizeFonts& fonts,
+                          bool width,
+                          wxArrayInt& extents)
+{
+    measurer.Measure(cells, fonts.Get(), width);
+
+    wxVector<AutoSizeCellText*> sorted;
+    sorted.reserve(cells.size());
+    for ( size_t n = 0; n < cells.size(); n++ )
+        sorted.push_back(&cells[n]);
+
+    std::sort(sorted.begin(), sorted.end(), AutoSizeCellHasBiggerExtent);
+
+    for ( size_t n = 0; n < sorted.size(); n++ )
+    {
+        const AutoSizeCellText& cell = *sorted[n];
+
+        const wxCoord
+            extentMax = cell.extent + GetAutoSizeExtentTolerance(cell.extent);
+        if ( extentMax / cell.span <= extents[cell.line] )
+            continue;
+
+        const wxCoord extent = width
+            ? cell.renderer->GetBestWidth(grid, *cell.attr, dc,
+                                          cell.row, cell.col,
+                                          grid.GetRowHeight(cell.row))
+            : cell.renderer->GetBestHeight(grid, *cell.attr, dc,
+                                           cell.row, cell.col,
+                                           grid.GetColWidth(cell.col));
+
+        if ( extent / cell.span > extents[cell.line] )
+            extents[cell.line] = extent / cell.span;
+    }
+
+    for ( size_t n = 0; n < cells.size(); n++ )
+    {
+        cells[n].renderer->DecRef();
+        cells[n].attr->DecRef();
+    }
+
+    cells.clear();
 }
 
-int  wxGrid::GetColMinimalAcceptableWidth() const
+} // anonymous namespace
+
+#endif // wxUSE_GRAPHICS_CONTEXT
+
+void wxGrid::SetAutoSizeMode(int mode, int maxSampledRows)
 {
-    return m_minAcceptableColWidth;
+    wxCHECK_RET( maxSampledRows > 0, "invalid number of sampled rows" );
+
+    m_autoSizeMode = mode;
+    m_autoSizeMaxSampledRows = maxSampledRows;
 }
 
-int  wxGrid::GetRowMinimalAcceptableHeight() const
+void wxGrid::GetAutoSizeSampledRows(int col, wxArrayInt& rows) const
 {
-    return m_minAcceptableRowHeight;
-}
+    rows.clear();
 
-// ----------------------------------------------------------------------------
-// auto sizing
-// ----------------------------------------------------------------------------
+    // Half of the sample is taken by the rows with the longest values in this
+    // column as they're the most likely to be the widest ones.
+    typedef std::pair<size_t, int> LengthAndRow;
+    typedef std::greater<LengthAndRow> LongerThan;
+
+    const size_t numLongest = m_autoSizeMaxSampledRows / 2;
+
+    wxVector<LengthAndRow> longest;
+    longest.reserve(numLongest);
+    for ( int row = 0; row < m_numRows && numLongest; row++ )
+    {
+        if ( !IsRowShown(row) )
+            continue;
+
+        const LengthAndRow item(GetCellValue(row, col).length(), row);
+
+        // Keep a heap with the shortest of the longest values at its front.
+        if ( longest.size() < numLongest )
+        {
+            longest.push_back(item);
+            std::push_heap(longest.begin(), longest.end(), LongerThan());
+        }
+        else if ( item.first > longest.front().first )
+        {
+            std::pop_heap(longest.begin(), longest.end(), LongerThan());
+            longest.back() = item;
+            std::push_heap(longest.begin(), longest.end(), LongerThan());
+        }
+    }
+
+    for ( size_t n = 0; n < longest.size(); n++ )
+        rows.push_back(longest[n].second);
+
+    // And the other half is spread evenly over all the rows to account for
+    // the values whose width doesn't depend on their length only.
+    const int numSpread = m_autoSizeMaxSampledRows - numLongest;
+    for ( int n = 0; n < numSpread; n++ )
+        rows.push_back((int)((wxLongLong_t)n * m_numRows / numSpread));
+
+    std::sort(rows.begin(), rows.end());
+
+    const size_t count = std::unique(rows.begin(), rows.end()) - rows.begin();
+    if ( count < rows.size() )
+        rows.RemoveAt(count, rows.size() - count);
+}
 
 void
-wxGrid::AutoSizeColOrRow(int colOrRow, bool setAsMin, wxGridDirection direction)
+wxGrid::CalcColsOrRowsContentsExtents(int first,
+                                      int count,
+                                      wxGridDirection direction,
+                                      wxArrayInt& extents)
 {
     const bool column = direction == wxGRID_COLUMN;
 
-    // We don't support auto-sizing hidden rows or columns, this doesn't seem
-    // to make much sense.
-    if ( column )
-    {
-        if ( GetColWidth(colOrRow) == 0 )
-            return;
-    }
-    else
-    {
-        if ( GetRowHeight(colOrRow) == 0 )
-            return;
-    }
+    extents.clear();
+    extents.Add(0, count);
 
     wxClientDC dc(m_gridWin);
 
-    // cancel editing of cell
-    HideCellEditControl();
-    SaveEditControlValue();
+#if wxUSE_GRAPHICS_CONTEXT
+    // In parallel mode, the cells whose best size is just the size of their
+    // text are collected in this array and measured in batches using
+    // graphics contexts in several threads, and then only those of them
+    // which may be the biggest ones are measured again using the DC, while
+    // all the others are measured immediately. Without graphics contexts
+    // support, parallel mode is simply ignored.
+    AutoSizeCellsText cells;
+    AutoSizeFonts fonts;
+    wxString text;
 
-    // initialize both of them just to avoid compiler warnings even if only
-    // really needs to be initialized here
-    int row,
-        col;
-    if ( column )
-    {
-        row = -1;
-        col = colOrRow;
-    }
-    else
-    {
-        row = colOrRow;
-        col = -1;
-    }
+    AutoSizeMeasurer measurer;
+    const bool parallel = (m_autoSizeMode & wxGRID_AUTOSIZE_PARALLEL) &&
+                            measurer.IsOk();
+#endif // wxUSE_GRAPHICS_CONTEXT
+
+    const bool sample = column &&
+                        (m_autoSizeMode & wxGRID_AUTOSIZE_SAMPLE) &&
+                        m_numRows > m_autoSizeMaxSampledRows;
 
-    wxCoord extent, extentMax = 0;
-    int max = column ? m_numRows : m_numCols;
-    for ( int rowOrCol = 0; rowOrCol < max; rowOrCol++ )
+    wxArrayInt sampledRows;
+
+    for ( int line = 0; line < count; line++ )
     {
-        if ( column )
-        {
-            if ( !IsRowShown(rowOrCol) )
-                continue;
+        const int colOrRow = first + line;
 
-            row = rowOrCol;
-            col = colOrRow;
-        }
-        else
-        {
-            if ( !IsColShown(rowOrCol) )
-                continue;
+        if ( column ? !IsColShown(colOrRow) : !IsRowShown(colOrRow) )
+            continue;
 
-            row = colOrRow;
-            col = rowOrCol;
-        }
+        if ( sample )
+            GetAutoSizeSampledRows(colOrRow, sampledRows);
 
-        // we need to account for the cells spanning multiple columns/rows:
-        // while they may need a lot of space, they don't need all of it in
-        // this column/row
-        int numRows, numCols;
-        const CellSpan span = GetCellSize(row, col, &numRows, &numCols);
-        if ( span == CellSpan_Inside )
+        // initialize both of them just to avoid compiler warnings even if
+        // only really needs to be initialized here
+        int row,
+            col;
+
+        const int max = sample ? (int)sampledRows.size()
+                               : column ? m_numRows : m_numCols;
+        for ( int n = 0; n < max; n++ )
         {
-            // we need to get the size of the main cell, not of a cell hidden
-            // by it
-            row += numRows;
-            col += numCols;
+            const int rowOrCol = sample ? sampledRows[n] : n;
 
-            // get the size of the main cell too
-            GetCellSize(row, col, &numRows, &numCols);
-        }
+            if ( column )
+            {
+                if ( !IsRowShown(rowOrCol) )
+                    continue;
 
-        // get cell ( main cell if CellSpan_Inside ) renderer best size
-        wxGridCellAttr *attr = GetCellAttr(row, col);
-        wxGridCellRenderer *renderer = attr->GetRenderer(this, row, col);
-        if ( renderer )
-        {
-            extent = column
+                row = rowOrCol;
+                col = colOrRow;
+            }
+            else
+            {
+                if ( !IsColShown(rowOrCol) )
+                    continue;
+
+                row = colOrRow;
+                col = rowOrCol;
+            }
+
+            // we need to account for the cells spanning multiple columns/rows:
+            // while they may need a lot of space, they don't need all of it in
+            // this column/row
+            int numRows, numCols;
+            const CellSpan span = GetCellSize(row, col, &numRows, &numCols);
+            if ( span == CellSpan_Inside )
+            {
+                // we need to get the size of the main cell, not of a cell hidden
+                // by it
+                row += numRows;
+                col += numCols;
+
+                // get the size of the main cell too
+                GetCellSize(row, col, &numRows, &numCols);
+            }
+
+            // get cell ( main cell if CellSpan_Inside ) renderer best size
+            wxGridCellAttr *attr = GetCellAttr(row, col);
+            wxGridCellRenderer *renderer = attr->GetRenderer(this, row, col);
+            if ( renderer )
+            {
+#if wxUSE_GRAPHICS_CONTEXT
+                if ( parallel &&
+                        renderer->GetBestSizeText(*this, *attr, row, col, &text) )
+                {
+                    AutoSizeCellText cell;
+                    cell.text = text;
+                    cell.font = fonts.GetIndex(attr->GetFont());
+                    cell.line = line;
+                    cell.span = span == CellSpan_None ? 1
+                                                      : column ? numCols
+                                                               : numRows;
+                    cell.row = row;
+                    cell.col = col;
+                    cell.attr = attr;
+                    cell.renderer = renderer;
+                    attr->IncRef();
+                    renderer->IncRef();
+                    cells.push_back(cell);
+
+                    if ( cells.size() == AUTOSIZE_CELLS_PER_BATCH )
+                        MeasureAutoSizeCells(*this, dc, measurer, cells, fonts,
+                                             column, extents);
+                }
+                else
+#endif // wxUSE_GRAPHICS_CONTEXT
+                {
+                    wxCoord extent = column
                         ? renderer->GetBestWidth(*this, *attr, dc, row, col,
                                                  GetRowHeight(row))
                         : renderer->GetBestHeight(*this, *attr, dc, row, col,
                                                   GetColWidth(col));
 
-            if ( span != CellSpan_None )
-            {
-                // we spread the size of a spanning cell over all the cells it
-                // covers evenly -- this is probably not ideal but we can't
-                // really do much better here
-                //
-                // notice that numCols and numRows are never 0 as they
-                // correspond to the size of the main cell of the span and not
-                // of the cell inside it
-                extent /= column ? numCols : numRows;
-            }
+                    if ( span != CellSpan_None )
+                    {
+                        // we spread the size of a spanning cell over all the
+                        // cells it covers evenly -- this is probably not
+                        // ideal but we can't really do much better here
+                        //
+                        // notice that numCols and numRows are never 0 as
+                        // they correspond to the size of the main cell of the
+                        // span and not of the cell inside it
+                        extent /= column ? numCols : numRows;
+                    }
 
-            if ( extent > extentMax )
-                extentMax = extent;
+                    if ( extent > extents[line] )
+                        extents[line] = extent;
+                }
+
+                renderer->DecRef();
+            }
 
-            renderer->DecRef();
+            attr->DecRef();
         }
+    }
 
-        attr->DecRef();
+#if wxUSE_GRAPHICS_CONTEXT
+    if ( !cells.empty() )
+        MeasureAutoSizeCells(*this, dc, measurer, cells, fonts, column,
+                             extents);
+#endif // wxUSE_GRAPHICS_CONTEXT
+}
+
+void
+wxGrid::AutoSizeColOrRow(int colOrRow, bool setAsMin, wxGridDirection direction)
+{
+    // We don't support auto-sizing hidden rows or columns, this doesn't seem
+    // to make much sense.
+    if ( direction == wxGRID_COLUMN )
+    {
+        if ( GetColWidth(colOrRow) == 0 )
+            return;
     }
+    else
+    {
+        if ( GetRowHeight(colOrRow) == 0 )
+            return;
+    }
+
+    // cancel editing of cell
+    HideCellEditControl();
+    SaveEditControlValue();
+
+    wxArrayInt extents;
+    CalcColsOrRowsContentsExtents(colOrRow, 1, direction, extents);
+
+    DoAutoSizeColOrRow(colOrRow, setAsMin, direction, extents[0]);
+}
+
+void
+wxGrid::DoAutoSizeColOrRow(int colOrRow,
+                           bool setAsMin,
+                           wxGridDirection direction,
+                           wxCoord extentMax)
+{
+    const bool column = direction == wxGRID_COLUMN;
 
-    // now also compare with the column label extent
+    wxClientDC dc(m_gridWin);
+
+    // compare the extent of the contents with the label extent
     wxCoord w, h;
     dc.SetFont( GetLabelFont() );
 
@@ -8458,7 +9518,7 @@ wxGrid::AutoSizeColOrRow(int colOrRow, bool setAsMin, wxGridDirection direction)
     else
         dc.GetMultiLineTextExtent( GetRowLabelValue(colOrRow), &w, &h );
 
-    extent = column ? w : h;
+    const wxCoord extent = column ? w : h;
     if ( extent > extentMax )
         extentMax = extent;
 
@@ -8597,10 +9657,22 @@ int wxGrid::SetOrCalcColumnSizes(bool calcOnly, bool setAsMin)
     if(!calcOnly)
         locker.Create(this);
 
+    // measure the contents of all columns at once, this is more efficient in
+    // parallel mode than measuring them one by one
+    wxArrayInt extents;
+    if ( !calcOnly )
+    {
+        HideCellEditControl();
+        SaveEditControlValue();
+
+        CalcColsOrRowsContentsExtents(0, m_numCols, wxGRID_COLUMN, extents);
+    }
+
     for ( int col = 0; col < m_numCols; col++ )
     {
-        if ( !calcOnly )
-            AutoSizeColumn(col, setAsMin);
+        // notice that hidden columns are not auto-sized, as in AutoSizeColumn()
+        if ( !calcOnly && GetColWidth(col) != 0 )
+            DoAutoSizeColOrRow(col, setAsMin, wxGRID_COLUMN, extents[col]);
 
         width += GetColWidth(col);
     }
@@ -8616,10 +9688,22 @@ int wxGrid::SetOrCalcRowSizes(bool calcOnly, bool setAsMin)
     if(!calcOnly)
         locker.Create(this);
 
+    // measure the contents of all rows at once, this is more efficient in
+    // parallel mode than measuring them one by one
+    wxArrayInt extents;
+    if ( !calcOnly )
+    {
+        HideCellEditControl();
+        SaveEditControlValue();
+
+        CalcColsOrRowsContentsExtents(0, m_numRows, wxGRID_ROW, extents);
+    }
+
     for ( int row = 0; row < m_numRows; row++ )
     {
-        if ( !calcOnly )
-            AutoSizeRow(row, setAsMin);
+        // notice that hidden rows are not auto-sized, as in AutoSizeRow()
+        if ( !calcOnly && GetRowHeight(row) != 0 )
+            DoAutoSizeColOrRow(row, setAsMin, wxGRID_ROW, extents[row]);
 
         height += GetRowHeight(row);
     }
@@ -9094,6 +10178,103 @@ int wxGridSizesInfo::GetSize(unsigned pos) const
     return it->second;
 }
 
+// ----------------------------------------------------------------------------
+// wxGridLineEnds
+// ----------------------------------------------------------------------------
+
+void
+wxGridLineEnds::Init(const wxArrayInt& sizes,
+                     const wxArrayInt& order,
+                     int sizeDefault)
+{
+    m_sizeDefault = sizeDefault;
+
+    const size_t count = sizes.size();
+
+    m_tree.Empty();
+    m_tree.Alloc(count);
+    for ( size_t pos = 0; pos < count; pos++ )
+    {
+        // Ignore the sizes of the currently hidden lines.
+        const int size = sizes[order.empty() ? pos : order[pos]];
+        m_tree.Add((size > 0 ? size : 0) - m_sizeDefault);
+    }
+
+    // Build the tree in linear time by adding each element to its parent.
+    for ( size_t i = 1; i <= count; i++ )
+    {
+        const size_t parent = i + (i & (0 - i));
+        if ( parent <= count )
+            m_tree[parent - 1] += m_tree[i - 1];
+    }
+}
+
+void wxGridLineEnds::AppendDefault(int count)
+{
+    const int countOld = m_tree.size();
+    const int sumOld = GetSum(countOld);
+
+    m_tree.Alloc(countOld + count);
+    for ( int i = countOld + 1; i <= countOld + count; i++ )
+    {
+        // The differences for the new lines are 0, so the new element only
+        // contains the sum of those for the old lines it covers, if any.
+        const int first = i - (i & -i);
+        m_tree.Add(first < countOld ? sumOld - GetSum(first) : 0);
+    }
+}
+
+int wxGridLineEnds::GetSum(int count) const
+{
+    int sum = 0;
+    for ( int i = count; i > 0; i -= i & -i )
+        sum += m_tree[i - 1];
+
+    return sum;
+}
+
+int wxGridLineEnds::GetEnd(int pos) const
+{
+    return (pos + 1)*m_sizeDefault + GetSum(pos + 1);
+}
+
+void wxGridLineEnds::Add(int pos, int diff)
+{
+    const int count = m_tree.size();
+    for ( int i = pos + 1; i <= count; i += i & -i )
+        m_tree[i - 1] += diff;
+}
+
+int wxGridLineEnds::FindPos(int coord) const
+{
+    // As the sizes of all lines are non-negative, their ends are sorted and we
+    // can descend the tree looking for the last line ending before or at
+    // coord, the element i of the tree covers (i & -i) lines.
+    const int count = m_tree.size();
+
+    int step = 1;
+    while ( step <= count / 2 )
+        step *= 2;
+
+    int pos = 0,
+        end = 0;
+    for ( ; step > 0; step /= 2 )
+    {
+        const int next = pos + step;
+        if ( next > count )
+            continue;
+
+        const int endNext = end + m_tree[next - 1] + step*m_sizeDefault;
+        if ( endNext <= coord )
+        {
+            pos = next;
+            end = endNext;
+        }
+    }
+
+    return pos;
+}
+
 // ----------------------------------------------------------------------------
 // drop target
 // ----------------------------------------------------------------------------
@@ -30,7 +30,30 @@
 
 #include "wx/tokenzr.h"
 #include "wx/renderer.h"
+#include "wx/typeinfo.h"
 
+namespace
+{
+
+// The standard renderers only return the text to measure from their
+// GetBestSizeText() if they are used directly and not via a derived class,
+// which could override GetBestSize() to compute the size differently: such
+// classes must override GetBestSizeText() themselves to allow measuring their
+// text.
+template <class T>
+inline bool IsRendererExactlyOf(const wxGridCellRenderer& renderer)
+{
+#ifndef wxNO_RTTI
+    return wxTypeId(renderer) == wxTypeId(T);
+#else // wxNO_RTTI
+    // we can't check the exact class of the renderer without RTTI, so be
+    // conservative and always measure the cells in the default way
+    wxUnusedVar(renderer);
+    return false;
+#endif // !wxNO_RTTI/wxNO_RTTI
+}
+
+} // anonymous namespace
 
 // ----------------------------------------------------------------------------
 // wxGridCellRenderer
@@ -162,6 +185,19 @@ wxSize wxGridCellDateTimeRenderer::GetBestSize(wxGrid& grid,
     return DoGetBestSize(attr, dc, GetString(grid, row, col));
 }
 
+bool wxGridCellDateTimeRenderer::GetBestSizeText(wxGrid& grid,
+                                                 wxGridCellAttr& WXUNUSED(attr),
+                                                 int row, int col,
+                                                 wxString* text)
+{
+    if ( !IsRendererExactlyOf<wxGridCellDateTimeRenderer>(*this) )
+        return false;
+
+    *text = GetString(grid, row, col);
+
+    return true;
+}
+
 void wxGridCellDateTimeRenderer::SetParameters(const wxString& params)
 {
     if (!params.empty())
@@ -239,6 +275,19 @@ wxSize wxGridCellEnumRenderer::GetBestSize(wxGrid& grid,
     return DoGetBestSize(attr, dc, GetString(grid, row, col));
 }
 
+bool wxGridCellEnumRenderer::GetBestSizeText(wxGrid& grid,
+                                             wxGridCellAttr& WXUNUSED(attr),
+                                             int row, int col,
+                                             wxString* text)
+{
+    if ( !IsRendererExactlyOf<wxGridCellEnumRenderer>(*this) )
+        return false;
+
+    *text = GetString(grid, row, col);
+
+    return true;
+}
+
 void wxGridCellEnumRenderer::SetParameters(const wxString& params)
 {
     if ( !params )
@@ -556,6 +605,19 @@ wxSize wxGridCellStringRenderer::GetBestSize(wxGrid& grid,
     return DoGetBestSize(attr, dc, grid.GetCellValue(row, col));
 }
 
+bool wxGridCellStringRenderer::GetBestSizeText(wxGrid& grid,
+                                               wxGridCellAttr& WXUNUSED(attr),
+                                               int row, int col,
+                                               wxString* text)
+{
+    if ( !IsRendererExactlyOf<wxGridCellStringRenderer>(*this) )
+        return false;
+
+    *text = grid.GetCellValue(row, col);
+
+    return true;
+}
+
 void wxGridCellStringRenderer::Draw(wxGrid& grid,
                                     wxGridCellAttr& attr,
                                     wxDC& dc,
@@ -705,6 +767,19 @@ wxSize wxGridCellNumberRenderer::GetBestSize(wxGrid& grid,
     return DoGetBestSize(attr, dc, GetString(grid, row, col));
 }
 
+bool wxGridCellNumberRenderer::GetBestSizeText(wxGrid& grid,
+                                               wxGridCellAttr& WXUNUSED(attr),
+                                               int row, int col,
+                                               wxString* text)
+{
+    if ( !IsRendererExactlyOf<wxGridCellNumberRenderer>(*this) )
+        return false;
+
+    *text = GetString(grid, row, col);
+
+    return true;
+}
+
 // ----------------------------------------------------------------------------
 // wxGridCellFloatRenderer
 // ----------------------------------------------------------------------------
@@ -820,6 +895,19 @@ wxSize wxGridCellFloatRenderer::GetBestSize(wxGrid& grid,
     return DoGetBestSize(attr, dc, GetString(grid, row, col));
 }
 
+bool wxGridCellFloatRenderer::GetBestSizeText(wxGrid& grid,
+                                              wxGridCellAttr& WXUNUSED(attr),
+                                              int row, int col,
+                                              wxString* text)
+{
+    if ( !IsRendererExactlyOf<wxGridCellFloatRenderer>(*this) )
+        return false;
+
+    *text = GetString(grid, row, col);
+
+    return true;
+}
+
 void wxGridCellFloatRenderer::SetParameters(const wxString& params)
 {
     if ( !params )
@@ -305,6 +305,18 @@ wxHtmlWordCell::wxHtmlWordCell(const wxString& word, const wxDC& dc) : wxHtmlCel
     m_allowLinebreak = true;
 }
 
+wxHtmlWordCell::wxHtmlWordCell(const wxString& word,
+                               wxCoord width, wxCoord height, wxCoord descent)
+    : wxHtmlCell()
+{
+    m_Word = word;
+    m_Width = width;
+    m_Height = height;
+    m_Descent = descent;
+    SetCanLiveOnPagebreak(false);
+    m_allowLinebreak = true;
+}
+
 void wxHtmlWordCell::SetPreviousWord(wxHtmlWordCell *cell)
 {
     if ( cell && m_Parent == cell->m_Parent &&
@@ -678,7 +690,7 @@ void wxHtmlContainerCell::SetIndent(int i, int what, int units)
     if (what & wxHTML_INDENT_RIGHT) m_IndentRight = val;
     if (what & wxHTML_INDENT_TOP) m_IndentTop = val;
     if (what & wxHTML_INDENT_BOTTOM) m_IndentBottom = val;
-    m_LastLayout = -1;
+    InvalidateLayout();
 }
 
 
@@ -1172,7 +1184,15 @@ void wxHtmlContainerCell::InsertCell(wxHtmlCell *f)
         if (m_LastCell) while (m_LastCell->GetNext()) m_LastCell = m_LastCell->GetNext();
     }
     f->SetParent(this);
-    m_LastLayout = -1;
+    InvalidateLayout();
+}
+
+
+
+void wxHtmlContainerCell::InvalidateLayout()
+{
+    for ( wxHtmlContainerCell *c = this; c; c = c->GetParent() )
+        c->m_LastLayout = -1;
 }
 
 
@@ -1191,7 +1211,7 @@ void wxHtmlContainerCell::SetAlign(const wxHtmlTag& tag)
             SetAlignHor(wxHTML_ALIGN_JUSTIFY);
         else if (alg == wxT("RIGHT"))
             SetAlignHor(wxHTML_ALIGN_RIGHT);
-        m_LastLayout = -1;
+        InvalidateLayout();
     }
 }
 
@@ -1211,7 +1231,7 @@ void wxHtmlContainerCell::SetWidthFloat(const wxHtmlTag& tag, double pixel_scale
         {
             SetWidthFloat((int)(pixel_scale * (double)wdi), wxHTML_UNITS_PIXELS);
         }
-        m_LastLayout = -1;
+        InvalidateLayout();
     }
 }
 
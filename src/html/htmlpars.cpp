@@ -66,9 +66,59 @@ public:
     wxHtmlTextPieces  *m_textPieces;
     int                m_curTextPiece;
     const wxString    *m_source;
+    wxHtmlParserIncrementalData *m_incremental;
     wxHtmlParserState *m_nextState;
 };
 
+class wxHtmlParserIncrementalData
+{
+public:
+    // The part of the source between pos and end remaining to be parsed
+    // inside the given tag (which is NULL for the entire source).
+    struct Frame
+    {
+        Frame() : tag(NULL) {}
+        Frame(wxHtmlTag *tag_,
+              const wxString::const_iterator& pos_,
+              const wxString::const_iterator& end_)
+            : tag(tag_), pos(pos_), end(end_) {}
+
+        wxHtmlTag *tag;
+        wxString::const_iterator pos, end;
+    };
+
+    wxHtmlParserIncrementalData() : m_cache(NULL), m_lazyTag(NULL) {}
+    ~wxHtmlParserIncrementalData() { Clear(); }
+
+    void Start(const wxString& source)
+    {
+        Clear();
+        m_cache = new wxHtmlTagsCache(source);
+        m_frames.push_back(Frame(NULL, source.begin(), source.end()));
+    }
+
+    // Stack of the tags being parsed, innermost last.
+    wxVector<Frame> m_frames;
+
+    wxHtmlTagsCache *m_cache;
+
+    // The tag passed to AddTag() by ParseNextPart() while its children are
+    // not created yet.
+    wxHtmlTag *m_lazyTag;
+
+private:
+    void Clear()
+    {
+        // The outermost tag on the stack owns all the other ones.
+        if ( m_frames.size() > 1 )
+            delete m_frames[1].tag;
+        m_frames.clear();
+        wxDELETE(m_cache);
+    }
+
+    wxDECLARE_NO_COPY_CLASS(wxHtmlParserIncrementalData);
+};
+
 //-----------------------------------------------------------------------------
 // wxHtmlParser
 //-----------------------------------------------------------------------------
@@ -86,11 +136,13 @@ wxHtmlParser::wxHtmlParser()
     m_TextPieces = NULL;
     m_CurTextPiece = 0;
     m_SavedStates = NULL;
+    m_incremental = NULL;
 }
 
 wxHtmlParser::~wxHtmlParser()
 {
     while (RestoreState()) {}
+    delete m_incremental;
     DestroyDOMTree();
 
     WX_CLEAR_ARRAY(m_HandlersStack);
@@ -101,6 +153,9 @@ wxHtmlParser::~wxHtmlParser()
 
 wxObject* wxHtmlParser::Parse(const wxString& source)
 {
+    // abandon incremental parsing, if any
+    wxDELETE(m_incremental);
+
     InitParser(source);
     DoParsing();
     wxObject *result = GetProduct();
@@ -114,8 +169,17 @@ void wxHtmlParser::InitParser(const wxString& source)
     m_stopParsing = false;
 }
 
+void wxHtmlParser::InitParserIncrementally(const wxString& source)
+{
+    delete m_incremental;
+    m_incremental = new wxHtmlParserIncrementalData;
+
+    InitParser(source);
+}
+
 void wxHtmlParser::DoneParser()
 {
+    wxDELETE(m_incremental);
     DestroyDOMTree();
 }
 
@@ -131,7 +195,17 @@ void wxHtmlParser::SetSource(const wxString& src)
     //     on the heap.
     delete m_Source;
     m_Source = new wxString(src);
-    CreateDOMTree();
+    if ( m_incremental )
+    {
+        // Only create the DOM tree for the part of the source being parsed
+        // in ParseNextPart() and not for all of it at once.
+        m_TextPieces = new wxHtmlTextPieces;
+        m_incremental->Start(*m_Source);
+    }
+    else
+    {
+        CreateDOMTree();
+    }
     m_CurTag = NULL;
     m_CurTextPiece = 0;
 }
@@ -267,6 +341,20 @@ void wxHtmlParser::DoParsing(const wxString::const_iterator& begin_pos_,
     if (end_pos <= begin_pos)
         return;
 
+    if ( m_incremental && m_incremental->m_lazyTag )
+    {
+        // The handler of the tag being parsed by ParseNextPart() parses its
+        // contents, so create the DOM subtree for them now.
+        wxHtmlTag * const tag = m_incremental->m_lazyTag;
+        m_incremental->m_lazyTag = NULL;
+
+        m_TextPieces->clear();
+        CreateDOMSubTree(tag, tag->GetBeginIter(), tag->GetEndIter1(),
+                         m_incremental->m_cache);
+        m_CurTag = tag->GetChildren();
+        m_CurTextPiece = 0;
+    }
+
     wxHtmlTextPieces& pieces = *m_TextPieces;
     size_t piecesCnt = pieces.size();
 
@@ -319,10 +407,126 @@ void wxHtmlParser::AddTag(const wxHtmlTag& tag)
     if (!inner)
     {
         if (tag.HasEnding())
+        {
+            if ( m_incremental && &tag == m_incremental->m_lazyTag &&
+                    !wxIsCDATAElement(tag.GetName()) )
+            {
+                // Let ParseNextPart() parse the contents of this tag part by
+                // part instead of doing it all at once.
+                m_incremental->m_frames.push_back(
+                    wxHtmlParserIncrementalData::Frame(
+                        m_incremental->m_lazyTag,
+                        tag.GetBeginIter(), tag.GetEndIter1()));
+                m_incremental->m_lazyTag = NULL;
+                return;
+            }
+
             DoParsing(tag.GetBeginIter(), tag.GetEndIter1());
+        }
     }
 }
 
+bool wxHtmlParser::ParseNextPart(size_t maxLength)
+{
+    wxCHECK_MSG( m_incremental, false,
+                 "InitParserIncrementally() must be called first" );
+
+    typedef wxHtmlParserIncrementalData::Frame Frame;
+    wxVector<Frame>& frames = m_incremental->m_frames;
+
+    size_t parsed = 0;
+    while ( !frames.empty() && !m_stopParsing )
+    {
+        // the tag to destroy at the end of this iteration, if any
+        wxHtmlTag *done = NULL;
+
+        Frame& frame = frames.back();
+        if ( frame.pos >= frame.end )
+        {
+            done = frame.tag;
+            frames.pop_back();
+        }
+        else if ( parsed && parsed >= maxLength )
+        {
+            // always parse something, even if maxLength is 0
+            break;
+        }
+        else if ( *frame.pos != wxT('<') )
+        {
+            wxString::const_iterator i = frame.pos;
+            while ( i < frame.end && *i != wxT('<') )
+                ++i;
+
+            const wxString text(frame.pos, i);
+            parsed += i - frame.pos;
+            frame.pos = i;
+
+            AddText(GetEntitiesParser()->Parse(text));
+        }
+        else
+        {
+            const wxString::const_iterator start = frame.pos;
+            wxString::const_iterator i = start;
+
+            if ( SkipCommentTag(i, m_Source->end()) )
+            {
+                frame.pos = i + 1;
+                parsed += frame.pos - start;
+            }
+            else if ( i < frame.end - 1 && *(i + 1) != wxT('/') )
+            {
+                wxHtmlTag * const tag = new wxHtmlTag(frame.tag, m_Source,
+                                                      i, frame.end,
+                                                      m_incremental->m_cache,
+                                                      m_entitiesParser);
+                frame.pos = tag->HasEnding() ? tag->GetEndIter2()
+                                             : tag->GetBeginIter();
+                const wxString::const_iterator next = frame.pos;
+
+                // notice that AddTag() may add a new frame, invalidating the
+                // frame reference
+                const size_t depth = frames.size();
+                m_incremental->m_lazyTag = tag->HasEnding() ? tag : NULL;
+                AddTag(*tag);
+                m_incremental->m_lazyTag = NULL;
+                m_CurTag = NULL;
+
+                if ( frames.size() > depth )
+                {
+                    // the contents of the tag will be parsed by the next
+                    // iterations
+                    parsed += tag->GetBeginIter() - start;
+                }
+                else
+                {
+                    parsed += next - start;
+                    done = tag;
+                }
+            }
+            else // skip ending tag
+            {
+                while ( i < frame.end && *i != wxT('>') )
+                    ++i;
+                frame.pos = i < frame.end ? i + 1 : i;
+                parsed += frame.pos - start;
+            }
+        }
+
+        if ( done )
+        {
+            // All the previous children of the parent tag were already
+            // destroyed, so this is its only child.
+            if ( done->m_Parent )
+                done->m_Parent->m_FirstChild =
+                done->m_Parent->m_LastChild = NULL;
+
+            delete done;
+        }
+    }
+
+    return !frames.empty() && !m_stopParsing;
+}
+
 void wxHtmlParser::AddTagHandler(wxHtmlTagHandler *handler)
 {
     wxString s(handler->GetSupportedTags());
@@ -370,6 +574,7 @@ void wxHtmlParser::SetSourceAndSaveState(const wxString& src)
     s->m_textPieces = m_TextPieces;
     s->m_curTextPiece = m_CurTextPiece;
     s->m_source = m_Source;
+    s->m_incremental = m_incremental;
 
     s->m_nextState = m_SavedStates;
     m_SavedStates = s;
@@ -379,6 +584,7 @@ void wxHtmlParser::SetSourceAndSaveState(const wxString& src)
     m_TextPieces = NULL;
     m_CurTextPiece = 0;
     m_Source = NULL;
+    m_incremental = NULL;
 
     SetSource(src);
 }
@@ -398,6 +604,7 @@ bool wxHtmlParser::RestoreState()
     m_TextPieces = s->m_textPieces;
     m_CurTextPiece = s->m_curTextPiece;
     m_Source = s->m_source;
+    m_incremental = s->m_incremental;
 
     delete s;
     return true;
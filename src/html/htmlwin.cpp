@@ -31,6 +31,7 @@
 #include "wx/html/htmlproc.h"
 #include "wx/clipbrd.h"
 #include "wx/recguard.h"
+#include "wx/stopwatch.h"
 
 #include "wx/arrimpl.cpp"
 #include "wx/listimpl.cpp"
@@ -303,6 +304,8 @@ void wxHtmlWindow::CleanUpStatics()
 void wxHtmlWindow::Init()
 {
     m_tmpCanDrawLocks = 0;
+    m_incrementalLayoutTime = 0;
+    m_pendingScrollPos = -1;
     m_FS = new wxFileSystem();
 #if wxUSE_STATUSBAR
     m_RelatedStatusBar = NULL;
@@ -364,6 +367,9 @@ wxHtmlWindow::~wxHtmlWindow()
 
     delete m_selection;
 
+    if ( m_Parser->IsParsingIncrementally() )
+        m_Parser->DoneParser();
+
     delete m_Cell;
 
     if ( m_Processors )
@@ -444,6 +450,12 @@ bool wxHtmlWindow::DoSetPage(const wxString& source)
     // we will soon delete all the cells, so clear pointers to them:
     m_tmpSelFromCell = NULL;
 
+    // stop parsing the previous page if it's still being parsed incrementally
+    if ( m_Parser->IsParsingIncrementally() )
+        m_Parser->DoneParser();
+    m_pendingAnchor.clear();
+    m_pendingScrollPos = -1;
+
     // pass HTML through registered processors:
     if (m_Processors || m_GlobalProcessors)
     {
@@ -493,7 +505,20 @@ bool wxHtmlWindow::DoSetPage(const wxString& source)
     // wxDELETE() and not just delete here
     wxDELETE(m_Cell);
 
-    m_Cell = (wxHtmlContainerCell*) m_Parser->Parse(newsrc);
+    if ( HasFlag(wxHW_INCREMENTAL) )
+    {
+        // Only create the top level cell now, the rest of the page will be
+        // parsed and shown part by part by ParseNextPagePart().
+        m_Parser->InitParserIncrementally(newsrc);
+
+        m_Cell = m_Parser->GetContainer();
+        while ( m_Cell->GetParent() )
+            m_Cell = m_Cell->GetParent();
+    }
+    else
+    {
+        m_Cell = (wxHtmlContainerCell*) m_Parser->Parse(newsrc);
+    }
 
     // The parser doesn't need the DC any more, so ensure it's not left with a
     // dangling pointer after the DC object goes out of scope.
@@ -501,12 +526,101 @@ bool wxHtmlWindow::DoSetPage(const wxString& source)
 
     m_Cell->SetIndent(m_Borders, wxHTML_INDENT_ALL, wxHTML_UNITS_PIXELS);
     m_Cell->SetAlignHor(wxHTML_ALIGN_CENTER);
+
+    if ( m_Parser->IsParsingIncrementally() )
+    {
+        // Show the beginning of the page immediately, OnIdle() will take
+        // care of the rest. Notice that ParseNextPagePart() preserves the
+        // current scroll position, so reset it for the new page first.
+        m_incrementalLayoutTime = 0;
+        Scroll(0, 0);
+        ParseNextPagePart();
+        return true;
+    }
+
     CreateLayout();
     if (m_tmpCanDrawLocks == 0)
         Refresh();
     return true;
 }
 
+bool wxHtmlWindow::ParseNextPagePart()
+{
+    // Minimal time to spend parsing before laying the page out again, in
+    // milliseconds.
+    static const long MIN_PARSE_TIME = 50;
+
+    wxClientDC dc(this);
+    dc.SetMapMode(wxMM_TEXT);
+    m_Parser->SetDC(&dc);
+
+    // The font used by the parser must be selected into the new DC.
+    m_Parser->CreateCurrentFont();
+
+    // Laying out the page takes longer as it grows, so parse for at least
+    // twice as long as the last layout took to avoid spending most of the
+    // time in it.
+    const long parseTime = wxMax(MIN_PARSE_TIME, 2*m_incrementalLayoutTime);
+
+    wxStopWatch sw;
+    bool more;
+    do
+    {
+        more = m_Parser->ParseNextPart();
+    } while ( more && sw.Time() < parseTime );
+
+    if ( !more )
+    {
+        m_Parser->GetProduct();
+        m_Parser->DoneParser();
+    }
+
+    m_Parser->SetDC(NULL);
+
+    // CreateLayout() resets the scroll position, but the page shouldn't jump
+    // back to its top whenever a new part is shown, so restore it.
+    int xViewStart, yViewStart;
+    GetViewStart(&xViewStart, &yViewStart);
+
+    sw.Start();
+    CreateLayout();
+    m_incrementalLayoutTime = sw.Time();
+
+    Scroll(xViewStart, yViewStart);
+
+    // Scroll to the position restored from history if it couldn't be done
+    // before because the page wasn't long enough yet.
+    if ( m_pendingScrollPos != -1 )
+    {
+        Scroll(0, m_pendingScrollPos);
+
+        GetViewStart(&xViewStart, &yViewStart);
+        if ( !more || yViewStart == m_pendingScrollPos )
+            m_pendingScrollPos = -1;
+    }
+
+    if ( !m_pendingAnchor.empty() &&
+            (!more || m_Cell->Find(wxHTML_COND_ISANCHOR, &m_pendingAnchor)) )
+    {
+        const wxString anchor(m_pendingAnchor);
+        m_pendingAnchor.clear();
+        ScrollToAnchor(anchor);
+    }
+
+    if (m_tmpCanDrawLocks == 0)
+        Refresh();
+
+    return more;
+}
+
+void wxHtmlWindow::OnIdle(wxIdleEvent& event)
+{
+    event.Skip();
+
+    if ( m_Parser->IsParsingIncrementally() && ParseNextPagePart() )
+        event.RequestMore();
+}
+
 bool wxHtmlWindow::AppendToPage(const wxString& source)
 {
     return DoSetPage(*(GetParser()->GetSource()) + source);
@@ -670,8 +784,19 @@ bool wxHtmlWindow::LoadFile(const wxFileName& filename)
 
 bool wxHtmlWindow::ScrollToAnchor(const wxString& anchor)
 {
+    // going to an anchor overrides any position restored from history
+    m_pendingScrollPos = -1;
+
     const wxHtmlCell *c = m_Cell->Find(wxHTML_COND_ISANCHOR, &anchor);
-    if (!c)
+    if (!c && m_Parser->IsParsingIncrementally())
+    {
+        // The anchor may be in the part of the page which is not parsed yet,
+        // ParseNextPagePart() will scroll to it later.
+        m_pendingAnchor = anchor;
+        m_OpenedAnchor = anchor;
+        return true;
+    }
+    else if (!c)
     {
         wxLogWarning(_("HTML anchor %s does not exist."), anchor.c_str());
         return false;
@@ -896,11 +1021,26 @@ bool wxHtmlWindow::HistoryBack()
     else LoadPage(l + wxT("#") + a);
     m_HistoryOn = true;
     m_tmpCanDrawLocks--;
-    Scroll(0, (*m_History)[m_HistoryPos].GetPos());
+    ScrollToHistoryPos();
     Refresh();
     return true;
 }
 
+void wxHtmlWindow::ScrollToHistoryPos()
+{
+    const int pos = (*m_History)[m_HistoryPos].GetPos();
+    Scroll(0, pos);
+
+    // If the page is still being parsed, it may be too short to scroll to
+    // this position yet, so let ParseNextPagePart() do it later. This takes
+    // precedence over any anchor, as when not parsing incrementally.
+    if ( m_Parser->IsParsingIncrementally() )
+    {
+        m_pendingAnchor.clear();
+        m_pendingScrollPos = pos;
+    }
+}
+
 bool wxHtmlWindow::HistoryCanBack()
 {
     if (m_HistoryPos < 1) return false;
@@ -926,7 +1066,7 @@ bool wxHtmlWindow::HistoryForward()
     else LoadPage(l + wxT("#") + a);
     m_HistoryOn = true;
     m_tmpCanDrawLocks--;
-    Scroll(0, (*m_History)[m_HistoryPos].GetPos());
+    ScrollToHistoryPos();
     Refresh();
     return true;
 }
@@ -1704,6 +1844,7 @@ wxIMPLEMENT_DYNAMIC_CLASS_XTI(wxHtmlWindow, wxScrolledWindow,"wx/html/htmlwin.h"
 
 BEGIN_EVENT_TABLE(wxHtmlWindow, wxScrolledWindow)
     EVT_SIZE(wxHtmlWindow::OnSize)
+    EVT_IDLE(wxHtmlWindow::OnIdle)
     EVT_LEFT_DOWN(wxHtmlWindow::OnMouseDown)
     EVT_LEFT_UP(wxHtmlWindow::OnMouseUp)
     EVT_RIGHT_UP(wxHtmlWindow::OnMouseUp)
@@ -27,6 +27,146 @@
 #include "wx/html/styleparams.h"
 #include "wx/fontmap.h"
 #include "wx/uri.h"
+#include "wx/hashmap.h"
+#include "wx/math.h"
+#include "wx/vector.h"
+
+//-----------------------------------------------------------------------------
+// wxHtmlWordExtentsCache
+//-----------------------------------------------------------------------------
+
+struct wxHtmlWordExtent
+{
+    wxCoord width, height, descent;
+};
+
+WX_DECLARE_STRING_HASH_MAP(wxHtmlWordExtent, wxHtmlWordExtentsHash);
+
+// Most of the words in a document are used many times in the same font, so
+// remember their extents instead of measuring them again. The extents are
+// stored separately for each font, which is kept alive by the cache, so the
+// font identity can be used instead of comparing fonts.
+class wxHtmlWordExtentsCache
+{
+public:
+    wxHtmlWordExtentsCache()
+        : m_ppi(wxDefaultSize)
+    {
+        m_scaleX =
+        m_scaleY = 0.;
+        m_count = 0;
+        m_last = NULL;
+    }
+
+    ~wxHtmlWordExtentsCache() { Clear(); }
+
+    void Clear()
+    {
+        for ( size_t n = 0; n < m_fonts.size(); n++ )
+            delete m_fonts[n].extents;
+        m_fonts.clear();
+        m_count = 0;
+        m_last = NULL;
+    }
+
+    // Must be called before measuring words using a (possibly) different DC,
+    // forgets all extents if the DC resolution or scale changed.
+    void UseDC(const wxDC& dc)
+    {
+        const wxSize ppi = dc.GetPPI();
+        double scaleX, scaleY;
+        dc.GetUserScale(&scaleX, &scaleY);
+
+        if ( ppi != m_ppi ||
+                !wxIsSameDouble(scaleX, m_scaleX) ||
+                    !wxIsSameDouble(scaleY, m_scaleY) )
+        {
+            Clear();
+
+            m_ppi = ppi;
+            m_scaleX = scaleX;
+            m_scaleY = scaleY;
+        }
+    }
+
+    // Returns the extent of the word in the current font of the DC.
+    const wxHtmlWordExtent& Get(const wxDC& dc, const wxString& word)
+    {
+        wxHtmlWordExtentsHash& extents = GetExtentsForFont(dc.GetFont());
+
+        wxHtmlWordExtentsHash::iterator it = extents.find(word);
+        if ( it == extents.end() )
+        {
+            // Don't let the cache grow indefinitely if most of the words are
+            // unique, e.g. numbers in a big table.
+            if ( m_count == MAX_WORDS )
+            {
+                Clear();
+                return Get(dc, word);
+            }
+
+            wxHtmlWordExtent ext;
+            dc.GetTextExtent(word, &ext.width, &ext.height, &ext.descent);
+
+            it = extents.insert(wxHtmlWordExtentsHash::value_type(word, ext)).first;
+            m_count++;
+        }
+
+        return it->second;
+    }
+
+private:
+    enum
+    {
+        MAX_FONTS = 64,
+        MAX_WORDS = 100000
+    };
+
+    struct FontExtents
+    {
+        wxFont font;
+        wxHtmlWordExtentsHash *extents;
+    };
+
+    wxHtmlWordExtentsHash& GetExtentsForFont(const wxFont& font)
+    {
+        // The font rarely changes between the words, so check the last used
+        // one first.
+        if ( m_last && m_last->font.GetRefData() == font.GetRefData() )
+            return *m_last->extents;
+
+        for ( size_t n = 0; n < m_fonts.size(); n++ )
+        {
+            if ( m_fonts[n].font.GetRefData() == font.GetRefData() )
+            {
+                m_last = &m_fonts[n];
+                return *m_last->extents;
+            }
+        }
+
+        // The fonts are recreated when their face changes, so avoid keeping
+        // too many of them alive.
+        if ( m_fonts.size() == MAX_FONTS )
+            Clear();
+
+        FontExtents fe;
+        fe.font = font;
+        fe.extents = new wxHtmlWordExtentsHash;
+        m_fonts.push_back(fe);
+
+        m_last = &m_fonts.back();
+        return *m_last->extents;
+    }
+
+    wxVector<FontExtents> m_fonts;
+    FontExtents *m_last;
+    size_t m_count;
+
+    wxSize m_ppi;
+    double m_scaleX, m_scaleY;
+
+    wxDECLARE_NO_COPY_CLASS(wxHtmlWordExtentsCache);
+};
 
 
 //-----------------------------------------------------------------------------
@@ -44,6 +184,7 @@ wxHtmlWinParser::wxHtmlWinParser(wxHtmlWindowInterface *wndIface)
     m_windowInterface = wndIface;
     m_Container = NULL;
     m_DC = NULL;
+    m_wordExtents = new wxHtmlWordExtentsCache;
     m_CharHeight = m_CharWidth = 0;
     m_UseLink = false;
 #if !wxUSE_UNICODE
@@ -101,6 +242,7 @@ wxHtmlWinParser::~wxHtmlWinParser()
     delete m_EncConv;
 #endif
     delete[] m_tmpStrBuf;
+    delete m_wordExtents;
 }
 
 void wxHtmlWinParser::AddModule(wxHtmlTagsModule *module)
@@ -175,6 +317,9 @@ void wxHtmlWinParser::SetFonts(const wxString& normal_face,
                             m_FontsTable[i][j][k][l][m] = NULL;
                         }
                     }
+
+    // all the fonts will be recreated, so the old extents won't be used
+    m_wordExtents->Clear();
 }
 
 void wxHtmlWinParser::SetStandardFonts(int size,
@@ -452,6 +597,12 @@ void wxHtmlWinParser::FlushWordBuf(wxChar *buf, int& len)
     len = 0;
 }
 
+void wxHtmlWinParser::AddWord(const wxString& word)
+{
+    const wxHtmlWordExtent& ext = m_wordExtents->Get(*m_DC, word);
+    AddWord(new wxHtmlWordCell(word, ext.width, ext.height, ext.descent));
+}
+
 void wxHtmlWinParser::AddWord(wxHtmlWordCell *word)
 {
     ApplyStateToCell(word);
@@ -550,6 +701,9 @@ void wxHtmlWinParser::SetDC(wxDC *dc, double pixel_scale, double font_scale)
     m_DC = dc;
     m_PixelScale = pixel_scale;
     m_FontScale = font_scale;
+
+    if ( m_DC )
+        m_wordExtents->UseDC(*m_DC);
 }
 
 void wxHtmlWinParser::SetFontPointSize(int pt)
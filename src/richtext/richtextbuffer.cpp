@@ -1305,6 +1305,7 @@ size_t wxRichTextCompositeObject::AppendChild(wxRichTextObject* child)
 {
     m_children.Append(child);
     child->SetParent(this);
+    OnChildrenChanged();
     return m_children.GetCount() - 1;
 }
 
@@ -1319,6 +1320,7 @@ bool wxRichTextCompositeObject::InsertChild(wxRichTextObject* child, wxRichTextO
     else
         m_children.Insert(child);
     child->SetParent(this);
+    OnChildrenChanged();
 
     return true;
 }
@@ -1331,6 +1333,7 @@ bool wxRichTextCompositeObject::RemoveChild(wxRichTextObject* child, bool delete
     {
         wxRichTextObject* obj = node->GetData();
         m_children.Erase(node);
+        OnChildrenChanged();
         if (deleteChild)
             delete obj;
 
@@ -1354,6 +1357,8 @@ bool wxRichTextCompositeObject::DeleteChildren()
         m_children.Erase(oldNode);
     }
 
+    OnChildrenChanged();
+
     return true;
 }
 
@@ -1380,6 +1385,8 @@ void wxRichTextCompositeObject::Copy(const wxRichTextCompositeObject& obj)
 
         node = node->GetNext();
     }
+
+    OnChildrenChanged();
 }
 
 /// Hit-testing: returns a flag indicating hit test details, plus
@@ -1592,6 +1599,7 @@ bool wxRichTextCompositeObject::Defragment(wxRichTextDrawingContext& context, co
                         {
                             nextChild->Dereference();
                             m_children.Erase(node->GetNext());
+                            OnChildrenChanged();
                         }
                         else
                             node = node->GetNext();
@@ -1638,6 +1646,7 @@ bool wxRichTextCompositeObject::Defragment(wxRichTextDrawingContext& context, co
                         {
                             nextChild->Dereference();
                             m_children.Erase(node->GetNext());
+                            OnChildrenChanged();
 
                             // Don't set node -- we'll see if we can merge again with the next
                             // child. UNLESS we split this or the next child, in which case we know we have to
@@ -1676,6 +1685,7 @@ bool wxRichTextCompositeObject::Defragment(wxRichTextDrawingContext& context, co
                 {
                     child->Dereference();
                     m_children.Erase(node);
+                    OnChildrenChanged();
                 }
                 node = next;
             }
@@ -1887,6 +1897,8 @@ void wxRichTextParagraphLayoutBox::Init()
 
     m_partialParagraph = false;
     m_floatCollector = NULL;
+
+    m_positionIndexOk = false;
 }
 
 void wxRichTextParagraphLayoutBox::Clear()
@@ -2502,74 +2514,153 @@ bool wxRichTextParagraphLayoutBox::GetRangeSize(const wxRichTextRange& range, wx
     return true;
 }
 
-/// Get the paragraph at the given position
-wxRichTextParagraph* wxRichTextParagraphLayoutBox::GetParagraphAtPosition(long pos, bool caretPosition) const
+/// Called when children are added or removed
+void wxRichTextParagraphLayoutBox::OnChildrenChanged()
 {
-    if (caretPosition)
-        pos ++;
+    m_positionIndexOk = false;
+}
 
-    // First find the first paragraph whose starting position is within the range.
+/// Rebuild the position index if necessary
+bool wxRichTextParagraphLayoutBox::UpdatePositionIndex() const
+{
+    // Also check the number of children in case the list was modified directly.
+    if (m_positionIndexOk && m_positionIndex.size() == m_children.GetCount())
+        return true;
+
+    m_positionIndexOk = false;
+    m_positionIndex.clear();
+    m_positionIndex.reserve(m_children.GetCount());
+
+    // The index can only be used if the children ranges follow each other, which is not
+    // the case while they're being modified and before UpdateRanges() is called. Notice
+    // that the index remains valid when the ranges change after editing the text of the
+    // paragraphs, as only the objects themselves are stored in it.
+    long lastEnd = 0;
     wxRichTextObjectList::compatibility_iterator node = m_children.GetFirst();
     while (node)
     {
-        // child is a paragraph
-        wxRichTextParagraph* child = wxDynamicCast(node->GetData(), wxRichTextParagraph);
-        // wxASSERT (child != NULL);
+        wxRichTextObject* child = node->GetData();
+        const wxRichTextRange& range = child->GetRange();
+        if ((!m_positionIndex.empty() && range.GetStart() <= lastEnd) || range.GetEnd() < range.GetStart())
+        {
+            m_positionIndex.clear();
+            return false;
+        }
 
-        if (child)
+        m_positionIndex.push_back(child);
+        lastEnd = range.GetEnd();
+
+        node = node->GetNext();
+    }
+
+    m_positionIndexOk = true;
+
+    return true;
+}
+
+// Check that the ranges of the object at the given index of the position index
+// and of its neighbours still follow each other.
+static bool wxRichTextIsPositionIndexConsistentAt(const wxVector<wxRichTextObject*>& index, size_t n)
+{
+    const wxRichTextRange& range = index[n]->GetRange();
+    if (range.GetEnd() < range.GetStart())
+        return false;
+
+    if (n > 0 && index[n - 1]->GetRange().GetEnd() >= range.GetStart())
+        return false;
+
+    if (n + 1 < index.size() && index[n + 1]->GetRange().GetStart() <= range.GetEnd())
+        return false;
+
+    return true;
+}
+
+/// Get the child whose range contains the given position
+wxRichTextObject* wxRichTextParagraphLayoutBox::GetChildContainingPosition(long pos) const
+{
+    if (UpdatePositionIndex())
+    {
+        const size_t count = m_positionIndex.size();
+        if (count == 0)
+            return NULL;
+
+        // Find the first child ending at or after the position.
+        size_t lo = 0,
+               hi = count;
+        while (lo < hi)
+        {
+            const size_t mid = lo + (hi - lo) / 2;
+            if (m_positionIndex[mid]->GetRange().GetEnd() < pos)
+                lo = mid + 1;
+            else
+                hi = mid;
+        }
+
+        // The ranges were consecutive when the index was built, but they may have
+        // been changed since then without UpdateRanges() having been called yet, in
+        // which case the result of the search can't be trusted. Checking the child
+        // we found against its neighbours is enough to detect this in practice.
+        if (wxRichTextIsPositionIndexConsistentAt(m_positionIndex, lo < count ? lo : count - 1))
         {
-            // Return first child in buffer if position is -1
-            // if (pos == -1)
-            //    return child;
+            if (lo < count && m_positionIndex[lo]->GetRange().Contains(pos))
+                return m_positionIndex[lo];
 
-            if (child->GetRange().Contains(pos))
-                return child;
+            return NULL;
         }
 
+        // Revalidate the index the next time.
+        m_positionIndexOk = false;
+    }
+
+    wxRichTextObjectList::compatibility_iterator node = m_children.GetFirst();
+    while (node)
+    {
+        wxRichTextObject* child = node->GetData();
+        if (child->GetRange().Contains(pos))
+            return child;
+
         node = node->GetNext();
     }
+
     return NULL;
 }
 
+/// Get the paragraph at the given position
+wxRichTextParagraph* wxRichTextParagraphLayoutBox::GetParagraphAtPosition(long pos, bool caretPosition) const
+{
+    if (caretPosition)
+        pos ++;
+
+    // The children ranges don't overlap, so at most one of them contains the position.
+    return wxDynamicCast(GetChildContainingPosition(pos), wxRichTextParagraph);
+}
+
 /// Get the line at the given position
 wxRichTextLine* wxRichTextParagraphLayoutBox::GetLineAtPosition(long pos, bool caretPosition) const
 {
     if (caretPosition)
         pos ++;
 
-    // First find the first paragraph whose starting position is within the range.
-    wxRichTextObjectList::compatibility_iterator node = m_children.GetFirst();
-    while (node)
+    // First find the paragraph whose range contains the position.
+    wxRichTextParagraph* child = wxDynamicCast(GetChildContainingPosition(pos), wxRichTextParagraph);
+    if (child)
     {
-        wxRichTextObject* obj = (wxRichTextObject*) node->GetData();
-        if (obj->GetRange().Contains(pos))
+        wxRichTextLineList::compatibility_iterator node2 = child->GetLines().GetFirst();
+        while (node2)
         {
-            // child is a paragraph
-            wxRichTextParagraph* child = wxDynamicCast(obj, wxRichTextParagraph);
-            // wxASSERT (child != NULL);
-
-            if (child)
-            {
-                wxRichTextLineList::compatibility_iterator node2 = child->GetLines().GetFirst();
-                while (node2)
-                {
-                    wxRichTextLine* line = node2->GetData();
+            wxRichTextLine* line = node2->GetData();
 
-                    wxRichTextRange range = line->GetAbsoluteRange();
+            wxRichTextRange range = line->GetAbsoluteRange();
 
-                    if (range.Contains(pos) ||
+            if (range.Contains(pos) ||
 
-                        // If the position is end-of-paragraph, then return the last line of
-                        // of the paragraph.
-                        ((range.GetEnd() == child->GetRange().GetEnd()-1) && (pos == child->GetRange().GetEnd())))
-                        return line;
+                // If the position is end-of-paragraph, then return the last line of
+                // of the paragraph.
+                ((range.GetEnd() == child->GetRange().GetEnd()-1) && (pos == child->GetRange().GetEnd())))
+                return line;
 
-                    node2 = node2->GetNext();
-                }
-            }
+            node2 = node2->GetNext();
         }
-
-        node = node->GetNext();
     }
 
     int lineCount = GetLineCount();
@@ -35,6 +35,27 @@
 
 #define wxEpollDispatcher_Trace wxT("epolldispatcher")
 
+// ----------------------------------------------------------------------------
+// wxEpollEntry
+// ----------------------------------------------------------------------------
+
+struct wxEpollEntry
+{
+    wxEpollEntry(int fd_, wxFDIOHandler *handler_, int flags_)
+        : fd(fd_),
+          handler(handler_),
+          flags(flags_)
+    {
+    }
+
+    int fd;
+
+    // the handler is reset to NULL when the descriptor is unregistered
+    wxFDIOHandler *handler;
+
+    int flags;
+};
+
 // ============================================================================
 // implementation
 // ============================================================================
@@ -68,6 +89,12 @@ static uint32_t GetEpollMask(int flags, int fd)
                    wxT("Registered fd %d for exceptional events"), fd);
     }
 
+    if ( flags & wxFDIO_EDGE_TRIGGERED )
+        ep |= EPOLLET;
+
+    if ( flags & wxFDIO_ONESHOT )
+        ep |= EPOLLONESHOT;
+
     return ep;
 }
 
@@ -76,8 +103,10 @@ static uint32_t GetEpollMask(int flags, int fd)
 // ----------------------------------------------------------------------------
 
 /* static */
-wxEpollDispatcher *wxEpollDispatcher::Create()
+wxEpollDispatcher *wxEpollDispatcher::Create(int maxEvents)
 {
+    wxCHECK_MSG( maxEvents > 0, NULL, wxT("invalid number of events") );
+
     int epollDescriptor = epoll_create(1024);
     if ( epollDescriptor == -1 )
     {
@@ -86,14 +115,17 @@ wxEpollDispatcher *wxEpollDispatcher::Create()
     }
     wxLogTrace(wxEpollDispatcher_Trace,
                    wxT("Epoll fd %d created"), epollDescriptor);
-    return new wxEpollDispatcher(epollDescriptor);
+    return new wxEpollDispatcher(epollDescriptor, maxEvents);
 }
 
-wxEpollDispatcher::wxEpollDispatcher(int epollDescriptor)
+wxEpollDispatcher::wxEpollDispatcher(int epollDescriptor, int maxEvents)
 {
     wxASSERT_MSG( epollDescriptor != -1, wxT("invalid descriptor") );
 
     m_epollDescriptor = epollDescriptor;
+    m_events = new epoll_event[maxEvents];
+    m_maxEvents = maxEvents;
+    m_dispatchLevel = 0;
 }
 
 wxEpollDispatcher::~wxEpollDispatcher()
@@ -102,22 +134,74 @@ wxEpollDispatcher::~wxEpollDispatcher()
     {
         wxLogSysError(_("Error closing epoll descriptor"));
     }
+
+    for ( wxEpollEntryMap::iterator it = m_entries.begin();
+          it != m_entries.end();
+          ++it )
+    {
+        delete it->second;
+    }
+
+    DeleteRemovedEntries();
+
+    delete [] m_events;
 }
 
-bool wxEpollDispatcher::RegisterFD(int fd, wxFDIOHandler* handler, int flags)
+void wxEpollDispatcher::SetMaxEvents(int maxEvents)
+{
+    wxCHECK_RET( maxEvents > 0, wxT("invalid number of events") );
+    wxCHECK_RET( !m_dispatchLevel, wxT("can't be called while dispatching") );
+
+    delete [] m_events;
+    m_events = new epoll_event[maxEvents];
+    m_maxEvents = maxEvents;
+}
+
+bool wxEpollDispatcher::DoControl(int op, wxEpollEntry *entry)
 {
     epoll_event ev;
-    ev.events = GetEpollMask(flags, fd);
-    ev.data.ptr = handler;
+    ev.events = GetEpollMask(entry->flags, entry->fd);
+    ev.data.ptr = entry;
+
+    return epoll_ctl(m_epollDescriptor, op, entry->fd, &ev) == 0;
+}
+
+wxFDIOHandler *
+wxEpollDispatcher::GetEntryHandler(const wxEpollEntry *entry, int *flags)
+{
+    wxCRIT_SECT_LOCKER(lock, m_entriesLock);
+
+    if ( flags )
+        *flags = entry->flags;
+
+    return entry->handler;
+}
+
+void wxEpollDispatcher::DeleteRemovedEntries()
+{
+    for ( size_t n = 0; n < m_removedEntries.size(); n++ )
+        delete m_removedEntries[n];
+
+    m_removedEntries.clear();
+}
+
+bool wxEpollDispatcher::RegisterFD(int fd, wxFDIOHandler* handler, int flags)
+{
+    wxEpollEntry * const entry = new wxEpollEntry(fd, handler, flags);
 
-    const int ret = epoll_ctl(m_epollDescriptor, EPOLL_CTL_ADD, fd, &ev);
-    if ( ret != 0 )
+    wxCRIT_SECT_LOCKER(lock, m_entriesLock);
+
+    if ( !DoControl(EPOLL_CTL_ADD, entry) )
     {
         wxLogSysError(_("Failed to add descriptor %d to epoll descriptor %d"),
                       fd, m_epollDescriptor);
 
+        delete entry;
         return false;
     }
+
+    m_entries[fd] = entry;
+
     wxLogTrace(wxEpollDispatcher_Trace,
                wxT("Added fd %d (handler %p) to epoll %d"), fd, handler, m_epollDescriptor);
 
@@ -126,16 +210,24 @@ bool wxEpollDispatcher::RegisterFD(int fd, wxFDIOHandler* handler, int flags)
 
 bool wxEpollDispatcher::ModifyFD(int fd, wxFDIOHandler* handler, int flags)
 {
-    epoll_event ev;
-    ev.events = GetEpollMask(flags, fd);
-    ev.data.ptr = handler;
+    wxCRIT_SECT_LOCKER(lock, m_entriesLock);
+
+    const wxEpollEntryMap::iterator it = m_entries.find(fd);
+    wxCHECK_MSG( it != m_entries.end(), false,
+                 wxT("modifying unregistered descriptor?") );
 
-    const int ret = epoll_ctl(m_epollDescriptor, EPOLL_CTL_MOD, fd, &ev);
-    if ( ret != 0 )
+    wxEpollEntry * const entry = it->second;
+    const wxEpollEntry old(*entry);
+
+    entry->handler = handler;
+    entry->flags = flags;
+
+    if ( !DoControl(EPOLL_CTL_MOD, entry) )
     {
         wxLogSysError(_("Failed to modify descriptor %d in epoll descriptor %d"),
                       fd, m_epollDescriptor);
 
+        *entry = old;
         return false;
     }
 
@@ -150,11 +242,34 @@ bool wxEpollDispatcher::UnregisterFD(int fd)
     ev.events = 0;
     ev.data.ptr = NULL;
 
+    wxCRIT_SECT_LOCKER(lock, m_entriesLock);
+
     if ( epoll_ctl(m_epollDescriptor, EPOLL_CTL_DEL, fd, &ev) != 0 )
     {
         wxLogSysError(_("Failed to unregister descriptor %d from epoll descriptor %d"),
                       fd, m_epollDescriptor);
     }
+
+    const wxEpollEntryMap::iterator it = m_entries.find(fd);
+    if ( it != m_entries.end() )
+    {
+        wxEpollEntry * const entry = it->second;
+        m_entries.erase(it);
+
+        // if we're inside Dispatch(), there may be still events referencing
+        // this entry waiting to be processed, so just mark it as unregistered
+        // and delete it later
+        if ( m_dispatchLevel )
+        {
+            entry->handler = NULL;
+            m_removedEntries.push_back(entry);
+        }
+        else
+        {
+            delete entry;
+        }
+    }
+
     wxLogTrace(wxEpollDispatcher_Trace,
                 wxT("removed fd %d from %d"), fd, m_epollDescriptor);
     return true;
@@ -204,43 +319,106 @@ bool wxEpollDispatcher::HasPending() const
 
 int wxEpollDispatcher::Dispatch(int timeout)
 {
-    epoll_event events[16];
+    // if we're called recursively, e.g. because one of the handlers runs a
+    // nested event loop, we can't reuse m_events which is still being used
+    epoll_event nestedEvents[DEFAULT_MAX_EVENTS];
+    epoll_event *events;
+    int maxEvents;
 
-    const int rc = DoPoll(events, WXSIZEOF(events), timeout);
+    {
+        wxCRIT_SECT_LOCKER(lock, m_entriesLock);
+
+        if ( m_dispatchLevel++ )
+        {
+            events = nestedEvents;
+            maxEvents = WXSIZEOF(nestedEvents);
+        }
+        else
+        {
+            events = m_events;
+            maxEvents = m_maxEvents;
+        }
+    }
+
+    const int rc = DoPoll(events, maxEvents, timeout);
 
+    int numEvents = 0;
     if ( rc == -1 )
     {
         wxLogSysError(_("Waiting for IO on epoll descriptor %d failed"),
                       m_epollDescriptor);
-        return -1;
+        numEvents = -1;
     }
 
-    int numEvents = 0;
-    for ( epoll_event *p = events; p < events + rc; p++ )
+    for ( int n = 0; n < rc; n++ )
     {
-        wxFDIOHandler * const handler = (wxFDIOHandler *)(p->data.ptr);
+        const epoll_event * const p = &events[n];
+        const wxEpollEntry * const entry = (wxEpollEntry *)(p->data.ptr);
+
+        // the entry may be modified by ModifyFD() called from another thread
+        // (e.g. to re-arm a wxFDIO_ONESHOT descriptor) while we use it, so
+        // only access it while holding the lock
+        int flags;
+        wxFDIOHandler *handler = GetEntryHandler(entry, &flags);
         if ( !handler )
         {
-            wxFAIL_MSG( wxT("NULL handler in epoll_event?") );
+            // this descriptor was unregistered by one of the handlers called
+            // for the previous events
             continue;
         }
 
-        // note that for compatibility with wxSelectDispatcher we call
-        // OnReadWaiting() on EPOLLHUP as this is what epoll_wait() returns
-        // when the write end of a pipe is closed while with select() the
-        // remaining pipe end becomes ready for reading when this happens
-        if ( p->events & (EPOLLIN | EPOLLHUP) )
-            handler->OnReadWaiting();
-        else if ( p->events & EPOLLOUT )
-            handler->OnWriteWaiting();
-        else if ( p->events & EPOLLERR )
-            handler->OnExceptionWaiting();
+        if ( flags & wxFDIO_EDGE_TRIGGERED )
+        {
+            // the events are not going to be reported again, so we must
+            // notify the handler about all of them and not just the first one
+            bool notified = false;
+            if ( p->events & (EPOLLIN | EPOLLHUP) )
+            {
+                handler->OnReadWaiting();
+                notified = true;
+
+                // the handler could have been changed or unregistered
+                handler = GetEntryHandler(entry);
+            }
+
+            if ( handler && (p->events & EPOLLOUT) )
+            {
+                handler->OnWriteWaiting();
+                notified = true;
+            }
+
+            if ( !notified )
+            {
+                if ( !(p->events & EPOLLERR) )
+                    continue;
+
+                handler->OnExceptionWaiting();
+            }
+        }
         else
-            continue;
+        {
+            // note that for compatibility with wxSelectDispatcher we call
+            // OnReadWaiting() on EPOLLHUP as this is what epoll_wait() returns
+            // when the write end of a pipe is closed while with select() the
+            // remaining pipe end becomes ready for reading when this happens
+            if ( p->events & (EPOLLIN | EPOLLHUP) )
+                handler->OnReadWaiting();
+            else if ( p->events & EPOLLOUT )
+                handler->OnWriteWaiting();
+            else if ( p->events & EPOLLERR )
+                handler->OnExceptionWaiting();
+            else
+                continue;
+        }
 
         numEvents++;
     }
 
+    wxCRIT_SECT_LOCKER(lock, m_entriesLock);
+
+    if ( !--m_dispatchLevel )
+        DeleteRemovedEntries();
+
     return numEvents;
 }
 
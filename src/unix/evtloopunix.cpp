@@ -31,6 +31,7 @@
 
 #include "wx/apptrait.h"
 #include "wx/scopedptr.h"
+#include "wx/scopeguard.h"
 #include "wx/thread.h"
 #include "wx/module.h"
 #include "wx/unix/private/timer.h"
@@ -53,20 +54,51 @@
 // initialization
 //-----------------------------------------------------------------------------
 
-wxConsoleEventLoop::wxConsoleEventLoop()
+wxConsoleEventLoop::wxConsoleEventLoop(DispatcherKind kind)
 {
     // Be pessimistic initially and assume that we failed to initialize.
     m_dispatcher = NULL;
+    m_ownsDispatcher = false;
+#if wxUSE_TIMER
+    m_timerScheduler = NULL;
+#endif // wxUSE_TIMER
     m_wakeupPipe = NULL;
     m_wakeupSource = NULL;
 
+    // Create our own dispatcher if needed, notice that we can't install it as
+    // the one to use for the current thread yet because we may be created in
+    // a different thread from the one where we're going to run, so this is
+    // only done in DoRun().
+    //
+    // Also notice that only epoll-based dispatcher can be used here because
+    // the descriptors can be registered with it from other threads while it's
+    // waiting for events in the loop thread, e.g. when a server accepts a new
+    // connection for a socket using this loop, and wxSelectDispatcher doesn't
+    // support this: it is not MT-safe and wouldn't monitor the new descriptor
+    // until the next iteration of the loop anyhow.
+    wxScopedPtr<wxFDIODispatcher> ownDispatcher;
+    if ( kind == Dispatcher_Own )
+    {
+#if wxUSE_EPOLL_DISPATCHER
+        ownDispatcher.reset(wxEpollDispatcher::Create());
+#endif // wxUSE_EPOLL_DISPATCHER
+        if ( !ownDispatcher )
+            return;
+    }
+
     // Create the pipe.
     wxScopedPtr<wxWakeUpPipeMT> wakeupPipe(new wxWakeUpPipeMT);
     const int pipeFD = wakeupPipe->GetReadFd();
     if ( pipeFD == wxPipe::INVALID_FD )
         return;
 
-    // And start monitoring it in our event loop.
+    // And start monitoring it in our event loop: AddSourceForFD() uses the
+    // dispatcher returned by wxFDIODispatcher::Get(), so temporarily make it
+    // return our own one if we have it.
+    wxFDIODispatcher * const dispatcherOld = ownDispatcher
+        ? wxFDIODispatcher::SetForCurrentThread(ownDispatcher.get())
+        : NULL;
+
     m_wakeupSource = wxEventLoopBase::AddSourceForFD
                                       (
                                         pipeFD,
@@ -74,28 +106,51 @@ wxConsoleEventLoop::wxConsoleEventLoop()
                                         wxFDIO_INPUT
                                       );
 
+    // This is a bit ugly but we know that AddSourceForFD() used the currently
+    // active dispatcher to register this source, so use the same one for our
+    // other operations.
+    wxFDIODispatcher * const dispatcher = wxFDIODispatcher::Get();
+
+    if ( ownDispatcher )
+        wxFDIODispatcher::SetForCurrentThread(dispatcherOld);
+
     if ( !m_wakeupSource )
         return;
 
-    // This is a bit ugly but we know that AddSourceForFD() used the currently
-    // active dispatcher to register this source, so use the same one for our
-    // other operations. Of course, currently the dispatcher returned by
-    // wxFDIODispatcher::Get() is always the same one anyhow so it doesn't
-    // really matter, but if we started returning different things later, it
-    // would.
-    m_dispatcher = wxFDIODispatcher::Get();
+    m_dispatcher = dispatcher;
 
     m_wakeupPipe = wakeupPipe.release();
+
+    if ( ownDispatcher )
+    {
+        ownDispatcher.release();
+        m_ownsDispatcher = true;
+
+#if wxUSE_TIMER
+        m_timerScheduler = new wxTimerScheduler;
+#endif // wxUSE_TIMER
+    }
 }
 
 wxConsoleEventLoop::~wxConsoleEventLoop()
 {
+    DeleteScheduledObjects();
+
     if ( m_wakeupPipe )
     {
         delete m_wakeupSource;
 
         delete m_wakeupPipe;
     }
+
+    if ( m_ownsDispatcher )
+    {
+#if wxUSE_TIMER
+        delete m_timerScheduler;
+#endif // wxUSE_TIMER
+
+        delete m_dispatcher;
+    }
 }
 
 //-----------------------------------------------------------------------------
@@ -153,6 +208,90 @@ wxUnixEventLoopSource::~wxUnixEventLoopSource()
 // events dispatch and loop handling
 //-----------------------------------------------------------------------------
 
+#if wxUSE_TIMER
+
+namespace
+{
+
+// return the scheduler to use for the given loop
+inline wxTimerScheduler& GetSchedulerFor(wxTimerScheduler *loopScheduler)
+{
+    return loopScheduler ? *loopScheduler : wxTimerScheduler::Get();
+}
+
+} // anonymous namespace
+
+#endif // wxUSE_TIMER
+
+int wxConsoleEventLoop::DoRun()
+{
+    if ( !m_ownsDispatcher )
+        return BaseEventLoop::DoRun();
+
+    // Make the IO handlers registered and the timers started while we run,
+    // i.e. from the handlers of the events dispatched by this loop, use our
+    // dispatcher and timer scheduler instead of the global ones.
+    wxFDIODispatcher * const
+        dispatcherOld = wxFDIODispatcher::SetForCurrentThread(m_dispatcher);
+    wxON_BLOCK_EXIT1(wxFDIODispatcher::SetForCurrentThread, dispatcherOld);
+
+#if wxUSE_TIMER
+    wxTimerScheduler * const
+        schedulerOld = wxTimerScheduler::SetForCurrentThread(m_timerScheduler);
+    wxON_BLOCK_EXIT1(wxTimerScheduler::SetForCurrentThread, schedulerOld);
+#endif // wxUSE_TIMER
+
+    // Unlike the main loop, we don't process the application pending events
+    // nor generate idle events, this is still done by the main loop only.
+    while ( !m_shouldExit )
+        Dispatch();
+
+    return m_exitcode;
+}
+
+void wxConsoleEventLoop::ScheduleForDestruction(wxObject *object)
+{
+    {
+        wxCRIT_SECT_LOCKER(lock, m_objectsToDeleteLock);
+
+        m_objectsToDelete.push_back(object);
+    }
+
+    // We may be called from another thread while the loop is blocked waiting
+    // for events, so make sure it deletes the object soon.
+    if ( m_wakeupPipe )
+        WakeUp();
+}
+
+void wxConsoleEventLoop::DeleteScheduledObjects()
+{
+    // deleting an object may schedule more of them for deletion, so don't
+    // use iterators here and don't keep the lock while deleting them
+    for ( ;; )
+    {
+        wxObject *object;
+        {
+            wxCRIT_SECT_LOCKER(lock, m_objectsToDeleteLock);
+
+            if ( m_objectsToDelete.empty() )
+                break;
+
+            object = m_objectsToDelete.back();
+            m_objectsToDelete.pop_back();
+        }
+
+        delete object;
+    }
+}
+
+void wxConsoleEventLoop::OnExit()
+{
+    // Worker loops never become active, so don't notify the application about
+    // their exit either.
+    if ( !m_ownsDispatcher )
+        BaseEventLoop::OnExit();
+}
+
 bool wxConsoleEventLoop::Pending() const
 {
     if ( m_dispatcher->HasPending() )
@@ -160,7 +299,7 @@ bool wxConsoleEventLoop::Pending() const
 
 #if wxUSE_TIMER
     wxUsecClock_t nextTimer;
-    if ( wxTimerScheduler::Get().GetNext(&nextTimer) &&
+    if ( GetSchedulerFor(m_timerScheduler).GetNext(&nextTimer) &&
             !wxMilliClockToLong(nextTimer) )
         return true;
 #endif // wxUSE_TIMER
@@ -181,7 +320,8 @@ int wxConsoleEventLoop::DispatchTimeout(unsigned long timeout)
 #if wxUSE_TIMER
     // check if we need to decrease the timeout to account for a timer
     wxUsecClock_t nextTimer;
-    if ( wxTimerScheduler::Get().GetNext(&nextTimer) )
+    wxTimerScheduler& scheduler = GetSchedulerFor(m_timerScheduler);
+    if ( scheduler.GetNext(&nextTimer) )
     {
         unsigned long timeUntilNextTimer = wxMilliClockToLong(nextTimer / 1000);
         if ( timeUntilNextTimer < timeout )
@@ -192,10 +332,12 @@ int wxConsoleEventLoop::DispatchTimeout(unsigned long timeout)
     bool hadEvent = m_dispatcher->Dispatch(timeout) > 0;
 
 #if wxUSE_TIMER
-    if ( wxTimerScheduler::Get().NotifyExpired() )
+    if ( scheduler.NotifyExpired() )
         hadEvent = true;
 #endif // wxUSE_TIMER
 
+    DeleteScheduledObjects();
+
     return hadEvent ? 1 : -1;
 }
 
@@ -211,6 +353,9 @@ void wxConsoleEventLoop::WakeUp()
 void wxConsoleEventLoop::OnNextIteration()
 {
     // call the signal handlers for any signals we caught recently
+    //
+    // notice that this is only done by the main loop as it is never called
+    // for the worker ones
     wxTheApp->CheckSignal();
 }
 
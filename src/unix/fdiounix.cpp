@@ -33,9 +33,22 @@
 // wxFDIOManagerUnix implementation
 // ============================================================================
 
+namespace
+{
+
+// return the dispatcher to use for the given handler
+inline wxFDIODispatcher *GetDispatcherFor(const wxFDIOHandler *handler)
+{
+    wxFDIODispatcher * const dispatcher = handler->GetDispatcher();
+
+    return dispatcher ? dispatcher : wxFDIODispatcher::Get();
+}
+
+} // anonymous namespace
+
 int wxFDIOManagerUnix::AddInput(wxFDIOHandler *handler, int fd, Direction d)
 {
-    wxFDIODispatcher * const dispatcher = wxFDIODispatcher::Get();
+    wxFDIODispatcher * const dispatcher = GetDispatcherFor(handler);
     wxCHECK_MSG( dispatcher, -1, "can't monitor FDs without FD IO dispatcher" );
 
     // translate our direction to dispatcher flags
@@ -58,6 +71,10 @@ int wxFDIOManagerUnix::AddInput(wxFDIOHandler *handler, int fd, Direction d)
     if ( !ok )
         return -1;
 
+    // remember the dispatcher used, the handler must be modified and
+    // unregistered using the same one later
+    handler->SetDispatcher(dispatcher);
+
     // update the stored mask of registered events
     handler->SetRegisteredEvent(flag);
 
@@ -66,7 +83,7 @@ int wxFDIOManagerUnix::AddInput(wxFDIOHandler *handler, int fd, Direction d)
 
 void wxFDIOManagerUnix::RemoveInput(wxFDIOHandler *handler, int fd, Direction d)
 {
-    wxFDIODispatcher * const dispatcher = wxFDIODispatcher::Get();
+    wxFDIODispatcher * const dispatcher = GetDispatcherFor(handler);
     if ( !dispatcher )
         return;
 
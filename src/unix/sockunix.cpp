@@ -14,6 +14,7 @@
 
 #if wxUSE_SOCKETS
 
+#include "wx/evtloop.h"
 #include "wx/private/fd.h"
 #include "wx/private/socket.h"
 #include "wx/unix/private/sockunix.h"
@@ -96,6 +97,18 @@ void wxSocketImplUnix::DoEnableEvents(int flags, bool enable)
 
     if ( enable )
     {
+#if wxUSE_CONSOLE_EVENTLOOP
+        // if the socket uses a worker loop, it must be registered with its
+        // dispatcher and this must be done before the first registration
+        wxSocketBase * const wxsocket = GetWxSocket();
+        if ( !GetDispatcher() && wxsocket )
+        {
+            wxConsoleEventLoop * const loop = wxsocket->GetEventLoop();
+            if ( loop )
+                SetDispatcher(loop->GetDispatcher());
+        }
+#endif // wxUSE_CONSOLE_EVENTLOOP
+
         if ( flags & wxSOCKET_INPUT_FLAG )
             manager->Install_Callback(this, wxSOCKET_INPUT);
         if ( flags & wxSOCKET_OUTPUT_FLAG )
@@ -23,7 +23,6 @@
     #include "wx/log.h"
     #include "wx/module.h"
     #include "wx/app.h"
-    #include "wx/list.h"
     #include "wx/hashmap.h"
     #include "wx/event.h"
 #endif
@@ -31,6 +30,7 @@
 #include "wx/apptrait.h"
 #include "wx/longlong.h"
 #include "wx/time.h"
+#include "wx/tls.h"
 #include "wx/vector.h"
 
 #include <sys/time.h>
@@ -38,9 +38,6 @@
 
 #include "wx/unix/private/timer.h"
 
-#include "wx/listimpl.cpp"
-WX_DEFINE_LIST(wxTimerList)
-
 // trace mask for the debugging messages used here
 #define wxTrace_Timer wxT("timer")
 
@@ -50,58 +47,124 @@ WX_DEFINE_LIST(wxTimerList)
 
 wxTimerScheduler *wxTimerScheduler::ms_instance = NULL;
 
+namespace
+{
+
+// the scheduler used by the current thread instead of the global one, if any
+inline wxTLS_TYPE_REF(wxTimerScheduler*) GetThisThreadScheduler()
+{
+    static wxTLS_TYPE(wxTimerScheduler*) s_thisThreadScheduler;
+
+    return s_thisThreadScheduler;
+}
+
+} // anonymous namespace
+
+/* static */
+wxTimerScheduler& wxTimerScheduler::Get()
+{
+    wxTimerScheduler * const scheduler = wxTLS_VALUE(GetThisThreadScheduler());
+    if ( scheduler )
+        return *scheduler;
+
+    if ( !ms_instance )
+        ms_instance = new wxTimerScheduler;
+
+    return *ms_instance;
+}
+
+/* static */
+wxTimerScheduler *
+wxTimerScheduler::SetForCurrentThread(wxTimerScheduler *scheduler)
+{
+    wxTimerScheduler * const old = wxTLS_VALUE(GetThisThreadScheduler());
+    wxTLS_VALUE(GetThisThreadScheduler()) = scheduler;
+
+    return old;
+}
+
 wxTimerScheduler::~wxTimerScheduler()
 {
-    for ( wxTimerList::iterator node = m_timers.begin();
-          node != m_timers.end();
-          ++node )
-    {
-        delete *node;
-    }
+    // don't leave the timers pointing to this scheduler, they would try to
+    // remove themselves from it when stopped later
+    for ( size_t n = 0; n < m_timers.size(); n++ )
+        m_timers[n].m_timer->MarkStopped();
 }
 
-void wxTimerScheduler::AddTimer(wxUnixTimerImpl *timer, wxUsecClock_t expiration)
+void wxTimerScheduler::SiftUp(size_t n)
 {
-    DoAddTimer(new wxTimerSchedule(timer, expiration));
+    const wxTimerSchedule s = m_timers[n];
+    while ( n > 0 )
+    {
+        const size_t parent = (n - 1) / 2;
+        if ( !s.IsBefore(m_timers[parent]) )
+            break;
+
+        PutAt(n, m_timers[parent]);
+        n = parent;
+    }
+
+    PutAt(n, s);
 }
 
-void wxTimerScheduler::DoAddTimer(wxTimerSchedule *s)
+void wxTimerScheduler::SiftDown(size_t n)
 {
-    // do an insertion sort to keep the list sorted in expiration order
-    wxTimerList::iterator node;
-    for ( node = m_timers.begin(); node != m_timers.end(); ++node )
+    const size_t count = m_timers.size();
+    const wxTimerSchedule s = m_timers[n];
+    for ( ;; )
     {
-        wxASSERT_MSG( (*node)->m_timer != s->m_timer,
-                      wxT("adding the same timer twice?") );
+        size_t child = 2*n + 1;
+        if ( child >= count )
+            break;
+
+        if ( child + 1 < count && m_timers[child + 1].IsBefore(m_timers[child]) )
+            child++;
 
-        if ( (*node)->m_expiration > s->m_expiration )
+        if ( !m_timers[child].IsBefore(s) )
             break;
+
+        PutAt(n, m_timers[child]);
+        n = child;
     }
 
-    m_timers.insert(node, s);
+    PutAt(n, s);
+}
+
+void wxTimerScheduler::AddTimer(wxUnixTimerImpl *timer, wxUsecClock_t expiration)
+{
+    m_timers.push_back(wxTimerSchedule(timer, expiration, m_nextOrder++));
+    SiftUp(m_timers.size() - 1);
 
     wxLogTrace(wxTrace_Timer, wxT("Inserted timer %d expiring at %s"),
-               s->m_timer->GetId(),
-               s->m_expiration.ToString());
+               timer->GetId(),
+               expiration.ToString());
 }
 
 void wxTimerScheduler::RemoveTimer(wxUnixTimerImpl *timer)
 {
     wxLogTrace(wxTrace_Timer, wxT("Removing timer %d"), timer->GetId());
 
-    for ( wxTimerList::iterator node = m_timers.begin();
-          node != m_timers.end();
-          ++node )
+    const size_t n = timer->m_heapIndex;
+    wxCHECK_RET( n < m_timers.size() && m_timers[n].m_timer == timer,
+                 wxT("removing inexistent timer?") );
+
+    // replace the timer being removed with the last one and move the latter
+    // to its correct position
+    const size_t last = m_timers.size() - 1;
+    if ( n != last )
     {
-        if ( (*node)->m_timer == timer )
-        {
-            delete *node;
-            m_timers.erase(node);
-            return;
-        }
-    }
+        PutAt(n, m_timers[last]);
+        m_timers.pop_back();
 
-    wxFAIL_MSG( wxT("removing inexistent timer?") );
+        if ( n > 0 && m_timers[n].IsBefore(m_timers[(n - 1) / 2]) )
+            SiftUp(n);
+        else
+            SiftDown(n);
+    }
+    else
+    {
+        m_timers.pop_back();
+    }
 }
 
 bool wxTimerScheduler::GetNext(wxUsecClock_t *remaining) const
@@ -111,7 +174,7 @@ bool wxTimerScheduler::GetNext(wxUsecClock_t *remaining) const
 
     wxCHECK_MSG( remaining, false, wxT("NULL pointer") );
 
-    *remaining = (*m_timers.begin())->m_expiration - wxGetUTCTimeUSec();
+    *remaining = m_timers[0].m_expiration - wxGetUTCTimeUSec();
     if ( *remaining < 0 )
     {
         // timer already expired, don't wait at all before notifying it
@@ -128,35 +191,34 @@ bool wxTimerScheduler::NotifyExpired()
 
     const wxUsecClock_t now = wxGetUTCTimeUSec();
 
+    // first take all the expired timers from the heap: they are not added
+    // back to it immediately, even if they're periodic, as we would loop
+    // forever if the next expiration time of one of them had already passed
     typedef wxVector<wxUnixTimerImpl *> TimerImpls;
     TimerImpls toNotify;
-    for ( wxTimerList::iterator next,
-            cur = m_timers.begin(); cur != m_timers.end(); cur = next )
+    while ( !m_timers.empty() && m_timers[0].m_expiration <= now )
     {
-        wxTimerSchedule * const s = *cur;
-        if ( s->m_expiration > now )
-        {
-            // as the list is sorted by expiration time, we can skip the rest
-            break;
-        }
-
-        // remember next as we will delete the node pointed to by cur
-        next = cur;
-        ++next;
+        toNotify.push_back(m_timers[0].m_timer);
 
-        m_timers.erase(cur);
+        PutAt(0, m_timers.back());
+        m_timers.pop_back();
+        if ( !m_timers.empty() )
+            SiftDown(0);
+    }
 
+    for ( TimerImpls::const_iterator i = toNotify.begin(),
+                                     end = toNotify.end();
+          i != end;
+          ++i )
+    {
         // check whether we need to keep this timer
-        wxUnixTimerImpl * const timer = s->m_timer;
+        wxUnixTimerImpl * const timer = *i;
         if ( timer->IsOneShot() )
         {
             // the timer needs to be stopped but don't call its Stop() from
-            // here as it would attempt to remove the timer from our list and
+            // here as it would attempt to remove the timer from our heap and
             // we had already done it, so we just need to reset its state
             timer->MarkStopped();
-
-            // don't need it any more
-            delete s;
         }
         else // reschedule the next timer expiration
         {
@@ -164,17 +226,13 @@ bool wxTimerScheduler::NotifyExpired()
             // the current time instead of just offsetting it from the current
             // expiration time because it could happen that we're late and the
             // current expiration time is (far) in the past
-            s->m_expiration = now + timer->GetInterval()*1000;
-            DoAddTimer(s);
+            AddTimer(timer, now + timer->GetInterval()*1000);
         }
-
-        // we can't notify the timer from this loop as the timer event handler
-        // could modify m_timers (for example, but not only, by stopping this
-        // timer) which would render our iterators invalid, so do it after the
-        // loop end
-        toNotify.push_back(timer);
     }
 
+    // notice that we can't notify the timers from the loops above as the
+    // timer event handler could modify m_timers (for example, but not only,
+    // by stopping this timer), so do it only now
     if ( toNotify.empty() )
         return false;
 
@@ -197,6 +255,8 @@ wxUnixTimerImpl::wxUnixTimerImpl(wxTimer* timer)
                : wxTimerImpl(timer)
 {
     m_isRunning = false;
+    m_scheduler = NULL;
+    m_heapIndex = 0;
 }
 
 bool wxUnixTimerImpl::Start(int milliseconds, bool oneShot)
@@ -204,7 +264,8 @@ bool wxUnixTimerImpl::Start(int milliseconds, bool oneShot)
     // notice that this will stop an already running timer
     wxTimerImpl::Start(milliseconds, oneShot);
 
-    wxTimerScheduler::Get().AddTimer(this, wxGetUTCTimeUSec() + m_milli*1000);
+    m_scheduler = &wxTimerScheduler::Get();
+    m_scheduler->AddTimer(this, wxGetUTCTimeUSec() + m_milli*1000);
     m_isRunning = true;
 
     return true;
@@ -214,12 +275,20 @@ void wxUnixTimerImpl::Stop()
 {
     if ( m_isRunning )
     {
-        wxTimerScheduler::Get().RemoveTimer(this);
+        m_scheduler->RemoveTimer(this);
 
         m_isRunning = false;
+        m_scheduler = NULL;
     }
 }
 
+bool wxUnixTimerImpl::CanStartInThisThread() const
+{
+    // the timers can also be used in the threads running a worker event loop
+    // with its own scheduler
+    return wxTLS_VALUE(GetThisThreadScheduler()) != NULL;
+}
+
 bool wxUnixTimerImpl::IsRunning() const
 {
     return m_isRunning;
@@ -29,6 +29,10 @@
 #include "wx/zstream.h"
 #include "wx/strconv.h"
 #include "wx/scopedptr.h"
+#include "wx/vector.h"
+#include "wx/buffer.h"
+#include "wx/hashmap.h"
+#include "wx/atomic.h"
 #include "wx/versioninfo.h"
 
 #include "expat.h" // from Expat
@@ -599,25 +603,292 @@ bool wxIsWhiteOnly(const wxString& buf)
     return true;
 }
 
+//-----------------------------------------------------------------------------
+//  wxXmlArena: memory pool used by the documents loaded with wxXMLDOC_USE_ARENA
+//-----------------------------------------------------------------------------
+
+namespace
+{
+
+class wxXmlArena;
+
+// Header preceding every wxXmlNode and wxXmlAttribute in memory: it contains
+// the arena the object was allocated from or NULL if it was allocated on the
+// heap and needs to be freed individually.
+union wxXmlAllocHeader
+{
+    wxXmlArena *arena;
+
+    // ensure the objects following the header are correctly aligned
+    double align;
+};
+
+// map of the interned names, the keys are stored in the arena itself (notice
+// that a typedef is needed to avoid "const const" in the macro expansion)
+typedef const char *wxXmlNameKey;
+WX_DECLARE_HASH_MAP(wxXmlNameKey, wxString, wxStringHash, wxStringEqual,
+                    wxXmlNamesMap);
+
+// The nodes and attributes of the document are allocated in big blocks of
+// memory which are freed all at once when the last of them is deleted. The
+// names, which are repeated many times in a typical document, are interned so
+// that each of them is converted only once (and its buffer is shared by all
+// the nodes using it when wxString uses reference counting).
+class wxXmlArena
+{
+public:
+    // The arena is initially referenced by the code loading the document
+    // which must call DecRef() when it doesn't need it any more.
+    wxXmlArena()
+        : m_refCount(1)
+    {
+        m_pos =
+        m_end = NULL;
+    }
+
+    // Allocate memory for a node or an attribute, returns the pointer after
+    // the header.
+    void *Alloc(size_t size)
+    {
+        wxXmlAllocHeader * const
+            header = static_cast<wxXmlAllocHeader *>(
+                        AllocBytes(sizeof(wxXmlAllocHeader) + size));
+        header->arena = this;
+
+        wxAtomicInc(m_refCount);
+
+        return header + 1;
+    }
+
+    // Called when an object allocated by Alloc() or the loading code doesn't
+    // need the arena any more, frees it if it was the last reference.
+    void DecRef()
+    {
+        if ( !wxAtomicDec(m_refCount) )
+            delete this;
+    }
+
+    // Return the shared string corresponding to the given name in UTF-8.
+    const wxString& Intern(wxMBConv *conv, const char *name)
+    {
+        wxXmlNamesMap::iterator it = m_names.find(name);
+        if ( it != m_names.end() )
+            return it->second;
+
+        const size_t len = strlen(name) + 1;
+        char * const key = static_cast<char *>(AllocBytes(len));
+        memcpy(key, name, len);
+
+        return m_names[key] = CharToString(conv, name);
+    }
+
+private:
+    enum
+    {
+        // size of the memory blocks used for allocations
+        BLOCK_SIZE = 65536
+    };
+
+    ~wxXmlArena()
+    {
+        for ( size_t n = 0; n < m_blocks.size(); n++ )
+            ::operator delete(m_blocks[n]);
+    }
+
+    void *AllocBytes(size_t size)
+    {
+        // round up the size to preserve the alignment of the next allocation
+        size = (size + sizeof(wxXmlAllocHeader) - 1) &
+                    ~(sizeof(wxXmlAllocHeader) - 1);
+
+        if ( size > static_cast<size_t>(m_end - m_pos) )
+        {
+            // allocate the big objects separately to avoid wasting the rest
+            // of the current block
+            if ( size > BLOCK_SIZE / 4 )
+            {
+                void * const p = ::operator new(size);
+                m_blocks.push_back(p);
+                return p;
+            }
+
+            m_pos = static_cast<char *>(::operator new(BLOCK_SIZE));
+            m_end = m_pos + BLOCK_SIZE;
+            m_blocks.push_back(m_pos);
+        }
+
+        void * const p = m_pos;
+        m_pos += size;
+        return p;
+    }
+
+    // all allocated blocks
+    wxVector<void *> m_blocks;
+
+    // the free part of the current block
+    char *m_pos,
+         *m_end;
+
+    // number of the objects allocated from this arena and still alive plus
+    // one for the code loading the document
+    wxAtomicInt m_refCount;
+
+    wxXmlNamesMap m_names;
+
+    wxDECLARE_NO_COPY_CLASS(wxXmlArena);
+};
+
+// Allocate and free the memory for the objects which may be allocated in the
+// arena, see wxXmlAllocHeader.
+void *wxXmlAllocObject(size_t size)
+{
+    wxXmlAllocHeader * const
+        header = static_cast<wxXmlAllocHeader *>(
+                    ::operator new(sizeof(wxXmlAllocHeader) + size));
+    header->arena = NULL;
+
+    return header + 1;
+}
+
+void wxXmlFreeObject(void *p)
+{
+    if ( !p )
+        return;
+
+    wxXmlAllocHeader * const header = static_cast<wxXmlAllocHeader *>(p) - 1;
+    if ( header->arena )
+        header->arena->DecRef();
+    else
+        ::operator delete(header);
+}
+
+} // anonymous namespace
+
+void *wxXmlNode::operator new(size_t size)
+{
+    return wxXmlAllocObject(size);
+}
+
+void wxXmlNode::operator delete(void *p)
+{
+    wxXmlFreeObject(p);
+}
+
+void *wxXmlAttribute::operator new(size_t size)
+{
+    return wxXmlAllocObject(size);
+}
+
+void wxXmlAttribute::operator delete(void *p)
+{
+    wxXmlFreeObject(p);
+}
+
+// size of the chunks in which the input is read and passed to Expat
+static const int XML_CHUNK_SIZE = 65536;
+
+// reads the next chunk of the stream directly into Expat buffer and parses it,
+// sets done to true if the end of the stream was reached
+static bool ParseNextChunk(XML_Parser parser, wxInputStream& stream, bool& done)
+{
+    void * const buf = XML_GetBuffer(parser, XML_CHUNK_SIZE);
+    if ( !buf )
+        return false;
+
+    const size_t len = stream.Read(buf, XML_CHUNK_SIZE).LastRead();
+    done = len < (size_t)XML_CHUNK_SIZE;
+
+    return XML_ParseBuffer(parser, (int)len, done) != XML_STATUS_ERROR;
+}
+
+static void LogParsingError(XML_Parser parser)
+{
+    wxString error(XML_ErrorString(XML_GetErrorCode(parser)),
+                   *wxConvCurrent);
+    wxLogError(_("XML parsing error: '%s' at line %d"),
+               error.c_str(),
+               (int)XML_GetCurrentLineNumber(parser));
+}
+
+// extracts version and encoding from the XML declaration if s is one
+static void ParseXmlDecl(wxMBConv *conv, const char *s, int len,
+                         wxString& version, wxString& encoding)
+{
+    if (len > 6 && memcmp(s, "<?xml ", 6) == 0)
+    {
+        wxString buf = CharToString(conv, s, (size_t)len);
+        int pos;
+        pos = buf.Find(wxS("encoding="));
+        if (pos != wxNOT_FOUND)
+            encoding = buf.Mid(pos + 10).BeforeFirst(buf[(size_t)pos+9]);
+        pos = buf.Find(wxS("version="));
+        if (pos != wxNOT_FOUND)
+            version = buf.Mid(pos + 9).BeforeFirst(buf[(size_t)pos+8]);
+    }
+}
+
 
 struct wxXmlParsingContext
 {
     wxXmlParsingContext()
         : conv(NULL),
+          arena(NULL),
           node(NULL),
           lastChild(NULL),
           lastAsText(NULL),
-          removeWhiteOnlyNodes(false)
+          removeWhiteOnlyNodes(false),
+          textName(wxS("text")),
+          cdataName(wxS("cdata")),
+          commentName(wxS("comment"))
     {}
 
+    // returns the string for the name of an element, attribute or PI
+    wxString GetName(const char *name) const
+    {
+        return arena ? arena->Intern(conv, name) : CharToString(conv, name);
+    }
+
+    // creates a new node in the arena if we use one or on the heap otherwise
+    wxXmlNode *CreateNode(wxXmlNodeType type,
+                          const wxString& name,
+                          const wxString& content = wxString()) const
+    {
+        const int lineNo = XML_GetCurrentLineNumber(parser);
+        if ( arena )
+        {
+            return new(arena->Alloc(sizeof(wxXmlNode)))
+                        wxXmlNode(type, name, content, lineNo);
+        }
+
+        return new wxXmlNode(type, name, content, lineNo);
+    }
+
+    wxXmlAttribute *CreateAttribute(const wxString& name,
+                                    const wxString& value) const
+    {
+        if ( arena )
+        {
+            return new(arena->Alloc(sizeof(wxXmlAttribute)))
+                        wxXmlAttribute(name, value);
+        }
+
+        return new wxXmlAttribute(name, value);
+    }
+
     XML_Parser parser;
     wxMBConv  *conv;
+    wxXmlArena *arena;                  // NULL unless wxXMLDOC_USE_ARENA
     wxXmlNode *node;                    // the node being parsed
     wxXmlNode *lastChild;               // the last child of "node"
     wxXmlNode *lastAsText;              // the last _text_ child of "node"
     wxString   encoding;
     wxString   version;
     bool       removeWhiteOnlyNodes;
+
+    // the names of the non-element nodes, shared by all of them
+    const wxString textName,
+                   cdataName,
+                   commentName;
 };
 
 // checks that ctx->lastChild is in consistent state
@@ -631,16 +902,21 @@ extern "C" {
 static void StartElementHnd(void *userData, const char *name, const char **atts)
 {
     wxXmlParsingContext *ctx = (wxXmlParsingContext*)userData;
-    wxXmlNode *node = new wxXmlNode(wxXML_ELEMENT_NODE,
-                                    CharToString(ctx->conv, name),
-                                    wxEmptyString,
-                                    XML_GetCurrentLineNumber(ctx->parser));
+    wxXmlNode *node = ctx->CreateNode(wxXML_ELEMENT_NODE, ctx->GetName(name));
     const char **a = atts;
 
     // add node attributes
+    wxXmlAttribute *lastAttr = NULL;
     while (*a)
     {
-        node->AddAttribute(CharToString(ctx->conv, a[0]), CharToString(ctx->conv, a[1]));
+        wxXmlAttribute *attr = ctx->CreateAttribute(ctx->GetName(a[0]),
+                                                    CharToString(ctx->conv, a[1]));
+        if ( lastAttr )
+            lastAttr->SetNext(attr);
+        else
+            node->SetAttributes(attr);
+        lastAttr = attr;
+
         a += 2;
     }
 
@@ -683,8 +959,7 @@ static void TextHnd(void *userData, const char *s, int len)
         if (!whiteOnly)
         {
             wxXmlNode *textnode =
-                new wxXmlNode(wxXML_TEXT_NODE, wxS("text"), str,
-                              XML_GetCurrentLineNumber(ctx->parser));
+                ctx->CreateNode(wxXML_TEXT_NODE, ctx->textName, str);
 
             ASSERT_LAST_CHILD_OK(ctx);
             ctx->node->InsertChildAfter(textnode, ctx->lastChild);
@@ -698,8 +973,7 @@ static void StartCdataHnd(void *userData)
     wxXmlParsingContext *ctx = (wxXmlParsingContext*)userData;
 
     wxXmlNode *textnode =
-        new wxXmlNode(wxXML_CDATA_SECTION_NODE, wxS("cdata"), wxS(""),
-                      XML_GetCurrentLineNumber(ctx->parser));
+        ctx->CreateNode(wxXML_CDATA_SECTION_NODE, ctx->cdataName);
 
     ASSERT_LAST_CHILD_OK(ctx);
     ctx->node->InsertChildAfter(textnode, ctx->lastChild);
@@ -722,9 +996,8 @@ static void CommentHnd(void *userData, const char *data)
     wxXmlParsingContext *ctx = (wxXmlParsingContext*)userData;
 
     wxXmlNode *commentnode =
-        new wxXmlNode(wxXML_COMMENT_NODE,
-                      wxS("comment"), CharToString(ctx->conv, data),
-                      XML_GetCurrentLineNumber(ctx->parser));
+        ctx->CreateNode(wxXML_COMMENT_NODE,
+                        ctx->commentName, CharToString(ctx->conv, data));
 
     ASSERT_LAST_CHILD_OK(ctx);
     ctx->node->InsertChildAfter(commentnode, ctx->lastChild);
@@ -737,9 +1010,8 @@ static void PIHnd(void *userData, const char *target, const char *data)
     wxXmlParsingContext *ctx = (wxXmlParsingContext*)userData;
 
     wxXmlNode *pinode =
-        new wxXmlNode(wxXML_PI_NODE, CharToString(ctx->conv, target),
-                      CharToString(ctx->conv, data),
-                      XML_GetCurrentLineNumber(ctx->parser));
+        ctx->CreateNode(wxXML_PI_NODE, ctx->GetName(target),
+                        CharToString(ctx->conv, data));
 
     ASSERT_LAST_CHILD_OK(ctx);
     ctx->node->InsertChildAfter(pinode, ctx->lastChild);
@@ -749,20 +1021,10 @@ static void PIHnd(void *userData, const char *target, const char *data)
 
 static void DefaultHnd(void *userData, const char *s, int len)
 {
-    // XML header:
-    if (len > 6 && memcmp(s, "<?xml ", 6) == 0)
-    {
-        wxXmlParsingContext *ctx = (wxXmlParsingContext*)userData;
+    wxXmlParsingContext *ctx = (wxXmlParsingContext*)userData;
 
-        wxString buf = CharToString(ctx->conv, s, (size_t)len);
-        int pos;
-        pos = buf.Find(wxS("encoding="));
-        if (pos != wxNOT_FOUND)
-            ctx->encoding = buf.Mid(pos + 10).BeforeFirst(buf[(size_t)pos+9]);
-        pos = buf.Find(wxS("version="));
-        if (pos != wxNOT_FOUND)
-            ctx->version = buf.Mid(pos + 9).BeforeFirst(buf[(size_t)pos+8]);
-    }
+    // XML header:
+    ParseXmlDecl(ctx->conv, s, len, ctx->version, ctx->encoding);
 }
 
 static int UnknownEncodingHnd(void * WXUNUSED(encodingHandlerData),
@@ -806,8 +1068,6 @@ bool wxXmlDocument::Load(wxInputStream& stream, const wxString& encoding, int fl
     m_encoding = encoding;
 #endif
 
-    const size_t BUFSIZE = 1024;
-    char buf[BUFSIZE];
     wxXmlParsingContext ctx;
     bool done;
     XML_Parser parser = XML_ParserCreate(NULL);
@@ -820,6 +1080,8 @@ bool wxXmlDocument::Load(wxInputStream& stream, const wxString& encoding, int fl
         ctx.conv = new wxCSConv(encoding);
 #endif
     ctx.removeWhiteOnlyNodes = (flags & wxXMLDOC_KEEP_WHITESPACE_NODES) == 0;
+    if ( flags & wxXMLDOC_USE_ARENA )
+        ctx.arena = new wxXmlArena;
     ctx.parser = parser;
     ctx.node = root;
 
@@ -835,15 +1097,9 @@ bool wxXmlDocument::Load(wxInputStream& stream, const wxString& encoding, int fl
     bool ok = true;
     do
     {
-        size_t len = stream.Read(buf, BUFSIZE).LastRead();
-        done = (len < BUFSIZE);
-        if (!XML_Parse(parser, buf, len, done))
+        if ( !ParseNextChunk(parser, stream, done) )
         {
-            wxString error(XML_ErrorString(XML_GetErrorCode(parser)),
-                           *wxConvCurrent);
-            wxLogError(_("XML parsing error: '%s' at line %d"),
-                       error.c_str(),
-                       (int)XML_GetCurrentLineNumber(parser));
+            LogParsingError(parser);
             ok = false;
             break;
         }
@@ -868,11 +1124,480 @@ bool wxXmlDocument::Load(wxInputStream& stream, const wxString& encoding, int fl
         delete ctx.conv;
 #endif
 
+    // the arena is kept alive by the nodes allocated from it, if any
+    if ( ctx.arena )
+        ctx.arena->DecRef();
+
     return ok;
 
 }
 
 
+//-----------------------------------------------------------------------------
+//  wxXmlReader
+//-----------------------------------------------------------------------------
+
+class wxXmlReaderImpl
+{
+public:
+    // An item found in the document. All its strings are stored, in UTF-8 and
+    // NUL-terminated, in m_data and are referenced by their offsets in it, as
+    // this avoids allocating memory for each of them.
+    struct Item
+    {
+        wxXmlReaderEvent event;
+        int depth,
+            lineNo;
+        size_t name,            // offsets in m_data or NO_STRING
+               content;
+        size_t firstAttr,       // index of the first attribute in m_attrs
+               numAttrs;
+    };
+
+    struct Attr
+    {
+        size_t name,
+               value;
+    };
+
+    static const size_t NO_STRING = (size_t)-1;
+
+    wxXmlReaderImpl(wxInputStream& stream, const wxString& encoding, int flags);
+    ~wxXmlReaderImpl();
+
+    wxXmlReaderEvent Next();
+
+    const Item& GetItem() const
+    {
+        wxASSERT_MSG( !m_items.empty(), "must call wxXmlReader::Next() first" );
+
+        return m_items[m_current];
+    }
+
+    const Attr& GetAttr(size_t n) const
+    {
+        static const Attr s_noAttr = { NO_STRING, NO_STRING };
+
+        const Item& item = GetItem();
+        wxCHECK_MSG( n < item.numAttrs, s_noAttr, "invalid attribute index" );
+
+        return m_attrs[item.firstAttr + n];
+    }
+
+    const char *GetString(size_t offset) const
+    {
+        if ( offset == NO_STRING )
+            return "";
+
+        return static_cast<const char *>(m_data.GetData()) + offset;
+    }
+
+    wxString ToString(size_t offset) const
+    {
+        return CharToString(m_conv, GetString(offset));
+    }
+
+    const wxString& GetVersion() const { return m_version; }
+    const wxString& GetFileEncoding() const { return m_fileEncoding; }
+
+    // Expat callbacks
+    void OnStartElement(const char *name, const char **atts);
+    void OnEndElement(const char *name);
+    void OnText(const char *s, int len);
+    void OnStartCdata();
+    void OnEndCdata();
+    void OnComment(const char *data);
+    void OnPI(const char *target, const char *data);
+    void OnDefault(const char *s, int len);
+
+private:
+    // add a new item at the current position in the document
+    Item& AddItem(wxXmlReaderEvent event, int depth, int lineNo = -1);
+
+    // add the string to m_data and return its offset
+    size_t AddString(const char *s, size_t len);
+    size_t AddString(const char *s) { return AddString(s, strlen(s)); }
+
+    // add the pending text, if any, as a text item
+    void FlushText();
+
+    wxInputStream& m_stream;
+    XML_Parser m_parser;
+    wxMBConv *m_conv;
+    const bool m_removeWhiteOnlyNodes;
+
+    // true once the entire stream has been parsed
+    bool m_done;
+
+    // the items found in the last parsed chunk of the document and the index
+    // of the current one
+    wxVector<Item> m_items;
+    wxVector<Attr> m_attrs;
+    wxMemoryBuffer m_data;
+    size_t m_current;
+
+    // the current depth in the elements tree
+    int m_depth;
+
+    // the text accumulated until the next item, it's stored separately as
+    // it can span several chunks
+    wxMemoryBuffer m_text;
+    int m_textLineNo;
+    bool m_inCdata;
+
+    wxString m_version,
+             m_fileEncoding;
+
+    wxDECLARE_NO_COPY_CLASS(wxXmlReaderImpl);
+};
+
+extern "C" {
+static void ReaderStartElementHnd(void *userData,
+                                  const char *name, const char **atts)
+{
+    static_cast<wxXmlReaderImpl *>(userData)->OnStartElement(name, atts);
+}
+
+static void ReaderEndElementHnd(void *userData, const char *name)
+{
+    static_cast<wxXmlReaderImpl *>(userData)->OnEndElement(name);
+}
+
+static void ReaderTextHnd(void *userData, const char *s, int len)
+{
+    static_cast<wxXmlReaderImpl *>(userData)->OnText(s, len);
+}
+
+static void ReaderStartCdataHnd(void *userData)
+{
+    static_cast<wxXmlReaderImpl *>(userData)->OnStartCdata();
+}
+
+static void ReaderEndCdataHnd(void *userData)
+{
+    static_cast<wxXmlReaderImpl *>(userData)->OnEndCdata();
+}
+
+static void ReaderCommentHnd(void *userData, const char *data)
+{
+    static_cast<wxXmlReaderImpl *>(userData)->OnComment(data);
+}
+
+static void ReaderPIHnd(void *userData, const char *target, const char *data)
+{
+    static_cast<wxXmlReaderImpl *>(userData)->OnPI(target, data);
+}
+
+static void ReaderDefaultHnd(void *userData, const char *s, int len)
+{
+    static_cast<wxXmlReaderImpl *>(userData)->OnDefault(s, len);
+}
+} // extern "C"
+
+wxXmlReaderImpl::wxXmlReaderImpl(wxInputStream& stream,
+                                 const wxString& encoding,
+                                 int flags)
+    : m_stream(stream),
+      m_parser(XML_ParserCreate(NULL)),
+      m_conv(NULL),
+      m_removeWhiteOnlyNodes((flags & wxXMLDOC_KEEP_WHITESPACE_NODES) == 0),
+      m_done(false),
+      m_current(0),
+      m_depth(0),
+      m_textLineNo(-1),
+      m_inCdata(false),
+      m_fileEncoding(wxS("UTF-8"))
+{
+#if !wxUSE_UNICODE
+    if ( encoding.CmpNoCase(wxS("UTF-8")) != 0 )
+        m_conv = new wxCSConv(encoding);
+#else
+    wxUnusedVar(encoding);
+#endif
+
+    XML_SetUserData(m_parser, this);
+    XML_SetElementHandler(m_parser, ReaderStartElementHnd, ReaderEndElementHnd);
+    XML_SetCharacterDataHandler(m_parser, ReaderTextHnd);
+    XML_SetCdataSectionHandler(m_parser, ReaderStartCdataHnd, ReaderEndCdataHnd);
+    XML_SetCommentHandler(m_parser, ReaderCommentHnd);
+    XML_SetProcessingInstructionHandler(m_parser, ReaderPIHnd);
+    XML_SetDefaultHandler(m_parser, ReaderDefaultHnd);
+    XML_SetUnknownEncodingHandler(m_parser, UnknownEncodingHnd, NULL);
+}
+
+wxXmlReaderImpl::~wxXmlReaderImpl()
+{
+    XML_ParserFree(m_parser);
+    delete m_conv;
+}
+
+wxXmlReaderEvent wxXmlReaderImpl::Next()
+{
+    if ( !m_items.empty() )
+    {
+        if ( m_current + 1 < m_items.size() )
+            return m_items[++m_current].event;
+
+        const wxXmlReaderEvent last = m_items[m_current].event;
+        if ( last == wxXML_READER_END_DOCUMENT || last == wxXML_READER_ERROR )
+            return last;
+    }
+
+    // we don't have any more items, parse the next chunk of the stream to
+    // get them, reusing the memory used by the previous ones
+    m_items.clear();
+    m_attrs.clear();
+    m_data.SetDataLen(0);
+    m_current = 0;
+
+    while ( m_items.empty() )
+    {
+        if ( m_done )
+        {
+            AddItem(wxXML_READER_END_DOCUMENT, 0);
+            break;
+        }
+
+        if ( !ParseNextChunk(m_parser, m_stream, m_done) )
+        {
+            LogParsingError(m_parser);
+
+            // keep the items found in the invalid chunk before the error, they
+            // are returned before it, just as when it is found in a later one
+            AddItem(wxXML_READER_ERROR, m_depth);
+            break;
+        }
+    }
+
+    return m_items[0].event;
+}
+
+wxXmlReaderImpl::Item&
+wxXmlReaderImpl::AddItem(wxXmlReaderEvent event, int depth, int lineNo)
+{
+    Item item;
+    item.event = event;
+    item.depth = depth;
+    item.lineNo = lineNo == -1 ? (int)XML_GetCurrentLineNumber(m_parser)
+                               : lineNo;
+    item.name =
+    item.content = NO_STRING;
+    item.firstAttr = m_attrs.size();
+    item.numAttrs = 0;
+
+    m_items.push_back(item);
+
+    return m_items.back();
+}
+
+size_t wxXmlReaderImpl::AddString(const char *s, size_t len)
+{
+    const size_t offset = m_data.GetDataLen();
+    m_data.AppendData(s, len);
+    m_data.AppendByte('\0');
+
+    return offset;
+}
+
+void wxXmlReaderImpl::FlushText()
+{
+    const size_t len = m_text.GetDataLen();
+    if ( !len )
+        return;
+
+    const char * const text = static_cast<const char *>(m_text.GetData());
+
+    bool whiteOnly = m_removeWhiteOnlyNodes;
+    for ( size_t n = 0; whiteOnly && n < len; n++ )
+    {
+        const char c = text[n];
+        if ( c != ' ' && c != '\t' && c != '\n' && c != '\r' )
+            whiteOnly = false;
+    }
+
+    if ( !whiteOnly )
+        AddItem(wxXML_READER_TEXT, m_depth, m_textLineNo).content =
+            AddString(text, len);
+
+    m_text.SetDataLen(0);
+}
+
+void wxXmlReaderImpl::OnStartElement(const char *name, const char **atts)
+{
+    FlushText();
+
+    Item& item = AddItem(wxXML_READER_START_ELEMENT, m_depth++);
+    item.name = AddString(name);
+
+    for ( const char **a = atts; *a; a += 2 )
+    {
+        Attr attr;
+        attr.name = AddString(a[0]);
+        attr.value = AddString(a[1]);
+        m_attrs.push_back(attr);
+
+        item.numAttrs++;
+    }
+}
+
+void wxXmlReaderImpl::OnEndElement(const char *name)
+{
+    FlushText();
+
+    AddItem(wxXML_READER_END_ELEMENT, --m_depth).name = AddString(name);
+}
+
+void wxXmlReaderImpl::OnText(const char *s, int len)
+{
+    if ( !m_text.GetDataLen() && !m_inCdata )
+        m_textLineNo = (int)XML_GetCurrentLineNumber(m_parser);
+
+    m_text.AppendData(s, len);
+}
+
+void wxXmlReaderImpl::OnStartCdata()
+{
+    FlushText();
+
+    m_inCdata = true;
+    m_textLineNo = (int)XML_GetCurrentLineNumber(m_parser);
+}
+
+void wxXmlReaderImpl::OnEndCdata()
+{
+    AddItem(wxXML_READER_CDATA, m_depth, m_textLineNo).content =
+        AddString(static_cast<const char *>(m_text.GetData()),
+                  m_text.GetDataLen());
+
+    m_text.SetDataLen(0);
+    m_inCdata = false;
+}
+
+void wxXmlReaderImpl::OnComment(const char *data)
+{
+    FlushText();
+
+    AddItem(wxXML_READER_COMMENT, m_depth).content = AddString(data);
+}
+
+void wxXmlReaderImpl::OnPI(const char *target, const char *data)
+{
+    FlushText();
+
+    Item& item = AddItem(wxXML_READER_PI, m_depth);
+    item.name = AddString(target);
+    item.content = AddString(data);
+}
+
+void wxXmlReaderImpl::OnDefault(const char *s, int len)
+{
+    ParseXmlDecl(m_conv, s, len, m_version, m_fileEncoding);
+}
+
+wxXmlReader::wxXmlReader(wxInputStream& stream,
+                         const wxString& encoding,
+                         int flags)
+    : m_impl(new wxXmlReaderImpl(stream, encoding, flags))
+{
+}
+
+wxXmlReader::~wxXmlReader()
+{
+    delete m_impl;
+}
+
+wxXmlReaderEvent wxXmlReader::Next()
+{
+    return m_impl->Next();
+}
+
+wxXmlReaderEvent wxXmlReader::GetEvent() const
+{
+    return m_impl->GetItem().event;
+}
+
+wxString wxXmlReader::GetName() const
+{
+    return m_impl->ToString(m_impl->GetItem().name);
+}
+
+wxString wxXmlReader::GetContent() const
+{
+    return m_impl->ToString(m_impl->GetItem().content);
+}
+
+const char *wxXmlReader::GetNameUTF8() const
+{
+    return m_impl->GetString(m_impl->GetItem().name);
+}
+
+const char *wxXmlReader::GetContentUTF8() const
+{
+    return m_impl->GetString(m_impl->GetItem().content);
+}
+
+size_t wxXmlReader::GetAttributesCount() const
+{
+    return m_impl->GetItem().numAttrs;
+}
+
+wxString wxXmlReader::GetAttributeName(size_t n) const
+{
+    return m_impl->ToString(m_impl->GetAttr(n).name);
+}
+
+wxString wxXmlReader::GetAttributeValue(size_t n) const
+{
+    return m_impl->ToString(m_impl->GetAttr(n).value);
+}
+
+bool wxXmlReader::GetAttribute(const wxString& attrName, wxString *value) const
+{
+    const size_t count = GetAttributesCount();
+    for ( size_t n = 0; n < count; n++ )
+    {
+        if ( GetAttributeName(n) == attrName )
+        {
+            if ( value )
+                *value = GetAttributeValue(n);
+
+            return true;
+        }
+    }
+
+    return false;
+}
+
+wxString wxXmlReader::GetAttribute(const wxString& attrName,
+                                   const wxString& defaultVal) const
+{
+    wxString tmp;
+    if ( GetAttribute(attrName, &tmp) )
+        return tmp;
+
+    return defaultVal;
+}
+
+int wxXmlReader::GetDepth() const
+{
+    return m_impl->GetItem().depth;
+}
+
+int wxXmlReader::GetLineNumber() const
+{
+    return m_impl->GetItem().lineNo;
+}
+
+const wxString& wxXmlReader::GetVersion() const
+{
+    return m_impl->GetVersion();
+}
+
+const wxString& wxXmlReader::GetFileEncoding() const
+{
+    return m_impl->GetFileEncoding();
+}
+
 
 //-----------------------------------------------------------------------------
 //  wxXmlDocument saving routines
@@ -29,6 +29,7 @@ wxHtmlWindowXmlHandler::wxHtmlWindowXmlHandler()
     XRC_ADD_STYLE(wxHW_SCROLLBAR_NEVER);
     XRC_ADD_STYLE(wxHW_SCROLLBAR_AUTO);
     XRC_ADD_STYLE(wxHW_NO_SELECTION);
+    XRC_ADD_STYLE(wxHW_INCREMENTAL);
     AddWindowStyles();
 }
 
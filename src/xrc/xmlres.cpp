@@ -47,6 +47,8 @@
 #include "wx/dir.h"
 #include "wx/xml/xml.h"
 #include "wx/hashset.h"
+#include "wx/hashmap.h"
+#include "wx/file.h"
 #include "wx/scopedptr.h"
 
 namespace
@@ -76,21 +78,32 @@ wxDateTime GetXRCFileModTime(const wxString& filename)
 // name.
 static void XRCID_Assign(const wxString& str_id, int value);
 
+WX_DECLARE_HASH_SET(wxString, wxStringHash, wxStringEqual,
+                    wxXmlResourceNames);
+
 class wxXmlResourceDataRecord
 {
 public:
-    // Ctor takes ownership of the document pointer.
+    // Ctor takes ownership of the document pointer, which may be NULL if the
+    // file is loaded on demand.
     wxXmlResourceDataRecord(const wxString& File_,
                             wxXmlDocument *Doc_
                            )
-        : File(File_), Doc(Doc_)
+        : File(File_), Doc(Doc_), OnDemand(Doc_ == NULL), Names(NULL)
     {
 #if wxUSE_DATETIME
         Time = GetXRCFileModTime(File);
 #endif
     }
 
-    ~wxXmlResourceDataRecord() {delete Doc;}
+    ~wxXmlResourceDataRecord() {delete Doc; delete Names;}
+
+    // Returns false if the file is known not to define a top level resource
+    // with the given name without loading it.
+    bool MayContain(const wxString& name) const
+    {
+        return !Names || Names->find(name) != Names->end();
+    }
 
     wxString File;
     wxXmlDocument *Doc;
@@ -98,12 +111,52 @@ public:
     wxDateTime Time;
 #endif
 
+    // true if the file must be loaded when it's needed, Doc is NULL then
+    bool OnDemand;
+
+    // names of the top level elements of the file loaded on demand if they're
+    // known without loading it or NULL
+    wxXmlResourceNames *Names;
+
     wxDECLARE_NO_COPY_CLASS(wxXmlResourceDataRecord);
 };
 
 class wxXmlResourceDataRecords : public wxVector<wxXmlResourceDataRecord*>
 {
     // this is a class so that it can be forward-declared
+
+public:
+    // Resource node and the index of the record containing it.
+    struct IndexEntry
+    {
+        size_t pos;
+        wxXmlNode *node;
+        bool topLevel;
+    };
+
+    typedef wxVector<IndexEntry> IndexEntries;
+
+    wxXmlResourceDataRecords() : m_indexValid(false) { }
+
+    // Must be called whenever the records or their documents change.
+    void InvalidateIndex()
+    {
+        m_index.clear();
+        m_indexValid = false;
+    }
+
+    // Returns all the object nodes with the given name in the loaded documents
+    // in the order in which wxXmlResource::DoFindResource() finds them, or
+    // NULL.
+    const IndexEntries *FindInIndex(const wxString& name);
+
+private:
+    void AddToIndex(size_t pos, wxXmlNode *parent, bool topLevel);
+
+    WX_DECLARE_STRING_HASH_MAP(IndexEntries, IndexMap);
+
+    IndexMap m_index;
+    bool m_indexValid;
 };
 
 WX_DECLARE_HASH_SET_PTR(int, wxIntegerHash, wxIntegerEqual, wxHashSetInt);
@@ -213,7 +266,7 @@ GetFileNameFromNode(const wxXmlNode *node, const wxXmlResourceDataRecords& files
     for ( wxXmlResourceDataRecords::const_iterator i = files.begin();
           i != files.end(); ++i )
     {
-        if ( (*i)->Doc->GetRoot() == node )
+        if ( (*i)->Doc && (*i)->Doc->GetRoot() == node )
         {
             return (*i)->File;
         }
@@ -222,8 +275,631 @@ GetFileNameFromNode(const wxXmlNode *node, const wxXmlResourceDataRecords& files
     return wxEmptyString; // not found
 }
 
+// helper used by DoFindResource() and GetResourceNodeAndLocation(): returns
+// true if the given object node is of the specified class, which may be empty
+// to match any class
+bool
+IsNodeOfClass(const wxXmlResource& res,
+              const wxXmlNode *node,
+              const wxString& classname)
+{
+    // empty class name matches everything
+    if ( classname.empty() )
+        return true;
+
+    wxString cls(node->GetAttribute(wxS("class")));
+
+    // object_ref may not have 'class' attribute:
+    if (cls.empty() && node->GetName() == wxS("object_ref"))
+    {
+        wxString refName = node->GetAttribute(wxS("ref"));
+        if (refName.empty())
+            return false;
+
+        const wxXmlNode * const refNode = res.GetResourceNode(refName);
+        if ( refNode )
+            cls = refNode->GetAttribute(wxS("class"));
+    }
+
+    return cls == classname;
+}
+
+// returns the encoding to use for loading XRC files with the given flags
+wxString GetXRCEncoding(int flags)
+{
+    wxString encoding(wxT("UTF-8"));
+#if !wxUSE_UNICODE && wxUSE_INTL
+    if ( (flags & wxXRC_USE_LOCALE) == 0 )
+    {
+        // In case we are not using wxLocale to translate strings, convert the
+        // strings GUI's charset. This must not be done when wxXRC_USE_LOCALE
+        // is on, because it could break wxGetTranslation lookup.
+        encoding = wxLocale::GetSystemEncodingName();
+    }
+#else
+    wxUnusedVar(flags);
+#endif
+
+    return encoding;
+}
+
+} // anonymous namespace
+
+void
+wxXmlResourceDataRecords::AddToIndex(size_t pos,
+                                      wxXmlNode *parent,
+                                      bool topLevel)
+{
+    // Add the nodes in the same order as DoFindResource() visits them: all
+    // children first and then their descendants.
+    wxXmlNode *node;
+    for ( node = parent->GetChildren(); node; node = node->GetNext() )
+    {
+        if ( IsObjectNode(node) )
+        {
+            const IndexEntry entry = { pos, node, topLevel };
+            m_index[node->GetAttribute(wxS("name"))].push_back(entry);
+        }
+    }
+
+    for ( node = parent->GetChildren(); node; node = node->GetNext() )
+    {
+        if ( IsObjectNode(node) )
+            AddToIndex(pos, node, false);
+    }
+}
+
+const wxXmlResourceDataRecords::IndexEntries *
+wxXmlResourceDataRecords::FindInIndex(const wxString& name)
+{
+    if ( !m_indexValid )
+    {
+        for ( size_t pos = 0; pos < size(); pos++ )
+        {
+            const wxXmlDocument * const doc = (*this)[pos]->Doc;
+            if ( doc && doc->GetRoot() )
+                AddToIndex(pos, doc->GetRoot(), true);
+        }
+
+        m_indexValid = true;
+    }
+
+    const IndexMap::const_iterator it = m_index.find(name);
+
+    return it == m_index.end() ? NULL : &it->second;
+}
+
+// ----------------------------------------------------------------------------
+// Binary cache of the XRC files
+// ----------------------------------------------------------------------------
+
+#if wxUSE_DATETIME
+
+namespace
+{
+
+// The cache file contains the following items, all numbers except for the
+// modification time are stored as variable length integers using 7 bits per
+// byte, with the high bit indicating that more bytes follow:
+//
+//  - Signature including the format version and the build kind.
+//  - Modification time of the source file as two 32 bit little endian
+//    numbers, followed by its URL and encoding.
+//  - Version and file encoding of the document.
+//  - String table: the number of strings and the length and the contents, in
+//    UTF-8 (or in the document encoding in non-Unicode build), of each one.
+//  - Index: the number of entries and the name and the offset from the start
+//    of the nodes data of each top level named element.
+//  - Nodes data: the nodes in pre-order, each one consisting of its type,
+//    flags, name, content, line number, the number of attributes followed by
+//    the name and value of each of them and, finally, the number of children
+//    which follow it.
+//
+// All strings, including the names of the elements and attributes, are
+// stored only once in the string table and referenced by their indices.
+
+#if wxUSE_UNICODE
+const char XRC_CACHE_SIGNATURE[] = "wxXRCbinU1";
+#else
+const char XRC_CACHE_SIGNATURE[] = "wxXRCbinA1";
+#endif
+
+// Bits of the node flags.
+const wxUint32 XRC_CACHE_FLAG_NO_CONVERSION = 1;
+
+// Returns the name of the cache file to use for the given XRC file.
+wxString GetXRCCacheFileName(const wxString& dir,
+                             const wxString& url,
+                             const wxString& encoding)
+{
+    // Use FNV-1a hash of the URL, the file is checked to correspond to the
+    // URL when loading it anyhow, so collisions are harmless.
+    const wxScopedCharBuffer buf((url + wxS('\n') + encoding).utf8_str());
+    wxUint64 hash = wxULL(14695981039346656037);
+    for ( const char *p = buf.data(); *p; p++ )
+    {
+        hash ^= static_cast<unsigned char>(*p);
+        hash *= wxULL(1099511628211);
+    }
+
+    wxFileName fn(dir, wxString::Format("%08x%08x.xrcb",
+                                        static_cast<unsigned>(hash >> 32),
+                                        static_cast<unsigned>(hash)));
+    return fn.GetFullPath();
+}
+
+class wxXmlResourceCacheWriter
+{
+public:
+    wxXmlResourceCacheWriter() : m_root(NULL) { }
+
+    // Serializes the document to the internal buffer.
+    void Write(const wxXmlDocument& doc,
+               const wxString& url,
+               const wxString& encoding,
+               const wxDateTime& modTime)
+    {
+        m_root = doc.GetRoot();
+        AddNode(doc.GetDocumentNode());
+
+        wxMemoryBuffer& buf = m_buf;
+        buf.AppendData(XRC_CACHE_SIGNATURE, strlen(XRC_CACHE_SIGNATURE));
+
+        const wxLongLong t = modTime.GetValue();
+        PutUint32LE(t.GetHi());
+        PutUint32LE(t.GetLo());
+        PutString(buf, url);
+        PutString(buf, encoding);
+        PutString(buf, doc.GetVersion());
+        PutString(buf, doc.GetFileEncoding());
+
+        PutNumber(buf, m_strings.size());
+        for ( size_t n = 0; n < m_strings.size(); n++ )
+            PutString(buf, m_strings[n]);
+
+        PutNumber(buf, m_index.size() / 2);
+        for ( size_t n = 0; n < m_index.size(); n++ )
+            PutNumber(buf, m_index[n]);
+
+        buf.AppendData(m_nodes.GetData(), m_nodes.GetDataLen());
+    }
+
+    bool Save(const wxString& filename) const
+    {
+        // Use a temporary file to ensure that a partially written cache file
+        // is never used.
+        wxTempFile file(filename);
+
+        return file.IsOpened() &&
+                file.Write(m_buf.GetData(), m_buf.GetDataLen()) &&
+                    file.Commit();
+    }
+
+private:
+    wxUint32 AddString(const wxString& s)
+    {
+        StringIndices::const_iterator it = m_stringIndices.find(s);
+        if ( it != m_stringIndices.end() )
+            return it->second;
+
+        const wxUint32 n = m_strings.size();
+        m_strings.push_back(s);
+        m_stringIndices[s] = n;
+
+        return n;
+    }
+
+    void AddNode(const wxXmlNode *node)
+    {
+        wxString name;
+        if ( node->GetParent() == m_root &&
+                node->GetType() == wxXML_ELEMENT_NODE &&
+                    node->GetAttribute(wxS("name"), &name) )
+        {
+            m_index.push_back(AddString(name));
+            m_index.push_back(m_nodes.GetDataLen());
+        }
+
+        PutNumber(m_nodes, node->GetType());
+        PutNumber(m_nodes, node->GetNoConversion()
+                            ? XRC_CACHE_FLAG_NO_CONVERSION
+                            : 0);
+        PutNumber(m_nodes, AddString(node->GetName()));
+        PutNumber(m_nodes, AddString(node->GetContent()));
+        PutNumber(m_nodes, node->GetLineNumber() + 1);
+
+        wxUint32 count = 0;
+        const wxXmlAttribute *attr;
+        for ( attr = node->GetAttributes(); attr; attr = attr->GetNext() )
+            count++;
+
+        PutNumber(m_nodes, count);
+        for ( attr = node->GetAttributes(); attr; attr = attr->GetNext() )
+        {
+            PutNumber(m_nodes, AddString(attr->GetName()));
+            PutNumber(m_nodes, AddString(attr->GetValue()));
+        }
+
+        count = 0;
+        const wxXmlNode *child;
+        for ( child = node->GetChildren(); child; child = child->GetNext() )
+            count++;
+
+        PutNumber(m_nodes, count);
+        for ( child = node->GetChildren(); child; child = child->GetNext() )
+            AddNode(child);
+    }
+
+    void PutUint32LE(wxUint32 n)
+    {
+        const unsigned char buf[4] =
+        {
+            static_cast<unsigned char>(n),
+            static_cast<unsigned char>(n >> 8),
+            static_cast<unsigned char>(n >> 16),
+            static_cast<unsigned char>(n >> 24)
+        };
+
+        m_buf.AppendData(buf, sizeof(buf));
+    }
+
+    static void PutNumber(wxMemoryBuffer& buf, wxUint32 n)
+    {
+        while ( n >= 0x80 )
+        {
+            buf.AppendByte(static_cast<char>((n & 0x7f) | 0x80));
+            n >>= 7;
+        }
+
+        buf.AppendByte(static_cast<char>(n));
+    }
+
+    static void PutString(wxMemoryBuffer& buf, const wxString& s)
+    {
+#if wxUSE_UNICODE
+        const wxScopedCharBuffer str(s.utf8_str());
+        PutNumber(buf, str.length());
+        buf.AppendData(str.data(), str.length());
+#else
+        PutNumber(buf, s.length());
+        buf.AppendData(s.wx_str(), s.length());
+#endif
+    }
+
+    WX_DECLARE_STRING_HASH_MAP(wxUint32, StringIndices);
+
+    // the root element, its children are put in the index
+    const wxXmlNode *m_root;
+
+    wxVector<wxString> m_strings;
+    StringIndices m_stringIndices;
+    wxVector<wxUint32> m_index;
+    wxMemoryBuffer m_nodes;
+    wxMemoryBuffer m_buf;
+
+    wxDECLARE_NO_COPY_CLASS(wxXmlResourceCacheWriter);
+};
+
+class wxXmlResourceCacheReader
+{
+public:
+    wxXmlResourceCacheReader()
+        : m_ptr(NULL),
+          m_end(NULL)
+    {
+    }
+
+    // Reads the cache file and checks that it corresponds to the given source
+    // file, returns false if it doesn't or if it couldn't be read.
+    bool Open(const wxString& filename,
+              const wxString& url,
+              const wxString& encoding,
+              const wxDateTime& modTime)
+    {
+        if ( !wxFileName::FileExists(filename) )
+            return false;
+
+        // Read the entire file at once, this is much faster than parsing it
+        // from a stream.
+        wxFile file(filename);
+        const wxFileOffset len = file.IsOpened() ? file.Length() : -1;
+        if ( len <= 0 )
+            return false;
+
+        void * const data = m_buf.GetWriteBuf(len);
+        if ( file.Read(data, len) != len )
+            return false;
+        m_buf.UngetWriteBuf(len);
+
+        m_ptr = static_cast<const unsigned char *>(m_buf.GetData());
+        m_end = m_ptr + len;
+
+        const size_t sigLen = strlen(XRC_CACHE_SIGNATURE);
+        if ( !HasBytes(sigLen) || memcmp(m_ptr, XRC_CACHE_SIGNATURE, sigLen) )
+            return false;
+        m_ptr += sigLen;
+
+        if ( !HasBytes(8) )
+            return false;
+
+        const wxLongLong t(static_cast<wxInt32>(ReadUint32LE(m_ptr)),
+                           ReadUint32LE(m_ptr + 4));
+        m_ptr += 8;
+
+        wxString cacheURL, cacheEncoding;
+        if ( !GetString(cacheURL) || !GetString(cacheEncoding) )
+            return false;
+
+        return t == modTime.GetValue() &&
+                cacheURL == url &&
+                    cacheEncoding == encoding;
+    }
+
+    // Creates the document from the cache contents, returns NULL if the cache
+    // is corrupted.
+    wxXmlDocument *ReadDocument()
+    {
+        wxString version, fileEncoding;
+        wxUint32 count;
+        if ( !ReadHeader(version, fileEncoding) || !GetNumber(count) )
+            return NULL;
+
+        // Skip the index, it's not needed when reading the entire document.
+        for ( wxUint32 n = 0; n < 2*count; n++ )
+        {
+            wxUint32 dummy;
+            if ( !GetNumber(dummy) )
+                return NULL;
+        }
+
+        wxScopedPtr<wxXmlNode> docNode(ReadNodes());
+        if ( !docNode || docNode->GetType() != wxXML_DOCUMENT_NODE )
+            return NULL;
+
+        wxXmlDocument * const doc = new wxXmlDocument;
+        doc->SetDocumentNode(docNode.release());
+        doc->SetVersion(version);
+        doc->SetFileEncoding(fileEncoding);
+
+        if ( !doc->GetRoot() )
+        {
+            delete doc;
+            return NULL;
+        }
+
+        return doc;
+    }
+
+    // Returns the names of the top level elements from the cache index or
+    // NULL if the cache is corrupted.
+    wxXmlResourceNames *ReadNames()
+    {
+        wxString version, fileEncoding;
+        wxUint32 count;
+        if ( !ReadHeader(version, fileEncoding) || !GetNumber(count) )
+            return NULL;
+
+        wxScopedPtr<wxXmlResourceNames> names(new wxXmlResourceNames);
+        for ( wxUint32 n = 0; n < count; n++ )
+        {
+            const wxString *name;
+            wxUint32 offset;
+            if ( !GetStringRef(name) || !GetNumber(offset) )
+                return NULL;
+
+            names->insert(*name);
+        }
+
+        return names.release();
+    }
+
+private:
+    // Reads the document properties and the string table.
+    bool ReadHeader(wxString& version, wxString& fileEncoding)
+    {
+        wxUint32 count;
+        if ( !GetString(version) || !GetString(fileEncoding) ||
+                !GetNumber(count) )
+            return false;
+
+        // Each string takes at least one byte, check for this before
+        // allocating memory for them to avoid allocating too much of it if
+        // the file is corrupted.
+        if ( !HasBytes(count) )
+            return false;
+
+        m_strings.resize(count);
+        for ( wxUint32 n = 0; n < count; n++ )
+        {
+            if ( !GetString(m_strings[n]) )
+                return false;
+        }
+
+        return true;
+    }
+
+    // Reads the tree of nodes starting at the current position.
+    wxXmlNode *ReadNodes()
+    {
+        // Use an explicit stack instead of recursion to avoid overflowing the
+        // real one for deeply nested (or corrupted) documents.
+        wxVector<Pending> stack;
+        wxXmlNode *top = NULL;
+        for ( ;; )
+        {
+            wxXmlNode * const node = ReadNode();
+            if ( !node )
+            {
+                // Nodes still on the stack are linked to the top one.
+                delete top;
+                return NULL;
+            }
+
+            if ( stack.empty() )
+            {
+                top = node;
+            }
+            else
+            {
+                // Only the top node can be the document node.
+                Pending& parent = stack.back();
+                node->SetParent(parent.node);
+                if ( parent.last )
+                    parent.last->SetNext(node);
+                else
+                    parent.node->SetChildren(node);
+                parent.last = node;
+                parent.count--;
+
+                if ( node->GetType() == wxXML_DOCUMENT_NODE )
+                {
+                    delete top;
+                    return NULL;
+                }
+            }
+
+            wxUint32 count;
+            if ( !GetNumber(count) )
+            {
+                delete top;
+                return NULL;
+            }
+
+            if ( count )
+            {
+                const Pending pending = { node, NULL, count };
+                stack.push_back(pending);
+                continue;
+            }
+
+            while ( !stack.empty() && !stack.back().count )
+                stack.pop_back();
+
+            if ( stack.empty() )
+                return top;
+        }
+    }
+
+    // Reads a single node with its attributes but without children.
+    wxXmlNode *ReadNode()
+    {
+        wxUint32 type, flags, line, count;
+        const wxString *name, *content;
+        if ( !GetNumber(type) || !GetNumber(flags) ||
+                !GetStringRef(name) || !GetStringRef(content) ||
+                    !GetNumber(line) || !GetNumber(count) )
+            return NULL;
+
+        if ( type < wxXML_ELEMENT_NODE || type > wxXML_HTML_DOCUMENT_NODE ||
+                (type == wxXML_ELEMENT_NODE && !content->empty()) )
+            return NULL;
+
+        wxScopedPtr<wxXmlNode>
+            node(new wxXmlNode(static_cast<wxXmlNodeType>(type),
+                               *name, *content,
+                               static_cast<int>(line) - 1));
+
+        if ( flags & XRC_CACHE_FLAG_NO_CONVERSION )
+            node->SetNoConversion(true);
+
+        wxXmlAttribute *last = NULL;
+        for ( wxUint32 n = 0; n < count; n++ )
+        {
+            const wxString *attrName, *attrValue;
+            if ( !GetStringRef(attrName) || !GetStringRef(attrValue) )
+                return NULL;
+
+            wxXmlAttribute * const
+                attr = new wxXmlAttribute(*attrName, *attrValue);
+            if ( last )
+                last->SetNext(attr);
+            else
+                node->SetAttributes(attr);
+            last = attr;
+        }
+
+        return node.release();
+    }
+
+    bool HasBytes(size_t len) const
+    {
+        return len <= static_cast<size_t>(m_end - m_ptr);
+    }
+
+    static wxUint32 ReadUint32LE(const unsigned char *p)
+    {
+        return p[0] | (p[1] << 8) | (p[2] << 16) |
+                (static_cast<wxUint32>(p[3]) << 24);
+    }
+
+    bool GetNumber(wxUint32& n)
+    {
+        n = 0;
+        for ( unsigned shift = 0; shift < 32; shift += 7 )
+        {
+            if ( m_ptr == m_end )
+                return false;
+
+            const unsigned char b = *m_ptr++;
+            n |= static_cast<wxUint32>(b & 0x7f) << shift;
+            if ( !(b & 0x80) )
+                return true;
+        }
+
+        // too many bytes for a 32 bit number
+        return false;
+    }
+
+    bool GetString(wxString& s)
+    {
+        wxUint32 len;
+        if ( !GetNumber(len) || !HasBytes(len) )
+            return false;
+
+        const char * const p = reinterpret_cast<const char *>(m_ptr);
+#if wxUSE_UNICODE
+        s = wxString::FromUTF8(p, len);
+#else
+        s.assign(p, len);
+#endif
+        m_ptr += len;
+
+        return true;
+    }
+
+    // Reads a reference to a string in the string table.
+    bool GetStringRef(const wxString *& s)
+    {
+        wxUint32 n;
+        if ( !GetNumber(n) || n >= m_strings.size() )
+            return false;
+
+        s = &m_strings[n];
+
+        return true;
+    }
+
+    // Element of the stack used by ReadNodes().
+    struct Pending
+    {
+        wxXmlNode *node;    // the node being read
+        wxXmlNode *last;    // its last child read so far
+        wxUint32 count;     // number of its children still to read
+    };
+
+    wxMemoryBuffer m_buf;
+    const unsigned char *m_ptr,
+                        *m_end;
+
+    wxVector<wxString> m_strings;
+
+    wxDECLARE_NO_COPY_CLASS(wxXmlResourceCacheReader);
+};
+
 } // anonymous namespace
 
+#endif // wxUSE_DATETIME
+
 
 wxXmlResource *wxXmlResource::ms_instance = NULL;
 
@@ -372,12 +1048,41 @@ bool wxXmlResource::Load(const wxString& filemask_)
         }
         else // a single resource URL
 #endif // wxUSE_FILESYSTEM
+        if ( m_flags & wxXRC_LOAD_ON_DEMAND )
+        {
+            wxXmlResourceDataRecord * const
+                rec = new wxXmlResourceDataRecord(fnd, NULL);
+
+#if wxUSE_DATETIME
+            // Use the cache, if it's up to date, to find out which resources
+            // are defined in this file without parsing it.
+            if ( !m_cacheDir.empty() && rec->Time.IsValid() )
+            {
+                const wxString encoding = GetXRCEncoding(m_flags);
+
+                wxXmlResourceCacheReader cache;
+                if ( cache.Open(GetXRCCacheFileName(m_cacheDir, fnd, encoding),
+                                fnd, encoding, rec->Time) )
+                {
+                    rec->Names = cache.ReadNames();
+                }
+            }
+#endif // wxUSE_DATETIME
+
+            Data().push_back(rec);
+        }
+        else
         {
             wxXmlDocument * const doc = DoLoadFile(fnd);
             if ( !doc )
+            {
                 allOK = false;
+            }
             else
+            {
                 Data().push_back(new wxXmlResourceDataRecord(fnd, doc));
+                Data().InvalidateIndex();
+            }
         }
 
         fnd = wxXmlFindNext;
@@ -418,6 +1123,7 @@ bool wxXmlResource::Unload(const wxString& filename)
             {
                 delete *i;
                 Data().erase(i);
+                Data().InvalidateIndex();
                 unloaded = true;
 
                 // no sense in continuing, there is only one file with this URL
@@ -677,6 +1383,19 @@ bool wxXmlResource::UpdateResources()
             continue;
         }
 
+        if ( !rec->Doc )
+        {
+            // The file is loaded on demand and wasn't loaded yet or couldn't
+            // be loaded: forget the possibly outdated names of the resources
+            // defined in it and (re)try loading it when it's needed.
+            wxDELETE(rec->Names);
+            rec->OnDemand = true;
+#if wxUSE_DATETIME
+            rec->Time = lastModTime;
+#endif // wxUSE_DATETIME
+            continue;
+        }
+
         wxXmlDocument * const doc = DoLoadFile(rec->File);
         if ( !doc )
         {
@@ -690,6 +1409,7 @@ bool wxXmlResource::UpdateResources()
         // Replace the old resource contents with the new one.
         delete rec->Doc;
         rec->Doc = doc;
+        Data().InvalidateIndex();
 
         // And, now that we loaded it successfully, update the last load time.
 #if wxUSE_DATETIME
@@ -704,44 +1424,90 @@ wxXmlDocument *wxXmlResource::DoLoadFile(const wxString& filename)
 {
     wxLogTrace(wxT("xrc"), wxT("opening file '%s'"), filename);
 
-    wxInputStream *stream = NULL;
+    const wxString encoding = GetXRCEncoding(GetFlags());
 
-#if wxUSE_FILESYSTEM
-    wxFileSystem fsys;
-    wxScopedPtr<wxFSFile> file(fsys.OpenFile(filename));
-    if (file)
+    wxScopedPtr<wxXmlDocument> doc;
+
+#if wxUSE_DATETIME
+    // Use the cached document if it's up to date.
+    wxString cacheFile;
+    wxDateTime modTime;
+    if ( !m_cacheDir.empty() )
     {
-        // Notice that we don't have ownership of the stream in this case, it
-        // remains owned by wxFSFile.
-        stream = file->GetStream();
+        modTime = GetXRCFileModTime(filename);
+        if ( modTime.IsValid() )
+        {
+            cacheFile = GetXRCCacheFileName(m_cacheDir, filename, encoding);
+
+            wxXmlResourceCacheReader cache;
+            if ( cache.Open(cacheFile, filename, encoding, modTime) )
+            {
+                doc.reset(cache.ReadDocument());
+                if ( doc )
+                {
+                    wxLogTrace(wxT("xrc"), wxT("using cache file '%s'"),
+                               cacheFile);
+#if !wxUSE_UNICODE
+                    doc->SetEncoding(encoding);
+#endif
+                }
+            }
+        }
     }
+
+    if ( !doc )
+#endif // wxUSE_DATETIME
+    {
+        wxInputStream *stream = NULL;
+
+#if wxUSE_FILESYSTEM
+        wxFileSystem fsys;
+        wxScopedPtr<wxFSFile> file(fsys.OpenFile(filename));
+        if (file)
+        {
+            // Notice that we don't have ownership of the stream in this case,
+            // it remains owned by wxFSFile.
+            stream = file->GetStream();
+        }
 #else // !wxUSE_FILESYSTEM
-    wxFileInputStream fstream(filename);
-    stream = &fstream;
+        wxFileInputStream fstream(filename);
+        stream = &fstream;
 #endif // wxUSE_FILESYSTEM/!wxUSE_FILESYSTEM
 
-    if ( !stream || !stream->IsOk() )
-    {
-        wxLogError(_("Cannot open resources file '%s'."), filename);
-        return NULL;
-    }
+        if ( !stream || !stream->IsOk() )
+        {
+            wxLogError(_("Cannot open resources file '%s'."), filename);
+            return NULL;
+        }
 
-    wxString encoding(wxT("UTF-8"));
-#if !wxUSE_UNICODE && wxUSE_INTL
-    if ( (GetFlags() & wxXRC_USE_LOCALE) == 0 )
-    {
-        // In case we are not using wxLocale to translate strings, convert the
-        // strings GUI's charset. This must not be done when wxXRC_USE_LOCALE
-        // is on, because it could break wxGetTranslation lookup.
-        encoding = wxLocale::GetSystemEncodingName();
-    }
-#endif
+        doc.reset(new wxXmlDocument);
+        if (!doc->Load(*stream, encoding, wxXMLDOC_USE_ARENA))
+        {
+            wxLogError(_("Cannot load resources from file '%s'."), filename);
+            return NULL;
+        }
 
-    wxScopedPtr<wxXmlDocument> doc(new wxXmlDocument);
-    if (!doc->Load(*stream, encoding))
-    {
-        wxLogError(_("Cannot load resources from file '%s'."), filename);
-        return NULL;
+#if wxUSE_DATETIME
+        if ( !cacheFile.empty() && doc->GetRoot()->GetName() == wxT("resource") )
+        {
+            wxXmlResourceCacheWriter cache;
+            cache.Write(*doc, filename, encoding, modTime);
+
+            // Failing to create the cache is not an error, we just won't be
+            // able to use it the next time.
+            bool saved;
+            {
+                wxLogNull noLog;
+                saved = cache.Save(cacheFile);
+            }
+
+            if ( !saved )
+            {
+                wxLogTrace(wxT("xrc"), wxT("failed to write cache file '%s'"),
+                           cacheFile);
+            }
+        }
+#endif // wxUSE_DATETIME
     }
 
     wxXmlNode * const root = doc->GetRoot();
@@ -787,29 +1553,9 @@ wxXmlNode *wxXmlResource::DoFindResource(wxXmlNode *parent,
     // where the resource is most commonly looked for):
     for (node = parent->GetChildren(); node; node = node->GetNext())
     {
-        if ( IsObjectNode(node) && node->GetAttribute(wxS("name")) == name )
-        {
-            // empty class name matches everything
-            if ( classname.empty() )
-                return node;
-
-            wxString cls(node->GetAttribute(wxS("class")));
-
-            // object_ref may not have 'class' attribute:
-            if (cls.empty() && node->GetName() == wxS("object_ref"))
-            {
-                wxString refName = node->GetAttribute(wxS("ref"));
-                if (refName.empty())
-                    continue;
-
-                const wxXmlNode * const refNode = GetResourceNode(refName);
-                if ( refNode )
-                    cls = refNode->GetAttribute(wxS("class"));
-            }
-
-            if ( cls == classname )
-                return node;
-        }
+        if ( IsObjectNode(node) && node->GetAttribute(wxS("name")) == name &&
+                IsNodeOfClass(*this, node, classname) )
+            return node;
     }
 
     // then recurse in child nodes
@@ -868,30 +1614,70 @@ wxXmlResource::GetResourceNodeAndLocation(const wxString& name,
                                           bool recursive,
                                           wxString *path) const
 {
+    wxXmlResource * const self = const_cast<wxXmlResource *>(this);
+
     // ensure everything is up-to-date: this is needed to support on-demand
     // reloading of XRC files
-    const_cast<wxXmlResource *>(this)->UpdateResources();
+    self->UpdateResources();
+
+    wxXmlResourceDataRecords& data = self->Data();
+
+    // Find the first matching node in the loaded files using the index.
+    // Notice that we need to copy the entries as checking the class can look
+    // up other resources and so invalidate the index.
+    size_t posFound = data.size();
+    wxXmlNode *found = NULL;
+    if ( const wxXmlResourceDataRecords::IndexEntries *
+            entries = data.FindInIndex(name) )
+    {
+        const wxXmlResourceDataRecords::IndexEntries candidates(*entries);
+        for ( size_t n = 0; n < candidates.size(); n++ )
+        {
+            if ( (recursive || candidates[n].topLevel) &&
+                    IsNodeOfClass(*this, candidates[n].node, classname) )
+            {
+                posFound = candidates[n].pos;
+                found = candidates[n].node;
+                break;
+            }
+        }
+    }
 
-    for ( wxXmlResourceDataRecords::const_iterator f = Data().begin();
-          f != Data().end(); ++f )
+    // The files preceding the one containing this node may still define the
+    // resource if they haven't been loaded yet.
+    for ( size_t pos = 0; pos < posFound; pos++ )
     {
-        wxXmlResourceDataRecord *const rec = *f;
-        wxXmlDocument * const doc = rec->Doc;
-        if ( !doc || !doc->GetRoot() )
+        wxXmlResourceDataRecord * const rec = data[pos];
+        if ( !rec->OnDemand || (!recursive && !rec->MayContain(name)) )
+            continue;
+
+        wxLogTrace(wxT("xrc"), wxT("loading file '%s' on demand"), rec->File);
+
+        rec->OnDemand = false;
+        rec->Doc = self->DoLoadFile(rec->File);
+#if wxUSE_DATETIME
+        rec->Time = GetXRCFileModTime(rec->File);
+#endif // wxUSE_DATETIME
+        wxDELETE(rec->Names);
+        data.InvalidateIndex();
+
+        if ( !rec->Doc || !rec->Doc->GetRoot() )
             continue;
 
         wxXmlNode * const
-            found = DoFindResource(doc->GetRoot(), name, classname, recursive);
-        if ( found )
+            node = DoFindResource(rec->Doc->GetRoot(), name, classname, recursive);
+        if ( node )
         {
-            if ( path )
-                *path = rec->File;
-
-            return found;
+            posFound = pos;
+            found = node;
+            break;
         }
     }
 
-    return NULL;
+    if ( found && path )
+        *path = data[posFound]->File;
+
+    return found;
 }
 
 static void MergeNodesOver(wxXmlNode& dest, wxXmlNode& overwriteWith,
@@ -20,6 +20,7 @@
 
 #include "archivetest.h"
 #include "wx/zipstrm.h"
+#include "wx/mstream.h"
 
 using std::string;
 using std::auto_ptr;
@@ -204,6 +205,217 @@ void ZipPipeTestCase::runTest()
 }
 
 
+///////////////////////////////////////////////////////////////////////////////
+// Test compressing entries using several threads and compressing them in
+// advance and writing them as raw entries.
+
+class ZipParallelTestCase : public CppUnit::TestCase
+{
+public:
+    ZipParallelTestCase(string name) :
+        CppUnit::TestCase(TestId::MakeId() + name)
+    { }
+
+protected:
+    void runTest();
+};
+
+void ZipParallelTestCase::runTest()
+{
+    // make the data big enough to be split in many small blocks
+    wxString testdata;
+    for (int i = 0; i < 1000; i++)
+        testdata << wxString::Format(wxT("line %d of the test data\n"), i);
+
+    const wxCharBuffer buf(testdata.mb_str());
+    const size_t len = strlen(buf);
+
+    wxMemoryOutputStream out;
+    {
+        wxZipOutputStream zip(out);
+        zip.SetThreads(4, 1024);
+
+        CPPUNIT_ASSERT(zip.PutNextEntry(wxT("parallel")));
+        CPPUNIT_ASSERT(zip.Write(buf, len).IsOk());
+
+        wxMemoryBuffer compressed;
+        wxZipEntry *entry = new wxZipEntry(wxT("raw"));
+        CPPUNIT_ASSERT(wxZipOutputStream::CompressEntry(*entry, buf, len,
+                                                        compressed));
+        CPPUNIT_ASSERT(entry->GetMethod() == wxZIP_METHOD_DEFLATE);
+        CPPUNIT_ASSERT(entry->GetCompressedSize() < (wxFileOffset)len);
+
+        CPPUNIT_ASSERT(zip.PutNextRawEntry(entry));
+        CPPUNIT_ASSERT(zip.Write(compressed.GetData(),
+                                 compressed.GetDataLen()).IsOk());
+
+        CPPUNIT_ASSERT(zip.Close());
+    }
+
+    wxMemoryInputStream in(out);
+    wxZipInputStream zip(in);
+
+    for (int n = 0; n < 2; n++) {
+        auto_ptr<wxZipEntry> entry(zip.GetNextEntry());
+        CPPUNIT_ASSERT(entry.get() != NULL);
+
+        wxCharBuffer data(len);
+        CPPUNIT_ASSERT_EQUAL(len, zip.Read(data.data(), len).LastRead());
+        CPPUNIT_ASSERT(memcmp(data, buf, len) == 0);
+
+        // this also checks the crc of the entry
+        zip.GetC();
+        CPPUNIT_ASSERT(zip.Eof());
+    }
+}
+
+
+///////////////////////////////////////////////////////////////////////////////
+// Test opening an entry of a seekable stream by its offset before reading the
+// end record and then loading it and enumerating the entries.
+
+class ZipOpenByOffsetTestCase : public CppUnit::TestCase
+{
+public:
+    ZipOpenByOffsetTestCase(string name) :
+        CppUnit::TestCase(TestId::MakeId() + name)
+    { }
+
+protected:
+    void runTest();
+};
+
+void ZipOpenByOffsetTestCase::runTest()
+{
+    const wxString comment = wxT("archive comment");
+    const int count = 3;
+    wxString testdata[count];
+
+    wxMemoryOutputStream out;
+    {
+        wxZipOutputStream zip(out);
+        zip.SetComment(comment);
+
+        for (int n = 0; n < count; n++) {
+            for (int i = 0; i < 200; i++)
+                testdata[n] << wxString::Format(wxT("line %d of entry %d\n"),
+                                                i, n);
+
+            const wxCharBuffer buf(testdata[n].mb_str());
+            CPPUNIT_ASSERT(zip.PutNextEntry(wxString::Format(wxT("entry%d"), n)));
+            CPPUNIT_ASSERT(zip.Write(buf, strlen(buf)).IsOk());
+        }
+
+        CPPUNIT_ASSERT(zip.Close());
+    }
+
+    // get the entry in the middle, which knows its offset, from another stream
+    auto_ptr<wxZipEntry> middle;
+    {
+        wxMemoryInputStream in(out);
+        wxZipInputStream zip(in);
+
+        for (int n = 0; n <= count / 2; n++) {
+            middle.reset(zip.GetNextEntry());
+            CPPUNIT_ASSERT(middle.get() != NULL);
+        }
+    }
+
+    wxMemoryInputStream in(out);
+    wxZipInputStream zip(in);
+
+    CPPUNIT_ASSERT(zip.OpenEntry(*middle));
+
+    const wxCharBuffer buf(testdata[count / 2].mb_str());
+    const size_t len = strlen(buf);
+    const size_t half = len / 2;
+
+    wxCharBuffer data(len);
+    CPPUNIT_ASSERT_EQUAL(half, zip.Read(data.data(), half).LastRead());
+
+    // loading the end record now must not disturb reading the current entry
+    CPPUNIT_ASSERT(zip.GetComment() == comment);
+    CPPUNIT_ASSERT_EQUAL(count, zip.GetTotalEntries());
+
+    CPPUNIT_ASSERT_EQUAL(len - half,
+                         zip.Read(data.data() + half, len - half).LastRead());
+    CPPUNIT_ASSERT(memcmp(data, buf, len) == 0);
+
+    // this also checks the crc of the entry
+    zip.GetC();
+    CPPUNIT_ASSERT(zip.Eof());
+
+    // and all the entries can still be enumerated from the beginning
+    for (int n = 0; n < count; n++) {
+        auto_ptr<wxZipEntry> entry(zip.GetNextEntry());
+        CPPUNIT_ASSERT(entry.get() != NULL);
+        CPPUNIT_ASSERT(entry->GetName() == wxString::Format(wxT("entry%d"), n));
+
+        const wxCharBuffer expected(testdata[n].mb_str());
+        const size_t expectedLen = strlen(expected);
+
+        wxCharBuffer entryData(expectedLen);
+        CPPUNIT_ASSERT_EQUAL(expectedLen,
+                             zip.Read(entryData.data(), expectedLen).LastRead());
+        CPPUNIT_ASSERT(memcmp(entryData, expected, expectedLen) == 0);
+
+        zip.GetC();
+        CPPUNIT_ASSERT(zip.Eof());
+    }
+
+    auto_ptr<wxZipEntry> end(zip.GetNextEntry());
+    CPPUNIT_ASSERT(end.get() == NULL);
+    CPPUNIT_ASSERT(zip.GetComment() == comment);
+}
+
+
+///////////////////////////////////////////////////////////////////////////////
+// Test that a corrupted central directory size in the end record is detected
+// instead of being used to read the directory into memory.
+
+class ZipBadDirSizeTestCase : public CppUnit::TestCase
+{
+public:
+    ZipBadDirSizeTestCase(string name) :
+        CppUnit::TestCase(TestId::MakeId() + name)
+    { }
+
+protected:
+    void runTest();
+};
+
+void ZipBadDirSizeTestCase::runTest()
+{
+    wxMemoryOutputStream out;
+    {
+        wxZipOutputStream zip(out);
+        CPPUNIT_ASSERT(zip.PutNextEntry(wxT("entry")));
+        CPPUNIT_ASSERT(zip.Write("data", 4).IsOk());
+        CPPUNIT_ASSERT(zip.Close());
+    }
+
+    const size_t len = out.GetLength();
+    wxCharBuffer data(len);
+    out.CopyTo(data.data(), len);
+
+    // without a comment, the end record is the last 22 bytes of the zip and
+    // the central directory size is stored at offset 12 in it
+    char * const endrec = data.data() + len - 22;
+    CPPUNIT_ASSERT(memcmp(endrec, "PK\x05\x06", 4) == 0);
+
+    static const char hugeSize[] = { '\xf0', '\xff', '\xff', '\xff' };
+    memcpy(endrec + 12, hugeSize, sizeof(hugeSize));
+
+    wxLogNull nolog;
+    wxMemoryInputStream in(data, len);
+    wxZipInputStream zip(in);
+
+    auto_ptr<wxZipEntry> entry(zip.GetNextEntry());
+    CPPUNIT_ASSERT(entry.get() == NULL);
+    CPPUNIT_ASSERT_EQUAL(wxSTREAM_READ_ERROR, zip.GetLastError());
+}
+
+
 ///////////////////////////////////////////////////////////////////////////////
 // Zip suite 
 
@@ -242,6 +454,10 @@ ArchiveTestSuite *ziptest::makeSuite()
         }
 #endif
 
+    addTest(new ZipParallelTestCase("ZipParallelTestCase"));
+    addTest(new ZipOpenByOffsetTestCase("ZipOpenByOffsetTestCase"));
+    addTest(new ZipBadDirSizeTestCase("ZipBadDirSizeTestCase"));
+
     return this;
 }
 
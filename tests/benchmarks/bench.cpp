@@ -17,7 +17,10 @@
 
 #include "wx/app.h"
 #include "wx/cmdline.h"
+#include "wx/ffile.h"
 #include "wx/stopwatch.h"
+#include "wx/tokenzr.h"
+#include "wx/vector.h"
 
 #if wxUSE_GUI
     #include "wx/frame.h"
@@ -25,6 +28,34 @@
 
 #include "bench.h"
 
+#include <algorithm>
+#include <errno.h>
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+
+// Hardware performance counters are only supported under Linux where they are
+// available via perf_event_open(2).
+#ifdef __LINUX__
+    #define wxBENCH_USE_PERF_COUNTERS 1
+
+    #include <linux/perf_event.h>
+    #include <sys/ioctl.h>
+    #include <sys/syscall.h>
+    #include <unistd.h>
+#else
+    #define wxBENCH_USE_PERF_COUNTERS 0
+#endif
+
+// Allocation tracking relies on overriding malloc() and forwarding to the
+// original functions, which are only accessible under their own names in
+// glibc.
+#if defined(__GLIBC__) && defined(__GNUC__)
+    #define wxBENCH_USE_ALLOC_TRACKING 1
+#else
+    #define wxBENCH_USE_ALLOC_TRACKING 0
+#endif
+
 // ----------------------------------------------------------------------------
 // constants
 // ----------------------------------------------------------------------------
@@ -37,6 +68,237 @@ static const char OPTION_NUM_RUNS = 'n';
 static const char OPTION_NUMERIC_PARAM = 'p';
 static const char OPTION_STRING_PARAM = 's';
 
+static const char OPTION_TIME_BUDGET = 't';
+static const char OPTION_JSON = 'j';
+static const char OPTION_BASELINE = 'b';
+static const char OPTION_THRESHOLD = 'r';
+static const char OPTION_PERF_COUNTERS = 'c';
+static const char OPTION_TRACK_ALLOCS = 'm';
+
+// in time-based mode, the budget is split in samples of at least this many
+// iterations taking at least budget/SAMPLES_TARGET each
+static const int SAMPLES_TARGET = 50;
+
+// but we always collect at least this many of them, even if it means going
+// over the budget, as statistics of fewer samples are meaningless
+static const int SAMPLES_MIN = 5;
+
+// ----------------------------------------------------------------------------
+// BenchStats: statistics for a single benchmark
+// ----------------------------------------------------------------------------
+
+// All times here are for a single iteration of the benchmark function and are
+// expressed in nanoseconds.
+struct BenchStats
+{
+    BenchStats()
+    {
+        iterations = 0;
+        samples = 0;
+        min = max = mean = median = p10 = p90 = mad = 0.;
+    }
+
+    // Compute all the fields from the given samples (which are sorted by this
+    // function as a side effect).
+    void Compute(wxVector<double>& times, long iterationsPerSample);
+
+    long iterations,
+         samples;
+    double min,
+           max,
+           mean,
+           median,
+           p10,
+           p90,
+           mad;  // median absolute deviation from the median
+};
+
+// Optional counters, averaged over all iterations of a single benchmark.
+struct BenchCounters
+{
+    BenchCounters()
+    {
+        hasPerf = false;
+        hasAllocs = false;
+        cycles = instructions = cacheMisses = branchMisses = 0.;
+        allocs = allocBytes = 0.;
+    }
+
+    bool hasPerf;
+    double cycles,
+           instructions,
+           cacheMisses,
+           branchMisses;
+
+    bool hasAllocs;
+    double allocs,
+           allocBytes;
+};
+
+// Result of running a single benchmark.
+struct BenchResult
+{
+    wxString name;
+    long numParam;
+    wxString strParam;
+    BenchStats stats;
+    BenchCounters counters;
+};
+
+// Baseline entry, as read from a JSON file saved by a previous run.
+struct BaselineEntry
+{
+    wxString name;
+    long numParam;
+    wxString strParam;
+    double median,
+           mad;
+};
+
+// ----------------------------------------------------------------------------
+// PerfCounters: hardware performance counters for the current process
+// ----------------------------------------------------------------------------
+
+class PerfCounters
+{
+public:
+    enum
+    {
+        Cycles,
+        Instructions,
+        CacheMisses,
+        BranchMisses,
+        Max
+    };
+
+    PerfCounters();
+    ~PerfCounters();
+
+    // Open the counters, return false if they're not available at all (e.g.
+    // because of insufficient permissions or lack of hardware support). Some
+    // of them can still be unavailable even if this returns true, check
+    // IsAvailable() for them.
+    bool Open();
+
+    bool IsAvailable(int counter) const { return m_fds[counter] != -1; }
+
+    // Start counting from 0.
+    void Start();
+
+    // Stop counting and add the counts since Start() to the given values.
+    void Stop(wxUint64 values[Max]);
+
+private:
+#if wxBENCH_USE_PERF_COUNTERS
+    int m_fds[Max];
+#else
+    static const int m_fds[Max];
+#endif
+
+    wxDECLARE_NO_COPY_CLASS(PerfCounters);
+};
+
+// ----------------------------------------------------------------------------
+// allocation tracking
+// ----------------------------------------------------------------------------
+
+namespace
+{
+
+// Counters of all calls to malloc() and related functions made while the
+// tracking is on: they're updated atomically as benchmarks can use threads.
+volatile bool gs_trackAllocs = false;
+wxUint64 gs_allocCount = 0;
+wxUint64 gs_allocBytes = 0;
+
+inline void TrackAlloc(size_t size)
+{
+#if wxBENCH_USE_ALLOC_TRACKING
+    if ( gs_trackAllocs )
+    {
+        __sync_fetch_and_add(&gs_allocCount, 1);
+        __sync_fetch_and_add(&gs_allocBytes, size);
+    }
+#else
+    wxUnusedVar(size);
+#endif
+}
+
+} // anonymous namespace
+
+#if wxBENCH_USE_ALLOC_TRACKING
+
+// Override the standard allocation functions for the entire process. This
+// also covers operator new, which uses malloc() in libstdc++, and all the
+// allocations done by wxWidgets libraries themselves. All the functions
+// allocating memory are overridden, and not only malloc(), as glibc doesn't
+// implement the others in terms of it.
+extern "C"
+{
+
+void *__libc_malloc(size_t size);
+void *__libc_calloc(size_t count, size_t size);
+void *__libc_realloc(void *ptr, size_t size);
+void *__libc_memalign(size_t alignment, size_t size);
+void __libc_free(void *ptr);
+
+void *malloc(size_t size) __THROW
+{
+    TrackAlloc(size);
+    return __libc_malloc(size);
+}
+
+void *calloc(size_t count, size_t size) __THROW
+{
+    TrackAlloc(count*size);
+    return __libc_calloc(count, size);
+}
+
+void *realloc(void *ptr, size_t size) __THROW
+{
+    TrackAlloc(size);
+    return __libc_realloc(ptr, size);
+}
+
+void *memalign(size_t alignment, size_t size) __THROW
+{
+    TrackAlloc(size);
+    return __libc_memalign(alignment, size);
+}
+
+void *aligned_alloc(size_t alignment, size_t size) __THROW
+{
+    TrackAlloc(size);
+    return __libc_memalign(alignment, size);
+}
+
+int posix_memalign(void **ptr, size_t alignment, size_t size) __THROW
+{
+    // unlike memalign(), this function must check its alignment argument
+    if ( !alignment || alignment % sizeof(void *) ||
+            (alignment & (alignment - 1)) )
+        return EINVAL;
+
+    TrackAlloc(size);
+    void * const p = __libc_memalign(alignment, size);
+    if ( !p )
+        return ENOMEM;
+
+    *ptr = p;
+    return 0;
+}
+
+// This one is not tracked, but is still overridden for consistency with the
+// functions above, as recommended by glibc documentation.
+void free(void *ptr) __THROW
+{
+    __libc_free(ptr);
+}
+
+} // extern "C"
+
+#endif // wxBENCH_USE_ALLOC_TRACKING
+
 // ----------------------------------------------------------------------------
 // BenchApp declaration
 // ----------------------------------------------------------------------------
@@ -67,12 +329,63 @@ private:
     // list all registered benchmarks
     void ListBenchmarks();
 
+    // run the benchmark the fixed number of times specified by the options
+    // and fill the times of each of the samples in the provided vector
+    bool RunFixed(Bench::Function *func,
+                  wxVector<double>& times,
+                  long& iterationsPerSample);
+
+    // run the benchmark for the given time budget, choosing the number of
+    // iterations per sample automatically
+    bool RunTimed(Bench::Function *func,
+                  wxVector<double>& times,
+                  long& iterationsPerSample);
+
+    // load the baseline file, return false if it couldn't be done
+    bool LoadBaseline(const wxString& filename);
+
+    // find the baseline entry for the given result or return NULL
+    const BaselineEntry *FindBaseline(const BenchResult& result) const;
+
+    // compare the result with the baseline, print the comparison and return
+    // false if a regression was detected
+    bool CompareWithBaseline(const BenchResult& result) const;
+
+    // save all results to the JSON file
+    bool SaveJSON(const wxString& filename) const;
+
+    // must be called before and after every sample to update the counters
+    // enabled by the command line options, if any
+    void StartSample();
+    void StopSample();
+
+    // reset the counters before starting a new benchmark
+    void ResetCounters();
+
+    // compute the per iteration values of the counters after finishing it
+    void GetCounters(BenchCounters& counters, long iterations) const;
+
     // command lines options/parameters
     wxSortedArrayString m_toRun;
     long m_numRuns,
          m_avgCount,
-         m_numParam;
-    wxString m_strParam;
+         m_numParam,
+         m_timeBudget;
+    double m_threshold;
+    wxString m_strParam,
+             m_jsonFile;
+
+    bool m_usePerfCounters,
+         m_trackAllocs;
+
+    // counters totals for the current benchmark
+    PerfCounters m_perfCounters;
+    wxUint64 m_perfTotals[PerfCounters::Max],
+             m_allocCount,
+             m_allocBytes;
+
+    wxVector<BaselineEntry> m_baseline;
+    wxVector<BenchResult> m_results;
 };
 
 IMPLEMENT_APP_CONSOLE(BenchApp)
@@ -93,6 +406,277 @@ wxString Bench::GetStringParameter()
     return wxGetApp().GetStringParameter();
 }
 
+// ============================================================================
+// helper functions
+// ============================================================================
+
+// Return the value at the given (0..1) position in the sorted vector, using
+// linear interpolation between the adjacent elements.
+static double GetPercentile(const wxVector<double>& sorted, double pos)
+{
+    const size_t count = sorted.size();
+    if ( !count )
+        return 0.;
+
+    const double index = pos*(count - 1);
+    const size_t lo = static_cast<size_t>(index);
+    if ( lo + 1 >= count )
+        return sorted[count - 1];
+
+    return sorted[lo] + (index - lo)*(sorted[lo + 1] - sorted[lo]);
+}
+
+void BenchStats::Compute(wxVector<double>& times, long iterationsPerSample)
+{
+    samples = times.size();
+    iterations = samples*iterationsPerSample;
+    if ( !samples )
+        return;
+
+    std::sort(times.begin(), times.end());
+
+    double total = 0.;
+    for ( size_t n = 0; n < times.size(); n++ )
+        total += times[n];
+
+    min = times[0];
+    max = times[samples - 1];
+    mean = total / samples;
+    median = GetPercentile(times, 0.5);
+    p10 = GetPercentile(times, 0.1);
+    p90 = GetPercentile(times, 0.9);
+
+    wxVector<double> deviations;
+    deviations.reserve(times.size());
+    for ( size_t n = 0; n < times.size(); n++ )
+        deviations.push_back(fabs(times[n] - median));
+
+    std::sort(deviations.begin(), deviations.end());
+    mad = GetPercentile(deviations, 0.5);
+}
+
+// ----------------------------------------------------------------------------
+// PerfCounters implementation
+// ----------------------------------------------------------------------------
+
+#if wxBENCH_USE_PERF_COUNTERS
+
+PerfCounters::PerfCounters()
+{
+    for ( int n = 0; n < Max; n++ )
+        m_fds[n] = -1;
+}
+
+PerfCounters::~PerfCounters()
+{
+    for ( int n = 0; n < Max; n++ )
+    {
+        if ( m_fds[n] != -1 )
+            close(m_fds[n]);
+    }
+}
+
+bool PerfCounters::Open()
+{
+    static const wxUint64 configs[Max] =
+    {
+        PERF_COUNT_HW_CPU_CYCLES,
+        PERF_COUNT_HW_INSTRUCTIONS,
+        PERF_COUNT_HW_CACHE_MISSES,
+        PERF_COUNT_HW_BRANCH_MISSES,
+    };
+
+    bool ok = false;
+    for ( int n = 0; n < Max; n++ )
+    {
+        perf_event_attr attr;
+        memset(&attr, 0, sizeof(attr));
+        attr.size = sizeof(attr);
+        attr.type = PERF_TYPE_HARDWARE;
+        attr.config = configs[n];
+        attr.disabled = 1;
+        attr.exclude_kernel = 1;
+        attr.exclude_hv = 1;
+
+        // Count the events in the threads created by the benchmark too.
+        attr.inherit = 1;
+
+        // The counters may be multiplexed if there are not enough of them,
+        // in which case we need to scale their values.
+        attr.read_format = PERF_FORMAT_TOTAL_TIME_ENABLED |
+                           PERF_FORMAT_TOTAL_TIME_RUNNING;
+
+        m_fds[n] = syscall(__NR_perf_event_open, &attr, 0, -1, -1, 0);
+        if ( m_fds[n] != -1 )
+            ok = true;
+    }
+
+    return ok;
+}
+
+void PerfCounters::Start()
+{
+    for ( int n = 0; n < Max; n++ )
+    {
+        if ( m_fds[n] != -1 )
+        {
+            ioctl(m_fds[n], PERF_EVENT_IOC_RESET, 0);
+            ioctl(m_fds[n], PERF_EVENT_IOC_ENABLE, 0);
+        }
+    }
+}
+
+void PerfCounters::Stop(wxUint64 values[Max])
+{
+    for ( int n = 0; n < Max; n++ )
+    {
+        if ( m_fds[n] != -1 )
+            ioctl(m_fds[n], PERF_EVENT_IOC_DISABLE, 0);
+    }
+
+    for ( int n = 0; n < Max; n++ )
+    {
+        if ( m_fds[n] == -1 )
+            continue;
+
+        // value, time enabled, time running
+        wxUint64 data[3];
+        if ( read(m_fds[n], data, sizeof(data)) != sizeof(data) || !data[2] )
+            continue;
+
+        if ( data[2] < data[1] )
+            data[0] = static_cast<wxUint64>(double(data[0])*data[1]/data[2]);
+
+        values[n] += data[0];
+    }
+}
+
+#else // !wxBENCH_USE_PERF_COUNTERS
+
+const int PerfCounters::m_fds[PerfCounters::Max] = { -1, -1, -1, -1 };
+
+PerfCounters::PerfCounters() { }
+PerfCounters::~PerfCounters() { }
+bool PerfCounters::Open() { return false; }
+void PerfCounters::Start() { }
+void PerfCounters::Stop(wxUint64 WXUNUSED(values)[Max]) { }
+
+#endif // wxBENCH_USE_PERF_COUNTERS/!wxBENCH_USE_PERF_COUNTERS
+
+// Format the time given in nanoseconds using appropriate units.
+static wxString FormatTime(double ns)
+{
+    if ( ns < 1e3 )
+        return wxString::Format("%.1fns", ns);
+    if ( ns < 1e6 )
+        return wxString::Format("%.2fus", ns / 1e3);
+    if ( ns < 1e9 )
+        return wxString::Format("%.2fms", ns / 1e6);
+
+    return wxString::Format("%.2fs", ns / 1e9);
+}
+
+// Quote the string for inclusion in JSON output.
+static wxString QuoteJSON(const wxString& s)
+{
+    wxString quoted("\"");
+    for ( wxString::const_iterator i = s.begin(); i != s.end(); ++i )
+    {
+        const wxChar ch = *i;
+        switch ( ch )
+        {
+            case '"':
+            case '\\':
+                quoted += '\\';
+                quoted += ch;
+                break;
+
+            case '\n':
+                quoted += "\\n";
+                break;
+
+            case '\t':
+                quoted += "\\t";
+                break;
+
+            default:
+                if ( static_cast<unsigned>(ch) < 0x20 )
+                    quoted += wxString::Format("\\u%04x", static_cast<unsigned>(ch));
+                else
+                    quoted += ch;
+        }
+    }
+
+    quoted += '"';
+
+    return quoted;
+}
+
+// Extract the value of the given key from a single line of JSON as written by
+// SaveJSON(). This is not a general JSON parser, but it doesn't need to be as
+// we only read the files we produce ourselves.
+static bool GetJSONValue(const wxString& line, const char *key, wxString& value)
+{
+    const wxString search = wxString::Format("\"%s\":", key);
+    size_t pos = line.find(search);
+    if ( pos == wxString::npos )
+        return false;
+
+    pos += search.length();
+    while ( pos < line.length() && line[pos] == ' ' )
+        pos++;
+
+    if ( pos == line.length() )
+        return false;
+
+    value.clear();
+    if ( line[pos] == '"' )
+    {
+        for ( pos++; pos < line.length(); pos++ )
+        {
+            wxChar ch = line[pos];
+            if ( ch == '"' )
+                return true;
+
+            if ( ch == '\\' && ++pos < line.length() )
+            {
+                ch = line[pos];
+                switch ( ch )
+                {
+                    case 'n':
+                        ch = '\n';
+                        break;
+
+                    case 't':
+                        ch = '\t';
+                        break;
+
+                    case 'u':
+                        {
+                            unsigned long code;
+                            if ( !line.substr(pos + 1, 4).ToULong(&code, 16) )
+                                return false;
+                            ch = static_cast<wxChar>(code);
+                            pos += 4;
+                        }
+                        break;
+                }
+            }
+
+            value += ch;
+        }
+
+        // unterminated string
+        return false;
+    }
+
+    const size_t end = line.find_first_of(",}", pos);
+    value = line.substr(pos, end == wxString::npos ? wxString::npos : end - pos);
+    value.Trim();
+
+    return !value.empty();
+}
+
 // ============================================================================
 // BenchApp implementation
 // ============================================================================
@@ -100,8 +684,14 @@ wxString Bench::GetStringParameter()
 BenchApp::BenchApp()
 {
     m_avgCount = 10;
-    m_numRuns = 10000; // just some default (TODO: switch to time-based one)
+    m_numRuns = 10000; // just some default, use --time for time-based mode
     m_numParam = 0;
+    m_timeBudget = 0;
+    m_threshold = 5.;
+    m_usePerfCounters = false;
+    m_trackAllocs = false;
+
+    ResetCounters();
 }
 
 bool BenchApp::OnInit()
@@ -163,6 +753,38 @@ void BenchApp::OnInitCmdLine(wxCmdLineParser& parser)
                      "string parameter used by some benchmark functions "
                      "(default: empty)",
                      wxCMD_LINE_VAL_STRING);
+    parser.AddOption(OPTION_TIME_BUDGET,
+                     "time",
+                     "run each benchmark for the given number of milliseconds, "
+                     "choosing the number of iterations automatically",
+                     wxCMD_LINE_VAL_NUMBER);
+    parser.AddOption(OPTION_JSON,
+                     "json",
+                     "save the results in JSON format to the given file",
+                     wxCMD_LINE_VAL_STRING);
+    parser.AddOption(OPTION_BASELINE,
+                     "baseline",
+                     "compare the results with those in the given JSON file "
+                     "and exit with an error if any benchmark became slower",
+                     wxCMD_LINE_VAL_STRING);
+    parser.AddOption(OPTION_THRESHOLD,
+                     "threshold",
+                     wxString::Format
+                     (
+                         "minimal slowdown, in percents, considered to be a "
+                         "regression when comparing with the baseline "
+                         "(default: %g)",
+                         m_threshold
+                     ),
+                     wxCMD_LINE_VAL_DOUBLE);
+    parser.AddSwitch(OPTION_PERF_COUNTERS,
+                     "perf-counters",
+                     "also show CPU cycles, instructions, cache and branch "
+                     "misses per iteration (Linux only)");
+    parser.AddSwitch(OPTION_TRACK_ALLOCS,
+                     "track-allocs",
+                     "also show the number of heap allocations and bytes "
+                     "allocated per iteration (glibc only)");
 
     parser.AddParam("benchmark name",
                     wxCMD_LINE_VAL_STRING,
@@ -195,6 +817,18 @@ bool BenchApp::OnCmdLineParsed(wxCmdLineParser& parser)
         numRunsSpecified = true;
     parser.Found(OPTION_NUMERIC_PARAM, &m_numParam);
     parser.Found(OPTION_STRING_PARAM, &m_strParam);
+    if ( parser.Found(OPTION_TIME_BUDGET, &m_timeBudget) )
+    {
+        if ( numRunsSpecified || m_timeBudget <= 0 )
+        {
+            wxFprintf(stderr, "Invalid time budget specified.\n");
+
+            return false;
+        }
+
+        numRunsSpecified = true;
+    }
+
     if ( parser.Found(OPTION_SINGLE) )
     {
         if ( numRunsSpecified )
@@ -208,6 +842,34 @@ bool BenchApp::OnCmdLineParsed(wxCmdLineParser& parser)
         m_numRuns = 1;
     }
 
+    parser.Found(OPTION_JSON, &m_jsonFile);
+    parser.Found(OPTION_THRESHOLD, &m_threshold);
+
+    if ( parser.Found(OPTION_PERF_COUNTERS) )
+    {
+        if ( !m_perfCounters.Open() )
+        {
+            wxFprintf(stderr, "Performance counters are not available.\n");
+            return false;
+        }
+
+        m_usePerfCounters = true;
+    }
+
+    if ( parser.Found(OPTION_TRACK_ALLOCS) )
+    {
+#if wxBENCH_USE_ALLOC_TRACKING
+        m_trackAllocs = true;
+#else
+        wxFprintf(stderr, "Allocation tracking is not supported.\n");
+        return false;
+#endif
+    }
+
+    wxString baseline;
+    if ( parser.Found(OPTION_BASELINE, &baseline) && !LoadBaseline(baseline) )
+        return false;
+
     // construct sorted array for quick verification of benchmark names
     wxSortedArrayString benchmarks;
     for ( Bench::Function *func = Bench::Function::GetFirst();
@@ -232,6 +894,115 @@ bool BenchApp::OnCmdLineParsed(wxCmdLineParser& parser)
     return BenchAppBase::OnCmdLineParsed(parser);
 }
 
+bool BenchApp::RunFixed(Bench::Function *func,
+                        wxVector<double>& times,
+                        long& iterationsPerSample)
+{
+    iterationsPerSample = m_numRuns;
+
+    long timeMin = LONG_MAX,
+         timeMax = 0,
+         timeTotal = 0;
+    bool ok = true;
+    for ( long a = 0; ok && a < m_avgCount; a++ )
+    {
+        StartSample();
+
+        wxStopWatch sw;
+        for ( long n = 0; n < m_numRuns && ok; n++ )
+        {
+            ok = func->Run();
+        }
+
+        sw.Pause();
+
+        StopSample();
+
+        const long t = sw.Time();
+        if ( t < timeMin )
+            timeMin = t;
+        if ( t > timeMax )
+            timeMax = t;
+        timeTotal += t;
+
+        times.push_back(sw.TimeInMicro().ToDouble()*1000. / m_numRuns);
+    }
+
+    if ( !ok )
+        return false;
+
+    wxPrintf("%ldms total, ", timeTotal);
+
+    long count = m_avgCount;
+    if ( m_avgCount > 2 )
+    {
+        timeTotal -= timeMin + timeMax;
+        count -= 2;
+    }
+
+    wxPrintf("%.2f avg (min=%ld, max=%ld)",
+             (float)timeTotal / count, timeMin, timeMax);
+
+    return true;
+}
+
+bool BenchApp::RunTimed(Bench::Function *func,
+                        wxVector<double>& times,
+                        long& iterationsPerSample)
+{
+    const double budget = m_timeBudget*1e6; // in ns
+    const double sampleTime = budget / SAMPLES_TARGET;
+
+    // Find the number of iterations which takes at least sampleTime. This
+    // also serves as warm up, so the times measured here are not used.
+    iterationsPerSample = 1;
+    double spent = 0.;
+    for ( ;; )
+    {
+        wxStopWatch sw;
+        for ( long n = 0; n < iterationsPerSample; n++ )
+        {
+            if ( !func->Run() )
+                return false;
+        }
+
+        const double t = sw.TimeInMicro().ToDouble()*1000.;
+        spent += t;
+        if ( t >= sampleTime || iterationsPerSample >= LONG_MAX / 10 )
+            break;
+
+        // Don't spend too long calibrating very fast functions, but avoid
+        // overshooting the target too much for the slow ones neither.
+        iterationsPerSample *= t < sampleTime / 10 ? 10 : 2;
+    }
+
+    // Use the remaining budget for the real measurements.
+    while ( times.size() < static_cast<size_t>(SAMPLES_MIN) ||
+                spent < budget )
+    {
+        StartSample();
+
+        wxStopWatch sw;
+        for ( long n = 0; n < iterationsPerSample; n++ )
+        {
+            if ( !func->Run() )
+            {
+                StopSample();
+                return false;
+            }
+        }
+
+        const double t = sw.TimeInMicro().ToDouble()*1000.;
+
+        StopSample();
+        spent += t;
+
+        times.push_back(t / iterationsPerSample);
+    }
+
+    return true;
+}
+
 int BenchApp::OnRun()
 {
     int rc = EXIT_SUCCESS;
@@ -253,27 +1024,16 @@ int BenchApp::OnRun()
         }
 
         wxPrintf("Benchmarking %s%s: ", func->GetName(), params);
+        fflush(stdout);
 
-        long timeMin = LONG_MAX,
-             timeMax = 0,
-             timeTotal = 0;
+        wxVector<double> times;
+        long iterationsPerSample = 0;
+        ResetCounters();
         bool ok = func->Init();
-        for ( long a = 0; ok && a < m_avgCount; a++ )
+        if ( ok )
         {
-            wxStopWatch sw;
-            for ( long n = 0; n < m_numRuns && ok; n++ )
-            {
-                ok = func->Run();
-            }
-
-            sw.Pause();
-
-            const long t = sw.Time();
-            if ( t < timeMin )
-                timeMin = t;
-            if ( t > timeMax )
-                timeMax = t;
-            timeTotal += t;
+            ok = m_timeBudget ? RunTimed(func, times, iterationsPerSample)
+                              : RunFixed(func, times, iterationsPerSample);
         }
 
         func->Done();
@@ -285,25 +1045,316 @@ int BenchApp::OnRun()
         }
         else
         {
-            wxPrintf("%ldms total, ", timeTotal);
+            BenchResult result;
+            result.name = func->GetName();
+            result.numParam = m_numParam;
+            result.strParam = m_strParam;
+            result.stats.Compute(times, iterationsPerSample);
+            GetCounters(result.counters, result.stats.iterations);
+
+            const BenchStats& stats = result.stats;
+            if ( m_timeBudget )
+            {
+                wxPrintf("%s/iter median (p10=%s, p90=%s, MAD=%s; "
+                         "%ld samples of %ld iterations)",
+                         FormatTime(stats.median),
+                         FormatTime(stats.p10),
+                         FormatTime(stats.p90),
+                         FormatTime(stats.mad),
+                         stats.samples,
+                         iterationsPerSample);
+            }
+
+            if ( !CompareWithBaseline(result) )
+                rc = EXIT_FAILURE;
+
+            wxPrintf("\n");
+
+            const BenchCounters& counters = result.counters;
+            if ( counters.hasPerf )
+            {
+                wxPrintf("    %.0f cycles, %.0f instructions (IPC=%.2f), "
+                         "%.1f cache misses, %.1f branch misses per iteration\n",
+                         counters.cycles,
+                         counters.instructions,
+                         counters.cycles > 0.
+                            ? counters.instructions / counters.cycles
+                            : 0.,
+                         counters.cacheMisses,
+                         counters.branchMisses);
+            }
 
-            long times = m_avgCount;
-            if ( m_avgCount > 2 )
+            if ( counters.hasAllocs )
             {
-                timeTotal -= timeMin + timeMax;
-                times -= 2;
+                wxPrintf("    %.2f allocations, %.0f bytes per iteration\n",
+                         counters.allocs,
+                         counters.allocBytes);
             }
 
-            wxPrintf("%.2f avg (min=%ld, max=%ld)\n",
-                     (float)timeTotal / times, timeMin, timeMax);
+            m_results.push_back(result);
         }
 
         fflush(stdout);
     }
 
+    if ( !m_jsonFile.empty() && !SaveJSON(m_jsonFile) )
+        rc = EXIT_FAILURE;
+
     return rc;
 }
 
+void BenchApp::ResetCounters()
+{
+    for ( int n = 0; n < PerfCounters::Max; n++ )
+        m_perfTotals[n] = 0;
+
+    m_allocCount =
+    m_allocBytes = 0;
+}
+
+void BenchApp::StartSample()
+{
+    if ( m_trackAllocs )
+    {
+        gs_allocCount =
+        gs_allocBytes = 0;
+        gs_trackAllocs = true;
+    }
+
+    // Start the performance counters last, so that they count as little of
+    // our own code as possible.
+    if ( m_usePerfCounters )
+        m_perfCounters.Start();
+}
+
+void BenchApp::StopSample()
+{
+    if ( m_usePerfCounters )
+        m_perfCounters.Stop(m_perfTotals);
+
+    if ( m_trackAllocs )
+    {
+        gs_trackAllocs = false;
+        m_allocCount += gs_allocCount;
+        m_allocBytes += gs_allocBytes;
+    }
+}
+
+void BenchApp::GetCounters(BenchCounters& counters, long iterations) const
+{
+    if ( iterations <= 0 )
+        return;
+
+    if ( m_usePerfCounters )
+    {
+        counters.hasPerf = true;
+        counters.cycles = double(m_perfTotals[PerfCounters::Cycles]) / iterations;
+        counters.instructions =
+            double(m_perfTotals[PerfCounters::Instructions]) / iterations;
+        counters.cacheMisses =
+            double(m_perfTotals[PerfCounters::CacheMisses]) / iterations;
+        counters.branchMisses =
+            double(m_perfTotals[PerfCounters::BranchMisses]) / iterations;
+    }
+
+    if ( m_trackAllocs )
+    {
+        counters.hasAllocs = true;
+        counters.allocs = double(m_allocCount) / iterations;
+        counters.allocBytes = double(m_allocBytes) / iterations;
+    }
+}
+
+bool BenchApp::LoadBaseline(const wxString& filename)
+{
+    wxFFile file(filename);
+    wxString contents;
+    if ( !file.IsOpened() || !file.ReadAll(&contents) )
+    {
+        wxFprintf(stderr, "Failed to read baseline file \"%s\".\n", filename);
+        return false;
+    }
+
+    wxStringTokenizer tk(contents, "\n");
+    while ( tk.HasMoreTokens() )
+    {
+        const wxString line = tk.GetNextToken();
+
+        BaselineEntry entry;
+        wxString value;
+        if ( !GetJSONValue(line, "name", entry.name) )
+            continue;
+
+        if ( !GetJSONValue(line, "numParam", value) ||
+                !value.ToLong(&entry.numParam) ||
+                    !GetJSONValue(line, "strParam", entry.strParam) ||
+                        !GetJSONValue(line, "median", value) ||
+                            !value.ToCDouble(&entry.median) ||
+                                !GetJSONValue(line, "mad", value) ||
+                                    !value.ToCDouble(&entry.mad) )
+        {
+            wxFprintf(stderr, "Invalid entry for \"%s\" in baseline file "
+                              "\"%s\".\n", entry.name, filename);
+            return false;
+        }
+
+        m_baseline.push_back(entry);
+    }
+
+    if ( m_baseline.empty() )
+    {
+        wxFprintf(stderr, "No results found in baseline file \"%s\".\n",
+                  filename);
+        return false;
+    }
+
+    return true;
+}
+
+const BaselineEntry *BenchApp::FindBaseline(const BenchResult& result) const
+{
+    for ( size_t n = 0; n < m_baseline.size(); n++ )
+    {
+        const BaselineEntry& entry = m_baseline[n];
+        if ( entry.name == result.name &&
+                entry.numParam == result.numParam &&
+                    entry.strParam == result.strParam )
+        {
+            return &entry;
+        }
+    }
+
+    return NULL;
+}
+
+bool BenchApp::CompareWithBaseline(const BenchResult& result) const
+{
+    if ( m_baseline.empty() )
+        return true;
+
+    const BaselineEntry * const entry = FindBaseline(result);
+    if ( !entry )
+    {
+        wxPrintf(" [not in baseline]");
+        return true;
+    }
+
+    if ( entry->median <= 0. )
+    {
+        wxPrintf(" [baseline time is 0]");
+        return true;
+    }
+
+    const double median = result.stats.median;
+    const double change = (median / entry->median - 1.)*100.;
+
+    // Don't consider differences comparable with the spread of the measured
+    // values as significant, whatever the threshold: they're just noise.
+    const double noise = 2*(result.stats.mad + entry->mad);
+    const bool significant = fabs(median - entry->median) > noise;
+
+    wxString verdict;
+    bool ok = true;
+    if ( significant && change > m_threshold )
+    {
+        verdict = "REGRESSION";
+        ok = false;
+    }
+    else if ( significant && change < -m_threshold )
+    {
+        verdict = "faster";
+    }
+    else
+    {
+        verdict = "unchanged";
+    }
+
+    wxPrintf(" [%+.1f%% vs baseline %s: %s]",
+             change, FormatTime(entry->median), verdict);
+
+    return ok;
+}
+
+bool BenchApp::SaveJSON(const wxString& filename) const
+{
+    wxFFile file(filename, "w");
+    if ( !file.IsOpened() )
+    {
+        wxFprintf(stderr, "Failed to create \"%s\".\n", filename);
+        return false;
+    }
+
+    // Each result is written on its own line, this is relied upon by
+    // LoadBaseline().
+    wxString json;
+    json << "{\n"
+         << "\"build\": " << QuoteJSON(WX_BUILD_OPTIONS_SIGNATURE) << ",\n"
+         << "\"unit\": \"ns\",\n"
+         << "\"benchmarks\": [\n";
+
+    for ( size_t n = 0; n < m_results.size(); n++ )
+    {
+        const BenchResult& result = m_results[n];
+        const BenchStats& stats = result.stats;
+
+        wxString extra;
+        const BenchCounters& counters = result.counters;
+        if ( counters.hasPerf )
+        {
+            extra << ", \"cycles\": "
+                  << wxString::FromCDouble(counters.cycles, 1)
+                  << ", \"instructions\": "
+                  << wxString::FromCDouble(counters.instructions, 1)
+                  << ", \"cacheMisses\": "
+                  << wxString::FromCDouble(counters.cacheMisses, 3)
+                  << ", \"branchMisses\": "
+                  << wxString::FromCDouble(counters.branchMisses, 3);
+        }
+
+        if ( counters.hasAllocs )
+        {
+            extra << ", \"allocs\": "
+                  << wxString::FromCDouble(counters.allocs, 3)
+                  << ", \"allocBytes\": "
+                  << wxString::FromCDouble(counters.allocBytes, 1);
+        }
+
+        json << wxString::Format
+                (
+                    "{\"name\": %s, \"numParam\": %ld, \"strParam\": %s, "
+                    "\"iterations\": %ld, \"samples\": %ld, "
+                    "\"min\": %s, \"max\": %s, \"mean\": %s, "
+                    "\"median\": %s, \"p10\": %s, \"p90\": %s, "
+                    "\"mad\": %s%s}%s\n",
+                    QuoteJSON(result.name),
+                    result.numParam,
+                    QuoteJSON(result.strParam),
+                    stats.iterations,
+                    stats.samples,
+                    wxString::FromCDouble(stats.min, 3),
+                    wxString::FromCDouble(stats.max, 3),
+                    wxString::FromCDouble(stats.mean, 3),
+                    wxString::FromCDouble(stats.median, 3),
+                    wxString::FromCDouble(stats.p10, 3),
+                    wxString::FromCDouble(stats.p90, 3),
+                    wxString::FromCDouble(stats.mad, 3),
+                    extra,
+                    n + 1 < m_results.size() ? "," : ""
+                );
+    }
+
+    json << "]\n"
+         << "}\n";
+
+    if ( !file.Write(json) || !file.Close() )
+    {
+        wxFprintf(stderr, "Failed to write results to \"%s\".\n", filename);
+        return false;
+    }
+
+    return true;
+}
+
 int BenchApp::OnExit()
 {
 #if wxUSE_GUI
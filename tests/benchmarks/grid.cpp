@@ -0,0 +1,273 @@
+/////////////////////////////////////////////////////////////////////////////
+// Name:        tests/benchmarks/grid.cpp
+// Purpose:     wxGrid tables benchmarks
+// Author:      wxWidgets team
+// Created:     2026-10-18
+// Copyright:   (c) 2026 wxWidgets team
+// Licence:     wxWindows licence
+/////////////////////////////////////////////////////////////////////////////
+
+#include "wx/grid.h"
+#include "wx/frame.h"
+#include "wx/bitmap.h"
+#include "wx/dcmemory.h"
+
+#include "bench.h"
+
+// The tables used by the benchmarks below have 20 columns: 10 of integers, 9
+// of floating point numbers and one of strings taking just a few values. The
+// numeric parameter gives the number of rows in thousands (10 by default) and
+// --track-allocs option can be used to compare the memory used by the tables.
+
+namespace
+{
+
+const int NUM_COLS_NUMBER = 10;
+const int NUM_COLS_FLOAT = 9;
+const int NUM_COLS = NUM_COLS_NUMBER + NUM_COLS_FLOAT + 1;
+
+int GetNumRows()
+{
+    long num = Bench::GetNumericParameter();
+    if ( !num )
+        num = 10;
+
+    return 1000*num;
+}
+
+wxString GetStringValue(int row)
+{
+    static const char *values[] = { "red", "green", "blue", "yellow" };
+
+    return values[row % WXSIZEOF(values)];
+}
+
+wxGridTableBase *CreateStringTable()
+{
+    const int numRows = GetNumRows();
+
+    wxGridStringTable * const table = new wxGridStringTable(numRows, NUM_COLS);
+    for ( int row = 0; row < numRows; row++ )
+    {
+        int col = 0;
+        for ( ; col < NUM_COLS_NUMBER; col++ )
+            table->SetValue(row, col, wxString::Format("%d", row + col));
+        for ( ; col < NUM_COLS - 1; col++ )
+            table->SetValue(row, col, wxString::FromDouble(row / (col + 1.)));
+
+        table->SetValue(row, col, GetStringValue(row));
+    }
+
+    return table;
+}
+
+wxGridTableBase *CreateTypedTable()
+{
+    const int numRows = GetNumRows();
+
+    wxGridTypedTable * const table = new wxGridTypedTable();
+    table->AppendCols(NUM_COLS_NUMBER, wxGRID_COLUMN_NUMBER);
+    table->AppendCols(NUM_COLS_FLOAT, wxGRID_COLUMN_FLOAT);
+    table->AppendCols(1, wxGRID_COLUMN_STRING);
+    table->AppendRows(numRows);
+
+    // Fill the table from buffers containing the values of each column.
+    wxVector<wxInt64> numbers(numRows);
+    wxVector<double> floats(numRows);
+    wxVector<wxString> strings(numRows);
+
+    int col = 0;
+    for ( ; col < NUM_COLS_NUMBER; col++ )
+    {
+        for ( int row = 0; row < numRows; row++ )
+            numbers[row] = row + col;
+
+        table->SetColValues(col, 0, &numbers[0], numRows);
+    }
+
+    for ( ; col < NUM_COLS - 1; col++ )
+    {
+        for ( int row = 0; row < numRows; row++ )
+            floats[row] = row / (col + 1.);
+
+        table->SetColValues(col, 0, &floats[0], numRows);
+    }
+
+    for ( int row = 0; row < numRows; row++ )
+        strings[row] = GetStringValue(row);
+
+    table->SetColValues(col, 0, &strings[0], numRows);
+
+    return table;
+}
+
+// Read all the numbers from the table in the same way as the grid renderers
+// do it.
+bool ReadTable(wxGridTableBase& table)
+{
+    const int numRows = table.GetNumberRows();
+
+    double sum = 0;
+    for ( int row = 0; row < numRows; row++ )
+    {
+        for ( int col = 0; col < NUM_COLS - 1; col++ )
+        {
+            double value;
+            if ( table.CanGetValueAs(row, col, wxGRID_VALUE_FLOAT) )
+                value = table.GetValueAsDouble(row, col);
+            else if ( !table.GetValue(row, col).ToDouble(&value) )
+                return false;
+
+            sum += value;
+        }
+    }
+
+    return sum > 0;
+}
+
+wxGridTableBase *gs_table = NULL;
+
+bool InitStringTable()
+{
+    gs_table = CreateStringTable();
+    return true;
+}
+
+bool InitTypedTable()
+{
+    gs_table = CreateTypedTable();
+    return true;
+}
+
+void DoneTable()
+{
+    wxDELETE(gs_table);
+}
+
+// Grid class giving access to the cells attributes used for drawing them.
+class BenchGrid : public wxGrid
+{
+public:
+    BenchGrid(wxWindow *parent) : wxGrid(parent, wxID_ANY) { }
+
+    using wxGrid::GetCellAttr;
+};
+
+wxFrame *gs_frame = NULL;
+BenchGrid *gs_grid = NULL;
+
+bool InitGrid(wxGridTableBase *table)
+{
+    gs_frame = new wxFrame(NULL, wxID_ANY, "wxGrid benchmark");
+    gs_grid = new BenchGrid(gs_frame);
+
+    return gs_grid->SetTable(table, true /* take ownership */);
+}
+
+bool InitGridWithStringTable()
+{
+    return InitGrid(CreateStringTable());
+}
+
+bool InitGridWithTypedTable()
+{
+    return InitGrid(CreateTypedTable());
+}
+
+void DoneGrid()
+{
+    delete gs_frame;
+    gs_frame = NULL;
+    gs_grid = NULL;
+}
+
+// Draw the cells of the first 100 rows into a bitmap in the same way as the
+// grid does it.
+bool PaintGrid()
+{
+    const int numRows = wxMin(gs_grid->GetNumberRows(), 100);
+
+    const wxRect rectLast = gs_grid->CellToRect(numRows - 1, NUM_COLS - 1);
+    wxBitmap bmp(rectLast.GetRight() + 1, rectLast.GetBottom() + 1);
+    wxMemoryDC dc(bmp);
+
+    for ( int row = 0; row < numRows; row++ )
+    {
+        for ( int col = 0; col < NUM_COLS; col++ )
+        {
+            wxGridCellAttr * const attr = gs_grid->GetCellAttr(row, col);
+            wxGridCellRenderer * const renderer = attr->GetRenderer(gs_grid,
+                                                                    row, col);
+            renderer->Draw(*gs_grid, *attr, dc, gs_grid->CellToRect(row, col),
+                           row, col, false);
+            renderer->DecRef();
+            attr->DecRef();
+        }
+    }
+
+    return dc.IsOk();
+}
+
+} // anonymous namespace
+
+BENCHMARK_FUNC(GridFillStringTable)
+{
+    wxGridTableBase * const table = CreateStringTable();
+    const bool ok = table->GetNumberRows() == GetNumRows();
+    delete table;
+
+    return ok;
+}
+
+BENCHMARK_FUNC(GridFillTypedTable)
+{
+    wxGridTableBase * const table = CreateTypedTable();
+    const bool ok = table->GetNumberRows() == GetNumRows();
+    delete table;
+
+    return ok;
+}
+
+BENCHMARK_FUNC_WITH_INIT(GridReadStringTable, InitStringTable, DoneTable)
+{
+    return ReadTable(*gs_table);
+}
+
+BENCHMARK_FUNC_WITH_INIT(GridReadTypedTable, InitTypedTable, DoneTable)
+{
+    return ReadTable(*gs_table);
+}
+
+BENCHMARK_FUNC_WITH_INIT(GridPaintStringTable, InitGridWithStringTable, DoneGrid)
+{
+    return PaintGrid();
+}
+
+BENCHMARK_FUNC_WITH_INIT(GridPaintTypedTable, InitGridWithTypedTable, DoneGrid)
+{
+    return PaintGrid();
+}
+
+BENCHMARK_FUNC_WITH_INIT(GridAutoSizeColumns, InitGridWithStringTable, DoneGrid)
+{
+    gs_grid->SetAutoSizeMode(wxGRID_AUTOSIZE_DEFAULT);
+    gs_grid->AutoSizeColumns(false);
+
+    return gs_grid->GetColSize(0) > 0;
+}
+
+BENCHMARK_FUNC_WITH_INIT(GridAutoSizeColumnsParallel, InitGridWithStringTable, DoneGrid)
+{
+    gs_grid->SetAutoSizeMode(wxGRID_AUTOSIZE_PARALLEL);
+    gs_grid->AutoSizeColumns(false);
+
+    return gs_grid->GetColSize(0) > 0;
+}
+
+BENCHMARK_FUNC_WITH_INIT(GridAutoSizeColumnsSampled, InitGridWithStringTable, DoneGrid)
+{
+    gs_grid->SetAutoSizeMode(wxGRID_AUTOSIZE_PARALLEL | wxGRID_AUTOSIZE_SAMPLE);
+    gs_grid->AutoSizeColumns(false);
+
+    return gs_grid->GetColSize(0) > 0;
+}
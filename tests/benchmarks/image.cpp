@@ -88,3 +88,44 @@ BENCHMARK_FUNC(ShrinkHighQuality)
 {
     return GetTestImage().Scale(50, 50, wxIMAGE_QUALITY_HIGH).IsOk();
 }
+
+// Multi-megapixel image used for benchmarking resampling of big images, this
+// is where using multiple threads makes the most difference.
+static const wxImage& GetBigTestImage()
+{
+    static wxImage s_image;
+    if ( !s_image.IsOk() )
+    {
+        // Use bilinear resampling as it doesn't change the image much, while
+        // also not producing blocky images, unlike nearest neighbour method.
+        s_image = GetTestImage().Scale(4000, 3000, wxIMAGE_QUALITY_BILINEAR);
+        s_image.InitAlpha();
+    }
+
+    return s_image;
+}
+
+BENCHMARK_FUNC(BigEnlargeBilinear)
+{
+    return GetBigTestImage().Scale(6000, 4500, wxIMAGE_QUALITY_BILINEAR).IsOk();
+}
+
+BENCHMARK_FUNC(BigEnlargeBicubic)
+{
+    return GetBigTestImage().Scale(6000, 4500, wxIMAGE_QUALITY_BICUBIC).IsOk();
+}
+
+BENCHMARK_FUNC(BigShrinkBilinear)
+{
+    return GetBigTestImage().Scale(1600, 1200, wxIMAGE_QUALITY_BILINEAR).IsOk();
+}
+
+BENCHMARK_FUNC(BigShrinkBicubic)
+{
+    return GetBigTestImage().Scale(1600, 1200, wxIMAGE_QUALITY_BICUBIC).IsOk();
+}
+
+BENCHMARK_FUNC(BigShrinkBoxAverage)
+{
+    return GetBigTestImage().Scale(400, 300, wxIMAGE_QUALITY_BOX_AVERAGE).IsOk();
+}
@@ -42,6 +42,58 @@ bool ConvertToMB(const wxMBConv& conv)
     return conv.FromWChar(buf.data(), outlen, TEST_STRING) == outlen;
 }
 
+// Mixed script text used for UTF-8 benchmarks: it contains ASCII, Cyrillic,
+// Greek, CJK and non-BMP characters.
+const wchar_t *TEST_STRING_MIXED =
+    L"Lorem ipsum dolor sit amet, consectetur adipisicing elit. "
+    L"\x0426\x0435\x043b\x043e\x0435 \x0447\x0438\x0441\x043b\x043e, "
+    L"\x03b1\x03bb\x03c6\x03b1\x03b2\x03b7\x03c4\x03bf. "
+    L"\x65e5\x672c\x8a9e\x306e\x6587\x7ae0 \x4e2d\x6587 "
+#if SIZEOF_WCHAR_T == 4
+    L"\x1f600\x1f30d "
+#endif
+    L"Duis aute irure dolor in reprehenderit in voluptate velit esse. "
+    ;
+
+// big strings containing many copies of TEST_STRING or TEST_STRING_MIXED
+wxWCharBuffer gs_wideLarge;
+wxCharBuffer gs_utf8Large;
+
+bool InitLarge(const wchar_t *str)
+{
+    wxString s;
+    for ( int n = 0; n < 1000; n++ )
+        s += str;
+
+    gs_wideLarge = s.wc_str();
+    gs_utf8Large = wxConvUTF8.cWC2MB(gs_wideLarge);
+
+    return gs_utf8Large.length() != 0;
+}
+
+bool InitLargeASCII() { return InitLarge(TEST_STRING); }
+bool InitLargeMixed() { return InitLarge(TEST_STRING_MIXED); }
+
+void DoneLarge()
+{
+    gs_wideLarge.reset();
+    gs_utf8Large.reset();
+}
+
+bool ConvertLargeFromUTF8()
+{
+    const size_t len = gs_wideLarge.length() + 1;
+    wxWCharBuffer buf(len - 1);
+    return wxConvUTF8.ToWChar(buf.data(), len, gs_utf8Large) == len;
+}
+
+bool ConvertLargeToUTF8()
+{
+    const size_t len = gs_utf8Large.length() + 1;
+    wxCharBuffer buf(len - 1);
+    return wxConvUTF8.FromWChar(buf.data(), len, gs_wideLarge) == len;
+}
+
 } // anonymous namespace
 
 BENCHMARK_FUNC(UTF16InitWX)
@@ -76,3 +128,29 @@ BENCHMARK_FUNC(UTF16Sys)
     return ConvertToMB(wxCSConv("UTF-16LE"));
 }
 
+
+BENCHMARK_FUNC_WITH_INIT(UTF8ToWCharASCII, InitLargeASCII, DoneLarge)
+{
+    return ConvertLargeFromUTF8();
+}
+
+BENCHMARK_FUNC_WITH_INIT(UTF8ToWCharMixed, InitLargeMixed, DoneLarge)
+{
+    return ConvertLargeFromUTF8();
+}
+
+BENCHMARK_FUNC_WITH_INIT(UTF8FromWCharASCII, InitLargeASCII, DoneLarge)
+{
+    return ConvertLargeToUTF8();
+}
+
+BENCHMARK_FUNC_WITH_INIT(UTF8FromWCharMixed, InitLargeMixed, DoneLarge)
+{
+    return ConvertLargeToUTF8();
+}
+
+BENCHMARK_FUNC_WITH_INIT(UTF8LenMixed, InitLargeMixed, DoneLarge)
+{
+    return wxConvUTF8.FromWChar(NULL, 0, gs_wideLarge)
+            == gs_utf8Large.length() + 1;
+}
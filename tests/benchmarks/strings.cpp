@@ -39,6 +39,13 @@ static const char utf8str[] =
     "\xD0\xA6\xD0\xB5\xD0\xBB\xD0\xBE\xD0\xB5 \xD1\x87\xD0\xB8\xD1\x81\xD0\xBB\xD0\xBE 9"
     ;
 
+// CJK and non-BMP characters, to be mixed with the strings above
+static const char utf8cjkstr[] =
+    "\xE6\x97\xA5\xE6\x9C\xAC\xE8\xAA\x9E\xE3\x81\xAE\xE6\x96\x87\xE7\xAB\xA0 "
+    "\xE4\xB8\xAD\xE6\x96\x87 \xED\x95\x9C\xEA\xB5\xAD\xEC\x96\xB4 "
+    "\xF0\x9F\x98\x80\xF0\x9F\x8C\x8D\xF0\x9D\x84\x9E"
+    ;
+
 namespace
 {
 
@@ -58,6 +65,28 @@ const wxString& GetTestAsciiString()
     return testString;
 }
 
+// Return a big UTF-8 string consisting of long ASCII runs interspersed with
+// Cyrillic, CJK and non-BMP characters, as found in real world documents.
+const std::string& GetTestMixedUTF8String()
+{
+    static std::string testString;
+    if ( testString.empty() )
+    {
+        long num = Bench::GetNumericParameter();
+        if ( !num )
+            num = 1;
+
+        for ( long n = 0; n < 100*num; n++ )
+        {
+            testString += asciistr;
+            testString += utf8str;
+            testString += utf8cjkstr;
+        }
+    }
+
+    return testString;
+}
+
 } // anonymous namespace
 
 // this is just a baseline
@@ -115,6 +144,17 @@ BENCHMARK_FUNC(FromUTF8WithLen)
     return true;
 }
 
+BENCHMARK_FUNC(FromUTF8Large)
+{
+    const std::string& utf8 = GetTestMixedUTF8String();
+
+    wxString s = wxString::FromUTF8(utf8.c_str(), utf8.length());
+    if ( s.empty() )
+        return false;
+
+    return strlen(s.utf8_str()) == utf8.length();
+}
+
 // ----------------------------------------------------------------------------
 // FromUTF8Unchecked() benchmarks
 // ----------------------------------------------------------------------------
@@ -244,6 +284,66 @@ BENCHMARK_FUNC(ForStringRIter)
     return true;
 }
 
+// ----------------------------------------------------------------------------
+// random access to long non-ASCII strings
+// ----------------------------------------------------------------------------
+
+namespace
+{
+
+const wxString& GetTestMixedString()
+{
+    static wxString testString;
+    if ( testString.empty() )
+    {
+        const std::string& utf8 = GetTestMixedUTF8String();
+        testString = wxString::FromUTF8(utf8.c_str(), utf8.length());
+    }
+
+    return testString;
+}
+
+// Return the next position to access in a string of the given length: this
+// jumps both forwards and backwards over big distances.
+inline size_t GetNextRandomPos(size_t pos, size_t len)
+{
+    return (pos + len/3 + 7919) % len;
+}
+
+} // anonymous namespace
+
+BENCHMARK_FUNC(RandomStringIndex)
+{
+    const wxString& s = GetTestMixedString();
+    const size_t len = s.length();
+
+    size_t pos = 0;
+    for ( int n = 0; n < 1000; n++ )
+    {
+        pos = GetNextRandomPos(pos, len);
+        if ( s[pos] == '~' )
+            return false;
+    }
+
+    return true;
+}
+
+BENCHMARK_FUNC(RandomStringSubstr)
+{
+    const wxString& s = GetTestMixedString();
+    const size_t len = s.length();
+
+    size_t pos = 0;
+    for ( int n = 0; n < 1000; n++ )
+    {
+        pos = GetNextRandomPos(pos, len);
+        if ( s.substr(pos, 10).empty() )
+            return false;
+    }
+
+    return true;
+}
+
 // ----------------------------------------------------------------------------
 // wxString::Replace()
 // ----------------------------------------------------------------------------
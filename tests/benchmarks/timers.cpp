@@ -0,0 +1,95 @@
+/////////////////////////////////////////////////////////////////////////////
+// Name:        tests/benchmarks/timers.cpp
+// Purpose:     wxTimer-related benchmarks
+// Author:      wxWidgets team
+// Created:     2026-10-18
+// Copyright:   (c) 2026 wxWidgets team
+// Licence:     wxWindows licence
+/////////////////////////////////////////////////////////////////////////////
+
+#include "bench.h"
+
+#include "wx/timer.h"
+#include "wx/vector.h"
+
+namespace
+{
+
+wxVector<wxTimer *> gs_timers;
+
+// Return the interval to use for the given timer: it is long enough for the
+// timers to never expire during the benchmark, as the event loop doesn't run
+// anyhow, and different timers are scattered over it.
+int GetInterval(size_t n)
+{
+    return 3600*1000 + static_cast<int>((n*7919) % 600000);
+}
+
+bool InitTimers(size_t count)
+{
+    gs_timers.reserve(count);
+    for ( size_t n = 0; n < count; n++ )
+        gs_timers.push_back(new wxTimer);
+
+    return true;
+}
+
+bool InitTimers10000() { return InitTimers(10000); }
+bool InitTimers100000() { return InitTimers(100000); }
+
+bool InitRunningTimers100000()
+{
+    InitTimers(100000);
+
+    for ( size_t n = 0; n < gs_timers.size(); n++ )
+        gs_timers[n]->Start(GetInterval(n));
+
+    return true;
+}
+
+void DoneTimers()
+{
+    for ( size_t n = 0; n < gs_timers.size(); n++ )
+        delete gs_timers[n];
+
+    gs_timers.clear();
+}
+
+// Start all timers and then stop them in a different order, which is typical
+// for timeouts of independent connections.
+bool StartStopTimers()
+{
+    const size_t count = gs_timers.size();
+    for ( size_t n = 0; n < count; n++ )
+        gs_timers[n]->Start(GetInterval(n), wxTIMER_ONE_SHOT);
+
+    // 7919 is prime and so is coprime with count, so all timers are stopped
+    const size_t step = 7919;
+    for ( size_t n = 0, i = 0; n < count; n++, i = (i + step) % count )
+        gs_timers[i]->Stop();
+
+    return !gs_timers[0]->IsRunning();
+}
+
+} // anonymous namespace
+
+BENCHMARK_FUNC_WITH_INIT(TimersStartStop10000, InitTimers10000, DoneTimers)
+{
+    return StartStopTimers();
+}
+
+BENCHMARK_FUNC_WITH_INIT(TimersStartStop100000, InitTimers100000, DoneTimers)
+{
+    return StartStopTimers();
+}
+
+// Restart all the timers which are already running, as is done when the
+// timeout is reset after some activity.
+BENCHMARK_FUNC_WITH_INIT(TimersRestart100000, InitRunningTimers100000, DoneTimers)
+{
+    const size_t count = gs_timers.size();
+    for ( size_t n = 0; n < count; n++ )
+        gs_timers[n]->Start(GetInterval(count - n));
+
+    return gs_timers[0]->IsRunning();
+}
@@ -64,6 +64,10 @@ private:
         CPPUNIT_TEST( Labels );
         CPPUNIT_TEST( SelectionMode );
         CPPUNIT_TEST( CellFormatting );
+        CPPUNIT_TEST( CellAttrInsertDelete );
+        CPPUNIT_TEST( LinePositions );
+        CPPUNIT_TEST( TypedTable );
+        CPPUNIT_TEST( AutoSizeModes );
         WXUISIM_TEST( Editable );
         WXUISIM_TEST( ReadOnly );
         CPPUNIT_TEST( PseudoTest_NativeHeader );
@@ -93,6 +97,10 @@ private:
     void Labels();
     void SelectionMode();
     void CellFormatting();
+    void CellAttrInsertDelete();
+    void LinePositions();
+    void TypedTable();
+    void AutoSizeModes();
     void Editable();
     void ReadOnly();
     void PseudoTest_NativeHeader() { ms_nativeheader = true; }
@@ -683,6 +691,253 @@ void GridTestCase::CellFormatting()
     CPPUNIT_ASSERT_EQUAL(*wxGREEN, m_grid->GetCellTextColour(0, 0));
 }
 
+void GridTestCase::CellAttrInsertDelete()
+{
+    m_grid->AppendRows(40);
+    m_grid->AppendCols(48);
+
+    // Give a different colour to all the cells except those in the first row
+    // and column and remember their original coordinates in their values.
+    for ( int row = 1; row < 50; row++ )
+    {
+        for ( int col = 1; col < 50; col++ )
+        {
+            m_grid->SetCellValue(row, col, wxString::Format("%d %d", row, col));
+            m_grid->SetCellBackgroundColour(row, col, wxColour(row, col, 0));
+        }
+    }
+
+    // Delete more than half of the cells to check that the attributes of the
+    // remaining ones are preserved when those of the deleted ones are freed.
+    m_grid->InsertRows(10, 5);
+    m_grid->DeleteRows(20, 30);
+    m_grid->InsertCols(0, 3);
+    m_grid->DeleteCols(5, 10);
+    m_grid->DeleteRows(2, 1);
+
+    m_grid->SetCellBackgroundColour(10, 10, *wxGREEN);
+
+    CPPUNIT_ASSERT_EQUAL(23, m_grid->GetNumberRows());
+    CPPUNIT_ASSERT_EQUAL(43, m_grid->GetNumberCols());
+
+    const wxColour colDefault = m_grid->GetDefaultCellBackgroundColour();
+    for ( int row = 0; row < m_grid->GetNumberRows(); row++ )
+    {
+        for ( int col = 0; col < m_grid->GetNumberCols(); col++ )
+        {
+            wxColour colExpected = colDefault;
+
+            const wxString value = m_grid->GetCellValue(row, col);
+            long rowOrig, colOrig;
+            if ( row == 10 && col == 10 )
+                colExpected = *wxGREEN;
+            else if ( value.BeforeFirst(' ').ToLong(&rowOrig) &&
+                        value.AfterFirst(' ').ToLong(&colOrig) )
+                colExpected = wxColour(rowOrig, colOrig, 0);
+
+            CPPUNIT_ASSERT_EQUAL(colExpected,
+                                 m_grid->GetCellBackgroundColour(row, col));
+        }
+    }
+
+    // The attribute of a deleted cell must be released immediately.
+    wxGridCellAttr* const attr = new wxGridCellAttr;
+    attr->IncRef();
+    m_grid->SetAttr(5, 5, attr);
+    CPPUNIT_ASSERT_EQUAL(2, attr->GetRefCount());
+    m_grid->DeleteRows(5);
+    CPPUNIT_ASSERT_EQUAL(1, attr->GetRefCount());
+    attr->DecRef();
+}
+
+void GridTestCase::LinePositions()
+{
+    m_grid->AppendRows(90);
+    m_grid->AppendCols(8);
+
+    m_grid->SetRowSize(3, 50);
+    m_grid->SetRowSize(50, 10);
+    m_grid->HideRow(4);
+    m_grid->InsertRows(10, 5);
+    m_grid->DeleteRows(20, 3);
+    m_grid->SetRowSize(11, 40);
+
+    // Appending the lines one by one must give the same results as adding
+    // them at once.
+    for ( int n = 0; n < 37; n++ )
+        m_grid->AppendRows(1);
+    m_grid->SetRowSize(m_grid->GetNumberRows() - 2, 25);
+
+    m_grid->SetColSize(1, 200);
+    m_grid->HideCol(6);
+    m_grid->SetColPos(1, 8);
+    m_grid->SetColSize(8, 30);
+
+    for ( int n = 0; n < 3; n++ )
+        m_grid->AppendCols(1);
+    m_grid->SetColSize(m_grid->GetNumberCols() - 2, 70);
+
+    int y = 0;
+    for ( int row = 0; row < m_grid->GetNumberRows(); row++ )
+    {
+        CPPUNIT_ASSERT_EQUAL(y, m_grid->CellToRect(row, 0).y);
+
+        const int height = m_grid->GetRowSize(row);
+        if ( height )
+        {
+            CPPUNIT_ASSERT_EQUAL(row, m_grid->YToRow(y));
+            CPPUNIT_ASSERT_EQUAL(row, m_grid->YToRow(y + height - 1));
+        }
+
+        y += height;
+    }
+
+    CPPUNIT_ASSERT_EQUAL(wxNOT_FOUND, m_grid->YToRow(y));
+    CPPUNIT_ASSERT_EQUAL(m_grid->GetNumberRows() - 1, m_grid->YToRow(y, true));
+
+    int x = 0;
+    for ( int pos = 0; pos < m_grid->GetNumberCols(); pos++ )
+    {
+        const int col = m_grid->GetColAt(pos);
+        CPPUNIT_ASSERT_EQUAL(x, m_grid->CellToRect(0, col).x);
+
+        const int width = m_grid->GetColSize(col);
+        if ( width )
+        {
+            CPPUNIT_ASSERT_EQUAL(col, m_grid->XToCol(x));
+            CPPUNIT_ASSERT_EQUAL(col, m_grid->XToCol(x + width - 1));
+        }
+
+        x += width;
+    }
+
+    CPPUNIT_ASSERT_EQUAL(wxNOT_FOUND, m_grid->XToCol(x));
+}
+
+void GridTestCase::TypedTable()
+{
+    wxGridTypedTable* const table = new wxGridTypedTable(3, 1);
+    table->AppendCols(1, wxGRID_COLUMN_NUMBER);
+    table->AppendCols(1, wxGRID_COLUMN_FLOAT);
+    table->AppendCols(1, wxGRID_COLUMN_BOOL);
+    m_grid->SetTable(table, true);
+
+    CPPUNIT_ASSERT_EQUAL(3, m_grid->GetNumberRows());
+    CPPUNIT_ASSERT_EQUAL(4, m_grid->GetNumberCols());
+
+    const wxString strings[] = { "foo", "bar", "foo" };
+    table->SetColValues(0, 0, strings, WXSIZEOF(strings));
+
+    const wxInt64 numbers[] = { 17, -2 };
+    table->SetColValues(1, 1, numbers, WXSIZEOF(numbers));
+
+    m_grid->SetCellValue(0, 2, "2.5");
+    m_grid->SetCellValue(1, 3, "1");
+
+    CPPUNIT_ASSERT_EQUAL( "foo", m_grid->GetCellValue(2, 0) );
+    CPPUNIT_ASSERT_EQUAL( "0", m_grid->GetCellValue(0, 1) );
+    CPPUNIT_ASSERT_EQUAL( -2, table->GetValueAsLong(2, 1) );
+    CPPUNIT_ASSERT_EQUAL( -2., table->GetValueAsDouble(2, 1) );
+    CPPUNIT_ASSERT_EQUAL( 2.5, table->GetValueAsDouble(0, 2) );
+    CPPUNIT_ASSERT( table->GetValueAsBool(1, 3) );
+    CPPUNIT_ASSERT( !table->GetValueAsBool(2, 3) );
+
+    CPPUNIT_ASSERT_EQUAL( wxGRID_VALUE_STRING, table->GetTypeName(0, 0) );
+    CPPUNIT_ASSERT_EQUAL( wxGRID_VALUE_NUMBER, table->GetTypeName(0, 1) );
+    CPPUNIT_ASSERT_EQUAL( wxGRID_VALUE_FLOAT, table->GetTypeName(0, 2) );
+    CPPUNIT_ASSERT_EQUAL( wxGRID_VALUE_BOOL, table->GetTypeName(0, 3) );
+    CPPUNIT_ASSERT( table->CanGetValueAs(0, 1, wxGRID_VALUE_FLOAT) );
+    CPPUNIT_ASSERT( !table->CanGetValueAs(0, 2, wxGRID_VALUE_NUMBER) );
+
+    m_grid->InsertRows(1, 2);
+    m_grid->DeleteCols(2);
+
+    CPPUNIT_ASSERT_EQUAL(5, m_grid->GetNumberRows());
+    CPPUNIT_ASSERT_EQUAL(3, m_grid->GetNumberCols());
+    CPPUNIT_ASSERT( m_grid->GetTable()->IsEmptyCell(1, 0) );
+    CPPUNIT_ASSERT_EQUAL( "bar", m_grid->GetCellValue(3, 0) );
+    CPPUNIT_ASSERT_EQUAL( 17, table->GetValueAsLong(3, 1) );
+    CPPUNIT_ASSERT( table->GetValueAsBool(3, 2) );
+
+    table->SetColType(1, wxGRID_COLUMN_FLOAT);
+    CPPUNIT_ASSERT_EQUAL( -2., table->GetValueAsDouble(4, 1) );
+}
+
+void GridTestCase::AutoSizeModes()
+{
+    m_grid->AppendRows(990);
+    for ( int row = 0; row < m_grid->GetNumberRows(); row++ )
+    {
+        m_grid->SetCellValue(row, 0, "x");
+        m_grid->SetCellValue(row, 1, wxString('w', row % 7 + 1));
+    }
+
+    m_grid->SetCellValue(567, 0, "much longer value");
+
+    m_grid->AutoSizeColumns(false);
+    const int width0 = m_grid->GetColSize(0),
+              width1 = m_grid->GetColSize(1);
+
+    // Sampling only a few rows still finds the longest values.
+    m_grid->SetAutoSizeMode(wxGRID_AUTOSIZE_SAMPLE, 10);
+    m_grid->AutoSizeColumns(false);
+    CPPUNIT_ASSERT_EQUAL( width0, m_grid->GetColSize(0) );
+    CPPUNIT_ASSERT_EQUAL( width1, m_grid->GetColSize(1) );
+
+    // Parallel mode must give the same results as the default one, whether
+    // all the rows or just some of them are measured.
+    m_grid->SetAutoSizeMode(wxGRID_AUTOSIZE_PARALLEL);
+    m_grid->AutoSizeColumns(false);
+    CPPUNIT_ASSERT_EQUAL( width0, m_grid->GetColSize(0) );
+    CPPUNIT_ASSERT_EQUAL( width1, m_grid->GetColSize(1) );
+
+    m_grid->SetAutoSizeMode(wxGRID_AUTOSIZE_PARALLEL | wxGRID_AUTOSIZE_SAMPLE,
+                            m_grid->GetNumberRows());
+    m_grid->AutoSizeColumns(false);
+    CPPUNIT_ASSERT_EQUAL( width0, m_grid->GetColSize(0) );
+    CPPUNIT_ASSERT_EQUAL( width1, m_grid->GetColSize(1) );
+
+    m_grid->SetAutoSizeMode(wxGRID_AUTOSIZE_PARALLEL | wxGRID_AUTOSIZE_SAMPLE,
+                            10);
+    m_grid->AutoSizeColumn(0, false);
+    CPPUNIT_ASSERT_EQUAL( width0, m_grid->GetColSize(0) );
+
+    // And this is also true for the rows.
+    m_grid->SetCellValue(3, 1, "two\nlines");
+
+    m_grid->SetAutoSizeMode(wxGRID_AUTOSIZE_DEFAULT);
+    m_grid->AutoSizeRows(false);
+    const int height2 = m_grid->GetRowSize(2),
+              height3 = m_grid->GetRowSize(3);
+    CPPUNIT_ASSERT( height3 > height2 );
+
+    m_grid->SetAutoSizeMode(wxGRID_AUTOSIZE_PARALLEL);
+    m_grid->AutoSizeRows(false);
+    CPPUNIT_ASSERT_EQUAL( height2, m_grid->GetRowSize(2) );
+    CPPUNIT_ASSERT_EQUAL( height3, m_grid->GetRowSize(3) );
+
+    // Renderers deriving from the standard ones must be used to measure the
+    // cells in parallel mode too.
+    class WideRenderer : public wxGridCellStringRenderer
+    {
+    public:
+        virtual wxSize GetBestSize(wxGrid& WXUNUSED(grid),
+                                   wxGridCellAttr& WXUNUSED(attr),
+                                   wxDC& WXUNUSED(dc),
+                                   int WXUNUSED(row), int WXUNUSED(col))
+        {
+            return wxSize(500, 10);
+        }
+
+        virtual wxGridCellRenderer *Clone() const
+            { return new WideRenderer; }
+    };
+
+    m_grid->SetCellRenderer(100, 1, new WideRenderer);
+    m_grid->AutoSizeColumn(1, false);
+    CPPUNIT_ASSERT_EQUAL( 500 + 10, m_grid->GetColSize(1) );
+}
+
 void GridTestCase::Editable()
 {
 #if wxUSE_UIACTIONSIMULATOR
@@ -62,6 +62,7 @@ private:
         CPPUNIT_TEST( Delete );
         CPPUNIT_TEST( Url );
         CPPUNIT_TEST( Table );
+        CPPUNIT_TEST( ParagraphAtPosition );
     CPPUNIT_TEST_SUITE_END();
 
     void CharacterEvent();
@@ -92,6 +93,7 @@ private:
     void Delete();
     void Url();
     void Table();
+    void ParagraphAtPosition();
 
     wxRichTextCtrl* m_rich;
 
@@ -888,4 +890,75 @@ void RichTextCtrlTestCase::Table()
     m_rich->SetFocusObject(NULL);
 }
 
+// Helper function for ::ParagraphAtPosition()
+static void CheckParagraphsPositions(wxRichTextBuffer& buffer)
+{
+    wxRichTextObjectList::compatibility_iterator node = buffer.GetChildren().GetFirst();
+    while (node)
+    {
+        wxRichTextParagraph* para = wxDynamicCast(node->GetData(), wxRichTextParagraph);
+        CPPUNIT_ASSERT(para);
+
+        const wxRichTextRange range = para->GetRange();
+        for (long pos = range.GetStart(); pos <= range.GetEnd(); pos++)
+        {
+            CPPUNIT_ASSERT_EQUAL(para, buffer.GetParagraphAtPosition(pos));
+            CPPUNIT_ASSERT_EQUAL(para, buffer.GetLineAtPosition(pos)->GetParent());
+        }
+
+        node = node->GetNext();
+    }
+
+    CPPUNIT_ASSERT(!buffer.GetParagraphAtPosition(buffer.GetOwnRange().GetEnd() + 1));
+}
+
+void RichTextCtrlTestCase::ParagraphAtPosition()
+{
+    for (int n = 0; n < 100; n++)
+    {
+        m_rich->WriteText(wxString::Format("Paragraph %d", n));
+        m_rich->Newline();
+    }
+
+    wxRichTextBuffer& buffer = m_rich->GetBuffer();
+    m_rich->LayoutContent();
+    CheckParagraphsPositions(buffer);
+
+    // Editing the text of a paragraph changes the positions of the next ones.
+    m_rich->SetInsertionPoint(5);
+    m_rich->WriteText("inserted text");
+    m_rich->LayoutContent();
+    CheckParagraphsPositions(buffer);
+
+    // And deleting paragraphs changes the paragraphs themselves.
+    m_rich->Remove(20, 200);
+    m_rich->LayoutContent();
+    CheckParagraphsPositions(buffer);
+
+    m_rich->SetInsertionPoint(30);
+    m_rich->Newline();
+    m_rich->LayoutContent();
+    CheckParagraphsPositions(buffer);
+
+    // The ranges may also become temporarily inconsistent after the index was
+    // built, e.g. while the buffer is being modified, check that the correct
+    // paragraph is still found in this case.
+    wxRichTextParagraph* const
+        first = wxDynamicCast(buffer.GetChildren().GetFirst()->GetData(), wxRichTextParagraph);
+    wxRichTextParagraph* const
+        last = wxDynamicCast(buffer.GetChildren().GetLast()->GetData(), wxRichTextParagraph);
+    CPPUNIT_ASSERT(first && last && first != last);
+
+    const wxRichTextRange firstRange = first->GetRange(),
+                          lastRange = last->GetRange();
+    first->SetRange(lastRange);
+    last->SetRange(firstRange);
+    CPPUNIT_ASSERT_EQUAL(last, buffer.GetParagraphAtPosition(firstRange.GetStart()));
+    CPPUNIT_ASSERT_EQUAL(first, buffer.GetParagraphAtPosition(lastRange.GetStart()));
+
+    first->SetRange(firstRange);
+    last->SetRange(lastRange);
+    CheckParagraphsPositions(buffer);
+}
+
 #endif //wxUSE_RICHTEXT
@@ -17,6 +17,9 @@
 #endif
 
 #include "wx/event.h"
+#include "wx/scopedptr.h"
+#include "wx/thread.h"
+#include "wx/vector.h"
 
 // ----------------------------------------------------------------------------
 // test events and their handlers
@@ -138,6 +141,122 @@ BEGIN_EVENT_TABLE(MyClassWithEventTable, wxEvtHandler)
     //EVT_IDLE(MyClassWithEventTable::OnAnotherEvent)
 END_EVENT_TABLE()
 
+#if wxUSE_THREADS
+
+// handler checking that the events queued from several threads are processed
+// in the order in which each of the threads queued them
+class PendingEventsHandler : public wxEvtHandler
+{
+public:
+    PendingEventsHandler(int numThreads)
+        : m_lastSeen(static_cast<size_t>(numThreads), -1)
+    {
+        m_count = 0;
+        m_inOrder = true;
+
+        Bind(wxEVT_THREAD, &PendingEventsHandler::OnThread, this);
+    }
+
+    int GetCount() const { return m_count; }
+    bool AreInOrder() const { return m_inOrder; }
+
+private:
+    void OnThread(wxThreadEvent& event)
+    {
+        int& last = m_lastSeen[event.GetId()];
+        if ( event.GetInt() != last + 1 )
+            m_inOrder = false;
+        last = event.GetInt();
+
+        m_count++;
+    }
+
+    wxVector<int> m_lastSeen;
+    int m_count;
+    bool m_inOrder;
+};
+
+class QueueEventsThread : public wxThread
+{
+public:
+    QueueEventsThread(wxEvtHandler& handler, int id, int count)
+        : wxThread(wxTHREAD_JOINABLE),
+          m_handler(handler),
+          m_id(id),
+          m_count(count)
+    {
+    }
+
+    virtual ExitCode Entry()
+    {
+        for ( int n = 0; n < m_count; n++ )
+        {
+            wxThreadEvent * const event = new wxThreadEvent(wxEVT_THREAD, m_id);
+            event->SetInt(n);
+            m_handler.QueueEvent(event);
+        }
+
+        return 0;
+    }
+
+private:
+    wxEvtHandler& m_handler;
+    const int m_id;
+    const int m_count;
+};
+
+#endif // wxUSE_THREADS
+
+wxDEFINE_EVENT(OtherThreadEventType, wxThreadEvent);
+
+void QueueThreadEvent(wxEvtHandler& handler, int value, long key = -1)
+{
+    wxThreadEvent* const event = new wxThreadEvent;
+    event->SetInt(value);
+    if ( key != -1 )
+        event->SetCoalescingKey(key);
+
+    handler.QueueEvent(event);
+}
+
+// handler remembering the values of all the thread events it processed
+class CoalescedEventsHandler : public wxEvtHandler
+{
+public:
+    CoalescedEventsHandler()
+    {
+        m_nestedValue = -1;
+
+        Bind(wxEVT_THREAD, &CoalescedEventsHandler::OnThread, this);
+        Bind(OtherThreadEventType, &CoalescedEventsHandler::OnThread, this);
+    }
+
+    const wxVector<int>& GetValues() const { return m_values; }
+
+    // when processing the event with the given value, queue two more events,
+    // the first one with the coalescing key 1, and process them immediately,
+    // as a nested event loop would do
+    void ProcessNestedEventsOn(int value) { m_nestedValue = value; }
+
+private:
+    void OnThread(wxThreadEvent& event)
+    {
+        m_values.push_back(event.GetInt());
+
+        if ( event.GetInt() == m_nestedValue )
+        {
+            m_nestedValue = -1;
+
+            QueueThreadEvent(*this, 100, 1);
+            QueueThreadEvent(*this, 101);
+            ProcessPendingEvents();
+        }
+    }
+
+    wxVector<int> m_values;
+    int m_nestedValue;
+};
+
 } // anonymous namespace
 
 
@@ -164,6 +283,9 @@ private:
         CPPUNIT_TEST( BindFunctionUsingBaseEvent );
         CPPUNIT_TEST( BindNonHandler );
         CPPUNIT_TEST( InvalidBind );
+        CPPUNIT_TEST( QueueEvents );
+        CPPUNIT_TEST( DeletePendingEvents );
+        CPPUNIT_TEST( CoalesceEvents );
     CPPUNIT_TEST_SUITE_END();
 
     void BuiltinConnect();
@@ -178,6 +300,9 @@ private:
     void BindFunctionUsingBaseEvent();
     void BindNonHandler();
     void InvalidBind();
+    void QueueEvents();
+    void DeletePendingEvents();
+    void CoalesceEvents();
 
 
     // these member variables exceptionally don't use "m_" prefix because
@@ -459,3 +584,119 @@ void EvtHandlerTestCase::InvalidBind()
     myHandler.Bind(MyEventType, &MyHandler::OnMyEvent, &mySink);
 #endif
 }
+
+void EvtHandlerTestCase::QueueEvents()
+{
+#if wxUSE_THREADS
+    static const int NUM_THREADS = 4;
+    static const int NUM_EVENTS = 10000;
+
+    PendingEventsHandler pendingHandler(NUM_THREADS);
+
+    QueueEventsThread* threads[NUM_THREADS];
+    for ( int n = 0; n < NUM_THREADS; n++ )
+    {
+        threads[n] = new QueueEventsThread(pendingHandler, n, NUM_EVENTS);
+        CPPUNIT_ASSERT_EQUAL( wxTHREAD_NO_ERROR, threads[n]->Run() );
+    }
+
+    // process the events while they're still being queued too
+    for ( int n = 0; n < 100; n++ )
+        wxTheApp->ProcessPendingEvents();
+
+    for ( int n = 0; n < NUM_THREADS; n++ )
+    {
+        threads[n]->Wait();
+        delete threads[n];
+    }
+
+    wxTheApp->ProcessPendingEvents();
+
+    CPPUNIT_ASSERT_EQUAL( NUM_THREADS*NUM_EVENTS, pendingHandler.GetCount() );
+    CPPUNIT_ASSERT( pendingHandler.AreInOrder() );
+    CPPUNIT_ASSERT( !wxTheApp->HasPendingEvents() );
+#endif // wxUSE_THREADS
+}
+
+void EvtHandlerTestCase::DeletePendingEvents()
+{
+    g_called.Reset();
+
+    {
+        MyHandler pendingHandler;
+        pendingHandler.Bind( MyEventType, &MyHandler::OnMyEvent, &pendingHandler );
+
+        pendingHandler.QueueEvent(new MyEvent);
+        pendingHandler.QueueEvent(new MyEvent);
+        CPPUNIT_ASSERT( wxTheApp->HasPendingEvents() );
+
+        pendingHandler.DeletePendingEvents();
+        wxTheApp->ProcessPendingEvents();
+        CPPUNIT_ASSERT( !g_called.method );
+        CPPUNIT_ASSERT( !wxTheApp->HasPendingEvents() );
+
+        // the handler must be usable again after deleting its events
+        pendingHandler.QueueEvent(new MyEvent);
+        wxTheApp->ProcessPendingEvents();
+        CPPUNIT_ASSERT( g_called.method );
+
+        // and destroying it with pending events must not leave it in the
+        // list of handlers with pending events
+        pendingHandler.QueueEvent(new MyEvent);
+    }
+
+    CPPUNIT_ASSERT( !wxTheApp->HasPendingEvents() );
+}
+
+void EvtHandlerTestCase::CoalesceEvents()
+{
+    CoalescedEventsHandler coalescedHandler;
+
+    QueueThreadEvent(coalescedHandler, 1, 0);
+    QueueThreadEvent(coalescedHandler, 2);
+    QueueThreadEvent(coalescedHandler, 3, 0);
+    QueueThreadEvent(coalescedHandler, 4, 1);
+    QueueThreadEvent(coalescedHandler, 5, 0);
+
+    // all the events queued so far are processed by a single call, which
+    // must discard the superseded ones
+    coalescedHandler.ProcessPendingEvents();
+    CPPUNIT_ASSERT_EQUAL( 3, (int)coalescedHandler.GetValues().size() );
+    CPPUNIT_ASSERT_EQUAL( 2, coalescedHandler.GetValues()[0] );
+    CPPUNIT_ASSERT_EQUAL( 4, coalescedHandler.GetValues()[1] );
+    CPPUNIT_ASSERT_EQUAL( 5, coalescedHandler.GetValues()[2] );
+
+    // the events queued from an event handler must be coalesced with those
+    // taken from the queue by the outer call but not processed yet: here
+    // the event 7 is superseded by the event 100 queued when processing 6
+    coalescedHandler.ProcessNestedEventsOn(6);
+    QueueThreadEvent(coalescedHandler, 6);
+    QueueThreadEvent(coalescedHandler, 7, 1);
+    QueueThreadEvent(coalescedHandler, 8);
+
+    // an event of another type with the same key must not be coalesced
+    QueueThreadEvent(coalescedHandler, 9, 0);
+    wxThreadEvent* const otherEvent = new wxThreadEvent(OtherThreadEventType);
+    otherEvent->SetInt(10);
+    otherEvent->SetCoalescingKey(0);
+    coalescedHandler.QueueEvent(otherEvent);
+
+    wxTheApp->ProcessPendingEvents();
+    CPPUNIT_ASSERT( !wxTheApp->HasPendingEvents() );
+
+    const wxVector<int>& values = coalescedHandler.GetValues();
+    CPPUNIT_ASSERT_EQUAL( 9, (int)values.size() );
+    CPPUNIT_ASSERT_EQUAL( 6, values[3] );
+    CPPUNIT_ASSERT_EQUAL( 8, values[4] );
+    CPPUNIT_ASSERT_EQUAL( 9, values[5] );
+    CPPUNIT_ASSERT_EQUAL( 10, values[6] );
+    CPPUNIT_ASSERT_EQUAL( 100, values[7] );
+    CPPUNIT_ASSERT_EQUAL( 101, values[8] );
+
+    // the coalescing key is copied when the event is cloned
+    wxThreadEvent event;
+    event.SetCoalescingKey(17);
+    wxScopedPtr<wxEvent> clone(event.Clone());
+    CPPUNIT_ASSERT( clone->HasCoalescingKey() );
+    CPPUNIT_ASSERT_EQUAL( 17L, clone->GetCoalescingKey() );
+}
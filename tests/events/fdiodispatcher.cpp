@@ -0,0 +1,306 @@
+///////////////////////////////////////////////////////////////////////////////
+// Name:        tests/events/fdiodispatcher.cpp
+// Purpose:     Tests for the IO dispatchers notification modes
+// Author:      wxWidgets team
+// Created:     2026-10-18
+// Copyright:   (c) 2026 wxWidgets team
+///////////////////////////////////////////////////////////////////////////////
+
+// ----------------------------------------------------------------------------
+// headers
+// ----------------------------------------------------------------------------
+
+#include "testprec.h"
+
+#ifdef __BORLANDC__
+    #pragma hdrstop
+#endif
+
+#if wxUSE_EPOLL_DISPATCHER
+
+#include "wx/unix/private/epolldispatcher.h"
+#include "wx/unix/pipe.h"
+
+#if wxUSE_THREADS
+    #include "wx/thread.h"
+#endif
+
+#include <unistd.h>
+
+// ----------------------------------------------------------------------------
+// helper classes
+// ----------------------------------------------------------------------------
+
+namespace
+{
+
+// Handler counting the number of notifications for the read end of a pipe.
+class PipeCounterHandler : public wxFDIOHandler
+{
+public:
+    PipeCounterHandler() { m_reads = 0; }
+
+    int GetNumReads() const { return m_reads; }
+
+    virtual void OnReadWaiting() { m_reads++; }
+    virtual void OnWriteWaiting() { }
+    virtual void OnExceptionWaiting() { }
+
+private:
+    int m_reads;
+};
+
+// Pipe registered with the dispatcher using the given flags.
+class RegisteredPipe
+{
+public:
+    RegisteredPipe(wxFDIODispatcher& dispatcher, int flags)
+        : m_dispatcher(dispatcher)
+    {
+        CPPUNIT_ASSERT( m_pipe.Create() );
+        CPPUNIT_ASSERT( m_pipe.MakeNonBlocking(wxPipe::Read) );
+        CPPUNIT_ASSERT( m_dispatcher.RegisterFD(GetFD(), &m_handler, flags) );
+    }
+
+    ~RegisteredPipe()
+    {
+        m_dispatcher.UnregisterFD(GetFD());
+    }
+
+    int GetFD() const { return m_pipe[wxPipe::Read]; }
+
+    PipeCounterHandler& GetHandler() { return m_handler; }
+
+    int GetNumReads() const { return m_handler.GetNumReads(); }
+
+    void Write()
+    {
+        CPPUNIT_ASSERT_EQUAL( 1, (int)write(m_pipe[wxPipe::Write], "x", 1) );
+    }
+
+    // read everything written to the pipe so far
+    void Drain()
+    {
+        char buf[64];
+        while ( read(GetFD(), buf, sizeof(buf)) > 0 )
+            ;
+    }
+
+private:
+    wxFDIODispatcher& m_dispatcher;
+    wxPipe m_pipe;
+    PipeCounterHandler m_handler;
+};
+
+#if wxUSE_THREADS
+
+// Thread re-arming a one-shot descriptor after a small delay.
+class RearmThread : public wxThread
+{
+public:
+    RearmThread(wxFDIODispatcher& dispatcher, RegisteredPipe& pipe, int flags)
+        : wxThread(wxTHREAD_JOINABLE),
+          m_dispatcher(dispatcher),
+          m_pipe(pipe),
+          m_flags(flags)
+    {
+        m_ok = false;
+    }
+
+    bool IsOk() const { return m_ok; }
+
+protected:
+    virtual ExitCode Entry()
+    {
+        wxMilliSleep(50);
+
+        m_ok = m_dispatcher.ModifyFD(m_pipe.GetFD(),
+                                     &m_pipe.GetHandler(),
+                                     m_flags);
+
+        return 0;
+    }
+
+private:
+    wxFDIODispatcher& m_dispatcher;
+    RegisteredPipe& m_pipe;
+    const int m_flags;
+    bool m_ok;
+};
+
+#endif // wxUSE_THREADS
+
+} // anonymous namespace
+
+// ----------------------------------------------------------------------------
+// test class
+// ----------------------------------------------------------------------------
+
+class FDIODispatcherTestCase : public CppUnit::TestCase
+{
+public:
+    FDIODispatcherTestCase() { m_dispatcher = NULL; }
+
+    virtual void setUp()
+    {
+        m_dispatcher = wxEpollDispatcher::Create();
+        CPPUNIT_ASSERT( m_dispatcher );
+    }
+
+    virtual void tearDown()
+    {
+        delete m_dispatcher;
+        m_dispatcher = NULL;
+    }
+
+private:
+    CPPUNIT_TEST_SUITE( FDIODispatcherTestCase );
+        CPPUNIT_TEST( LevelTriggered );
+        CPPUNIT_TEST( EdgeTriggered );
+        CPPUNIT_TEST( OneShot );
+#if wxUSE_THREADS
+        CPPUNIT_TEST( OneShotRearmFromThread );
+#endif // wxUSE_THREADS
+        CPPUNIT_TEST( MaxEvents );
+    CPPUNIT_TEST_SUITE_END();
+
+    void LevelTriggered();
+    void EdgeTriggered();
+    void OneShot();
+#if wxUSE_THREADS
+    void OneShotRearmFromThread();
+#endif // wxUSE_THREADS
+    void MaxEvents();
+
+    wxEpollDispatcher *m_dispatcher;
+
+    DECLARE_NO_COPY_CLASS(FDIODispatcherTestCase)
+};
+
+// register in the unnamed registry so that these tests are run by default
+CPPUNIT_TEST_SUITE_REGISTRATION( FDIODispatcherTestCase );
+
+// also include in its own registry so that these tests can be run alone
+CPPUNIT_TEST_SUITE_NAMED_REGISTRATION( FDIODispatcherTestCase, "FDIODispatcherTestCase" );
+
+void FDIODispatcherTestCase::LevelTriggered()
+{
+    RegisteredPipe pipe(*m_dispatcher, wxFDIO_INPUT);
+
+    CPPUNIT_ASSERT_EQUAL( 0, m_dispatcher->Dispatch(0) );
+
+    // The handler is notified for as long as there is data to read.
+    pipe.Write();
+    CPPUNIT_ASSERT_EQUAL( 1, m_dispatcher->Dispatch(0) );
+    CPPUNIT_ASSERT_EQUAL( 1, m_dispatcher->Dispatch(0) );
+    CPPUNIT_ASSERT_EQUAL( 2, pipe.GetNumReads() );
+
+    pipe.Drain();
+    CPPUNIT_ASSERT_EQUAL( 0, m_dispatcher->Dispatch(0) );
+    CPPUNIT_ASSERT_EQUAL( 2, pipe.GetNumReads() );
+}
+
+void FDIODispatcherTestCase::EdgeTriggered()
+{
+    RegisteredPipe pipe(*m_dispatcher, wxFDIO_INPUT | wxFDIO_EDGE_TRIGGERED);
+
+    // The handler is notified only once even if it doesn't read anything.
+    pipe.Write();
+    CPPUNIT_ASSERT_EQUAL( 1, m_dispatcher->Dispatch(0) );
+    CPPUNIT_ASSERT_EQUAL( 0, m_dispatcher->Dispatch(0) );
+    CPPUNIT_ASSERT_EQUAL( 1, pipe.GetNumReads() );
+
+    // But it is notified again when more data arrives.
+    pipe.Write();
+    CPPUNIT_ASSERT_EQUAL( 1, m_dispatcher->Dispatch(0) );
+    CPPUNIT_ASSERT_EQUAL( 0, m_dispatcher->Dispatch(0) );
+    CPPUNIT_ASSERT_EQUAL( 2, pipe.GetNumReads() );
+
+    // And, of course, after reading everything and getting more data.
+    pipe.Drain();
+    CPPUNIT_ASSERT_EQUAL( 0, m_dispatcher->Dispatch(0) );
+    pipe.Write();
+    CPPUNIT_ASSERT_EQUAL( 1, m_dispatcher->Dispatch(0) );
+    CPPUNIT_ASSERT_EQUAL( 3, pipe.GetNumReads() );
+}
+
+void FDIODispatcherTestCase::OneShot()
+{
+    const int flags = wxFDIO_INPUT | wxFDIO_ONESHOT;
+    RegisteredPipe pipe(*m_dispatcher, flags);
+
+    // The descriptor is disabled after the first notification, even if new
+    // data arrives.
+    pipe.Write();
+    CPPUNIT_ASSERT_EQUAL( 1, m_dispatcher->Dispatch(0) );
+    CPPUNIT_ASSERT_EQUAL( 0, m_dispatcher->Dispatch(0) );
+    pipe.Write();
+    CPPUNIT_ASSERT_EQUAL( 0, m_dispatcher->Dispatch(0) );
+    CPPUNIT_ASSERT_EQUAL( 1, pipe.GetNumReads() );
+
+    // Re-arming it results in another notification as the data is still there.
+    CPPUNIT_ASSERT( m_dispatcher->ModifyFD(pipe.GetFD(), &pipe.GetHandler(), flags) );
+    CPPUNIT_ASSERT_EQUAL( 1, m_dispatcher->Dispatch(0) );
+    CPPUNIT_ASSERT_EQUAL( 0, m_dispatcher->Dispatch(0) );
+    CPPUNIT_ASSERT_EQUAL( 2, pipe.GetNumReads() );
+
+    // But not if there is nothing to read any more.
+    pipe.Drain();
+    CPPUNIT_ASSERT( m_dispatcher->ModifyFD(pipe.GetFD(), &pipe.GetHandler(), flags) );
+    CPPUNIT_ASSERT_EQUAL( 0, m_dispatcher->Dispatch(0) );
+    CPPUNIT_ASSERT_EQUAL( 2, pipe.GetNumReads() );
+
+    pipe.Write();
+    CPPUNIT_ASSERT_EQUAL( 1, m_dispatcher->Dispatch(0) );
+    CPPUNIT_ASSERT_EQUAL( 3, pipe.GetNumReads() );
+}
+
+#if wxUSE_THREADS
+
+void FDIODispatcherTestCase::OneShotRearmFromThread()
+{
+    const int flags = wxFDIO_INPUT | wxFDIO_ONESHOT;
+    RegisteredPipe pipe(*m_dispatcher, flags);
+
+    pipe.Write();
+    CPPUNIT_ASSERT_EQUAL( 1, m_dispatcher->Dispatch(0) );
+    CPPUNIT_ASSERT_EQUAL( 1, pipe.GetNumReads() );
+
+    // Re-arm the descriptor from another thread while we're waiting for it.
+    RearmThread thread(*m_dispatcher, pipe, flags);
+    CPPUNIT_ASSERT_EQUAL( wxTHREAD_NO_ERROR, thread.Run() );
+
+    CPPUNIT_ASSERT_EQUAL( 1, m_dispatcher->Dispatch(5000) );
+    CPPUNIT_ASSERT_EQUAL( 2, pipe.GetNumReads() );
+
+    thread.Wait();
+    CPPUNIT_ASSERT( thread.IsOk() );
+}
+
+#endif // wxUSE_THREADS
+
+void FDIODispatcherTestCase::MaxEvents()
+{
+    RegisteredPipe pipe1(*m_dispatcher, wxFDIO_INPUT),
+                   pipe2(*m_dispatcher, wxFDIO_INPUT),
+                   pipe3(*m_dispatcher, wxFDIO_INPUT);
+
+    pipe1.Write();
+    pipe2.Write();
+    pipe3.Write();
+
+    m_dispatcher->SetMaxEvents(1);
+    CPPUNIT_ASSERT_EQUAL( 1, m_dispatcher->GetMaxEvents() );
+    CPPUNIT_ASSERT_EQUAL( 1, m_dispatcher->Dispatch(0) );
+
+    m_dispatcher->SetMaxEvents(2);
+    CPPUNIT_ASSERT_EQUAL( 2, m_dispatcher->Dispatch(0) );
+
+    m_dispatcher->SetMaxEvents(wxEpollDispatcher::DEFAULT_MAX_EVENTS);
+    CPPUNIT_ASSERT_EQUAL( 3, m_dispatcher->Dispatch(0) );
+    CPPUNIT_ASSERT_EQUAL( 6, pipe1.GetNumReads() +
+                             pipe2.GetNumReads() +
+                             pipe3.GetNumReads() );
+}
+
+#endif // wxUSE_EPOLL_DISPATCHER
@@ -23,6 +23,55 @@
 
 #include "wx/html/htmlpars.h"
 
+// ----------------------------------------------------------------------------
+// helper classes
+// ----------------------------------------------------------------------------
+
+namespace
+{
+
+// Parser recording all the text and tags passed to it.
+class RecordingParser : public wxHtmlParser
+{
+public:
+    virtual wxObject *GetProduct() { return NULL; }
+
+    wxString m_log;
+
+protected:
+    virtual void AddText(const wxString& txt) { m_log << txt; }
+
+    virtual void AddTag(const wxHtmlTag& tag)
+    {
+        m_log << '<' << tag.GetName() << '>';
+        wxHtmlParser::AddTag(tag);
+    }
+};
+
+// Handler parsing the contents of the tag itself, either directly or after
+// changing them to upper case.
+class RecordingHandler : public wxHtmlTagHandler
+{
+public:
+    virtual wxString GetSupportedTags() { return "B,U"; }
+
+    virtual bool HandleTag(const wxHtmlTag& tag)
+    {
+        wxString& log = static_cast<RecordingParser *>(m_Parser)->m_log;
+
+        log << '[';
+        if ( tag.GetName() == "U" )
+            ParseInnerSource(m_Parser->GetInnerSource(tag).Upper());
+        else
+            ParseInner(tag);
+        log << ']';
+
+        return true;
+    }
+};
+
+} // anonymous namespace
+
 // ----------------------------------------------------------------------------
 // test class
 // ----------------------------------------------------------------------------
@@ -35,9 +84,11 @@ public:
 private:
     CPPUNIT_TEST_SUITE( HtmlParserTestCase );
         CPPUNIT_TEST( Invalid );
+        CPPUNIT_TEST( Incremental );
     CPPUNIT_TEST_SUITE_END();
 
     void Invalid();
+    void Incremental();
 
     wxDECLARE_NO_COPY_CLASS(HtmlParserTestCase);
 };
@@ -71,4 +122,48 @@ void HtmlParserTestCase::Invalid()
     p.Parse("<!---");
 }
 
+// Test that parsing incrementally gives the same results as parsing at once.
+void HtmlParserTestCase::Incremental()
+{
+    const wxString html =
+        "<html><head><title>Title</title></head><body>"
+        "Hello &amp; <i>world</i><!-- comment --><p>one<p>two"
+        "<b>bold <i>text</i></b> and<br> <u>more <b>x</b> text</u>"
+        "<script>if (a<b) f();</script></end><div><span>tail"
+        "</body></html>";
+
+    RecordingParser parser;
+    parser.AddTagHandler(new RecordingHandler);
+    parser.Parse(html);
+    const wxString expected = parser.m_log;
+    CPPUNIT_ASSERT( expected.Contains("[bold <I>text]") );
+    CPPUNIT_ASSERT( expected.Contains("[MORE <B>[X] TEXT]") );
+
+    for ( size_t maxLength = 0; maxLength < 20; maxLength += 3 )
+    {
+        parser.m_log.clear();
+        parser.InitParserIncrementally(html);
+        CPPUNIT_ASSERT( parser.IsParsingIncrementally() );
+
+        int parts = 1;
+        while ( parser.ParseNextPart(maxLength) )
+            parts++;
+        parser.DoneParser();
+
+        CPPUNIT_ASSERT( !parser.IsParsingIncrementally() );
+        CPPUNIT_ASSERT( parts > 1 );
+        CPPUNIT_ASSERT_EQUAL( expected, parser.m_log );
+    }
+
+    // It must be possible to abandon incremental parsing at any moment.
+    parser.InitParserIncrementally(html);
+    CPPUNIT_ASSERT( parser.ParseNextPart(50) );
+    parser.m_log.clear();
+    parser.Parse(html);
+    CPPUNIT_ASSERT_EQUAL( expected, parser.m_log );
+
+    parser.InitParserIncrementally(html);
+    CPPUNIT_ASSERT( parser.ParseNextPart(50) );
+}
+
 #endif //wxUSE_HTML
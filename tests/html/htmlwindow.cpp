@@ -47,6 +47,8 @@ private:
         WXUISIM_TEST( LinkClick );
 #endif // wxUSE_UIACTIONSIMULATOR
         CPPUNIT_TEST( AppendToPage );
+        CPPUNIT_TEST( WordExtents );
+        CPPUNIT_TEST( IncrementalScroll );
     CPPUNIT_TEST_SUITE_END();
 
     void SelectionToText();
@@ -54,6 +56,8 @@ private:
     void CellClick();
     void LinkClick();
     void AppendToPage();
+    void WordExtents();
+    void IncrementalScroll();
 
     wxHtmlWindow *m_win;
 
@@ -164,4 +168,102 @@ void HtmlWindowTestCase::AppendToPage()
     CPPUNIT_ASSERT_EQUAL("link A new paragraph", m_win->ToText());
 }
 
+// Returns the widths of all cells containing the given word.
+static wxArrayInt GetWordWidths(wxHtmlWindow *win, const wxString& word)
+{
+    wxArrayInt widths;
+
+    const wxHtmlContainerCell * const top = win->GetInternalRepresentation();
+    for ( wxHtmlTerminalCellsInterator i(top->GetFirstTerminal(),
+                                         top->GetLastTerminal()); i; ++i )
+    {
+        if ( i->ConvertToText(NULL) == word )
+            widths.push_back(i->GetWidth());
+    }
+
+    return widths;
+}
+
+void HtmlWindowTestCase::WordExtents()
+{
+    static const char *TEST_MARKUP_WORDS =
+        "<html><body>"
+        "word<p>word<p><font size=+3>word</font>"
+        "</body></html>";
+
+    m_win->SetPage(TEST_MARKUP_WORDS);
+    wxArrayInt widths = GetWordWidths(m_win, "word");
+    CPPUNIT_ASSERT_EQUAL( 3, widths.size() );
+    CPPUNIT_ASSERT( widths[0] > 0 );
+    CPPUNIT_ASSERT_EQUAL( widths[0], widths[1] );
+    CPPUNIT_ASSERT( widths[2] > widths[0] );
+
+    // The same words must be measured again after changing the fonts.
+    m_win->SetStandardFonts(30);
+    wxArrayInt widthsBig = GetWordWidths(m_win, "word");
+    CPPUNIT_ASSERT_EQUAL( 3, widthsBig.size() );
+    CPPUNIT_ASSERT( widthsBig[0] > widths[0] );
+    CPPUNIT_ASSERT_EQUAL( widthsBig[0], widthsBig[1] );
+}
+
+// Returns the vertical scroll position of the window.
+static int GetViewStartY(wxHtmlWindow *win)
+{
+    int x, y;
+    win->GetViewStart(&x, &y);
+    return y;
+}
+
+// Lets the window parse the rest of the page from its idle event handler.
+static void FinishIncrementalParsing(wxHtmlWindow *win)
+{
+    while ( win->GetParser()->IsParsingIncrementally() )
+    {
+        wxIdleEvent event;
+        win->GetEventHandler()->ProcessEvent(event);
+    }
+}
+
+void HtmlWindowTestCase::IncrementalScroll()
+{
+    delete m_win;
+    m_win = new wxHtmlWindow(wxTheApp->GetTopWindow(), wxID_ANY,
+                             wxDefaultPosition, wxSize(400, 200),
+                             wxHW_SCROLLBAR_AUTO | wxHW_INCREMENTAL);
+
+    // The page must be long enough to not be parsed at once.
+    wxString markup("<html><body>");
+    for ( int n = 0; n < 50000; n++ )
+    {
+        if ( n == 100 )
+            markup += "<a name=\"mid\"></a>";
+        markup += wxString::Format("<p>Line %d", n);
+    }
+    markup += "</body></html>";
+
+    // Going to an anchor found in the already parsed part of the page must
+    // not be undone when the next parts are shown.
+    m_win->SetPage(markup);
+    CPPUNIT_ASSERT( m_win->GetParser()->IsParsingIncrementally() );
+    CPPUNIT_ASSERT_EQUAL( 0, GetViewStartY(m_win) );
+
+    CPPUNIT_ASSERT( m_win->LoadPage("#mid") );
+    const int yAnchor = GetViewStartY(m_win);
+    CPPUNIT_ASSERT( yAnchor > 0 );
+
+    FinishIncrementalParsing(m_win);
+    CPPUNIT_ASSERT_EQUAL( yAnchor, GetViewStartY(m_win) );
+
+    // And neither must scrolling the window while the page is being loaded.
+    m_win->SetPage(markup);
+    CPPUNIT_ASSERT( m_win->GetParser()->IsParsingIncrementally() );
+    CPPUNIT_ASSERT_EQUAL( 0, GetViewStartY(m_win) );
+
+    m_win->Scroll(0, 10);
+    CPPUNIT_ASSERT_EQUAL( 10, GetViewStartY(m_win) );
+
+    FinishIncrementalParsing(m_win);
+    CPPUNIT_ASSERT_EQUAL( 10, GetViewStartY(m_win) );
+}
+
 #endif //wxUSE_HTML
@@ -29,6 +29,8 @@
 #include "wx/mstream.h"
 #include "wx/zstream.h"
 #include "wx/wfstream.h"
+#include "wx/quantize.h"
+#include "wx/private/parallel.h"
 
 #include "testimage.h"
 
@@ -79,6 +81,8 @@ private:
         CPPUNIT_TEST( DibPadding );
         CPPUNIT_TEST( BMPFlippingAndRLECompression );
         CPPUNIT_TEST( ScaleCompare );
+        CPPUNIT_TEST( Blur );
+        CPPUNIT_TEST( QuantizePalette );
     CPPUNIT_TEST_SUITE_END();
 
     void LoadFromSocketStream();
@@ -95,6 +99,8 @@ private:
     void DibPadding();
     void BMPFlippingAndRLECompression();
     void ScaleCompare();
+    void Blur();
+    void QuantizePalette();
 
     DECLARE_NO_COPY_CLASS(ImageTestCase)
 };
@@ -1387,6 +1393,103 @@ void ImageTestCase::ScaleCompare()
                                "image/horse_bilinear_300x300.png");
 }
 
+void ImageTestCase::Blur()
+{
+    wxImage original;
+    CPPUNIT_ASSERT(original.LoadFile("horse.bmp"));
+    original.InitAlpha();
+
+    // Blurring in both directions at once or separately must give the same
+    // results, whether it's done in place or not.
+    const wxImage blurred = original.Blur(5);
+    CPPUNIT_ASSERT_EQUAL( original.BlurHorizontal(5).BlurVertical(5), blurred );
+
+    wxImage image = original.Copy();
+    image.BlurInPlace(5);
+    CPPUNIT_ASSERT_EQUAL( blurred, image );
+
+    // Radius bigger than the image size must work too.
+    image = original.Copy();
+    image.BlurInPlace(1000);
+    CPPUNIT_ASSERT_EQUAL( original.Blur(1000), image );
+
+    // And blurring a uniform image shouldn't change it, even when using
+    // several passes.
+    wxImage uniform(100, 100, false);
+    uniform.SetRGB(wxRect(0, 0, 100, 100), 12, 34, 56);
+    image = uniform.Copy();
+    image.BlurInPlace(10, wxIMAGE_BLUR_GAUSSIAN);
+    CPPUNIT_ASSERT_EQUAL( uniform, image );
+
+#if wxUSE_THREADS
+    // Blurring using several threads must give the same results as doing it
+    // in a single one: use an image big enough to be split between the
+    // threads by default, whose size is not a multiple of the chunk sizes.
+    const wxImage big = original.Scale(1000, 1100);
+
+    wxPrivate::wxSetParallelMinPerThread(INT_MAX);
+    const wxImage bigBlurred = big.Blur(7);
+    wxImage bigGaussian = big.Copy();
+    bigGaussian.BlurInPlace(20, wxIMAGE_BLUR_GAUSSIAN);
+
+    // Check both the default splitting and the finest possible one.
+    static const int minPerThreadValues[] = { 0, 1 };
+    for ( size_t n = 0; n < WXSIZEOF(minPerThreadValues); n++ )
+    {
+        wxPrivate::wxSetParallelMinPerThread(minPerThreadValues[n]);
+
+        CPPUNIT_ASSERT_EQUAL( bigBlurred, big.Blur(7) );
+
+        image = big.Copy();
+        image.BlurInPlace(20, wxIMAGE_BLUR_GAUSSIAN);
+        CPPUNIT_ASSERT_EQUAL( bigGaussian, image );
+    }
+
+    wxPrivate::wxSetParallelMinPerThread(0);
+#endif // wxUSE_THREADS
+}
+
+void ImageTestCase::QuantizePalette()
+{
+    static const unsigned char colours[] =
+    {
+          0,   0,   0,
+        255,   0,   0,
+          0, 255,   0,
+          0,   0, 255,
+    };
+
+    wxImage original(64, 64, false);
+    for ( int n = 0; n < 4; n++ )
+    {
+        original.SetRGB(wxRect((n % 2)*32, (n / 2)*32, 32, 32),
+                        colours[3*n], colours[3*n + 1], colours[3*n + 2]);
+    }
+
+    wxQuantizePalette palette;
+    CPPUNIT_ASSERT( !palette.IsOk() );
+    CPPUNIT_ASSERT( !palette.Fit() );
+
+    // Mapping an image using only the palette colours must not change it.
+    CPPUNIT_ASSERT( palette.SetColours(colours, 4) );
+    CPPUNIT_ASSERT_EQUAL( 4, palette.GetColoursCount() );
+
+    wxImage image;
+    CPPUNIT_ASSERT( palette.Map(original, image, false) );
+    CPPUNIT_ASSERT_EQUAL( original, image );
+    CPPUNIT_ASSERT( image.HasPalette() );
+
+    unsigned char data8bit[64*64];
+    CPPUNIT_ASSERT( palette.Map(original, data8bit) );
+    CPPUNIT_ASSERT_EQUAL( 0, (int)data8bit[0] );
+    CPPUNIT_ASSERT_EQUAL( 3, (int)data8bit[64*64 - 1] );
+
+    // And the palette chosen for it must contain as many colours as it has.
+    palette.AddImage(original);
+    CPPUNIT_ASSERT( palette.Fit(236) );
+    CPPUNIT_ASSERT_EQUAL( 4, palette.GetColoursCount() );
+}
+
 #endif //wxUSE_IMAGE
 
 
@@ -71,6 +71,7 @@ private:
         CPPUNIT_TEST( WC2CP1250 );
         CPPUNIT_TEST( UTF7Tests );
         CPPUNIT_TEST( UTF8Tests );
+        CPPUNIT_TEST( UTF8ASCIIRuns );
         CPPUNIT_TEST( UTF16LETests );
         CPPUNIT_TEST( UTF16BETests );
         CPPUNIT_TEST( CP932Tests );
@@ -106,6 +107,7 @@ private:
     void WC2CP1250();
     void UTF7Tests();
     void UTF8Tests();
+    void UTF8ASCIIRuns();
     void UTF16LETests();
     void UTF16BETests();
     void UTF32LETests();
@@ -129,6 +131,16 @@ private:
         int            sizeofNull   // number of bytes occupied by terminating null in this encoding
         );
 
+    // verifies that the specified UTF-8 and wchar_t sequences are converted to
+    // each other, from any source alignment, and that the conversion fails
+    // without writing past the end of the output buffer if it's too short
+    void TestUTF8ASCIIRun(
+        const char*    utf8,        // the UTF-8 character sequence, without NUL
+        size_t         utf8Len,     // the number of bytes at utf8
+        const wchar_t* wide,        // the same character sequence as wchar_t
+        size_t         wideLen      // the number of characters at wide
+        );
+
     // verifies that the specified wchar_t sequence encodes to the specified multibyte sequence
     void TestEncoder(
         const wchar_t* wideBuffer,  // the same character sequence as multiBuffer, encoded as wchar_t
@@ -463,6 +475,70 @@ void MBConvTestCase::UTF8Tests()
         );
 }
 
+// The runs of ASCII characters are converted in blocks of 16 characters (or
+// of the size of a machine word, depending on the platform) at once, so check
+// the lengths around the block boundaries and non-ASCII characters at all
+// positions inside the blocks.
+void MBConvTestCase::UTF8ASCIIRuns()
+{
+    char utf8[64];
+    wchar_t wide[64];
+
+    static const size_t lengths[] = { 15, 16, 17, 31, 32, 33 };
+    for ( size_t n = 0; n < WXSIZEOF(lengths); n++ )
+    {
+        const size_t len = lengths[n];
+        for ( size_t i = 0; i < len; i++ )
+        {
+            utf8[i] = 'a' + i % 26;
+            wide[i] = utf8[i];
+        }
+
+        TestUTF8ASCIIRun(utf8, len, wide, len);
+    }
+
+    // U+0080, U+00E9, U+0100 and U+4E00 encoded in UTF-8: use several
+    // non-ASCII characters as they are detected differently in wchar_t
+    // strings depending on whether they fit into a byte
+    static const struct
+    {
+        wchar_t wc;
+        const char *utf8;
+    } nonASCII[] =
+    {
+        { 0x80, "\xc2\x80" },
+        { 0xe9, "\xc3\xa9" },
+        { 0x100, "\xc4\x80" },
+        { 0x4e00, "\xe4\xb8\x80" },
+    };
+
+    const size_t len = 33;
+    for ( size_t pos = 0; pos < 32; pos++ )
+    {
+        const wchar_t wc = nonASCII[pos % WXSIZEOF(nonASCII)].wc;
+        const char * const mb = nonASCII[pos % WXSIZEOF(nonASCII)].utf8;
+        const size_t mbLen = strlen(mb);
+
+        size_t utf8Len = 0;
+        for ( size_t i = 0; i < len; i++ )
+        {
+            if ( i == pos )
+            {
+                memcpy(utf8 + utf8Len, mb, mbLen);
+                utf8Len += mbLen;
+                wide[i] = wc;
+            }
+            else
+            {
+                utf8[utf8Len++] = 'A' + i % 26;
+                wide[i] = utf8[utf8Len - 1];
+            }
+        }
+
+        TestUTF8ASCIIRun(utf8, utf8Len, wide, len);
+    }
+}
+
 void MBConvTestCase::UTF16LETests()
 {
     wxMBConvUTF16LE convUTF16LE;
@@ -1068,6 +1144,63 @@ void MBConvTestCase::TestDecoder(
 }
 
 // verifies that the specified wc sequences encodes to the specified mb sequence
+void MBConvTestCase::TestUTF8ASCIIRun(
+    const char*    utf8,
+    size_t         utf8Len,
+    const wchar_t* wide,
+    size_t         wideLen
+    )
+{
+    wxMBConvStrictUTF8 conv;
+
+    // use all the possible alignments of the source buffer
+    for ( size_t offset = 0; offset < 16; offset++ )
+    {
+        char mbuf[96];
+        wchar_t wbuf[96];
+
+        memcpy(mbuf + offset, utf8, utf8Len);
+        memcpy(wbuf + offset, wide, wideLen*sizeof(wchar_t));
+
+        const char * const src = mbuf + offset;
+        const wchar_t * const wsrc = wbuf + offset;
+
+        // UTF-8 to wchar_t
+        wchar_t wout[64];
+        for ( size_t n = 0; n < WXSIZEOF(wout); n++ )
+            wout[n] = L'!';
+
+        CPPUNIT_ASSERT_EQUAL( wideLen, conv.ToWChar(NULL, 0, src, utf8Len) );
+        CPPUNIT_ASSERT_EQUAL( wideLen,
+                              conv.ToWChar(wout, wideLen, src, utf8Len) );
+        CPPUNIT_ASSERT( memcmp(wout, wide, wideLen*sizeof(wchar_t)) == 0 );
+        CPPUNIT_ASSERT_EQUAL( L'!', wout[wideLen] );
+
+        for ( size_t n = 0; n < WXSIZEOF(wout); n++ )
+            wout[n] = L'!';
+
+        CPPUNIT_ASSERT_EQUAL( wxCONV_FAILED,
+                              conv.ToWChar(wout, wideLen - 1, src, utf8Len) );
+        CPPUNIT_ASSERT_EQUAL( L'!', wout[wideLen - 1] );
+
+        // wchar_t to UTF-8
+        char out[96];
+        memset(out, '!', sizeof(out));
+
+        CPPUNIT_ASSERT_EQUAL( utf8Len, conv.FromWChar(NULL, 0, wsrc, wideLen) );
+        CPPUNIT_ASSERT_EQUAL( utf8Len,
+                              conv.FromWChar(out, utf8Len, wsrc, wideLen) );
+        CPPUNIT_ASSERT( memcmp(out, utf8, utf8Len) == 0 );
+        CPPUNIT_ASSERT_EQUAL( '!', out[utf8Len] );
+
+        memset(out, '!', sizeof(out));
+
+        CPPUNIT_ASSERT_EQUAL( wxCONV_FAILED,
+                              conv.FromWChar(out, utf8Len - 1, wsrc, wideLen) );
+        CPPUNIT_ASSERT_EQUAL( '!', out[utf8Len - 1] );
+    }
+}
+
 void MBConvTestCase::TestEncoder(
     const wchar_t* wideBuffer,  // the same character sequence as multiBuffer, encoded as wchar_t
     size_t         wideChars,   // the number of wide characters at wideBuffer
@@ -0,0 +1,316 @@
+///////////////////////////////////////////////////////////////////////////////
+// Name:        tests/net/workerloop.cpp
+// Purpose:     Test sockets using event loops running in worker threads
+// Author:      wxWidgets team
+// Created:     2026-10-18
+// Copyright:   (c) 2026 wxWidgets team
+///////////////////////////////////////////////////////////////////////////////
+
+// ----------------------------------------------------------------------------
+// headers
+// ----------------------------------------------------------------------------
+
+#include "testprec.h"
+
+#ifdef __BORLANDC__
+    #pragma hdrstop
+#endif
+
+#if wxUSE_SOCKETS && wxUSE_THREADS && wxUSE_TIMER && wxUSE_EPOLL_DISPATCHER
+
+#include "wx/evtloop.h"
+#include "wx/socket.h"
+#include "wx/thread.h"
+#include "wx/timer.h"
+
+#include "wx/private/fdiodispatcher.h"
+
+#include <string.h>
+
+// ----------------------------------------------------------------------------
+// helper classes
+// ----------------------------------------------------------------------------
+
+namespace
+{
+
+// Socket remembering whether it was deleted.
+class WorkerSocket : public wxSocketBase
+{
+public:
+    WorkerSocket(bool& deleted)
+        : wxSocketBase(wxSOCKET_NOWAIT, wxSOCKET_BASE),
+          m_deleted(deleted)
+    {
+    }
+
+    virtual ~WorkerSocket()
+    {
+        m_deleted = true;
+    }
+
+private:
+    bool& m_deleted;
+};
+
+// Socket posting a semaphore when it's deleted and remembering the thread it
+// was deleted in.
+class DeletionNotifyingSocket : public wxSocketBase
+{
+public:
+    DeletionNotifyingSocket(wxSemaphore& deleted, wxThreadIdType& thread)
+        : wxSocketBase(wxSOCKET_NOWAIT, wxSOCKET_BASE),
+          m_deleted(deleted),
+          m_thread(thread)
+    {
+    }
+
+    virtual ~DeletionNotifyingSocket()
+    {
+        m_thread = wxThread::GetCurrentId();
+        m_deleted.Post();
+    }
+
+private:
+    wxSemaphore& m_deleted;
+    wxThreadIdType& m_thread;
+};
+
+// Handler answering to the data received by the socket and destroying it from
+// a timer started from the socket event handler.
+class WorkerSocketHandler : public wxEvtHandler
+{
+public:
+    WorkerSocketHandler(wxConsoleEventLoop& loop, wxSemaphore& done)
+        : m_loop(loop),
+          m_done(done),
+          m_timer(this)
+    {
+        m_socket = NULL;
+        m_inputThread =
+        m_timerThread = 0;
+        m_dispatcher = NULL;
+
+        Connect(wxEVT_SOCKET,
+                wxSocketEventHandler(WorkerSocketHandler::OnSocket));
+        Connect(wxEVT_TIMER,
+                wxTimerEventHandler(WorkerSocketHandler::OnTimer));
+    }
+
+    void SetSocket(wxSocketBase* socket) { m_socket = socket; }
+
+    wxThreadIdType GetInputThread() const { return m_inputThread; }
+    wxThreadIdType GetTimerThread() const { return m_timerThread; }
+
+    wxFDIODispatcher* GetDispatcher() const { return m_dispatcher; }
+
+private:
+    void OnSocket(wxSocketEvent& event)
+    {
+        if ( event.GetSocketEvent() != wxSOCKET_INPUT )
+            return;
+
+        m_inputThread = wxThread::GetCurrentId();
+        m_dispatcher = wxFDIODispatcher::Get();
+
+        char buf[4];
+        if ( m_socket->Read(buf, sizeof(buf)).LastCount() != sizeof(buf) ||
+                memcmp(buf, "ping", sizeof(buf)) != 0 )
+            return;
+
+        m_socket->Write("pong", 4);
+
+        // Timers can only be started in this thread because the worker loop
+        // installed its own scheduler for it and, as the main thread doesn't
+        // run any event loop during this test, this timer can only fire if it
+        // really uses this scheduler.
+        m_timer.StartOnce(10);
+    }
+
+    void OnTimer(wxTimerEvent& WXUNUSED(event))
+    {
+        m_timerThread = wxThread::GetCurrentId();
+
+        // The socket is deleted by the loop later, not immediately.
+        m_socket->Destroy();
+        m_socket = NULL;
+
+        m_loop.ScheduleExit();
+
+        m_done.Post();
+    }
+
+    wxConsoleEventLoop& m_loop;
+    wxSemaphore& m_done;
+    wxTimer m_timer;
+
+    wxSocketBase* m_socket;
+
+    wxThreadIdType m_inputThread,
+                   m_timerThread;
+
+    wxFDIODispatcher* m_dispatcher;
+
+    wxDECLARE_NO_COPY_CLASS(WorkerSocketHandler);
+};
+
+// Thread running the worker loop.
+class WorkerLoopThread : public wxThread
+{
+public:
+    WorkerLoopThread(wxConsoleEventLoop& loop)
+        : wxThread(wxTHREAD_JOINABLE),
+          m_loop(loop)
+    {
+        m_id = 0;
+        m_restored = false;
+    }
+
+    wxThreadIdType GetLoopThread() const { return m_id; }
+
+    // true if the thread dispatcher was reset after running the loop
+    bool WereRestored() const { return m_restored; }
+
+protected:
+    virtual ExitCode Entry()
+    {
+        m_id = wxThread::GetCurrentId();
+
+        m_loop.Run();
+
+        m_restored = !wxFDIODispatcher::SetForCurrentThread(NULL);
+
+        return 0;
+    }
+
+private:
+    wxConsoleEventLoop& m_loop;
+
+    wxThreadIdType m_id;
+    bool m_restored;
+};
+
+} // anonymous namespace
+
+// ----------------------------------------------------------------------------
+// test class
+// ----------------------------------------------------------------------------
+
+class WorkerLoopTestCase : public CppUnit::TestCase
+{
+public:
+    WorkerLoopTestCase() { }
+
+private:
+    CPPUNIT_TEST_SUITE( WorkerLoopTestCase );
+        CPPUNIT_TEST( AcceptedSocket );
+        CPPUNIT_TEST( DestroyFromOtherThread );
+    CPPUNIT_TEST_SUITE_END();
+
+    void AcceptedSocket();
+    void DestroyFromOtherThread();
+
+    DECLARE_NO_COPY_CLASS(WorkerLoopTestCase)
+};
+
+// register in the unnamed registry so that these tests are run by default
+CPPUNIT_TEST_SUITE_REGISTRATION( WorkerLoopTestCase );
+
+// also include in its own registry so that these tests can be run alone
+CPPUNIT_TEST_SUITE_NAMED_REGISTRATION( WorkerLoopTestCase, "WorkerLoopTestCase" );
+
+void WorkerLoopTestCase::AcceptedSocket()
+{
+    wxConsoleEventLoop loop(wxConsoleEventLoop::Dispatcher_Own);
+    CPPUNIT_ASSERT( loop.IsOk() );
+    CPPUNIT_ASSERT( loop.GetDispatcher() != wxFDIODispatcher::Get() );
+
+    wxIPV4address addr;
+    addr.LocalHost();
+    addr.Service(0);
+
+    wxSocketServer server(addr, wxSOCKET_REUSEADDR);
+    CPPUNIT_ASSERT( server.IsOk() );
+    CPPUNIT_ASSERT( server.GetLocal(addr) );
+
+    // Start the loop first to check that the sockets registered while it is
+    // already waiting for events are monitored by it.
+    WorkerLoopThread thread(loop);
+    CPPUNIT_ASSERT_EQUAL( wxTHREAD_NO_ERROR, thread.Run() );
+
+    wxSocketClient client(wxSOCKET_WAITALL);
+    CPPUNIT_ASSERT( client.Connect(addr) );
+    CPPUNIT_ASSERT( server.WaitForAccept(5) );
+
+    wxSemaphore done;
+    WorkerSocketHandler handler(loop, done);
+
+    bool deleted = false;
+    WorkerSocket* const sock = new WorkerSocket(deleted);
+    sock->SetEventLoop(&loop);
+    sock->SetEventHandler(handler);
+    sock->SetNotify(wxSOCKET_INPUT_FLAG);
+    sock->Notify(true);
+    handler.SetSocket(sock);
+
+    CPPUNIT_ASSERT( server.AcceptWith(*sock, false) );
+
+    client.SetTimeout(5);
+    client.Write("ping", 4);
+
+    char buf[4];
+    const bool gotAnswer =
+        client.Read(buf, sizeof(buf)).LastCount() == sizeof(buf) &&
+            memcmp(buf, "pong", sizeof(buf)) == 0;
+
+    // Don't hang if something went wrong.
+    const bool finished = done.WaitTimeout(5000) == wxSEMA_NO_ERROR;
+    if ( !finished )
+        loop.ScheduleExit();
+
+    thread.Wait();
+
+    CPPUNIT_ASSERT( gotAnswer );
+    CPPUNIT_ASSERT( finished );
+
+    // Both the socket and the timer events must have been processed in the
+    // worker thread, using its dispatcher.
+    CPPUNIT_ASSERT( thread.GetLoopThread() != wxThread::GetMainId() );
+    CPPUNIT_ASSERT( handler.GetInputThread() == thread.GetLoopThread() );
+    CPPUNIT_ASSERT( handler.GetTimerThread() == thread.GetLoopThread() );
+    CPPUNIT_ASSERT( handler.GetDispatcher() == loop.GetDispatcher() );
+
+    // The socket was deleted by the loop itself after Destroy().
+    CPPUNIT_ASSERT( deleted );
+
+    // And the loop didn't leave its dispatcher installed.
+    CPPUNIT_ASSERT( thread.WereRestored() );
+}
+
+void WorkerLoopTestCase::DestroyFromOtherThread()
+{
+    wxConsoleEventLoop loop(wxConsoleEventLoop::Dispatcher_Own);
+    CPPUNIT_ASSERT( loop.IsOk() );
+
+    WorkerLoopThread thread(loop);
+    CPPUNIT_ASSERT_EQUAL( wxTHREAD_NO_ERROR, thread.Run() );
+
+    wxSemaphore deleted;
+    wxThreadIdType deletedIn = 0;
+    wxSocketBase* const sock = new DeletionNotifyingSocket(deleted, deletedIn);
+    sock->SetEventLoop(&loop);
+
+    // The loop is (or will soon be) blocked waiting for events, destroying the
+    // socket from this thread must wake it up to delete it.
+    sock->Destroy();
+
+    const bool wasDeleted = deleted.WaitTimeout(5000) == wxSEMA_NO_ERROR;
+
+    loop.ScheduleExit();
+    thread.Wait();
+
+    CPPUNIT_ASSERT( wasDeleted );
+    CPPUNIT_ASSERT( deletedIn == thread.GetLoopThread() );
+}
+
+#endif // wxUSE_SOCKETS && wxUSE_THREADS && wxUSE_TIMER && wxUSE_EPOLL_DISPATCHER
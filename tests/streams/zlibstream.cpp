@@ -72,15 +72,18 @@ public:
         CPPUNIT_TEST(TestStream_NoHeader_SpeedComp);
         CPPUNIT_TEST(TestStream_NoHeader_BestComp);
         CPPUNIT_TEST(TestStream_NoHeader_Dictionary);
+        CPPUNIT_TEST(TestStream_NoHeader_Parallel);
         CPPUNIT_TEST(TestStream_ZLib_Default);
         CPPUNIT_TEST(TestStream_ZLib_NoComp);
         CPPUNIT_TEST(TestStream_ZLib_SpeedComp);
         CPPUNIT_TEST(TestStream_ZLib_BestComp);
+        CPPUNIT_TEST(TestStream_ZLib_Parallel);
         WXTEST_WITH_GZIP_CONDITION(TestStream_GZip_Default);
         WXTEST_WITH_GZIP_CONDITION(TestStream_GZip_NoComp);
         WXTEST_WITH_GZIP_CONDITION(TestStream_GZip_SpeedComp);
         WXTEST_WITH_GZIP_CONDITION(TestStream_GZip_BestComp);
         WXTEST_WITH_GZIP_CONDITION(TestStream_GZip_Dictionary);
+        WXTEST_WITH_GZIP_CONDITION(TestStream_GZip_Parallel);
         WXTEST_WITH_GZIP_CONDITION(TestStream_ZLibGZip);
         CPPUNIT_TEST(Decompress_BadData);
         CPPUNIT_TEST(Decompress_wx251_zlib114_Data_NoHeader);
@@ -95,15 +98,18 @@ protected:
     void TestStream_NoHeader_SpeedComp();
     void TestStream_NoHeader_BestComp();
     void TestStream_NoHeader_Dictionary();
+    void TestStream_NoHeader_Parallel();
     void TestStream_ZLib_Default();
     void TestStream_ZLib_NoComp();
     void TestStream_ZLib_SpeedComp();
     void TestStream_ZLib_BestComp();
+    void TestStream_ZLib_Parallel();
     void TestStream_GZip_Default();
     void TestStream_GZip_NoComp();
     void TestStream_GZip_SpeedComp();
     void TestStream_GZip_BestComp();
     void TestStream_GZip_Dictionary();
+    void TestStream_GZip_Parallel();
     void TestStream_ZLibGZip();
     // Try to decompress bad data.
     void Decompress_BadData();
@@ -117,7 +123,7 @@ protected:
 private:
     const char *GetDataBuffer();
     const unsigned char *GetCompressedData();
-    void doTestStreamData(int input_flag, int output_flag, int compress_level, const wxMemoryBuffer *buf = NULL);
+    void doTestStreamData(int input_flag, int output_flag, int compress_level, const wxMemoryBuffer *buf = NULL, int threads = 1);
     void doDecompress_ExternalData(const unsigned char *data, const char *value, size_t data_size, size_t value_size, int flag = wxZLIB_AUTO);
 
 private:
@@ -197,6 +203,10 @@ void zlibStream::TestStream_NoHeader_Dictionary()
 {
     doTestStreamData(wxZLIB_NO_HEADER, wxZLIB_NO_HEADER, wxZ_DEFAULT_COMPRESSION, &m_Dictionary);
 }
+void zlibStream::TestStream_NoHeader_Parallel()
+{
+    doTestStreamData(wxZLIB_NO_HEADER, wxZLIB_NO_HEADER, wxZ_DEFAULT_COMPRESSION, &m_Dictionary, 4);
+}
 
 void zlibStream::TestStream_ZLib_Default()
 {
@@ -214,6 +224,10 @@ void zlibStream::TestStream_ZLib_BestComp()
 {
     doTestStreamData(wxZLIB_ZLIB, wxZLIB_ZLIB, wxZ_BEST_COMPRESSION);
 }
+void zlibStream::TestStream_ZLib_Parallel()
+{
+    doTestStreamData(wxZLIB_ZLIB, wxZLIB_ZLIB, wxZ_DEFAULT_COMPRESSION, NULL, 4);
+}
 
 void zlibStream::TestStream_GZip_Default()
 {
@@ -235,6 +249,10 @@ void zlibStream::TestStream_GZip_Dictionary()
 {
     doTestStreamData(wxZLIB_GZIP, wxZLIB_GZIP, wxZ_DEFAULT_COMPRESSION, &m_Dictionary);
 }
+void zlibStream::TestStream_GZip_Parallel()
+{
+    doTestStreamData(wxZLIB_GZIP, wxZLIB_GZIP, wxZ_DEFAULT_COMPRESSION, NULL, 4);
+}
 
 void zlibStream::TestStream_ZLibGZip()
 {
@@ -321,7 +339,7 @@ const unsigned char *zlibStream::GetCompressedData()
     return m_pCompressedData;
 }
 
-void zlibStream::doTestStreamData(int input_flag, int output_flag, int compress_level, const wxMemoryBuffer *buf)
+void zlibStream::doTestStreamData(int input_flag, int output_flag, int compress_level, const wxMemoryBuffer *buf, int threads)
 {
     size_t fail_pos;
     char last_value = 0;
@@ -334,6 +352,10 @@ void zlibStream::doTestStreamData(int input_flag, int output_flag, int compress_
             wxZlibOutputStream zstream_out(fstream_out, compress_level, output_flag);
             CPPUNIT_ASSERT_MESSAGE("Could not create the output stream", zstream_out.IsOk());
 
+            // Use blocks much smaller than the data to compress.
+            if (threads != 1)
+                CPPUNIT_ASSERT(zstream_out.SetThreads(threads, DATABUFFER_SIZE / 10));
+
             if (buf)
                 zstream_out.SetDictionary(*buf);
 
@@ -61,6 +61,9 @@ private:
         CPPUNIT_TEST( CStrDataImplicitConversion );
         CPPUNIT_TEST( ExplicitConversion );
         CPPUNIT_TEST( IndexedAccess );
+#if wxUSE_UNICODE_UTF8
+        CPPUNIT_TEST( LongIndexedAccess );
+#endif // wxUSE_UNICODE_UTF8
         CPPUNIT_TEST( BeforeAndAfter );
         CPPUNIT_TEST( ScopedBuffers );
     CPPUNIT_TEST_SUITE_END();
@@ -96,6 +99,9 @@ private:
     void CStrDataImplicitConversion();
     void ExplicitConversion();
     void IndexedAccess();
+#if wxUSE_UNICODE_UTF8
+    void LongIndexedAccess();
+#endif // wxUSE_UNICODE_UTF8
     void BeforeAndAfter();
     void ScopedBuffers();
 
@@ -1033,6 +1039,60 @@ void StringTestCase::IndexedAccess()
     CPPUNIT_ASSERT_EQUAL( 'r', (char)s[2] );
 }
 
+#if wxUSE_UNICODE_UTF8
+
+// the positions index only exists in this build
+void StringTestCase::LongIndexedAccess()
+{
+    // the characters in this string take 1, 2 and 3 bytes in UTF-8
+    static const wchar_t chars[] = { L'x', L'\xe9', L'\x4e2d' };
+
+    wxString s;
+    for ( int n = 0; n < 3000; n++ )
+        s += chars[n % 3];
+
+    CPPUNIT_ASSERT_EQUAL( 3000, s.length() );
+
+    // access the characters in an order which requires seeking both backwards
+    // and forwards
+    for ( size_t n = 2999; n > 0; n -= 7 )
+    {
+        CPPUNIT_ASSERT_EQUAL( chars[n % 3], (wchar_t)s[n] );
+        CPPUNIT_ASSERT_EQUAL( chars[(3000 - n) % 3], (wchar_t)s[3000 - n] );
+
+        if ( n < 7 )
+            break;
+    }
+
+    // check that the string positions are updated after modifying it
+    s.insert(s.begin(), wxUniChar(chars[2]));
+    CPPUNIT_ASSERT_EQUAL( chars[1], (wchar_t)s[2000] );
+    CPPUNIT_ASSERT_EQUAL( chars[2], (wchar_t)s[0] );
+
+    s.erase(s.begin());
+    CPPUNIT_ASSERT_EQUAL( 3000, s.length() );
+    CPPUNIT_ASSERT_EQUAL( chars[2000 % 3], (wchar_t)s[2000] );
+
+    s.insert(0, "yy");
+    CPPUNIT_ASSERT_EQUAL( chars[2000 % 3], (wchar_t)s[2002] );
+
+    s.erase(0, 3);
+    CPPUNIT_ASSERT_EQUAL( chars[2001 % 3], (wchar_t)s[2000] );
+
+    s[1000] = chars[0];
+    s[1001] = chars[0];
+    CPPUNIT_ASSERT_EQUAL( chars[2001 % 3], (wchar_t)s[2000] );
+
+    s += s;
+    CPPUNIT_ASSERT_EQUAL( chars[2001 % 3], (wchar_t)s[2999 + 2000] );
+    CPPUNIT_ASSERT_EQUAL( chars[1], (wchar_t)s[2999] );
+
+    s.assign(3000, chars[2]);
+    CPPUNIT_ASSERT_EQUAL( chars[2], (wchar_t)s[2999] );
+}
+
+#endif // wxUSE_UNICODE_UTF8
+
 void StringTestCase::BeforeAndAfter()
 {
     // Construct a string with 2 equal signs in it by concatenating its three
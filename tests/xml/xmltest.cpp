@@ -82,6 +82,9 @@ private:
         CPPUNIT_TEST( AppendToProlog );
         CPPUNIT_TEST( SetRoot );
         CPPUNIT_TEST( CopyNode );
+        CPPUNIT_TEST( Reader );
+        CPPUNIT_TEST( ReaderLarge );
+        CPPUNIT_TEST( LoadArena );
     CPPUNIT_TEST_SUITE_END();
 
     void InsertChild();
@@ -94,6 +97,9 @@ private:
     void AppendToProlog();
     void SetRoot();
     void CopyNode();
+    void Reader();
+    void ReaderLarge();
+    void LoadArena();
 
     DECLARE_NO_COPY_CLASS(XmlTestCase)
 };
@@ -507,3 +513,170 @@ void XmlTestCase::CopyNode()
     ;
     CPPUNIT_ASSERT_EQUAL( xmlTextResult, sos.GetString() );
 }
+
+void XmlTestCase::Reader()
+{
+    const char *xmlText =
+"<?xml version=\"1.0\" encoding=\"UTF-8\"?>\n"
+"<!-- comment -->\n"
+"<root a=\"1\" b=\"x&amp;y\">\n"
+"  <p>Some &lt;text&gt;</p>\n"
+"  <?target data?>\n"
+"  <empty/><![CDATA[<cdata>]]>\n"
+"</root>\n"
+    ;
+
+    wxStringInputStream sis(xmlText);
+    wxXmlReader reader(sis);
+
+    CPPUNIT_ASSERT_EQUAL( wxXML_READER_COMMENT, reader.Next() );
+    CPPUNIT_ASSERT_EQUAL( " comment ", reader.GetContent() );
+    CPPUNIT_ASSERT_EQUAL( "1.0", reader.GetVersion() );
+    CPPUNIT_ASSERT_EQUAL( "UTF-8", reader.GetFileEncoding() );
+
+    CPPUNIT_ASSERT_EQUAL( wxXML_READER_START_ELEMENT, reader.Next() );
+    CPPUNIT_ASSERT_EQUAL( "root", reader.GetName() );
+    CPPUNIT_ASSERT_EQUAL( 0, reader.GetDepth() );
+    CPPUNIT_ASSERT_EQUAL( 3, reader.GetLineNumber() );
+    CPPUNIT_ASSERT_EQUAL( (size_t)2, reader.GetAttributesCount() );
+    CPPUNIT_ASSERT_EQUAL( "a", reader.GetAttributeName(0) );
+    CPPUNIT_ASSERT_EQUAL( "x&y", reader.GetAttribute("b") );
+    CPPUNIT_ASSERT_EQUAL( "def", reader.GetAttribute("c", "def") );
+    CPPUNIT_ASSERT( !reader.GetAttribute("c", NULL) );
+
+    CPPUNIT_ASSERT_EQUAL( wxXML_READER_START_ELEMENT, reader.Next() );
+    CPPUNIT_ASSERT_EQUAL( "p", reader.GetName() );
+    CPPUNIT_ASSERT_EQUAL( 1, reader.GetDepth() );
+    CPPUNIT_ASSERT( !reader.GetAttributesCount() );
+
+    CPPUNIT_ASSERT_EQUAL( wxXML_READER_TEXT, reader.Next() );
+    CPPUNIT_ASSERT_EQUAL( "Some <text>", reader.GetContent() );
+    CPPUNIT_ASSERT_EQUAL( 2, reader.GetDepth() );
+
+    CPPUNIT_ASSERT_EQUAL( wxXML_READER_END_ELEMENT, reader.Next() );
+    CPPUNIT_ASSERT_EQUAL( "p", reader.GetName() );
+    CPPUNIT_ASSERT_EQUAL( 1, reader.GetDepth() );
+
+    CPPUNIT_ASSERT_EQUAL( wxXML_READER_PI, reader.Next() );
+    CPPUNIT_ASSERT_EQUAL( "target", reader.GetName() );
+    CPPUNIT_ASSERT_EQUAL( "data", reader.GetContent() );
+
+    CPPUNIT_ASSERT_EQUAL( wxXML_READER_START_ELEMENT, reader.Next() );
+    CPPUNIT_ASSERT_EQUAL( "empty", reader.GetName() );
+    CPPUNIT_ASSERT_EQUAL( wxXML_READER_END_ELEMENT, reader.Next() );
+    CPPUNIT_ASSERT_EQUAL( "empty", reader.GetName() );
+
+    CPPUNIT_ASSERT_EQUAL( wxXML_READER_CDATA, reader.Next() );
+    CPPUNIT_ASSERT_EQUAL( "<cdata>", reader.GetContent() );
+
+    CPPUNIT_ASSERT_EQUAL( wxXML_READER_END_ELEMENT, reader.Next() );
+    CPPUNIT_ASSERT_EQUAL( "root", reader.GetName() );
+    CPPUNIT_ASSERT_EQUAL( 0, reader.GetDepth() );
+
+    CPPUNIT_ASSERT_EQUAL( wxXML_READER_END_DOCUMENT, reader.Next() );
+    CPPUNIT_ASSERT_EQUAL( wxXML_READER_END_DOCUMENT, reader.Next() );
+
+    // Errors are reported after all the preceding events.
+    wxLogNull noLog;
+    wxStringInputStream sisBad("<root><a></b></root>");
+    wxXmlReader readerBad(sisBad);
+    CPPUNIT_ASSERT_EQUAL( wxXML_READER_START_ELEMENT, readerBad.Next() );
+    CPPUNIT_ASSERT_EQUAL( "root", readerBad.GetName() );
+    CPPUNIT_ASSERT_EQUAL( wxXML_READER_START_ELEMENT, readerBad.Next() );
+    CPPUNIT_ASSERT_EQUAL( "a", readerBad.GetName() );
+    CPPUNIT_ASSERT_EQUAL( wxXML_READER_ERROR, readerBad.Next() );
+    CPPUNIT_ASSERT_EQUAL( wxXML_READER_ERROR, readerBad.Next() );
+}
+
+void XmlTestCase::ReaderLarge()
+{
+    // Check that the document spanning many input chunks is read in the same
+    // way by wxXmlReader and wxXmlDocument.
+    wxString xmlText("<root>\n");
+    for ( int n = 0; n < 10000; n++ )
+    {
+        xmlText += wxString::Format("  <item id=\"%d\">text %d</item>\n", n, n);
+        if ( n % 100 == 0 )
+            xmlText += "  <long>" + wxString('x', 5000) + "</long>\n";
+    }
+    xmlText += "</root>\n";
+
+    wxStringInputStream sisDoc(xmlText);
+    wxXmlDocument doc;
+    CPPUNIT_ASSERT( doc.Load(sisDoc) );
+
+    wxStringInputStream sis(xmlText);
+    wxXmlReader reader(sis);
+
+    CPPUNIT_ASSERT_EQUAL( wxXML_READER_START_ELEMENT, reader.Next() );
+    CPPUNIT_ASSERT_EQUAL( doc.GetRoot()->GetName(), reader.GetName() );
+
+    for ( const wxXmlNode *node = doc.GetRoot()->GetChildren();
+          node;
+          node = node->GetNext() )
+    {
+        CPPUNIT_ASSERT_EQUAL( wxXML_READER_START_ELEMENT, reader.Next() );
+        CPPUNIT_ASSERT_EQUAL( node->GetName(), reader.GetName() );
+        CPPUNIT_ASSERT_EQUAL( node->GetLineNumber(), reader.GetLineNumber() );
+        CPPUNIT_ASSERT_EQUAL( node->GetAttribute("id"),
+                              reader.GetAttribute("id") );
+
+        CPPUNIT_ASSERT_EQUAL( wxXML_READER_TEXT, reader.Next() );
+        CPPUNIT_ASSERT_EQUAL( node->GetNodeContent(), reader.GetContent() );
+
+        CPPUNIT_ASSERT_EQUAL( wxXML_READER_END_ELEMENT, reader.Next() );
+    }
+
+    CPPUNIT_ASSERT_EQUAL( wxXML_READER_END_ELEMENT, reader.Next() );
+    CPPUNIT_ASSERT_EQUAL( wxXML_READER_END_DOCUMENT, reader.Next() );
+}
+
+void XmlTestCase::LoadArena()
+{
+    wxString xmlText("<?xml version=\"1.0\" encoding=\"UTF-8\"?>\n"
+                     "<root>\n");
+    for ( int n = 0; n < 1000; n++ )
+    {
+        xmlText += wxString::Format("  <item id=\"%d\" kind=\"test\">"
+                                    "<!-- comment --><![CDATA[data]]>"
+                                    "<?pi %d?>text %d</item>\n", n, n, n);
+    }
+    xmlText += "</root>\n";
+
+    wxStringInputStream sis(xmlText);
+    wxXmlDocument doc;
+    CPPUNIT_ASSERT( doc.Load(sis) );
+
+    wxStringInputStream sisArena(xmlText);
+    wxScopedPtr<wxXmlDocument> docArena(new wxXmlDocument);
+    CPPUNIT_ASSERT( docArena->Load(sisArena, "UTF-8", wxXMLDOC_USE_ARENA) );
+
+    wxStringOutputStream sos;
+    CPPUNIT_ASSERT( doc.Save(sos) );
+    wxStringOutputStream sosArena;
+    CPPUNIT_ASSERT( docArena->Save(sosArena) );
+    CPPUNIT_ASSERT_EQUAL( sos.GetString(), sosArena.GetString() );
+
+    // The nodes allocated in the arena can be modified and deleted as usual.
+    wxXmlNode *root = docArena->GetRoot();
+    wxXmlNode *first = root->GetChildren();
+    CPPUNIT_ASSERT( root->RemoveChild(first) );
+    delete first;
+
+    wxXmlNode *second = root->GetChildren();
+    CPPUNIT_ASSERT( second->DeleteAttribute("kind") );
+    second->AddAttribute("new", "value");
+    root->AddChild(new wxXmlNode(wxXML_ELEMENT_NODE, "last"));
+
+    // And they must remain valid even after the document is destroyed.
+    root = docArena->DetachRoot();
+    docArena.reset();
+
+    CPPUNIT_ASSERT_EQUAL( "item", root->GetChildren()->GetName() );
+    CPPUNIT_ASSERT_EQUAL( "1", second->GetAttribute("id") );
+    CPPUNIT_ASSERT_EQUAL( "value", second->GetAttribute("new") );
+    CPPUNIT_ASSERT( !second->HasAttribute("kind") );
+    CPPUNIT_ASSERT_EQUAL( "data", second->GetNodeContent() );
+
+    delete root;
+}
@@ -24,6 +24,8 @@
 #include "wx/sstream.h"
 #include "wx/wfstream.h"
 #include "wx/xrc/xmlres.h"
+#include "wx/dir.h"
+#include "wx/filename.h"
 
 #include <stdarg.h>
 
@@ -144,10 +146,14 @@ private:
     CPPUNIT_TEST_SUITE( XrcTestCase );
         CPPUNIT_TEST( ObjectReferences );
         CPPUNIT_TEST( IDRanges );
+        CPPUNIT_TEST( BinaryCache );
+        CPPUNIT_TEST( LoadOnDemand );
     CPPUNIT_TEST_SUITE_END();
 
     void ObjectReferences();
     void IDRanges();
+    void BinaryCache();
+    void LoadOnDemand();
 
     DECLARE_NO_COPY_CLASS(XrcTestCase)
 };
@@ -226,3 +232,96 @@ void XrcTestCase::IDRanges()
         CPPUNIT_ASSERT( wxXmlResource::Get()->Unload(TEST_XRC_FILE) );
     }
 }
+
+void XrcTestCase::BinaryCache()
+{
+    const wxString cacheDir("xrccache");
+    CPPUNIT_ASSERT( wxFileName::Mkdir(cacheDir, wxS_DIR_DEFAULT,
+                                      wxPATH_MKDIR_FULL) );
+
+    wxXmlResource res;
+    res.InitAllHandlers();
+    res.SetCacheDirectory(cacheDir);
+
+    // The first time the file is parsed and the cache is created, the second
+    // time the cache is used and must give the same results.
+    for ( int n = 0; n < 2; ++n )
+    {
+        CPPUNIT_ASSERT( res.Load(TEST_XRC_FILE) );
+        CPPUNIT_ASSERT( wxDir(cacheDir).HasFiles("*.xrcb") );
+
+        const wxXmlNode * const node = res.GetResourceNode("dialog");
+        CPPUNIT_ASSERT( node );
+        CPPUNIT_ASSERT_EQUAL( "wxDialog", node->GetAttribute("class") );
+
+        wxDialog dlg;
+        CPPUNIT_ASSERT( res.LoadDialog(&dlg, NULL, "dialog") );
+        CPPUNIT_ASSERT_EQUAL( "test", dlg.GetTitle() );
+        CPPUNIT_ASSERT( XRCCTRL(dlg, "ref_of_panel1", wxPanel) );
+
+        CPPUNIT_ASSERT( res.Unload(TEST_XRC_FILE) );
+    }
+
+    // Check that the cache is not used after the file modification.
+    {
+        const char *xrc = "<?xml version=\"1.0\" ?>"
+                          "<resource>"
+                          "  <object class=\"wxPanel\" name=\"panel\"/>"
+                          "</resource>";
+
+        wxFFileOutputStream fos(TEST_XRC_FILE);
+        CPPUNIT_ASSERT( fos.IsOk() );
+        fos.Write(xrc, strlen(xrc));
+    }
+
+    // Ensure that the modification time is different from the original one
+    // even if the file system timestamps have low resolution.
+    const wxDateTime future = wxDateTime::Now() + wxTimeSpan::Hours(1);
+    CPPUNIT_ASSERT( wxFileName(TEST_XRC_FILE).SetTimes(NULL, &future, NULL) );
+
+    CPPUNIT_ASSERT( res.Load(TEST_XRC_FILE) );
+    CPPUNIT_ASSERT( res.GetResourceNode("panel") );
+    CPPUNIT_ASSERT( !res.GetResourceNode("dialog") );
+    CPPUNIT_ASSERT( res.Unload(TEST_XRC_FILE) );
+
+    CPPUNIT_ASSERT( wxFileName::Rmdir(cacheDir, wxPATH_RMDIR_RECURSIVE) );
+}
+
+void XrcTestCase::LoadOnDemand()
+{
+    wxXmlResource res(wxXRC_USE_LOCALE | wxXRC_LOAD_ON_DEMAND);
+    res.InitAllHandlers();
+
+    // Loading a broken file on demand succeeds as it isn't parsed yet.
+    const char * const BROKEN_XRC_FILE = "broken.xrc";
+    {
+        wxFFileOutputStream fos(BROKEN_XRC_FILE);
+        CPPUNIT_ASSERT( fos.IsOk() );
+        fos.Write("<resource>", 10);
+    }
+
+    CPPUNIT_ASSERT( res.Load(TEST_XRC_FILE) );
+    CPPUNIT_ASSERT( res.Load(BROKEN_XRC_FILE) );
+
+    // The resources from the first file can be used without parsing the
+    // second one.
+    wxDialog dlg;
+    CPPUNIT_ASSERT( res.LoadDialog(&dlg, NULL, "dialog") );
+    CPPUNIT_ASSERT( XRCCTRL(dlg, "panel1", wxPanel) );
+
+    const wxXmlNode * const node = res.GetResourceNode("panel1");
+    CPPUNIT_ASSERT( node );
+    CPPUNIT_ASSERT_EQUAL( "wxPanel", node->GetAttribute("class") );
+
+    {
+        // Looking for a non-existent resource does parse the second file.
+        wxLogNull noLog;
+        CPPUNIT_ASSERT( !res.GetResourceNode("nonexistent") );
+    }
+
+    CPPUNIT_ASSERT( res.Unload(BROKEN_XRC_FILE) );
+    CPPUNIT_ASSERT( res.Unload(TEST_XRC_FILE) );
+    CPPUNIT_ASSERT( !res.GetResourceNode("panel1") );
+
+    wxRemoveFile(BROKEN_XRC_FILE);
+}